@@ -1 +1,2 @@
 find_package(GStreamer REQUIRED)
+find_package(ALSA REQUIRED)
@@ -0,0 +1,51 @@
+#include "audio/buffer_pool.h"
+
+#include <gst/gst.h>
+
+#include <benchmark/benchmark.h>
+
+#include <cstring>
+
+namespace
+{
+constexpr int BLOCK = 480;
+
+/// @brief What need_data does for every block before rendering into it: allocate a buffer, map
+/// it for writing, unmap and release it. Arg: bytes per frame.
+void gst_buffer_allocate(benchmark::State& state) {
+    gsize size = BLOCK * static_cast<gsize>(state.range(0));
+    for (auto _ : state) {
+        GstBuffer* buffer = gst_buffer_new_allocate(nullptr, size, nullptr);
+        GstMapInfo map;
+        gst_buffer_map(buffer, &map, GST_MAP_WRITE);
+        std::memset(map.data, 0, map.size);
+        benchmark::DoNotOptimize(map.data);
+        gst_buffer_unmap(buffer, &map);
+        gst_buffer_unref(buffer);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(gst_buffer_allocate)->Arg(2)->Arg(4)->Arg(8)->ArgName("bytes_per_frame");
+
+/// @brief The same with the buffer taken from an audio::BufferPool and recycled on unref.
+void gst_buffer_pool(benchmark::State& state) {
+    audio::BufferPool pool;
+    if (!pool.start(nullptr, BLOCK * static_cast<guint>(state.range(0)), 8)) {
+        state.SkipWithError("could not start the pool");
+        return;
+    }
+    for (auto _ : state) {
+        GstBuffer* buffer = pool.acquire();
+        GstMapInfo map;
+        gst_buffer_map(buffer, &map, GST_MAP_WRITE);
+        std::memset(map.data, 0, map.size);
+        benchmark::DoNotOptimize(map.data);
+        gst_buffer_unmap(buffer, &map);
+        gst_buffer_unref(buffer);
+    }
+    state.counters["misses"] = double(pool.misses());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(gst_buffer_pool)->Arg(2)->Arg(4)->Arg(8)->ArgName("bytes_per_frame");
+
+}  // namespace
@@ -0,0 +1,81 @@
+#include "logger/logger.h"
+#include "logger/trace.h"
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <iostream>
+#include <streambuf>
+
+namespace
+{
+/// @brief Sends std::cout nowhere while alive, so the benchmark measures the logger and not
+/// the terminal, and the report stays readable.
+class SilenceCout
+{
+public:
+    SilenceCout()
+    : saved(std::cout.rdbuf(&null)) {}
+    ~SilenceCout() { std::cout.rdbuf(saved); }
+
+private:
+    class NullBuffer : public std::streambuf
+    {
+    protected:
+        int overflow(int c) override { return c; }
+        std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+    };
+
+    NullBuffer null;
+    std::streambuf* saved;
+};
+
+void log_constant(benchmark::State& state) {
+    SilenceCout silence;
+    for (auto _ : state) {
+        logger::log("Note on");
+    }
+}
+BENCHMARK(log_constant);
+
+void log_formatted(benchmark::State& state) {
+    SilenceCout silence;
+    int note = 60;
+    for (auto _ : state) {
+        logger::log("Note on: {} velocity {} at {}", note, 100, 1.5);
+    }
+}
+BENCHMARK(log_formatted);
+
+/// @brief The caller's side of async logging; the writer thread drains in the background.
+void log_async_formatted(benchmark::State& state) {
+    SilenceCout silence;
+    logger::start_async();
+    auto droppedBefore = logger::dropped();
+    int note = 60;
+    for (auto _ : state) {
+        logger::log("Note on: {} velocity {} at {}", note, 100, 1.5);
+    }
+    state.counters["dropped"] = double(logger::dropped() - droppedBefore);
+    logger::stop_async();
+}
+BENCHMARK(log_async_formatted);
+
+void trace_formatted(benchmark::State& state) {
+    auto path = std::filesystem::temp_directory_path() / "benchmarks.trace";
+    if (!logger::start_trace(path.string())) {
+        state.SkipWithError("could not create the trace file");
+        return;
+    }
+    auto droppedBefore = logger::trace_dropped();
+    int note = 60;
+    for (auto _ : state) {
+        logger::trace("Note on: {} velocity {} at {}", note, 100, 1.5);
+    }
+    state.counters["dropped"] = double(logger::trace_dropped() - droppedBefore);
+    logger::stop_trace();
+    std::filesystem::remove(path);
+}
+BENCHMARK(trace_formatted);
+
+}  // namespace
@@ -0,0 +1,14 @@
+#include <gst/gst.h>
+
+#include <benchmark/benchmark.h>
+
+int main(int argc, char* argv[]) {
+    gst_init(&argc, &argv);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include "events/event.h"
+#include "events/event_queue.h"
+#include "midi/decoder.h"
+#include "midi/smf.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+/// @brief Note on, note off and control change messages, as they come from a keyboard.
+constexpr std::array<std::array<std::uint8_t, 3>, 4> MESSAGES = {{
+    {0x90, 60, 100},
+    {0x80, 60, 0},
+    {0x90, 64, 0},
+    {0xB0, 64, 127},
+}};
+
+void parse_message(benchmark::State& state) {
+    events::Event event;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        auto const& message = MESSAGES[i++ % MESSAGES.size()];
+        benchmark::DoNotOptimize(events::parse(message.data(), message.size(), 0, event));
+        benchmark::DoNotOptimize(event);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(parse_message);
+
+/// @brief What midi_callback and need_data do per message: parse, push, and pop on the other side.
+void parse_push_pop(benchmark::State& state) {
+    events::EventQueue queue;
+    events::Event event;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        auto const& message = MESSAGES[i++ % MESSAGES.size()];
+        if (events::parse(message.data(), message.size(), 0, event)) {
+            queue.push(event);
+        }
+        queue.pop(event);
+        benchmark::DoNotOptimize(event);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(parse_push_pop);
+
+/// @brief A mod wheel sweep in running status, the densest stream a controller sends.
+std::vector<std::uint8_t> controller_sweep() {
+    std::vector<std::uint8_t> bytes = {0xB0};
+    for (int i = 0; i < 1024; ++i) {
+        int value = i % 256;
+        bytes.insert(bytes.end(), {1, std::uint8_t(value < 128 ? value : 255 - value)});
+    }
+    return bytes;
+}
+
+struct ControllerSum
+{
+    void control_change(std::uint8_t, std::uint8_t, std::uint8_t value) { sum += value; }
+    std::uint64_t sum = 0;
+};
+
+void decode_controller_sweep(benchmark::State& state) {
+    auto bytes = controller_sweep();
+    ControllerSum handler;
+    midi::Decoder decoder(handler);
+    for (auto _ : state) {
+        decoder.decode(bytes);
+        benchmark::DoNotOptimize(handler.sum);
+    }
+    state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(decode_controller_sweep);
+
+void append_be(std::vector<std::uint8_t>& out, std::uint32_t value, int size) {
+    for (int i = size - 1; i >= 0; --i) {
+        out.push_back(std::uint8_t(value >> (8 * i)));
+    }
+}
+
+/// @brief A format 1 file of 16 tracks of notes with running status, small deltas and a tempo
+/// change every 64 events, roughly what a dense piano roll looks like.
+std::filesystem::path write_test_file() {
+    constexpr int TRACKS = 16;
+    constexpr int EVENTS_PER_TRACK = 50'000;
+    std::vector<std::uint8_t> out = {'M', 'T', 'h', 'd'};
+    append_be(out, 6, 4);
+    append_be(out, 1, 2);
+    append_be(out, TRACKS, 2);
+    append_be(out, 480, 2);
+    for (int t = 0; t < TRACKS; ++t) {
+        std::vector<std::uint8_t> track;
+        for (int i = 0; i < EVENTS_PER_TRACK; ++i) {
+            if (i % 64 == 0) {
+                track.insert(track.end(), {0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20});
+            }
+            std::uint8_t delta = std::uint8_t((i * 7 + t) % 96);
+            track.insert(track.end(), {delta, std::uint8_t(0x90 | t), std::uint8_t(i % 128), 90});
+        }
+        track.insert(track.end(), {0x00, 0xFF, 0x2F, 0x00});
+        out.insert(out.end(), {'M', 'T', 'r', 'k'});
+        append_be(out, std::uint32_t(track.size()), 4);
+        out.insert(out.end(), track.begin(), track.end());
+    }
+    auto path = std::filesystem::temp_directory_path() / "benchmarks.mid";
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(out.data()), std::streamsize(out.size()));
+    return path;
+}
+
+/// @brief Decode every event of a mapped file, merged across tracks.
+void smf_read(benchmark::State& state) {
+    auto path = write_test_file();
+    midi::File file;
+    if (!file.open(path.string())) {
+        state.SkipWithError("could not open the test file");
+        return;
+    }
+    midi::EventReader reader = file.events();
+    std::int64_t events = 0;
+    for (auto _ : state) {
+        reader.rewind();
+        for (midi::Event const& event : reader) {
+            benchmark::DoNotOptimize(event.data1);
+            ++events;
+        }
+    }
+    state.SetItemsProcessed(events);
+    state.SetBytesProcessed(
+        state.iterations() * static_cast<std::int64_t>(std::filesystem::file_size(path))
+    );
+    std::filesystem::remove(path);
+}
+BENCHMARK(smf_read);
+
+}  // namespace
@@ -0,0 +1,83 @@
+#include "oscillator/oscillator.h"
+#include "synth/render.h"
+#include "synth/voice_engine.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+
+namespace
+{
+constexpr int BLOCK = 480;  // what need_data renders per callback
+constexpr int SAMPLE_RATE = 48'000;
+
+/// @brief The per-sample std::sin loop need_data used before the oscillator kernels, as the
+/// baseline they are measured against.
+void sine_reference(benchmark::State& state) {
+    std::array<float, BLOCK> buffer{};
+    double phase = 0.0;
+    double const increment = 2.0 * std::numbers::pi * 440.0 / SAMPLE_RATE;
+    for (auto _ : state) {
+        for (int i = 0; i < BLOCK; ++i) {
+            buffer[i] = static_cast<float>(0.3 * std::sin(phase));
+            phase += increment;
+            if (phase >= 2.0 * std::numbers::pi) {
+                phase -= 2.0 * std::numbers::pi;
+            }
+        }
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * BLOCK);
+}
+BENCHMARK(sine_reference);
+
+/// @brief One oscillator kernel filling a block, as app_src.cpp does. Args: isa, waveform.
+void oscillator_kernel(benchmark::State& state) {
+    auto isa = static_cast<oscillator::Isa>(state.range(0));
+    auto waveform = static_cast<oscillator::Waveform>(state.range(1));
+    if (!oscillator::is_supported(isa)) {
+        state.SkipWithError("instruction set not supported by this CPU");
+        return;
+    }
+    auto kernel = oscillator::kernels(isa).get(waveform);
+    std::array<float, BLOCK> buffer{};
+    float phase = 0.f;
+    for (auto _ : state) {
+        std::memset(buffer.data(), 0, sizeof(buffer));
+        kernel(buffer.data(), BLOCK, phase, 440.f / SAMPLE_RATE, 0.3f, 0.f);
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * BLOCK);
+}
+BENCHMARK(oscillator_kernel)
+    ->ArgsProduct({
+        {int(oscillator::Isa::SCALAR), int(oscillator::Isa::SSE41), int(oscillator::Isa::AVX2)},
+        {int(oscillator::Waveform::SINE),
+         int(oscillator::Waveform::SAW),
+         int(oscillator::Waveform::SQUARE)},
+    })
+    ->ArgNames({"isa", "waveform"});
+
+/// @brief A full midiplayer block: mix the held voices and write f32 mono. Arg: voices.
+void render_block(benchmark::State& state) {
+    synth::VoiceEngine engine(SAMPLE_RATE, synth::Waveform::SQUARE);
+    for (int n = 0; n < state.range(0); ++n) {
+        engine.note_on(0, static_cast<std::uint8_t>(36 + n), 100);
+    }
+    auto render = synth::renderer(synth::Waveform::SQUARE, 1, synth::SampleFormat::F32);
+    std::array<float, BLOCK> buffer{};
+    for (auto _ : state) {
+        render(engine, buffer.data(), BLOCK);
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * BLOCK);
+}
+BENCHMARK(render_block)->Arg(1)->Arg(8)->Arg(32)->Arg(64)->ArgName("voices");
+
+}  // namespace
@@ -0,0 +1,130 @@
+#include "resampler/resampler.h"
+#include "soundfont/player.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+constexpr int BLOCK = 480;
+constexpr int SAMPLE_RATE = 48'000;
+constexpr int SAMPLE_FRAMES = 1 << 16;
+constexpr float SEMITONE_UP = 1.0594631f;
+
+/// @brief A second or so of a harmonically rich 16 bit sample: the source of a voice.
+std::vector<std::int16_t> sample_data() {
+    std::vector<std::int16_t> data(SAMPLE_FRAMES);
+    for (int i = 0; i < SAMPLE_FRAMES; ++i) {
+        double x = 0.0;
+        for (int h = 1; h < 16; ++h) {
+            x += std::sin(0.0131 * i * h) / h;
+        }
+        data[i] = static_cast<std::int16_t>(x * 12'000.0);
+    }
+    return data;
+}
+
+/// @brief Voices of this cost one core could keep playing in real time at 48 kHz.
+benchmark::Counter realtime_voices(benchmark::State const& state) {
+    return {double(state.iterations()) * BLOCK / SAMPLE_RATE, benchmark::Counter::kIsRate};
+}
+
+/// @brief One voice pitched a semitone up through a resampling kernel. Args: isa, quality.
+void resample_voice(benchmark::State& state) {
+    auto isa = static_cast<resampler::Isa>(state.range(0));
+    auto quality = static_cast<resampler::Quality>(state.range(1));
+    if (!oscillator::is_supported(isa)) {
+        state.SkipWithError("instruction set not supported by this CPU");
+        return;
+    }
+    auto const kernel = resampler::kernels(isa).samples;
+    auto const& filter = resampler::filter(quality, SEMITONE_UP);
+    auto const data = sample_data();
+    std::array<float, BLOCK> buffer{};
+    double position = resampler::MAX_TAPS;
+    for (auto _ : state) {
+        kernel(buffer.data(), BLOCK, data.data(), position, SEMITONE_UP, filter, 0.3f, 0.f);
+        if (position > SAMPLE_FRAMES - 2 * BLOCK) {
+            position = resampler::MAX_TAPS;
+        }
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * BLOCK);
+    state.counters["realtime_voices"] = realtime_voices(state);
+}
+BENCHMARK(resample_voice)
+    ->ArgsProduct({
+        {int(resampler::Isa::SCALAR), int(resampler::Isa::SSE41), int(resampler::Isa::AVX2)},
+        {int(resampler::Quality::LINEAR),
+         int(resampler::Quality::FAST),
+         int(resampler::Quality::GOOD),
+         int(resampler::Quality::BEST)},
+    })
+    ->ArgNames({"isa", "quality"});
+
+/// @brief One looped SoundFont voice, loop wrap included, as the engine plays it. Arg: quality.
+void play_sample(benchmark::State& state) {
+    auto quality = static_cast<resampler::Quality>(state.range(0));
+    auto const data = sample_data();
+    soundfont::Zone const zone = {
+        .start = 0,
+        .end = SAMPLE_FRAMES,
+        .loopStart = SAMPLE_FRAMES / 2,
+        .loopEnd = SAMPLE_FRAMES - 16,
+        .rootKey = 60.f,
+        .sampleRate = float(SAMPLE_RATE),
+        .gain = 1.f,
+        .loop = soundfont::LoopMode::CONTINUOUS,
+        .keyLow = 0,
+        .keyHigh = 127,
+        .velocityLow = 0,
+        .velocityHigh = 127,
+    };
+    std::array<float, BLOCK> buffer{};
+    double position = 0.0;
+    for (auto _ : state) {
+        soundfont::play(
+            buffer.data(), BLOCK, data, zone, position, SEMITONE_UP, 0.3f, 0.f, true, quality
+        );
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * BLOCK);
+    state.counters["realtime_voices"] = realtime_voices(state);
+}
+BENCHMARK(play_sample)
+    ->Arg(int(resampler::Quality::LINEAR))
+    ->Arg(int(resampler::Quality::FAST))
+    ->Arg(int(resampler::Quality::GOOD))
+    ->Arg(int(resampler::Quality::BEST))
+    ->ArgName("quality");
+
+/// @brief The engine's 48 kHz output converted to a 44.1 kHz device, a block at a time.
+/// Arg: quality.
+void convert_stream(benchmark::State& state) {
+    auto quality = static_cast<resampler::Quality>(state.range(0));
+    resampler::Converter converter(SAMPLE_RATE, 44'100, quality, BLOCK);
+    std::vector<float> input(BLOCK * 2);
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        input[i] = float(std::sin(0.05 * double(i)));
+    }
+    std::array<float, BLOCK> output{};
+    for (auto _ : state) {
+        converter.process(input.data(), output.data(), BLOCK);
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * BLOCK);
+}
+BENCHMARK(convert_stream)
+    ->Arg(int(resampler::Quality::LINEAR))
+    ->Arg(int(resampler::Quality::GOOD))
+    ->Arg(int(resampler::Quality::BEST))
+    ->ArgName("quality");
+
+}  // namespace
@@ -0,0 +1,123 @@
+#include "soundfont/bank.h"
+#include "soundfont/sf2_builder.h"
+#include "synth/voice_engine.h"
+
+#include <benchmark/benchmark.h>
+
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+constexpr std::uint32_t BANK_MB = 512;
+constexpr std::uint32_t NUM_FRAMES = BANK_MB << 19;  // 16 bit frames
+constexpr std::uint32_t ZONES_PER_PROGRAM = 16;      // of 8 keys each
+constexpr std::uint32_t ZONE_FRAMES = NUM_FRAMES / (128 * ZONES_PER_PROGRAM);
+
+/// @brief A General MIDI sized bank over BANK_MB of samples, 256 kB a zone. The sample chunk is
+/// left as a hole in a sparse file, so it takes no time to write nor room on disk.
+std::filesystem::path write_large_bank() {
+    std::vector<Sample> headers;
+    std::vector<std::vector<Zone>> instruments;
+    std::vector<Preset> presets;
+    for (std::uint16_t program = 0; program < 128; ++program) {
+        std::vector<Zone> zones;
+        for (std::uint32_t z = 0; z < ZONES_PER_PROGRAM; ++z) {
+            std::uint32_t const start = std::uint32_t(headers.size()) * ZONE_FRAMES;
+            zones.push_back({
+                {GEN_KEY_RANGE, range(std::uint8_t(z * 8), std::uint8_t(z * 8 + 7))},
+                {GEN_SAMPLE_MODES, 1},
+                {GEN_SAMPLE_ID, std::uint16_t(headers.size())},
+            });
+            headers.push_back({
+                .start = start,
+                .end = start + ZONE_FRAMES - 64,
+                .loopStart = start + ZONE_FRAMES / 2,
+                .loopEnd = start + ZONE_FRAMES - 64,
+            });
+        }
+        instruments.push_back(std::move(zones));
+        presets.push_back({.program = program, .bank = 0, .zones = {{{GEN_INSTRUMENT, program}}}});
+    }
+    Bytes const presetData = pdta(headers, instruments, presets);
+
+    std::uint32_t const smplSize = NUM_FRAMES * 2;
+    std::uint32_t const sdtaSize = 4 + 8 + smplSize;
+    std::uint32_t const pdtaSize = 4 + std::uint32_t(presetData.size());
+    Bytes head = {'R', 'I', 'F', 'F'};
+    append_le(head, 4 + 8 + sdtaSize + 8 + pdtaSize, 4);
+    head.insert(head.end(), {'s', 'f', 'b', 'k', 'L', 'I', 'S', 'T'});
+    append_le(head, sdtaSize, 4);
+    head.insert(head.end(), {'s', 'd', 't', 'a', 's', 'm', 'p', 'l'});
+    append_le(head, smplSize, 4);
+    Bytes tail = {'L', 'I', 'S', 'T'};
+    append_le(tail, pdtaSize, 4);
+    tail.insert(tail.end(), {'p', 'd', 't', 'a'});
+    tail.insert(tail.end(), presetData.begin(), presetData.end());
+
+    auto path = std::filesystem::temp_directory_path() / "benchmarks.sf2";
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(head.data()), std::streamsize(head.size()));
+    file.seekp(smplSize, std::ios::cur);
+    file.write(reinterpret_cast<const char*>(tail.data()), std::streamsize(tail.size()));
+    return path;
+}
+
+double resident_mb() {
+    long pages = 0;
+    std::ifstream("/proc/self/statm") >> pages >> pages;
+    return double(pages) * double(::sysconf(_SC_PAGESIZE)) / (1 << 20);
+}
+
+/// @brief Open and index a large bank. Reports how much of it became resident.
+void open_large_bank(benchmark::State& state) {
+    auto const path = write_large_bank();
+    double const before = resident_mb();
+    for (auto _ : state) {
+        soundfont::Bank bank;
+        if (!bank.open(path.string())) {
+            state.SkipWithError("could not open the bank");
+            break;
+        }
+        benchmark::DoNotOptimize(bank.num_zones());
+    }
+    soundfont::Bank bank;
+    bank.open(path.string());
+    state.counters["bank_mb"] = BANK_MB;
+    state.counters["resident_mb"] = resident_mb() - before;
+    std::filesystem::remove(path);
+}
+BENCHMARK(open_large_bank)->Unit(benchmark::kMillisecond);
+
+/// @brief Play a chord from a large bank through the engine. Only the played zones are paged in:
+/// 8 of 2048, about 2 MB.
+void play_large_bank(benchmark::State& state) {
+    constexpr int BLOCK = 480;
+    auto const path = write_large_bank();
+    soundfont::Bank bank;
+    if (!bank.open(path.string())) {
+        state.SkipWithError("could not open the bank");
+        return;
+    }
+    double const before = resident_mb();
+    synth::VoiceEngine engine(48'000);
+    engine.set_soundfont(&bank);
+    for (std::uint8_t n = 0; n < 8; ++n) {
+        engine.note_on(0, std::uint8_t(24 + n * 8), 100);
+    }
+    std::array<float, BLOCK> buffer{};
+    for (auto _ : state) {
+        engine.render(buffer.data(), BLOCK);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    state.counters["resident_mb"] = resident_mb() - before;
+    state.SetItemsProcessed(state.iterations() * BLOCK);
+    std::filesystem::remove(path);
+}
+BENCHMARK(play_large_bank);
+
+}  // namespace
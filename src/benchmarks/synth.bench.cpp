@@ -0,0 +1,82 @@
+#include "synth/render.h"
+#include "synth/voice_engine.h"
+#include "synth/worker_pool.h"
+
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace
+{
+constexpr int BLOCK = 480;  // one midiplayer block, 10 ms at 48 kHz
+constexpr int SAMPLE_RATE = 48'000;
+constexpr double BLOCK_SECONDS = double(BLOCK) / SAMPLE_RATE;
+
+std::unique_ptr<synth::VoiceEngine> dense_engine(int voices) {
+    // Multitimbral material: the voices spread over all 16 channels.
+    auto engine = std::make_unique<synth::VoiceEngine>(SAMPLE_RATE, synth::Waveform::SAW);
+    for (int n = 0; n < voices; ++n) {
+        engine->note_on(std::uint8_t(n % 16), std::uint8_t(24 + n / 16 * 5 + n % 16), 100);
+    }
+    return engine;
+}
+
+/// @brief Seconds one block takes on the calling thread alone, the baseline for speedup.
+double serial_block_seconds(int voices) {
+    constexpr int BLOCKS = 200;
+    auto engine = dense_engine(voices);
+    auto render = synth::renderer(synth::Waveform::SAW, 1, synth::SampleFormat::F32);
+    std::array<float, BLOCK> buffer{};
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BLOCKS; ++i) {
+        render(*engine, buffer.data(), BLOCK);
+        benchmark::DoNotOptimize(buffer.data());
+    }
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / BLOCKS;
+}
+
+/// @brief A dense block mixed on a WorkerPool. Args: voices, threads. Reports how many voices
+/// each core sustains in real time and the speedup over a single thread.
+void parallel_mix(benchmark::State& state) {
+    int const voices = int(state.range(0));
+    int const threads = int(state.range(1));
+    if (threads > int(std::thread::hardware_concurrency())) {
+        state.SkipWithError("more threads than CPUs");
+        return;
+    }
+    double const serial = serial_block_seconds(voices);
+
+    auto engine = dense_engine(voices);
+    synth::WorkerPool workers(threads);
+    engine->set_workers(&workers);
+    auto render = synth::renderer(synth::Waveform::SAW, 1, synth::SampleFormat::F32);
+    std::array<float, BLOCK> buffer{};
+
+    auto const start = std::chrono::steady_clock::now();
+    for (auto _ : state) {
+        render(*engine, buffer.data(), BLOCK);
+        benchmark::DoNotOptimize(buffer.data());
+        benchmark::ClobberMemory();
+    }
+    double const elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                               .count();
+    double const perBlock = elapsed / double(state.iterations());
+
+    state.counters["voices_per_core"] = voices * (BLOCK_SECONDS / perBlock) / threads;
+    state.counters["speedup"] = serial / perBlock;
+    state.counters["steals"] = benchmark::Counter(
+        double(workers.steals()),
+        benchmark::Counter::kAvgIterations
+    );
+    state.SetItemsProcessed(state.iterations() * BLOCK);
+}
+BENCHMARK(parallel_mix)
+    ->ArgsProduct({{64, 256}, {1, 2, 4, 8}})
+    ->ArgNames({"voices", "threads"})
+    ->UseRealTime();
+
+}  // namespace
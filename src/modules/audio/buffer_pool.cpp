@@ -0,0 +1,84 @@
+#include "audio/buffer_pool.h"
+
+#include "logger/logger.h"
+
+#include <cstring>
+#include <vector>
+
+bool audio::BufferPool::start(GstCaps* caps, guint size, guint count) {
+    stop();
+    pool = gst_buffer_pool_new();
+
+    GstAllocationParams params;
+    gst_allocation_params_init(&params);
+    params.align = ALIGNMENT - 1;  // GStreamer takes the alignment as a mask
+
+    // min == max: everything is allocated when the pool is activated, and never again.
+    GstStructure* config = gst_buffer_pool_get_config(pool);
+    gst_buffer_pool_config_set_params(config, caps, size, count, count);
+    gst_buffer_pool_config_set_allocator(config, nullptr, &params);
+    if (!gst_buffer_pool_set_config(pool, config) || !gst_buffer_pool_set_active(pool, TRUE)) {
+        logger::log("Could not start a pool of {} buffers of {} bytes", count, size);
+        gst_object_unref(pool);
+        pool = nullptr;
+        return false;
+    }
+    bufferSize = size;
+    numBuffers = count;
+
+    // Take every buffer out once and write to it, so no page fault is left for the audio thread.
+    std::vector<GstBuffer*> buffers;
+    buffers.reserve(count);
+    for (guint i = 0; i < count; ++i) {
+        GstBuffer* buffer = nullptr;
+        if (gst_buffer_pool_acquire_buffer(pool, &buffer, nullptr) != GST_FLOW_OK) {
+            break;
+        }
+        GstMapInfo map;
+        if (gst_buffer_map(buffer, &map, GST_MAP_WRITE)) {
+            std::memset(map.data, 0, map.size);
+            gst_buffer_unmap(buffer, &map);
+        }
+        buffers.push_back(buffer);
+    }
+    for (GstBuffer* buffer : buffers) {
+        gst_buffer_unref(buffer);
+    }
+    hitCount.store(0, std::memory_order_relaxed);
+    missCount.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+void audio::BufferPool::stop() {
+    if (pool) {
+        gst_buffer_pool_set_active(pool, FALSE);
+        gst_object_unref(pool);
+        pool = nullptr;
+    }
+}
+
+GstBuffer* audio::BufferPool::try_acquire() {
+    if (!pool) {
+        return nullptr;
+    }
+    GstBufferPoolAcquireParams params{};
+    params.flags = GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT;
+    GstBuffer* buffer = nullptr;
+    if (gst_buffer_pool_acquire_buffer(pool, &buffer, &params) != GST_FLOW_OK) {
+        missCount.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    hitCount.fetch_add(1, std::memory_order_relaxed);
+    return buffer;
+}
+
+GstBuffer* audio::BufferPool::acquire() {
+    if (GstBuffer* buffer = try_acquire()) {
+        return buffer;
+    }
+    GstBuffer* buffer = nullptr;
+    if (!pool || gst_buffer_pool_acquire_buffer(pool, &buffer, nullptr) != GST_FLOW_OK) {
+        return nullptr;
+    }
+    return buffer;
+}
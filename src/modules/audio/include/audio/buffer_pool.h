@@ -0,0 +1,49 @@
+#pragma once
+
+#include <gst/gst.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace audio
+{
+/// @brief A fixed number of preallocated GstBuffers for an appsrc producer. Buffers go back to
+/// the pool when the last reference is dropped, normally by the sink, so after start() the
+/// audio path never allocates.
+class BufferPool
+{
+public:
+    static constexpr gsize ALIGNMENT = 64;  ///< of the buffer memory, for aligned SIMD stores
+
+    BufferPool() = default;
+    ~BufferPool() { stop(); }
+
+    BufferPool(BufferPool const&) = delete;
+    BufferPool& operator=(BufferPool const&) = delete;
+
+    /// @brief Allocate numBuffers buffers of size bytes and touch every page of them.
+    /// Returns false and logs on error.
+    bool start(GstCaps* caps, guint size, guint numBuffers);
+    void stop();
+
+    /// @brief A free buffer, or nullptr if all of them are in flight. Never blocks.
+    GstBuffer* try_acquire();
+
+    /// @brief A free buffer, waiting for the sink to release one if all of them are in flight.
+    /// Returns nullptr only if the pool is not started.
+    GstBuffer* acquire();
+
+    std::uint64_t hits() const { return hitCount.load(std::memory_order_relaxed); }
+    std::uint64_t misses() const { return missCount.load(std::memory_order_relaxed); }
+    guint buffer_size() const { return bufferSize; }
+    guint num_buffers() const { return numBuffers; }
+
+private:
+    GstBufferPool* pool = nullptr;
+    guint bufferSize = 0;
+    guint numBuffers = 0;
+    std::atomic<std::uint64_t> hitCount{0};
+    std::atomic<std::uint64_t> missCount{0};
+};
+
+}  // namespace audio
@@ -0,0 +1,21 @@
+#pragma once
+
+namespace audio
+{
+/// @brief Scheduling for a thread that has to meet audio deadlines.
+struct RealtimeOptions
+{
+    int priority = 0;  ///< SCHED_FIFO priority 1..99, 0 to keep the default policy
+    int cpu = -1;      ///< CPU to pin the thread to, -1 to let the scheduler choose
+};
+
+/// @brief Apply options to the calling thread. Steps that fail, typically for lack of
+/// CAP_SYS_NICE or an rtprio limit, are logged and skipped, and the thread keeps running with
+/// what it has. Returns true if everything requested was applied.
+bool make_realtime(RealtimeOptions const& options);
+
+/// @brief Lock current and future pages of the process in memory, so the audio path never
+/// waits on a page fault. Logs and returns false if the memlock limit does not allow it.
+bool lock_memory();
+
+}  // namespace audio
@@ -0,0 +1,46 @@
+#include "audio/realtime.h"
+
+#include "logger/logger.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+#include <cerrno>
+#include <cstring>
+
+bool audio::make_realtime(RealtimeOptions const& options) {
+    bool ok = true;
+    if (options.cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(options.cpu, &cpus);
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (error != 0) {
+            logger::log("Could not pin to CPU {}: {}", options.cpu, std::strerror(error));
+            ok = false;
+        }
+    }
+    if (options.priority > 0) {
+        sched_param param{};
+        param.sched_priority = options.priority;
+        int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (error != 0) {
+            logger::log(
+                "Could not use SCHED_FIFO priority {}: {}, keeping the default policy",
+                options.priority,
+                std::strerror(error)
+            );
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+bool audio::lock_memory() {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        logger::log("Could not lock memory: {}, pages may fault", std::strerror(errno));
+        return false;
+    }
+    return true;
+}
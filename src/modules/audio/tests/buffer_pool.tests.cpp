@@ -0,0 +1,42 @@
+#include "audio/buffer_pool.h"
+
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <vector>
+
+TEST_CASE("Buffers are aligned, counted and recycled") {
+    constexpr guint SIZE = 480 * sizeof(float);
+    constexpr guint COUNT = 4;
+    audio::BufferPool pool;
+    REQUIRE(pool.start(nullptr, SIZE, COUNT));
+
+    std::vector<GstBuffer*> buffers;
+    for (guint i = 0; i < COUNT; ++i) {
+        GstBuffer* buffer = pool.try_acquire();
+        REQUIRE(buffer);
+        CHECK(gst_buffer_get_size(buffer) == SIZE);
+        GstMapInfo map;
+        REQUIRE(gst_buffer_map(buffer, &map, GST_MAP_WRITE));
+        CHECK(reinterpret_cast<std::uintptr_t>(map.data) % audio::BufferPool::ALIGNMENT == 0);
+        gst_buffer_unmap(buffer, &map);
+        buffers.push_back(buffer);
+    }
+    CHECK(pool.hits() == COUNT);
+    CHECK(pool.try_acquire() == nullptr);
+    CHECK(pool.misses() == 1);
+
+    // Dropping the last reference, as the sink does, hands the buffer back.
+    GstBuffer* released = buffers.back();
+    buffers.pop_back();
+    gst_buffer_unref(released);
+    GstBuffer* recycled = pool.try_acquire();
+    CHECK(recycled == released);
+    buffers.push_back(recycled);
+
+    for (GstBuffer* buffer : buffers) {
+        gst_buffer_unref(buffer);
+    }
+    pool.stop();
+    CHECK(pool.try_acquire() == nullptr);
+}
@@ -0,0 +1,9 @@
+#define DOCTEST_CONFIG_IMPLEMENT
+#include <gst/gst.h>
+
+#include <doctest/doctest.h>
+
+int main(int argc, char* argv[]) {
+    gst_init(&argc, &argv);
+    return doctest::Context(argc, argv).run();
+}
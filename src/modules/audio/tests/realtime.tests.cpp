@@ -0,0 +1,25 @@
+#include "audio/realtime.h"
+
+#include <doctest/doctest.h>
+
+#include <sched.h>
+
+#include <thread>
+
+TEST_CASE("Default options change nothing") {
+    CHECK(audio::make_realtime({}));
+}
+
+TEST_CASE("A thread can be pinned, and a refused priority is not fatal") {
+    int cpu = sched_getcpu();
+    REQUIRE(cpu >= 0);
+    std::thread thread([cpu] {
+        CHECK(audio::make_realtime({.cpu = cpu}));
+        CHECK(sched_getcpu() == cpu);
+
+        // Succeeds with CAP_SYS_NICE or an rtprio limit, fails cleanly otherwise.
+        audio::make_realtime({.priority = 10});
+        CHECK(sched_getcpu() == cpu);
+    });
+    thread.join();
+}
@@ -0,0 +1,57 @@
+#include "events/capture.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+bool events::CaptureReader::open(std::string const& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (data.size() < sizeof(CAPTURE_MAGIC) ||
+        !std::equal(std::begin(CAPTURE_MAGIC), std::end(CAPTURE_MAGIC), data.begin())) {
+        data.clear();
+        return false;
+    }
+    rewind();
+    return true;
+}
+
+bool events::CaptureReader::next(CapturedMessage& message) {
+    if (pos + CAPTURE_RECORD_HEADER > data.size()) {
+        return false;
+    }
+    const std::uint8_t* header = data.data() + pos;
+    std::uint16_t size;
+    std::memcpy(&message.timestamp, header, 8);
+    message.port = header[8];
+    std::memcpy(&size, header + 10, 2);
+    if (pos + CAPTURE_RECORD_HEADER + size > data.size()) {
+        return false;  // truncated file
+    }
+    message.bytes = {header + CAPTURE_RECORD_HEADER, size};
+    pos += CAPTURE_RECORD_HEADER + size;
+    return true;
+}
+
+bool events::CaptureWriter::open(std::string const& path) {
+    file.open(path, std::ios::binary | std::ios::trunc);
+    file.write(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    return file.good();
+}
+
+void events::CaptureWriter::write(
+    std::int64_t timestamp,
+    std::uint8_t port,
+    std::span<const std::uint8_t> bytes
+) {
+    auto size = static_cast<std::uint16_t>(std::min<std::size_t>(bytes.size(), 0xFFFF));
+    char header[CAPTURE_RECORD_HEADER] = {};
+    std::memcpy(header, &timestamp, 8);
+    header[8] = static_cast<char>(port);
+    std::memcpy(header + 10, &size, 2);
+    file.write(header, CAPTURE_RECORD_HEADER);
+    file.write(reinterpret_cast<const char*>(bytes.data()), size);
+}
@@ -0,0 +1,74 @@
+#include "events/capture_ring.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace
+{
+// Every record starts on a RECORD_ALIGN boundary: int64 timestamp, uint32 size, uint32 unused,
+// then the message bytes. A record never wraps; when it does not fit before the end of the
+// buffer, a WRAP header sends the reader back to the start.
+constexpr std::size_t RECORD_ALIGN = 16;
+constexpr std::size_t HEADER_SIZE = 16;
+constexpr std::uint32_t WRAP = 0xFFFF'FFFF;
+
+constexpr std::size_t record_size(std::size_t bytes) {
+    return HEADER_SIZE + (bytes + RECORD_ALIGN - 1) / RECORD_ALIGN * RECORD_ALIGN;
+}
+}  // namespace
+
+events::CaptureRing::CaptureRing(std::size_t capacity)
+: size(std::bit_ceil(std::max(capacity, 2 * HEADER_SIZE)))
+, buffer(new std::uint8_t[size]) {}
+
+bool events::CaptureRing::push(std::int64_t timestamp, std::span<const std::uint8_t> bytes) {
+    std::size_t const need = record_size(bytes.size());
+    std::uint64_t h = head.load(std::memory_order_relaxed);
+    std::uint64_t const t = tail.load(std::memory_order_acquire);
+    std::size_t offset = h & (size - 1);
+    std::size_t const toEnd = size - offset;
+    std::size_t const total = need <= toEnd ? need : toEnd + need;
+    if (need > size / 2 || size - (h - t) < total) {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (need > toEnd) {
+        std::memcpy(buffer.get() + offset + 8, &WRAP, sizeof(WRAP));
+        h += toEnd;
+        offset = 0;
+    }
+    std::uint8_t* record = buffer.get() + offset;
+    auto length = static_cast<std::uint32_t>(bytes.size());
+    std::memcpy(record, &timestamp, sizeof(timestamp));
+    std::memcpy(record + 8, &length, sizeof(length));
+    std::memcpy(record + HEADER_SIZE, bytes.data(), bytes.size());
+    head.store(h + need, std::memory_order_release);
+    return true;
+}
+
+bool events::CaptureRing::peek(CapturedMessage& message) {
+    std::uint64_t t = tail.load(std::memory_order_relaxed);
+    std::uint64_t const h = head.load(std::memory_order_acquire);
+    while (t != h) {
+        std::size_t const offset = t & (size - 1);
+        std::uint8_t const* record = buffer.get() + offset;
+        std::uint32_t length;
+        std::memcpy(&length, record + 8, sizeof(length));
+        if (length == WRAP) {
+            t += size - offset;
+            tail.store(t, std::memory_order_release);
+            continue;
+        }
+        std::memcpy(&message.timestamp, record, sizeof(message.timestamp));
+        message.bytes = {record + HEADER_SIZE, length};
+        next = t + record_size(length);
+        return true;
+    }
+    return false;
+}
+
+void events::CaptureRing::pop() {
+    tail.store(next, std::memory_order_release);
+}
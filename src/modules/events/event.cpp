@@ -0,0 +1,60 @@
+#include "events/event.h"
+
+#include "midi/decoder.h"
+
+namespace
+{
+/// @brief Decoder handler that fills in an Event from the first channel message.
+struct EventBuilder
+{
+    void set(events::EventType type, std::uint8_t channel, std::uint8_t d1, std::uint8_t d2) {
+        if (!found) {
+            event.type = type;
+            event.channel = channel;
+            event.data1 = d1;
+            event.data2 = d2;
+            found = true;
+        }
+    }
+
+    void note_on(std::uint8_t ch, std::uint8_t note, std::uint8_t velocity) {
+        set(events::EventType::NOTE_ON, ch, note, velocity);
+    }
+    void note_off(std::uint8_t ch, std::uint8_t note, std::uint8_t velocity) {
+        set(events::EventType::NOTE_OFF, ch, note, velocity);
+    }
+    void control_change(std::uint8_t ch, std::uint8_t controller, std::uint8_t value) {
+        set(events::EventType::CONTROL_CHANGE, ch, controller, value);
+    }
+    void program_change(std::uint8_t ch, std::uint8_t program) {
+        set(events::EventType::PROGRAM_CHANGE, ch, program, 0);
+    }
+    void channel_pressure(std::uint8_t ch, std::uint8_t pressure) {
+        set(events::EventType::CHANNEL_PRESSURE, ch, pressure, 0);
+    }
+    void poly_pressure(std::uint8_t ch, std::uint8_t note, std::uint8_t pressure) {
+        set(events::EventType::POLY_PRESSURE, ch, note, pressure);
+    }
+    void pitch_bend(std::uint8_t ch, std::uint16_t value) {
+        set(events::EventType::PITCH_BEND, ch, value & 0x7F, std::uint8_t(value >> 7));
+    }
+
+    events::Event& event;
+    bool found = false;
+};
+}  // namespace
+
+bool events::parse(
+    const std::uint8_t* data,
+    std::size_t size,
+    std::int64_t timestamp,
+    Event& event
+) {
+    EventBuilder builder{event};
+    midi::Decoder decoder(builder);
+    decoder.decode({data, size});
+    if (builder.found) {
+        event.timestamp = timestamp;
+    }
+    return builder.found;
+}
@@ -0,0 +1,20 @@
+#include "events/event_queue.h"
+
+events::EventQueue::EventQueue(std::size_t capacity)
+: queue(capacity) {}
+
+bool events::EventQueue::push(Event const& event) {
+    if (!queue.try_enqueue(event)) {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+bool events::EventQueue::pop(Event& event) {
+    return queue.try_dequeue(event);
+}
+
+events::Event const* events::EventQueue::peek() {
+    return queue.peek();
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace events
+{
+/// @brief One raw MIDI message as received from a port.
+struct CapturedMessage
+{
+    std::int64_t timestamp;  ///< ns, as reported by libremidi::message::timestamp
+    std::uint8_t port;
+    std::span<const std::uint8_t> bytes;
+};
+
+// Capture file layout: the 8 byte magic, then one record per message:
+// int64 timestamp, uint8 port, uint8 reserved, uint16 size, followed by size bytes.
+constexpr char CAPTURE_MAGIC[8] = {'M', 'T', 'C', 'A', 'P', 'T', 'R', '1'};
+constexpr std::size_t CAPTURE_RECORD_HEADER = 12;  ///< bytes of a record before the message
+
+/// @brief Reads a capture file written by CaptureWriter.
+class CaptureReader
+{
+public:
+    /// @brief Load a capture file. Returns false if it cannot be read or is not a capture.
+    bool open(std::string const& path);
+
+    /// @brief The next message, valid until the reader is destroyed. Returns false at the end.
+    bool next(CapturedMessage& message);
+
+    void rewind() { pos = sizeof(CAPTURE_MAGIC); }
+
+private:
+    std::vector<std::uint8_t> data;
+    std::size_t pos = 0;
+};
+
+/// @brief Appends messages to a capture file.
+class CaptureWriter
+{
+public:
+    bool open(std::string const& path);
+    void write(std::int64_t timestamp, std::uint8_t port, std::span<const std::uint8_t> bytes);
+    void close() { file.close(); }
+
+private:
+    std::ofstream file;
+};
+
+}  // namespace events
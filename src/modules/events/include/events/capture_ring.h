@@ -0,0 +1,50 @@
+#pragma once
+
+#include "events/capture.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace events
+{
+/// @brief Single-producer single-consumer ring of raw MIDI messages of any length, for handing
+/// messages from a MIDI input thread to a thread that writes them out.
+///
+/// The storage is allocated in the constructor. push() copies the message into the ring and
+/// never locks or allocates; when the ring is full the message is dropped and counted instead.
+class CaptureRing
+{
+public:
+    /// @param capacity bytes of storage, rounded up to a power of two
+    explicit CaptureRing(std::size_t capacity = 256 * 1024);
+
+    CaptureRing(CaptureRing const&) = delete;
+    CaptureRing& operator=(CaptureRing const&) = delete;
+
+    /// @brief Producer side. Returns false (and counts a drop) if the message does not fit.
+    bool push(std::int64_t timestamp, std::span<const std::uint8_t> bytes);
+
+    /// @brief Consumer side. Points message at the oldest message, leaving port untouched; it
+    /// stays valid until pop(). Returns false if the ring is empty.
+    bool peek(CapturedMessage& message);
+
+    /// @brief Consumer side. Releases the message returned by the last successful peek().
+    void pop();
+
+    std::size_t capacity() const { return size; }
+    std::uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    std::size_t size;
+    std::unique_ptr<std::uint8_t[]> buffer;
+
+    alignas(64) std::atomic<std::uint64_t> head{0};  ///< bytes written, owned by the producer
+    alignas(64) std::atomic<std::uint64_t> tail{0};  ///< bytes released, owned by the consumer
+    std::uint64_t next = 0;                          ///< tail after the peeked message
+    alignas(64) std::atomic<std::uint64_t> droppedCount{0};
+};
+
+}  // namespace events
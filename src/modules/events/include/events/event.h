@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace events
+{
+enum class EventType : std::uint8_t
+{
+    NOTE_ON,
+    NOTE_OFF,
+    CONTROL_CHANGE,
+    PROGRAM_CHANGE,
+    CHANNEL_PRESSURE,
+    POLY_PRESSURE,
+    PITCH_BEND  ///< data1 and data2 hold the low and high 7 bits
+};
+
+/// @brief A preparsed MIDI channel event, small enough to be copied through a lock-free queue.
+struct Event
+{
+    std::int64_t timestamp = 0;  ///< as reported by libremidi::message::timestamp
+    EventType type = EventType::NOTE_ON;
+    std::uint8_t channel = 0;  ///< 0..15
+    std::uint8_t data1 = 0;    ///< note number or controller number
+    std::uint8_t data2 = 0;    ///< velocity or controller value
+};
+
+/// @brief Decode a raw MIDI message into an Event, through midi::Decoder.
+/// @return false if the message is not a complete channel message. A note on with velocity zero
+/// is reported as a note off.
+bool parse(const std::uint8_t* data, std::size_t size, std::int64_t timestamp, Event& event);
+
+}  // namespace events
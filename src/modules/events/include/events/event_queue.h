@@ -0,0 +1,44 @@
+#pragma once
+
+#include "events/event.h"
+
+#include <readerwriterqueue.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace events
+{
+/// @brief Single-producer single-consumer queue carrying events from the MIDI input thread to the
+/// audio thread.
+///
+/// All storage is allocated in the constructor. push() and pop() never lock or allocate; when the
+/// queue is full the event is dropped and counted instead.
+class EventQueue
+{
+public:
+    explicit EventQueue(std::size_t capacity = 1024);
+
+    EventQueue(EventQueue const&) = delete;
+    EventQueue& operator=(EventQueue const&) = delete;
+
+    /// @brief Producer side. Returns false (and counts a drop) if the queue is full.
+    bool push(Event const& event);
+
+    /// @brief Consumer side. Returns false if the queue is empty.
+    bool pop(Event& event);
+
+    /// @brief Consumer side. Returns the next event without removing it, or nullptr.
+    Event const* peek();
+
+    std::size_t size() const { return queue.size_approx(); }
+    std::size_t capacity() const { return queue.max_capacity(); }
+    std::uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    moodycamel::ReaderWriterQueue<Event> queue;
+    std::atomic<std::uint64_t> droppedCount{0};
+};
+
+}  // namespace events
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "events/event_queue.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace events
+{
+/// @brief Events from several inputs, each with its own EventQueue, read back by a single consumer
+/// in timestamp order.
+///
+/// Every source has one producer thread; add_source() may be called while the consumer runs, and
+/// only allocates on the calling thread. pop() compares the heads of the active sources, so it
+/// costs a peek per source and never locks or allocates.
+class MergedQueue
+{
+public:
+    static constexpr std::size_t MAX_SOURCES = 16;
+    static constexpr std::size_t NO_SOURCE = MAX_SOURCES;
+
+    /// @param capacity events each source can hold before it drops
+    explicit MergedQueue(std::size_t capacity = 1024);
+
+    /// @brief Add a source. Not thread safe with respect to other add_source() calls.
+    /// @return its index, or NO_SOURCE when MAX_SOURCES are in use.
+    std::size_t add_source();
+
+    /// @brief Producer side, from the thread feeding that source. Returns false on a drop.
+    bool push(std::size_t source, Event const& event);
+
+    /// @brief Consumer side. Pops the earliest event at the head of any source.
+    /// @param source set to the index of the source it came from, if not null
+    bool pop(Event& event, std::size_t* source = nullptr);
+
+    std::size_t num_sources() const { return numSources.load(std::memory_order_acquire); }
+    std::uint64_t received(std::size_t source) const;
+    std::uint64_t dropped(std::size_t source) const;
+
+private:
+    struct Source
+    {
+        explicit Source(std::size_t capacity)
+        : queue(capacity) {}
+
+        EventQueue queue;
+        std::atomic<std::uint64_t> received{0};
+    };
+
+    std::size_t capacity;
+    std::array<std::unique_ptr<Source>, MAX_SOURCES> sources;
+    std::atomic<std::size_t> numSources{0};
+};
+
+}  // namespace events
@@ -0,0 +1,49 @@
+#include "events/merged_queue.h"
+
+events::MergedQueue::MergedQueue(std::size_t capacity)
+: capacity(capacity) {}
+
+std::size_t events::MergedQueue::add_source() {
+    std::size_t index = numSources.load(std::memory_order_relaxed);
+    if (index == MAX_SOURCES) {
+        return NO_SOURCE;
+    }
+    sources[index] = std::make_unique<Source>(capacity);
+    // Publish the source only once it is fully built.
+    numSources.store(index + 1, std::memory_order_release);
+    return index;
+}
+
+bool events::MergedQueue::push(std::size_t source, Event const& event) {
+    Source& s = *sources[source];
+    s.received.fetch_add(1, std::memory_order_relaxed);
+    return s.queue.push(event);
+}
+
+bool events::MergedQueue::pop(Event& event, std::size_t* source) {
+    std::size_t const n = numSources.load(std::memory_order_acquire);
+    std::size_t earliest = NO_SOURCE;
+    std::int64_t earliestTime = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        Event const* head = sources[i]->queue.peek();
+        if (head && (earliest == NO_SOURCE || head->timestamp < earliestTime)) {
+            earliest = i;
+            earliestTime = head->timestamp;
+        }
+    }
+    if (earliest == NO_SOURCE) {
+        return false;
+    }
+    if (source) {
+        *source = earliest;
+    }
+    return sources[earliest]->queue.pop(event);
+}
+
+std::uint64_t events::MergedQueue::received(std::size_t source) const {
+    return sources[source]->received.load(std::memory_order_relaxed);
+}
+
+std::uint64_t events::MergedQueue::dropped(std::size_t source) const {
+    return sources[source]->queue.dropped();
+}
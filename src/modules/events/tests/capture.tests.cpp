@@ -0,0 +1,52 @@
+#include "events/capture.h"
+
+#include <doctest/doctest.h>
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+TEST_CASE("capture files round trip") {
+    auto path = std::filesystem::temp_directory_path() / ("capture_" + std::to_string(getpid()));
+
+    std::vector<std::uint8_t> sysex(300, 0x42);
+    sysex.front() = 0xF0;
+    sysex.back() = 0xF7;
+    {
+        events::CaptureWriter writer;
+        REQUIRE(writer.open(path.string()));
+        writer.write(1'000, 0, std::vector<std::uint8_t>{0x90, 60, 100});
+        writer.write(2'000, 1, sysex);
+        writer.write(3'000, 0, std::vector<std::uint8_t>{0x80, 60, 0});
+        writer.close();
+    }
+
+    events::CaptureReader reader;
+    REQUIRE(reader.open(path.string()));
+    events::CapturedMessage message;
+
+    REQUIRE(reader.next(message));
+    CHECK(message.timestamp == 1'000);
+    CHECK(message.port == 0);
+    REQUIRE(message.bytes.size() == 3);
+    CHECK(message.bytes[0] == 0x90);
+
+    REQUIRE(reader.next(message));
+    CHECK(message.timestamp == 2'000);
+    CHECK(message.port == 1);
+    CHECK(message.bytes.size() == sysex.size());
+    CHECK(message.bytes.back() == 0xF7);
+
+    REQUIRE(reader.next(message));
+    CHECK(message.timestamp == 3'000);
+    CHECK_FALSE(reader.next(message));
+
+    reader.rewind();
+    REQUIRE(reader.next(message));
+    CHECK(message.timestamp == 1'000);
+
+    std::filesystem::remove(path);
+    CHECK_FALSE(reader.open(path.string()));
+}
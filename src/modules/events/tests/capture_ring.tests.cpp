@@ -0,0 +1,98 @@
+#include "events/capture_ring.h"
+
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST_CASE("capture ring keeps messages of any length in order") {
+    events::CaptureRing ring(1024);
+    std::vector<std::uint8_t> sysex(200, 0x42);
+    CHECK(ring.push(1, std::vector<std::uint8_t>{0x90, 60, 100}));
+    CHECK(ring.push(2, sysex));
+    CHECK(ring.push(3, std::vector<std::uint8_t>{0xF8}));
+
+    events::CapturedMessage message{};
+    REQUIRE(ring.peek(message));
+    CHECK(message.timestamp == 1);
+    REQUIRE(message.bytes.size() == 3);
+    CHECK(message.bytes[1] == 60);
+    ring.pop();
+
+    REQUIRE(ring.peek(message));
+    CHECK(message.timestamp == 2);
+    CHECK(message.bytes.size() == sysex.size());
+    ring.pop();
+
+    REQUIRE(ring.peek(message));
+    CHECK(message.timestamp == 3);
+    CHECK(message.bytes.size() == 1);
+    ring.pop();
+    CHECK_FALSE(ring.peek(message));
+}
+
+TEST_CASE("capture ring wraps around and drops when full") {
+    events::CaptureRing ring(256);
+    CHECK(ring.capacity() == 256);
+    std::vector<std::uint8_t> message(40, 0x11);  // 64 bytes with its header
+
+    int pushed = 0;
+    for (int i = 0; i < 8; ++i) {
+        pushed += ring.push(i, message) ? 1 : 0;
+    }
+    CHECK(pushed == 4);
+    CHECK(ring.dropped() == 4);
+    CHECK_FALSE(ring.push(0, std::vector<std::uint8_t>(200)));  // larger than half the ring
+
+    events::CapturedMessage out{};
+    for (std::int64_t i = 0; i < 4; ++i) {
+        REQUIRE(ring.peek(out));
+        CHECK(out.timestamp == i);
+        ring.pop();
+    }
+
+    // Odd sizes, so records keep landing across the end of the buffer.
+    int wrong = 0;
+    for (int i = 0; i < 100; ++i) {
+        message.assign(1 + i % 90, std::uint8_t(i));
+        REQUIRE(ring.push(i, message));
+        REQUIRE(ring.peek(out));
+        wrong += out.timestamp != i || out.bytes.size() != message.size() ? 1 : 0;
+        wrong += out.bytes.back() != std::uint8_t(i) ? 1 : 0;
+        ring.pop();
+    }
+    CHECK(wrong == 0);
+}
+
+TEST_CASE("capture ring stress: producer and consumer threads") {
+    constexpr int NUM_MESSAGES = 200'000;
+    events::CaptureRing ring(4096);
+
+    std::thread producer([&ring] {
+        std::vector<std::uint8_t> bytes;
+        for (int i = 0; i < NUM_MESSAGES; ++i) {
+            bytes.assign(1 + i % 50, std::uint8_t(i & 0x7F));
+            while (!ring.push(i, bytes)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int received = 0;
+    int corrupt = 0;
+    events::CapturedMessage message{};
+    while (received < NUM_MESSAGES) {
+        if (!ring.peek(message)) {
+            continue;
+        }
+        int i = static_cast<int>(message.timestamp);
+        corrupt += i != received ? 1 : 0;
+        corrupt += message.bytes.size() != std::size_t(1 + i % 50) ? 1 : 0;
+        corrupt += message.bytes.back() != std::uint8_t(i & 0x7F) ? 1 : 0;
+        ring.pop();
+        ++received;
+    }
+    producer.join();
+    CHECK(corrupt == 0);
+}
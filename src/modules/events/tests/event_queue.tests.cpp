@@ -0,0 +1,145 @@
+#include "events/event_queue.h"
+
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+TEST_CASE("parse channel messages") {
+    events::Event event{};
+
+    const std::uint8_t noteOn[] = {0x93, 60, 100};
+    REQUIRE(events::parse(noteOn, 3, 42, event));
+    CHECK(event.type == events::EventType::NOTE_ON);
+    CHECK(event.channel == 3);
+    CHECK(event.data1 == 60);
+    CHECK(event.data2 == 100);
+    CHECK(event.timestamp == 42);
+
+    const std::uint8_t silentNoteOn[] = {0x90, 60, 0};
+    REQUIRE(events::parse(silentNoteOn, 3, 0, event));
+    CHECK(event.type == events::EventType::NOTE_OFF);
+
+    const std::uint8_t noteOff[] = {0x80, 61, 64};
+    REQUIRE(events::parse(noteOff, 3, 0, event));
+    CHECK(event.type == events::EventType::NOTE_OFF);
+
+    const std::uint8_t cc[] = {0xB1, 1, 127};
+    REQUIRE(events::parse(cc, 3, 0, event));
+    CHECK(event.type == events::EventType::CONTROL_CHANGE);
+    CHECK(event.channel == 1);
+
+    const std::uint8_t programChange[] = {0xC0, 5};
+    REQUIRE(events::parse(programChange, 2, 0, event));
+    CHECK(event.type == events::EventType::PROGRAM_CHANGE);
+    CHECK(event.data1 == 5);
+
+    const std::uint8_t pitchBend[] = {0xE2, 0x01, 0x40};
+    REQUIRE(events::parse(pitchBend, 3, 0, event));
+    CHECK(event.type == events::EventType::PITCH_BEND);
+    CHECK((event.data1 | event.data2 << 7) == 8193);
+
+    const std::uint8_t truncated[] = {0x90, 60};
+    CHECK_FALSE(events::parse(truncated, 2, 0, event));
+
+    const std::uint8_t sysex[] = {0xF0, 0x7E, 0xF7};
+    CHECK_FALSE(events::parse(sysex, 3, 0, event));
+}
+
+TEST_CASE("event queue drops and counts when full") {
+    events::EventQueue queue(4);
+    int pushed = 0;
+    for (int i = 0; i < 64; ++i) {
+        pushed += queue.push({.timestamp = i}) ? 1 : 0;
+    }
+    CHECK(pushed >= 4);
+    CHECK(queue.dropped() == std::uint64_t(64 - pushed));
+
+    events::Event event{};
+    for (int i = 0; i < pushed; ++i) {
+        REQUIRE(queue.pop(event));
+        CHECK(event.timestamp == i);
+    }
+    CHECK_FALSE(queue.pop(event));
+}
+
+TEST_CASE("event queue stress: paced events arrive complete and in order") {
+    using namespace std::chrono;
+    constexpr int numEvents = 20'000;
+    constexpr auto interval = microseconds(50);  // 20k events/s
+
+    // Room for every event, so a consumer held up by a loaded machine cannot cause drops: what
+    // is checked is that the events all come through, in order. The rate is only reported.
+    events::EventQueue queue(numEvents);
+    std::atomic<bool> done{false};
+
+    std::thread producer([&] {
+        auto next = steady_clock::now();
+        for (int i = 0; i < numEvents; ++i) {
+            queue.push({
+                .timestamp = i,
+                .type = events::EventType::CONTROL_CHANGE,
+                .channel = std::uint8_t(i & 0x0F),
+                .data1 = 1,
+                .data2 = std::uint8_t(i & 0x7F),
+            });
+            next += interval;
+            std::this_thread::sleep_until(next);
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    // Consume the way the audio thread does: drain everything once per 10 ms block.
+    std::int64_t expected = 0;
+    int outOfOrder = 0;
+    auto drain = [&] {
+        events::Event event{};
+        while (queue.pop(event)) {
+            outOfOrder += event.timestamp != expected ? 1 : 0;
+            expected = event.timestamp + 1;
+        }
+    };
+    auto start = steady_clock::now();
+    while (!done.load(std::memory_order_acquire)) {
+        drain();
+        std::this_thread::sleep_for(milliseconds(10));
+    }
+    drain();
+    auto elapsed = duration<double>(steady_clock::now() - start).count();
+    producer.join();
+
+    MESSAGE("received " << expected << " events in " << elapsed << " s: "
+                        << expected / elapsed << " events/s");
+    CHECK(expected == numEvents);
+    CHECK(outOfOrder == 0);
+    CHECK(queue.dropped() == 0);
+}
+
+TEST_CASE("event queue stress: unpaced burst with spinning consumer") {
+    constexpr int numEvents = 200'000;
+    events::EventQueue queue(1024);
+
+    std::thread producer([&] {
+        for (int i = 0; i < numEvents; ++i) {
+            while (!queue.push({.timestamp = i})) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::int64_t expected = 0;
+    int outOfOrder = 0;
+    events::Event event{};
+    while (expected < numEvents) {
+        if (queue.pop(event)) {
+            outOfOrder += event.timestamp != expected ? 1 : 0;
+            expected = event.timestamp + 1;
+        }
+    }
+    producer.join();
+
+    CHECK(outOfOrder == 0);
+    CHECK_FALSE(queue.pop(event));
+}
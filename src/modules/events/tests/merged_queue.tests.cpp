@@ -0,0 +1,92 @@
+#include "events/merged_queue.h"
+
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST_CASE("merged queue pops in timestamp order across sources") {
+    events::MergedQueue queue(16);
+    std::size_t keys = queue.add_source();
+    std::size_t pads = queue.add_source();
+    std::size_t pedal = queue.add_source();
+    CHECK(queue.num_sources() == 3);
+
+    queue.push(keys, {.timestamp = 10});
+    queue.push(keys, {.timestamp = 40});
+    queue.push(pads, {.timestamp = 20});
+    queue.push(pads, {.timestamp = 30});
+    queue.push(pedal, {.timestamp = 10});
+
+    std::vector<std::int64_t> times;
+    std::vector<std::size_t> from;
+    events::Event event;
+    std::size_t source;
+    while (queue.pop(event, &source)) {
+        times.push_back(event.timestamp);
+        from.push_back(source);
+    }
+    CHECK(times == std::vector<std::int64_t>{10, 10, 20, 30, 40});
+    CHECK(from == std::vector<std::size_t>{keys, pedal, pads, pads, keys});  // ties: lower index
+    CHECK(queue.received(keys) == 2);
+    CHECK(queue.received(pads) == 2);
+    CHECK(queue.received(pedal) == 1);
+}
+
+TEST_CASE("merged queue counts drops per source and caps the number of sources") {
+    events::MergedQueue queue(4);
+    std::size_t busy = queue.add_source();
+    std::size_t quiet = queue.add_source();
+    int pushed = 0;
+    for (int i = 0; i < 64; ++i) {
+        pushed += queue.push(busy, {.timestamp = i}) ? 1 : 0;
+    }
+    CHECK(queue.received(busy) == 64);
+    CHECK(queue.dropped(busy) == std::uint64_t(64 - pushed));
+    CHECK(queue.dropped(quiet) == 0);
+
+    while (queue.num_sources() < events::MergedQueue::MAX_SOURCES) {
+        CHECK(queue.add_source() != events::MergedQueue::NO_SOURCE);
+    }
+    CHECK(queue.add_source() == events::MergedQueue::NO_SOURCE);
+}
+
+TEST_CASE("merged queue stress: one producer thread per source") {
+    constexpr int NUM_SOURCES = 4;
+    constexpr int EVENTS_PER_SOURCE = 50'000;
+    events::MergedQueue queue(1024);
+    for (int s = 0; s < NUM_SOURCES; ++s) {
+        queue.add_source();
+    }
+
+    std::vector<std::thread> producers;
+    for (int s = 0; s < NUM_SOURCES; ++s) {
+        producers.emplace_back([&queue, s] {
+            for (int i = 0; i < EVENTS_PER_SOURCE; ++i) {
+                while (!queue.push(s, {.timestamp = i, .data1 = std::uint8_t(s)})) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<std::int64_t> last(NUM_SOURCES, -1);
+    int received = 0;
+    int outOfOrder = 0;
+    events::Event event;
+    std::size_t source;
+    while (received < NUM_SOURCES * EVENTS_PER_SOURCE) {
+        if (queue.pop(event, &source)) {
+            outOfOrder += event.timestamp != last[source] + 1 ? 1 : 0;
+            outOfOrder += event.data1 != source ? 1 : 0;
+            last[source] = event.timestamp;
+            ++received;
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    CHECK(outOfOrder == 0);
+    CHECK_FALSE(queue.pop(event));
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "events/merged_queue.h"
+
+#include <libremidi/libremidi.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace input
+{
+/// @brief True if the port name contains one of the patterns, or if there are no patterns.
+bool matches(std::string_view portName, std::span<const std::string> patterns);
+
+/// @brief Any number of ALSA sequencer input ports, each feeding its own source of a MergedQueue.
+///
+/// Every port gets its own libremidi input, so its messages are parsed and queued on its own
+/// thread. Ports plugged in later are opened too if they match, and a port plugged back in feeds
+/// its old source again. Opening a port only touches the consumer through
+/// MergedQueue::add_source(), so the audio thread never waits on it.
+class MidiInputs
+{
+public:
+    /// @brief Called on the port's input thread with every message, before it is queued.
+    using Listener = std::function<void(std::size_t port, libremidi::message const& message)>;
+
+    explicit MidiInputs(events::MergedQueue& queue, Listener listener = {});
+    ~MidiInputs();
+
+    MidiInputs(MidiInputs const&) = delete;
+    MidiInputs& operator=(MidiInputs const&) = delete;
+
+    /// @brief Open every input port whose name contains one of the patterns, or every port if
+    /// there are none, and keep watching for more.
+    /// @return the number of ports open
+    std::size_t open(std::vector<std::string> patterns);
+
+    std::size_t size() const;
+    /// @brief Name of a port, by its source index in the queue.
+    std::string name(std::size_t port) const;
+    /// @brief How many of the open ports are unplugged right now.
+    std::size_t removed() const { return numRemoved.load(std::memory_order_relaxed); }
+
+    /// @brief Log messages received and dropped, per port.
+    void log_stats() const;
+
+private:
+    void open_port(libremidi::input_port const& port);
+    void port_removed(libremidi::input_port const& port);
+
+    events::MergedQueue& queue;
+    Listener listener;
+    std::vector<std::string> patterns;
+
+    mutable std::mutex mutex;  ///< guards the port lists against the observer thread
+    std::vector<std::string> names;
+    std::vector<std::unique_ptr<libremidi::midi_in>> inputs;
+    std::vector<bool> unplugged;
+    std::atomic<std::size_t> numRemoved{0};
+
+    std::optional<libremidi::observer> observer;  ///< last, so it stops first
+};
+
+}  // namespace input
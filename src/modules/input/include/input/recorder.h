@@ -0,0 +1,95 @@
+#pragma once
+
+#include "events/capture.h"
+#include "events/capture_ring.h"
+#include "events/merged_queue.h"
+#include "midi/smf_writer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace input
+{
+enum class RecordFormat
+{
+    CAPTURE,  ///< events::CaptureWriter, keeps every message and the port it came from
+    SMF       ///< format 0 Standard MIDI File, see midi::SmfWriter
+};
+
+struct RecordOptions
+{
+    std::string path;  ///< files are named <path>-0001.capture, <path>-0002.capture, ...
+    RecordFormat format = RecordFormat::CAPTURE;
+    std::uint64_t rotateBytes = 0;         ///< start a new file past this size, 0 for never
+    std::chrono::seconds rotateSeconds{0};  ///< start a new file after this long, 0 for never
+    std::size_t ringBytes = 256 * 1024;     ///< buffered per port between the writer's wakeups
+};
+
+/// @brief Records raw MIDI input to disk without slowing down the input threads.
+///
+/// record() only copies the message into its port's preallocated CaptureRing. A writer thread
+/// wakes up every POLL_INTERVAL, merges what the rings hold in timestamp order and writes it out
+/// in one batch, starting a new file whenever the current one gets too big or too old.
+class Recorder
+{
+public:
+    static constexpr std::size_t MAX_PORTS = events::MergedQueue::MAX_SOURCES;
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{50};
+
+    /// @brief Allocates a ring for each of MAX_PORTS ports.
+    explicit Recorder(RecordOptions options);
+    ~Recorder();
+
+    Recorder(Recorder const&) = delete;
+    Recorder& operator=(Recorder const&) = delete;
+
+    /// @brief Open the first file and start the writer thread. Messages recorded before this
+    /// are kept.
+    bool start();
+
+    /// @brief Called on a port's input thread. Never blocks; the message is dropped and counted
+    /// if the port's ring is full.
+    void record(std::size_t port, std::int64_t timestamp, std::span<const std::uint8_t> bytes);
+
+    /// @brief Stop the writer once it has written everything recorded so far.
+    void stop();
+
+    std::uint64_t recorded() const { return recordedCount.load(std::memory_order_relaxed); }
+    std::uint64_t dropped() const;
+    std::size_t files() const { return fileCount.load(std::memory_order_relaxed); }
+
+    /// @brief Name of the nth file, counting from 1.
+    std::string file_name(std::size_t n) const;
+
+private:
+    void run();
+    void drain();
+    void write(events::CapturedMessage const& message);
+    bool open_next();
+    void close();
+
+    RecordOptions options;
+    std::vector<std::unique_ptr<events::CaptureRing>> rings;
+    std::atomic<std::uint64_t> outOfRange{0};
+
+    std::atomic<bool> running{false};
+    std::thread writer;
+
+    events::CaptureWriter capture;
+    midi::SmfWriter smf;
+    bool fileOpen = false;
+    std::uint64_t fileBytes = 0;
+    std::chrono::steady_clock::time_point fileStart;
+
+    std::atomic<std::uint64_t> recordedCount{0};
+    std::atomic<std::size_t> fileCount{0};
+};
+
+}  // namespace input
@@ -0,0 +1,117 @@
+#include "input/midi_inputs.h"
+
+#include "events/event.h"
+#include "logger/logger.h"
+
+#include <algorithm>
+
+bool input::matches(std::string_view portName, std::span<const std::string> patterns) {
+    return patterns.empty() ||
+           std::ranges::any_of(patterns, [portName](std::string const& pattern) {
+               return portName.find(pattern) != std::string_view::npos;
+           });
+}
+
+input::MidiInputs::MidiInputs(events::MergedQueue& queue, Listener listener)
+: queue(queue)
+, listener(std::move(listener)) {}
+
+input::MidiInputs::~MidiInputs() {
+    observer.reset();  // no more hot plugging while the inputs close
+}
+
+std::size_t input::MidiInputs::open(std::vector<std::string> portPatterns) {
+    patterns = std::move(portPatterns);
+
+    libremidi::observer_configuration callbacks;
+    callbacks.input_added = [this](libremidi::input_port const& port) { open_port(port); };
+    callbacks.input_removed = [this](libremidi::input_port const& port) { port_removed(port); };
+    observer.emplace(callbacks, libremidi::observer_configuration_for(libremidi::API::ALSA_SEQ));
+
+    for (auto const& port : observer->get_input_ports()) {
+        open_port(port);
+    }
+    return size();
+}
+
+void input::MidiInputs::open_port(libremidi::input_port const& port) {
+    if (!matches(port.port_name, patterns)) {
+        return;
+    }
+    std::lock_guard lock(mutex);
+    std::size_t source = std::size_t(std::ranges::find(names, port.port_name) - names.begin());
+    if (source < names.size()) {
+        if (!unplugged[source]) {
+            return;  // already open: the observer may report ports we listed ourselves
+        }
+        // Plugged back in: feed the same source. The old input's thread stops first, so the
+        // source never has two producers.
+        inputs[source].reset();
+        unplugged[source] = false;
+        numRemoved.fetch_sub(1, std::memory_order_relaxed);
+    } else {
+        source = queue.add_source();
+        if (source == events::MergedQueue::NO_SOURCE) {
+            logger::log("Not opening {}: {} ports already open", port.port_name, names.size());
+            return;
+        }
+        // The source stays in the queue even if opening fails, so indices keep matching names.
+        names.push_back(port.port_name);
+        inputs.emplace_back();
+        unplugged.push_back(false);
+    }
+
+    // Monotonic timestamps can be compared across ports and with the audio clock.
+    inputs[source] = std::make_unique<libremidi::midi_in>(libremidi::input_configuration{
+        .on_message =
+            [this, source](libremidi::message const& message) {
+                if (listener) {
+                    listener(source, message);
+                }
+                events::Event event;
+                auto const& bytes = message.bytes;
+                if (events::parse(bytes.data(), bytes.size(), message.timestamp, event)) {
+                    queue.push(source, event);
+                }
+            },
+        .timestamps = libremidi::timestamp_mode::SystemMonotonic
+    });
+    if (inputs[source]->open_port(port) != stdx::error{}) {
+        logger::log("Could not open {}", port.port_name);
+    } else {
+        logger::log("Using port {} as input {}", port.port_name, source);
+    }
+}
+
+void input::MidiInputs::port_removed(libremidi::input_port const& port) {
+    std::lock_guard lock(mutex);
+    std::size_t source = std::size_t(std::ranges::find(names, port.port_name) - names.begin());
+    if (source < names.size() && !unplugged[source]) {
+        logger::log("{} was removed", port.port_name);
+        unplugged[source] = true;
+        numRemoved.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::size_t input::MidiInputs::size() const {
+    std::lock_guard lock(mutex);
+    return names.size();
+}
+
+std::string input::MidiInputs::name(std::size_t port) const {
+    std::lock_guard lock(mutex);
+    return port < names.size() ? names[port] : std::string{};
+}
+
+void input::MidiInputs::log_stats() const {
+    std::lock_guard lock(mutex);
+    for (std::size_t port = 0; port < names.size(); ++port) {
+        logger::log(
+            "Input {} ({}): {} events, {} dropped",
+            port,
+            names[port],
+            queue.received(port),
+            queue.dropped(port)
+        );
+    }
+}
@@ -0,0 +1,147 @@
+#include "input/recorder.h"
+
+#include "logger/logger.h"
+
+#include <array>
+#include <format>
+
+input::Recorder::Recorder(RecordOptions options)
+: options(std::move(options)) {
+    // Every ring up front: a port opened later must not allocate on its input thread.
+    for (std::size_t i = 0; i < MAX_PORTS; ++i) {
+        rings.push_back(std::make_unique<events::CaptureRing>(this->options.ringBytes));
+    }
+}
+
+input::Recorder::~Recorder() {
+    stop();
+}
+
+std::string input::Recorder::file_name(std::size_t n) const {
+    char const* extension = options.format == RecordFormat::SMF ? "mid" : "capture";
+    return std::format("{}-{:04}.{}", options.path, n, extension);
+}
+
+bool input::Recorder::start() {
+    if (running.load()) {
+        return false;
+    }
+    if (!open_next()) {
+        return false;
+    }
+    running.store(true);
+    writer = std::thread([this] { run(); });
+    return true;
+}
+
+void input::Recorder::record(
+    std::size_t port,
+    std::int64_t timestamp,
+    std::span<const std::uint8_t> bytes
+) {
+    if (port >= rings.size()) {
+        outOfRange.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    rings[port]->push(timestamp, bytes);
+}
+
+void input::Recorder::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    writer.join();
+    drain();  // anything recorded after the writer's last pass
+    close();
+}
+
+std::uint64_t input::Recorder::dropped() const {
+    std::uint64_t total = outOfRange.load(std::memory_order_relaxed);
+    for (auto const& ring : rings) {
+        total += ring->dropped();
+    }
+    return total;
+}
+
+void input::Recorder::run() {
+    while (running.load(std::memory_order_relaxed)) {
+        std::this_thread::sleep_for(POLL_INTERVAL);
+        drain();
+    }
+}
+
+void input::Recorder::drain() {
+    // Merge the rings by timestamp: keep the head of every ring and write the oldest. Each port
+    // is in order already, so only the ring just written from needs another look.
+    std::array<events::CapturedMessage, MAX_PORTS> heads;
+    std::array<bool, MAX_PORTS> ready{};
+    for (std::size_t i = 0; i < rings.size(); ++i) {
+        ready[i] = rings[i]->peek(heads[i]);
+        heads[i].port = std::uint8_t(i);
+    }
+    while (true) {
+        std::size_t oldest = MAX_PORTS;
+        for (std::size_t i = 0; i < rings.size(); ++i) {
+            if (!ready[i]) {
+                continue;
+            }
+            if (oldest == MAX_PORTS || heads[i].timestamp < heads[oldest].timestamp) {
+                oldest = i;
+            }
+        }
+        if (oldest == MAX_PORTS) {
+            return;
+        }
+        write(heads[oldest]);
+        rings[oldest]->pop();
+        ready[oldest] = rings[oldest]->peek(heads[oldest]);
+    }
+}
+
+void input::Recorder::write(events::CapturedMessage const& message) {
+    bool const tooBig = options.rotateBytes && fileBytes >= options.rotateBytes;
+    bool const tooOld = options.rotateSeconds.count() &&
+                        std::chrono::steady_clock::now() - fileStart >= options.rotateSeconds;
+    if ((tooBig || tooOld) && !open_next()) {
+        return;
+    }
+    if (!fileOpen) {
+        return;
+    }
+
+    if (options.format == RecordFormat::SMF) {
+        smf.write(message.timestamp, message.port, message.bytes);
+        fileBytes = smf.size();
+    } else {
+        capture.write(message.timestamp, message.port, message.bytes);
+        fileBytes += events::CAPTURE_RECORD_HEADER + message.bytes.size();
+    }
+    recordedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool input::Recorder::open_next() {
+    close();
+    std::string const name = file_name(fileCount.load() + 1);
+    bool const ok = options.format == RecordFormat::SMF ? smf.open(name) : capture.open(name);
+    if (!ok) {
+        logger::log("Could not open {} for recording", name);
+        return false;
+    }
+    fileOpen = true;
+    fileBytes = options.format == RecordFormat::SMF ? smf.size() : sizeof(events::CAPTURE_MAGIC);
+    fileStart = std::chrono::steady_clock::now();
+    fileCount.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void input::Recorder::close() {
+    if (!fileOpen) {
+        return;
+    }
+    if (options.format == RecordFormat::SMF) {
+        smf.close();
+    } else {
+        capture.close();
+    }
+    fileOpen = false;
+}
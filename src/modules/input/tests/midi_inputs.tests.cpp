@@ -0,0 +1,28 @@
+#include "input/midi_inputs.h"
+
+#include <doctest/doctest.h>
+
+#include <string>
+#include <vector>
+
+TEST_CASE("ports are matched by any of the name patterns") {
+    std::vector<std::string> patterns = {"CASIO", "Traktor"};
+    CHECK(input::matches("CASIO USB-MIDI:CASIO USB-MIDI MIDI 1 24:0", patterns));
+    CHECK(input::matches("Traktor Kontrol S4 MK3", patterns));
+    CHECK_FALSE(input::matches("Midi Through Port-0", patterns));
+    CHECK_FALSE(input::matches("casio", patterns));  // case sensitive, like the port list
+}
+
+TEST_CASE("no patterns matches every port") {
+    CHECK(input::matches("Midi Through Port-0", {}));
+    CHECK(input::matches("", {}));
+}
+
+TEST_CASE("inputs start empty and unknown ports have no name") {
+    events::MergedQueue queue;
+    input::MidiInputs inputs(queue);
+    CHECK(inputs.size() == 0);
+    CHECK(inputs.removed() == 0);
+    CHECK(inputs.name(0).empty());
+    CHECK(queue.num_sources() == 0);
+}
@@ -0,0 +1,146 @@
+#include "input/recorder.h"
+
+#include "events/capture.h"
+#include "midi/smf.h"
+#include "test_support/files.h"
+
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace
+{
+using Bytes = std::vector<std::uint8_t>;
+using test_support::temp_path;
+
+constexpr std::int64_t MS = 1'000'000;
+
+std::vector<events::CapturedMessage> read_capture(std::string const& path, Bytes& storage) {
+    events::CaptureReader reader;
+    std::vector<events::CapturedMessage> messages;
+    if (!reader.open(path)) {
+        return messages;
+    }
+    // Copy the bytes out: the reader's buffer goes away with it.
+    events::CapturedMessage message;
+    std::vector<std::size_t> offsets;
+    while (reader.next(message)) {
+        offsets.push_back(storage.size());
+        storage.insert(storage.end(), message.bytes.begin(), message.bytes.end());
+        messages.push_back(message);
+    }
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+        messages[i].bytes = {storage.data() + offsets[i], messages[i].bytes.size()};
+    }
+    return messages;
+}
+
+}  // namespace
+
+TEST_CASE("recorded messages from several ports are written in timestamp order") {
+    input::RecordOptions options;
+    options.path = temp_path("input_recorder_test");
+    input::Recorder recorder(options);
+
+    // Recorded before the writer starts, so they all go out in one batch.
+    recorder.record(1, 10 * MS, Bytes{0x90, 60, 100});
+    recorder.record(0, 5 * MS, Bytes{0xF0, 0x7E, 0x7F, 0x09, 0x01, 0xF7});
+    recorder.record(0, 20 * MS, Bytes{0xB0, 7, 90});
+    recorder.record(1, 30 * MS, Bytes{0x80, 60, 0});
+    REQUIRE(recorder.start());
+    recorder.stop();
+
+    CHECK(recorder.recorded() == 4);
+    CHECK(recorder.dropped() == 0);
+    CHECK(recorder.files() == 1);
+
+    Bytes storage;
+    auto messages = read_capture(recorder.file_name(1), storage);
+    REQUIRE(messages.size() == 4);
+    CHECK(messages[0].timestamp == 5 * MS);
+    CHECK(messages[0].port == 0);
+    CHECK(messages[0].bytes.size() == 6);
+    CHECK(messages[1].timestamp == 10 * MS);
+    CHECK(messages[1].port == 1);
+    CHECK(messages[2].timestamp == 20 * MS);
+    CHECK(messages[2].port == 0);
+    CHECK(messages[3].timestamp == 30 * MS);
+    CHECK(Bytes(messages[3].bytes.begin(), messages[3].bytes.end()) == Bytes{0x80, 60, 0});
+
+    std::filesystem::remove(recorder.file_name(1));
+}
+
+TEST_CASE("a full ring drops messages instead of blocking") {
+    input::RecordOptions options;
+    options.path = temp_path("input_recorder_full");
+    options.ringBytes = 1024;
+    input::Recorder recorder(options);
+    REQUIRE(recorder.start());
+
+    // Each record takes 32 bytes of ring, far more than fit before the writer wakes up.
+    for (int i = 0; i < 200; ++i) {
+        recorder.record(0, i * MS, Bytes{0x90, 60, 100});
+    }
+    recorder.record(input::Recorder::MAX_PORTS, 0, Bytes{0x90, 60, 100});
+    recorder.stop();
+
+    CHECK(recorder.dropped() > 0);
+    CHECK(recorder.recorded() + recorder.dropped() == 201);
+    std::filesystem::remove(recorder.file_name(1));
+}
+
+TEST_CASE("recording rotates to a new file past the size limit") {
+    input::RecordOptions options;
+    options.path = temp_path("input_recorder_rotate");
+    options.rotateBytes = 100;
+    input::Recorder recorder(options);
+    REQUIRE(recorder.start());
+
+    // 8 bytes of magic, then 15 bytes a message: the file is full after 7 messages.
+    for (int i = 0; i < 10; ++i) {
+        recorder.record(0, i * MS, Bytes{0x90, std::uint8_t(60 + i), 100});
+    }
+    recorder.stop();
+
+    REQUIRE(recorder.files() == 2);
+    Bytes firstBytes, secondBytes;
+    auto first = read_capture(recorder.file_name(1), firstBytes);
+    auto second = read_capture(recorder.file_name(2), secondBytes);
+    CHECK(first.size() == 7);
+    REQUIRE(second.size() == 3);
+    CHECK(second[0].timestamp == 7 * MS);
+    CHECK(second[0].bytes[1] == 67);
+
+    for (std::size_t n = 1; n <= recorder.files(); ++n) {
+        std::filesystem::remove(recorder.file_name(n));
+    }
+}
+
+TEST_CASE("recording to a Standard MIDI File") {
+    input::RecordOptions options;
+    options.path = temp_path("input_recorder_smf");
+    options.format = input::RecordFormat::SMF;
+    input::Recorder recorder(options);
+    REQUIRE(recorder.start());
+
+    recorder.record(0, 1000 * MS, Bytes{0x90, 60, 100});
+    recorder.record(0, 1500 * MS, Bytes{0x80, 60, 0});
+    recorder.stop();
+
+    std::string const path = recorder.file_name(1);
+    CHECK(path.ends_with(".mid"));
+    midi::File file;
+    REQUIRE(file.open(path));
+    std::vector<midi::Event> notes;
+    for (midi::Event const& event : file.events()) {
+        if (event.kind == midi::EventKind::CHANNEL) {
+            notes.push_back(event);
+        }
+    }
+    REQUIRE(notes.size() == 2);
+    CHECK(notes[0].tick == 0);
+    CHECK(notes[1].tick == std::uint64_t(500 * MS / midi::SmfWriter::NS_PER_TICK));
+    std::filesystem::remove(path);
+}
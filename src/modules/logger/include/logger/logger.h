@@ -1,5 +1,9 @@
 #pragma once
 
+#include "logger/record.h"
+
+#include <atomic>
+#include <cstdint>
 #include <format>
 #include <source_location>
 #include <string>
@@ -9,7 +13,17 @@ namespace logger
 namespace detail
 {
 void log(std::string const& msg, std::source_location const& loc = std::source_location::current());
-}
+
+/// @brief Claim a slot in the async ring, or return nullptr (and count a drop) if it is full or
+/// async logging was switched off meanwhile.
+Record* begin_record();
+
+/// @brief Hand a record filled after begin_record() over to the background thread.
+void commit_record(Record* record);
+
+/// @brief Set with release semantics once the ring is ready: load it with acquire.
+inline std::atomic<bool> asyncEnabled{false};
+}  // namespace detail
 
 struct FormatWithLocation
 {
@@ -26,8 +40,41 @@ struct FormatWithLocation
 
 template <typename... Args>
 void log(FormatWithLocation fmt, Args&&... args) {
+    if constexpr ((detail::is_encodable_v<std::remove_cvref_t<Args>> && ...)) {
+        // Async mode: copy the raw arguments, the background thread does the formatting.
+        if (detail::asyncEnabled.load(std::memory_order_acquire)) {
+            if (auto* record = detail::begin_record()) {
+                record->loc = fmt.loc;
+                record->fmt = fmt.value;
+                record->payload.size = 0;
+                record->payload.numArgs = 0;
+                record->payload.truncated = false;
+                (record->payload.put(args), ...);
+                detail::commit_record(record);
+            }
+            return;
+        }
+    }
     auto formatted = std::vformat(fmt.value, std::make_format_args(args...));
     detail::log(formatted, fmt.loc);
 }
 
-}  // namespace logger
\ No newline at end of file
+/// @brief Switch to asynchronous logging.
+///
+/// log() calls then only copy their arguments into a preallocated lock-free ring of `capacity`
+/// records; a background thread formats and writes them. When the ring is full, messages are
+/// dropped and counted. Arguments that are not arithmetic, strings or pointers are still
+/// formatted at the call site.
+void start_async(std::size_t capacity = 4096);
+
+/// @brief Write all pending messages and go back to synchronous logging. Call it once the
+/// real-time threads have stopped logging.
+void stop_async();
+
+/// @brief Block until all messages logged so far have been written out.
+void flush();
+
+/// @brief Number of messages dropped because the async ring was full.
+std::uint64_t dropped();
+
+}  // namespace logger
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <source_location>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace logger::detail
+{
+/// @brief Tag written in front of each encoded argument.
+enum class ArgType : std::uint8_t
+{
+    BOOL,
+    CHAR,
+    INT,
+    UINT,
+    DOUBLE,
+    STRING,
+    POINTER
+};
+
+template <typename T>
+constexpr bool is_string_like_v = std::is_convertible_v<T const&, std::string_view>;
+
+/// @brief Whether an argument of this type can be copied into a record without formatting it.
+template <typename T>
+constexpr bool is_encodable_v = std::is_arithmetic_v<T> || is_string_like_v<T> ||
+                                std::is_same_v<T, void*> || std::is_same_v<T, const void*> ||
+                                std::is_same_v<T, std::nullptr_t>;
+
+/// @brief Fixed-size buffer holding the tagged, raw bytes of the arguments of one log call.
+struct Payload
+{
+    static constexpr std::size_t CAPACITY = 216;
+
+    std::uint16_t size = 0;
+    std::uint8_t numArgs = 0;
+    bool truncated = false;
+    std::array<std::byte, CAPACITY> data;
+
+    void put_bytes(const void* src, std::size_t n) {
+        std::memcpy(data.data() + size, src, n);
+        size += static_cast<std::uint16_t>(n);
+    }
+
+    template <typename T>
+    void put_value(ArgType type, T value) {
+        if (std::size_t(size) + 1 + sizeof(T) > CAPACITY) {
+            truncated = true;
+            return;
+        }
+        put_bytes(&type, 1);
+        put_bytes(&value, sizeof(T));
+        ++numArgs;
+    }
+
+    void put_string(std::string_view s) {
+        if (std::size_t(size) + 3 > CAPACITY) {
+            truncated = true;
+            return;
+        }
+        auto length = static_cast<std::uint16_t>(std::min(s.size(), CAPACITY - size - 3));
+        truncated |= length < s.size();
+        auto type = ArgType::STRING;
+        put_bytes(&type, 1);
+        put_bytes(&length, sizeof(length));
+        put_bytes(s.data(), length);
+        ++numArgs;
+    }
+
+    template <typename T>
+    void put(T const& value) {
+        using U = std::remove_cvref_t<T>;
+        if constexpr (std::is_same_v<U, bool>) {
+            put_value(ArgType::BOOL, value);
+        } else if constexpr (std::is_same_v<U, char>) {
+            put_value(ArgType::CHAR, value);
+        } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+            put_value(ArgType::INT, static_cast<std::int64_t>(value));
+        } else if constexpr (std::is_integral_v<U>) {
+            put_value(ArgType::UINT, static_cast<std::uint64_t>(value));
+        } else if constexpr (std::is_floating_point_v<U>) {
+            put_value(ArgType::DOUBLE, static_cast<double>(value));
+        } else if constexpr (is_string_like_v<U>) {
+            put_string(std::string_view(value));
+        } else {
+            put_value(ArgType::POINTER, static_cast<const void*>(value));
+        }
+    }
+};
+
+/// @brief One log call, captured without formatting.
+struct Record
+{
+    std::source_location loc;
+    std::string_view fmt;  ///< must outlive the record, i.e. a string literal
+    std::uint64_t ticket;  ///< position in the ring, set by begin_record()
+    Payload payload;
+};
+
+/// @brief Format a payload according to fmt, like std::vformat() would have with the original
+/// arguments. Malformed format strings produce a message instead of throwing.
+void format_payload(std::string& out, std::string_view fmt, std::span<const std::byte> payload);
+
+}  // namespace logger::detail
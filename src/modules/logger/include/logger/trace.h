@@ -0,0 +1,56 @@
+#pragma once
+
+#include "logger/logger.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace logger
+{
+namespace detail
+{
+inline std::atomic<bool> traceEnabled{false};
+
+/// @brief Id of a call site. The site (file, line, function, format string) is written to the
+/// trace file the first time it is seen, so events only carry the id.
+std::uint32_t trace_site(FormatWithLocation const& fmt);
+
+void trace_write(std::uint32_t site, Payload const& payload);
+}  // namespace detail
+
+/// @brief Start recording trace() calls into a memory-mapped binary file of at most `capacity`
+/// bytes. Records that do not fit anymore are dropped and counted.
+bool start_trace(std::string const& path, std::size_t capacity = 64 << 20);
+
+/// @brief Stop recording and truncate the trace file to its used size. Call it once the threads
+/// calling trace() are done.
+void stop_trace();
+
+/// @brief Number of trace records dropped because the trace file was full.
+std::uint64_t trace_dropped();
+
+/// @brief Deferred-format logging for hot paths.
+///
+/// Writes the call site id, a timestamp and the raw argument bytes; formatting happens offline
+/// in decode_trace() (see the trace_decode tool). Does nothing unless start_trace() was called.
+template <typename... Args>
+void trace(FormatWithLocation fmt, Args const&... args) {
+    static_assert(
+        (detail::is_encodable_v<std::remove_cvref_t<Args>> && ...),
+        "trace() only takes arithmetic, string and void pointer arguments"
+    );
+    if (!detail::traceEnabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    detail::Payload payload;
+    (payload.put(args), ...);
+    detail::trace_write(detail::trace_site(fmt), payload);
+}
+
+/// @brief Turn a trace file back into text, one `file(line)::func: msg` line per record like
+/// detail::log() writes them, optionally prefixed with the time since start_trace().
+bool decode_trace(std::string const& path, std::ostream& out, bool timestamps = false);
+
+}  // namespace logger
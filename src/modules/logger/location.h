@@ -0,0 +1,58 @@
+#pragma once
+
+#include <ostream>
+#include <string_view>
+
+namespace logger::detail
+{
+/// @brief Extract filename from a source file path, removing all directories up to the specified
+/// level.
+constexpr std::string_view filename(std::string_view file, int level = 0) {
+    size_t pos = file.size();
+    for (int i = 0; i <= level; ++i) {
+        auto substr = file.substr(0, pos);
+        auto pos2 = substr.rfind('/');
+        if (pos2 == std::string_view::npos) {
+            break;
+        }
+        pos = pos2;
+    }
+    if (pos == file.size()) {
+        return file;
+    }
+    return file.substr(pos + 1, file.size() - pos - 1);
+}
+
+/// @brief Extract function name from a source location function signature
+constexpr std::string_view funcname(std::string_view func) {
+    auto pos = func.find('(');
+    if (pos != std::string_view::npos) {
+        func = func.substr(0, pos);
+    }
+    // pos = func.rfind("::");
+    // if (pos != std::string_view::npos) {
+    //     func = func.substr(pos + 2);
+    // }
+    pos = func.rfind(" ");
+    if (pos != std::string_view::npos) {
+        func = func.substr(pos + 1);
+    }
+    return func;
+}
+
+/// @brief Write one log line: `file(line)::func: msg`
+inline void write_line(
+    std::ostream& out,
+    std::string_view file,
+    unsigned line,
+    std::string_view func,
+    std::string_view msg
+) {
+    out << filename(file, 1) << "(" << line << ")" << "::" << funcname(func);
+    if (!msg.empty()) {
+        out << ": " << msg;
+    }
+    out << '\n';
+}
+
+}  // namespace logger::detail
@@ -1,53 +1,227 @@
 #include "logger/logger.h"
 
+#include "location.h"
+
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <thread>
 
 namespace
 {
+void print_line(std::string_view msg, std::source_location const& loc) {
+    logger::detail::write_line(std::cout, loc.file_name(), loc.line(), loc.function_name(), msg);
+}
+
+/// @brief Bounded multi-producer single-consumer ring of records (Vyukov's bounded queue).
+///
+/// Producers claim a slot with one CAS, fill it in place and publish it through the slot's
+/// sequence number. Nothing is allocated after construction.
+class Ring
+{
+public:
+    explicit Ring(std::size_t capacity)
+    : mask(capacity - 1)
+    , slots(std::make_unique<Slot[]>(capacity)) {
+        for (std::size_t i = 0; i < capacity; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    logger::detail::Record* claim() {
+        auto pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            auto& slot = slots[pos & mask];
+            auto seq = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<std::int64_t>(seq) - static_cast<std::int64_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.record.ticket = pos;
+                    return &slot.record;
+                }
+            } else if (diff < 0) {
+                drop();
+                return nullptr;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void publish(logger::detail::Record* record) {
+        slots[record->ticket & mask].sequence.store(record->ticket + 1, std::memory_order_release);
+    }
+
+    /// @brief Consumer side: the next published record, or nullptr.
+    logger::detail::Record* front() {
+        auto& slot = slots[dequeuePos & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != dequeuePos + 1) {
+            return nullptr;
+        }
+        return &slot.record;
+    }
+
+    /// @brief Consumer side: release the record returned by front().
+    void pop() {
+        slots[dequeuePos & mask].sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+        ++dequeuePos;
+        consumedPos.store(dequeuePos, std::memory_order_release);
+    }
+
+    std::uint64_t claimed() const { return enqueuePos.load(std::memory_order_acquire); }
+    std::uint64_t consumed() const { return consumedPos.load(std::memory_order_acquire); }
+    void drop() { droppedCount.fetch_add(1, std::memory_order_relaxed); }
+
+    std::uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+    std::size_t capacity() const { return mask + 1; }
 
-/// @brief Extract filename from source location, removing all directories up to the specified
-/// level.
-constexpr std::string_view filename(std::source_location const& loc, int level = 0) {
-    std::string_view file = loc.file_name();
-    size_t pos = file.size();
-    for (int i = 0; i <= level; ++i) {
-        auto substr = file.substr(0, pos);
-        auto pos2 = substr.rfind('/');
-        if (pos2 == std::string_view::npos) {
-            break;
+private:
+    struct alignas(64) Slot
+    {
+        std::atomic<std::uint64_t> sequence;
+        logger::detail::Record record;
+    };
+
+    std::size_t mask;
+    std::unique_ptr<Slot[]> slots;
+    alignas(64) std::atomic<std::uint64_t> enqueuePos{0};
+    alignas(64) std::uint64_t dequeuePos = 0;
+    std::atomic<std::uint64_t> consumedPos{0};
+    std::atomic<std::uint64_t> droppedCount{0};
+};
+
+// Only (re)created by start_async(), which must not race with log() calls from other threads.
+// It is published to them by the release store of asyncEnabled.
+std::unique_ptr<Ring> ring;
+std::thread writer;
+std::atomic<bool> stopping{false};
+
+// Producers between begin_record() and commit_record(). stop_async() waits for them, so that no
+// record is claimed after the writer has drained the ring for the last time.
+std::atomic<int> producers{0};
+
+/// @brief Format and write everything that is in the ring. Returns the number of records.
+std::size_t drain(std::string& msg) {
+    std::size_t count = 0;
+    while (auto* record = ring->front()) {
+        msg.clear();
+        auto const& payload = record->payload;
+        logger::detail::format_payload(
+            msg,
+            record->fmt,
+            std::span<const std::byte>(payload.data.data(), payload.size)
+        );
+        if (payload.truncated) {
+            msg += " [truncated]";
         }
-        pos = pos2;
+        print_line(msg, record->loc);
+        ring->pop();
+        ++count;
     }
-    if (pos == file.size()) {
-        return file;
+    if (count > 0) {
+        std::cout.flush();
     }
-    return file.substr(pos + 1, file.size() - pos - 1);
+    return count;
 }
 
-/// @brief Extract function name from source location
-constexpr std::string_view funcname(std::source_location const& loc) {
-    std::string_view func = loc.function_name();
-    auto pos = func.find('(');
-    if (pos != std::string_view::npos) {
-        func = func.substr(0, pos);
+void writer_loop() {
+    std::string msg;
+    msg.reserve(1024);
+    while (!stopping.load(std::memory_order_acquire)) {
+        if (drain(msg) == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
     }
-    // pos = func.rfind("::");
-    // if (pos != std::string_view::npos) {
-    //     func = func.substr(pos + 2);
-    // }
-    pos = func.rfind(" ");
-    if (pos != std::string_view::npos) {
-        func = func.substr(pos + 1);
+    // Records claimed before logging was switched back to synchronous mode.
+    while (ring->consumed() < ring->claimed()) {
+        if (drain(msg) == 0) {
+            std::this_thread::yield();
+        }
     }
-    return func;
 }
 
 }  // namespace
 
 void logger::detail::log(std::string const& msg, std::source_location const& loc) {
-    std::cout << filename(loc, 1) << "(" << loc.line() << ")" << "::" << funcname(loc);
-    if (!msg.empty()) {
-        std::cout << ": " << msg;
+    if (asyncEnabled.load(std::memory_order_acquire)) {
+        if (auto* record = begin_record()) {
+            record->loc = loc;
+            record->fmt = "{}";
+            record->payload.size = 0;
+            record->payload.numArgs = 0;
+            record->payload.truncated = false;
+            record->payload.put_string(msg);
+            commit_record(record);
+        }
+        return;
+    }
+    print_line(msg, loc);
+    std::cout.flush();
+}
+
+logger::detail::Record* logger::detail::begin_record() {
+    // Sequentially consistent with the exchange in stop_async(): either it sees this producer,
+    // or this producer sees async logging switched off.
+    producers.fetch_add(1);
+    if (!asyncEnabled.load()) {
+        ring->drop();
+        producers.fetch_sub(1, std::memory_order_release);
+        return nullptr;
+    }
+    auto* record = ring->claim();
+    if (!record) {
+        producers.fetch_sub(1, std::memory_order_release);
+    }
+    return record;
+}
+
+void logger::detail::commit_record(Record* record) {
+    ring->publish(record);
+    producers.fetch_sub(1, std::memory_order_release);
+}
+
+void logger::start_async(std::size_t capacity) {
+    if (detail::asyncEnabled.load()) {
+        return;
+    }
+    std::size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    if (!ring || ring->capacity() != size) {
+        ring = std::make_unique<Ring>(size);
     }
-    std::cout << std::endl;
-}
\ No newline at end of file
+    stopping.store(false);
+    writer = std::thread(writer_loop);
+    detail::asyncEnabled.store(true, std::memory_order_release);
+}
+
+void logger::stop_async() {
+    if (!detail::asyncEnabled.exchange(false)) {
+        return;
+    }
+    // Let the producers that saw async logging still on commit their records before the writer
+    // drains the ring for the last time.
+    while (producers.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+    stopping.store(true, std::memory_order_release);
+    writer.join();
+    if (auto count = ring->dropped()) {
+        logger::log("{} log messages were dropped", count);
+    }
+}
+
+void logger::flush() {
+    if (detail::asyncEnabled.load(std::memory_order_acquire)) {
+        auto target = ring->claimed();
+        while (ring->consumed() < target) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+    std::cout.flush();
+}
+
+std::uint64_t logger::dropped() {
+    return ring ? ring->dropped() : 0;
+}
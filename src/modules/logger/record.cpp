@@ -0,0 +1,158 @@
+#include "logger/record.h"
+
+#include <charconv>
+#include <format>
+
+namespace
+{
+using logger::detail::ArgType;
+
+struct ArgValue
+{
+    ArgType type;
+    union
+    {
+        bool b;
+        char c;
+        std::int64_t i;
+        std::uint64_t u;
+        double d;
+        const void* p;
+    };
+    std::string_view s;
+};
+
+constexpr std::size_t MAX_ARGS = logger::detail::Payload::CAPACITY / 2;
+
+template <typename T>
+T read(std::span<const std::byte> payload, std::size_t& pos) {
+    T value;
+    std::memcpy(&value, payload.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return value;
+}
+
+/// @brief Decode the tagged arguments of a payload. Returns the number of arguments.
+std::size_t decode(std::span<const std::byte> payload, std::array<ArgValue, MAX_ARGS>& args) {
+    std::size_t count = 0;
+    std::size_t pos = 0;
+    while (pos < payload.size() && count < MAX_ARGS) {
+        auto& arg = args[count++];
+        arg.type = read<ArgType>(payload, pos);
+        switch (arg.type) {
+            case ArgType::BOOL:
+                arg.b = read<bool>(payload, pos);
+                break;
+            case ArgType::CHAR:
+                arg.c = read<char>(payload, pos);
+                break;
+            case ArgType::INT:
+                arg.i = read<std::int64_t>(payload, pos);
+                break;
+            case ArgType::UINT:
+                arg.u = read<std::uint64_t>(payload, pos);
+                break;
+            case ArgType::DOUBLE:
+                arg.d = read<double>(payload, pos);
+                break;
+            case ArgType::POINTER:
+                arg.p = read<const void*>(payload, pos);
+                break;
+            case ArgType::STRING: {
+                auto length = read<std::uint16_t>(payload, pos);
+                arg.s = {reinterpret_cast<const char*>(payload.data() + pos), length};
+                pos += length;
+                break;
+            }
+            default:
+                return count - 1;  // corrupted
+        }
+    }
+    return count;
+}
+
+template <typename T>
+void format_one(std::string& out, std::string const& field, T value) {
+    std::vformat_to(std::back_inserter(out), field, std::make_format_args(value));
+}
+
+void format_arg(std::string& out, std::string const& field, ArgValue const& arg) {
+    switch (arg.type) {
+        case ArgType::BOOL:
+            return format_one(out, field, arg.b);
+        case ArgType::CHAR:
+            return format_one(out, field, arg.c);
+        case ArgType::INT:
+            return format_one(out, field, arg.i);
+        case ArgType::UINT:
+            return format_one(out, field, arg.u);
+        case ArgType::DOUBLE:
+            return format_one(out, field, arg.d);
+        case ArgType::POINTER:
+            return format_one(out, field, arg.p);
+        case ArgType::STRING:
+            return format_one(out, field, arg.s);
+    }
+}
+}  // namespace
+
+void logger::detail::format_payload(
+    std::string& out,
+    std::string_view fmt,
+    std::span<const std::byte> payload
+) {
+    std::array<ArgValue, MAX_ARGS> args;
+    std::size_t numArgs = decode(payload, args);
+
+    std::size_t nextArg = 0;
+    std::string field;
+    for (std::size_t i = 0; i < fmt.size(); ++i) {
+        char ch = fmt[i];
+        if (ch == '}' && i + 1 < fmt.size() && fmt[i + 1] == '}') {
+            out += '}';
+            ++i;
+            continue;
+        }
+        if (ch != '{') {
+            out += ch;
+            continue;
+        }
+        if (i + 1 < fmt.size() && fmt[i + 1] == '{') {
+            out += '{';
+            ++i;
+            continue;
+        }
+
+        auto close = fmt.find('}', i);
+        if (close == std::string_view::npos) {
+            out += "<bad format string>";
+            return;
+        }
+        // Replacement field: {[arg-id][:spec]}
+        auto replacement = fmt.substr(i + 1, close - i - 1);
+        auto colon = replacement.find(':');
+        auto id = replacement.substr(0, colon);
+        std::size_t index = nextArg++;
+        if (!id.empty()) {
+            std::from_chars(id.data(), id.data() + id.size(), index);
+        }
+        i = close;
+
+        if (index >= numArgs) {
+            out += "<missing>";
+            continue;
+        }
+        field = "{";
+        if (colon != std::string_view::npos) {
+            field += replacement.substr(colon);
+        }
+        field += '}';
+        try {
+            format_arg(out, field, args[index]);
+        } catch (std::format_error const& e) {
+            out += "<format error: ";
+            out += e.what();
+            out += '>';
+        }
+    }
+}
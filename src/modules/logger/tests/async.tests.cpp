@@ -0,0 +1,168 @@
+#include "logger/logger.h"
+
+#include <doctest/doctest.h>
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+thread_local bool countAllocations = false;
+thread_local int allocations = 0;
+
+/// @brief Redirect std::cout for the lifetime of the object.
+struct CaptureOutput
+{
+    std::ostringstream out;
+    std::streambuf* previous = std::cout.rdbuf(out.rdbuf());
+    ~CaptureOutput() { std::cout.rdbuf(previous); }
+};
+
+int count_lines(std::string const& s) {
+    int lines = 0;
+    for (char c : s) {
+        lines += c == '\n' ? 1 : 0;
+    }
+    return lines;
+}
+}  // namespace
+
+void* operator new(std::size_t size) {
+    if (countAllocations) {
+        ++allocations;
+    }
+    if (void* p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// noinline: keeps GCC from flagging free() on memory it saw come from operator new
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+TEST_CASE("payload formatting matches std::format") {
+    logger::detail::Payload payload;
+    payload.put(42);
+    payload.put(2.5);
+    payload.put("test");
+    payload.put(std::string("owned"));
+    payload.put('c');
+    payload.put(true);
+    payload.put(std::uint8_t(200));
+
+    std::string out;
+    logger::detail::format_payload(
+        out,
+        "{} {:.2f} {} {} {} {} {:#x} {{literal}}",
+        std::span<const std::byte>(payload.data.data(), payload.size)
+    );
+    auto expected = std::format(
+        "{} {:.2f} {} {} {} {} {:#x} {{literal}}",
+        42,
+        2.5,
+        "test",
+        "owned",
+        'c',
+        true,
+        200
+    );
+    CHECK(out == expected);
+
+    out.clear();
+    logger::detail::format_payload(
+        out,
+        "{1} {0} {9}",
+        std::span<const std::byte>(payload.data.data(), payload.size)
+    );
+    CHECK(out == "2.5 42 <missing>");
+}
+
+TEST_CASE("payload truncates long strings") {
+    logger::detail::Payload payload;
+    payload.put(std::string(1000, 'x'));
+    CHECK(payload.truncated);
+    CHECK(payload.size == logger::detail::Payload::CAPACITY);
+    CHECK(payload.numArgs == 1);
+}
+
+TEST_CASE("async logging writes the same lines as synchronous logging") {
+    std::string syncOutput;
+    std::string asyncOutput;
+    auto logSomething = [] {
+        logger::log("Hello, World!");
+        logger::log("Formatted number: {}", int(42));
+        logger::log("Multiple values: {}, {}, {}", 1, 2.5, "test");
+    };
+    {
+        CaptureOutput capture;
+        logSomething();
+        syncOutput = capture.out.str();
+    }
+    {
+        CaptureOutput capture;
+        logger::start_async();
+        logSomething();
+        logger::stop_async();
+        asyncOutput = capture.out.str();
+    }
+    CHECK(count_lines(syncOutput) == 3);
+    // Only the line numbers differ.
+    CHECK(asyncOutput.size() == syncOutput.size());
+    CHECK(asyncOutput.find("Multiple values: 1, 2.5, test") != std::string::npos);
+}
+
+TEST_CASE("async log call sites never allocate") {
+    CaptureOutput capture;
+    logger::start_async(1024);
+
+    std::string const owned = "a string that would not fit a small string buffer";
+    allocations = 0;
+    countAllocations = true;
+    for (int i = 0; i < 500; ++i) {
+        logger::log("no arguments");
+        logger::log("int {} double {} char {}", i, i * 0.5, 'x');
+        logger::log("strings {} {}", "literal", owned);
+    }
+    countAllocations = false;
+    CHECK(allocations == 0);
+
+    logger::stop_async();
+    CHECK(count_lines(capture.out.str()) + logger::dropped() >= 1500);
+}
+
+TEST_CASE("async logging counts drops when the ring is full") {
+    CaptureOutput capture;
+    logger::start_async(16);
+    auto droppedBefore = logger::dropped();
+
+    constexpr int perThread = 10'000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < perThread; ++i) {
+                logger::log("thread {} message {}", t, i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    logger::flush();
+    auto written = count_lines(capture.out.str());
+    auto dropped = logger::dropped() - droppedBefore;
+    logger::stop_async();
+
+    MESSAGE("written " << written << ", dropped " << dropped);
+    CHECK(written + dropped == 4 * perThread);
+}
@@ -0,0 +1,76 @@
+#include "logger/trace.h"
+
+#include "test_support/files.h"
+
+#include <doctest/doctest.h>
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+/// @brief A temporary file of this process.
+std::string temp_path(std::string_view name) {
+    return test_support::temp_path(std::string(name) + std::to_string(getpid()));
+}
+
+/// @brief Trace and log the same message, from the caller's location.
+template <typename... Args>
+void trace_and_log(logger::FormatWithLocation fmt, Args const&... args) {
+    logger::trace(fmt, args...);
+    logger::log(fmt, args...);
+}
+}  // namespace
+
+TEST_CASE("trace decodes to the same text as log") {
+    auto path = temp_path("logger_trace_");
+    std::ostringstream logged;
+
+    REQUIRE(logger::start_trace(path, 1 << 20));
+    {
+        auto* previous = std::cout.rdbuf(logged.rdbuf());
+        trace_and_log("no arguments");
+        for (int i = 0; i < 3; ++i) {
+            trace_and_log("block {} voices {:>3}", i, 2 * i);
+        }
+        trace_and_log("{} {} {}", 2.5, "text", true);
+        std::cout.rdbuf(previous);
+    }
+    logger::stop_trace();
+    CHECK(logger::trace_dropped() == 0);
+
+    std::ostringstream decoded;
+    REQUIRE(logger::decode_trace(path, decoded));
+    CHECK(decoded.str() == logged.str());
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("trace drops records when the file is full") {
+    auto path = temp_path("logger_trace_full_");
+    REQUIRE(logger::start_trace(path, 8192));
+    for (int i = 0; i < 1000; ++i) {
+        logger::trace("message {}", i);
+    }
+    logger::stop_trace();
+
+    std::ostringstream decoded;
+    REQUIRE(logger::decode_trace(path, decoded));
+    int lines = 0;
+    for (char c : decoded.str()) {
+        lines += c == '\n' ? 1 : 0;
+    }
+    CHECK(lines > 0);
+    CHECK(lines + logger::trace_dropped() == 1000);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("trace is a no-op when not started") {
+    logger::trace("nothing is recorded {}", 1);
+    CHECK_FALSE(logger::decode_trace("/nonexistent/trace", std::cout));
+}
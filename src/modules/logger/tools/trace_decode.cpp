@@ -0,0 +1,23 @@
+#include "logger/trace.h"
+
+#include <iostream>
+#include <string_view>
+
+int main(int argc, char* argv[]) {
+    bool timestamps = false;
+    std::string_view path;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--timestamps") {
+            timestamps = true;
+        } else {
+            path = arg;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "usage: " << argv[0] << " [--timestamps] <trace file>\n";
+        return EXIT_FAILURE;
+    }
+    return logger::decode_trace(std::string(path), std::cout, timestamps) ? EXIT_SUCCESS
+                                                                            : EXIT_FAILURE;
+}
@@ -0,0 +1,319 @@
+#include "logger/trace.h"
+
+#include "location.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <format>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+constexpr std::array<char, 8> MAGIC = {'M', 'T', 'T', 'R', 'A', 'C', 'E', '1'};
+constexpr std::uint32_t NO_SITE = 0xFFFF'FFFF;
+constexpr std::uint16_t FLAG_TRUNCATED = 1;
+
+enum class Kind : std::uint16_t
+{
+    SITE = 1,
+    EVENT = 2
+};
+
+struct FileHeader
+{
+    std::array<char, 8> magic;
+    std::uint32_t headerSize;
+    std::uint32_t reserved;
+    std::int64_t startTime;  ///< steady clock, ns
+    std::uint64_t used;      ///< bytes used, written by stop_trace(), 0 if the process died
+};
+
+/// @brief Header of each record. Records are 8 byte aligned; a zero size marks the end.
+struct RecordHeader
+{
+    std::uint32_t size;  ///< header included, written last
+    Kind kind;
+    std::uint16_t flags;
+    std::uint32_t site;
+    std::uint32_t reserved;
+    std::int64_t timestamp;  ///< steady clock, ns
+};
+static_assert(sizeof(RecordHeader) == 24);
+
+constexpr std::size_t DATA_OFFSET = 64;
+static_assert(sizeof(FileHeader) <= DATA_OFFSET);
+
+std::int64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()
+    )
+        .count();
+}
+
+struct Trace
+{
+    struct Site
+    {
+        std::atomic<std::uint64_t> key{0};
+        std::atomic<std::uint32_t> id{0};
+    };
+    static constexpr std::size_t MAX_SITES = 4096;
+
+    int fd = -1;
+    std::byte* base = nullptr;
+    std::size_t capacity = 0;
+    alignas(64) std::atomic<std::size_t> offset{DATA_OFFSET};
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<std::uint32_t> nextSite{1};
+    std::array<Site, MAX_SITES> sites;
+
+    /// @brief Reserve space for a record, nullptr if the file is full.
+    RecordHeader* reserve(std::size_t size) {
+        std::size_t aligned = (size + 7) & ~std::size_t(7);
+        std::size_t pos = offset.fetch_add(aligned, std::memory_order_relaxed);
+        if (pos + aligned > capacity) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        return reinterpret_cast<RecordHeader*>(base + pos);
+    }
+
+    static void publish(RecordHeader* header, std::size_t size) {
+        std::atomic_ref<std::uint32_t>(header->size)
+            .store(static_cast<std::uint32_t>(size), std::memory_order_release);
+    }
+};
+
+// Only (re)created by start_trace(), which must not race with trace() calls from other threads.
+std::unique_ptr<Trace> active;
+
+void put_string(std::byte*& out, std::string_view s) {
+    auto length = static_cast<std::uint16_t>(std::min<std::size_t>(s.size(), 0xFFFF));
+    std::memcpy(out, &length, sizeof(length));
+    std::memcpy(out + sizeof(length), s.data(), length);
+    out += sizeof(length) + length;
+}
+
+std::uint32_t register_site(logger::FormatWithLocation const& fmt) {
+    auto const& loc = fmt.loc;
+    std::string_view file = loc.file_name();
+    std::string_view func = loc.function_name();
+    std::size_t size = sizeof(RecordHeader) + 2 * sizeof(std::uint32_t) + 3 * sizeof(std::uint16_t) +
+                       file.size() + func.size() + fmt.value.size();
+    auto* header = active->reserve(size);
+    if (!header) {
+        return NO_SITE;
+    }
+    std::uint32_t id = active->nextSite.fetch_add(1, std::memory_order_relaxed);
+    header->kind = Kind::SITE;
+    header->flags = 0;
+    header->site = id;
+    header->timestamp = now();
+
+    auto* out = reinterpret_cast<std::byte*>(header + 1);
+    std::uint32_t position[] = {loc.line(), loc.column()};
+    std::memcpy(out, position, sizeof(position));
+    out += sizeof(position);
+    put_string(out, file);
+    put_string(out, func);
+    put_string(out, fmt.value);
+    Trace::publish(header, size);
+    return id;
+}
+
+template <typename T>
+T read(const std::byte* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+std::string_view read_string(const std::byte*& p) {
+    auto length = read<std::uint16_t>(p);
+    std::string_view s(reinterpret_cast<const char*>(p + sizeof(length)), length);
+    p += sizeof(length) + length;
+    return s;
+}
+}  // namespace
+
+std::uint32_t logger::detail::trace_site(FormatWithLocation const& fmt) {
+    // Sites are identified by the addresses of their (static) strings and their position.
+    auto key = reinterpret_cast<std::uintptr_t>(fmt.value.data()) * 0x9E37'79B9'7F4A'7C15ull;
+    key ^= reinterpret_cast<std::uintptr_t>(fmt.loc.file_name()) * 0xC2B2'AE3D'27D4'EB4Full;
+    key ^= (std::uint64_t(fmt.loc.line()) << 32 | fmt.loc.column()) * 0x1656'67B1'9E37'79F9ull;
+    key |= 1;  // 0 marks an empty slot
+
+    auto& sites = active->sites;
+    for (std::size_t probe = 0; probe < Trace::MAX_SITES; ++probe) {
+        auto& slot = sites[(key + probe) & (Trace::MAX_SITES - 1)];
+        auto k = slot.key.load(std::memory_order_acquire);
+        if (k == 0) {
+            if (slot.key.compare_exchange_strong(k, key, std::memory_order_acq_rel)) {
+                auto id = register_site(fmt);
+                slot.id.store(id, std::memory_order_release);
+                return id;
+            }
+        }
+        if (k == key) {
+            std::uint32_t id;
+            while ((id = slot.id.load(std::memory_order_acquire)) == 0) {
+                // another thread is registering this site
+            }
+            return id;
+        }
+    }
+    return NO_SITE;
+}
+
+void logger::detail::trace_write(std::uint32_t site, Payload const& payload) {
+    if (site == NO_SITE) {
+        active->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    std::size_t size = sizeof(RecordHeader) + payload.size;
+    auto* header = active->reserve(size);
+    if (!header) {
+        return;
+    }
+    header->kind = Kind::EVENT;
+    header->flags = payload.truncated ? FLAG_TRUNCATED : 0;
+    header->site = site;
+    header->timestamp = now();
+    std::memcpy(header + 1, payload.data.data(), payload.size);
+    Trace::publish(header, size);
+}
+
+bool logger::start_trace(std::string const& path, std::size_t capacity) {
+    if (detail::traceEnabled.load()) {
+        return false;
+    }
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        logger::log("Could not open trace file {}: {}", path, std::strerror(errno));
+        return false;
+    }
+    capacity = std::max(capacity, DATA_OFFSET + 4096);
+    if (::ftruncate(fd, static_cast<off_t>(capacity)) != 0) {
+        logger::log("Could not resize trace file {}: {}", path, std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    // Pre-fault the pages so that trace() never takes a page fault.
+    void* base = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    if (base == MAP_FAILED) {
+        logger::log("Could not map trace file {}: {}", path, std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+
+    active = std::make_unique<Trace>();
+    active->fd = fd;
+    active->base = static_cast<std::byte*>(base);
+    active->capacity = capacity;
+
+    auto* header = reinterpret_cast<FileHeader*>(base);
+    header->magic = MAGIC;
+    header->headerSize = DATA_OFFSET;
+    header->startTime = now();
+    header->used = 0;
+
+    detail::traceEnabled.store(true);
+    return true;
+}
+
+void logger::stop_trace() {
+    if (!detail::traceEnabled.exchange(false)) {
+        return;
+    }
+    auto used = std::min(active->offset.load(), active->capacity);
+    reinterpret_cast<FileHeader*>(active->base)->used = used;
+    ::munmap(active->base, active->capacity);
+    if (::ftruncate(active->fd, static_cast<off_t>(used)) != 0) {
+        logger::log("Could not truncate trace file: {}", std::strerror(errno));
+    }
+    ::close(active->fd);
+    if (auto dropped = active->dropped.load()) {
+        logger::log("{} trace records were dropped", dropped);
+    }
+}
+
+std::uint64_t logger::trace_dropped() {
+    return active ? active->dropped.load() : 0;
+}
+
+bool logger::decode_trace(std::string const& path, std::ostream& out, bool timestamps) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> contents(
+        (std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>()
+    );
+    std::span<const std::byte> data(
+        reinterpret_cast<const std::byte*>(contents.data()),
+        contents.size()
+    );
+    FileHeader header;
+    if (data.size() < DATA_OFFSET) {
+        logger::log("{} is not a trace file", path);
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != MAGIC) {
+        logger::log("{} is not a trace file", path);
+        return false;
+    }
+    std::size_t end = header.used != 0 ? std::min<std::size_t>(header.used, data.size())
+                                       : data.size();
+
+    struct Site
+    {
+        std::uint32_t line;
+        std::string_view file;
+        std::string_view func;
+        std::string_view fmt;
+    };
+    std::unordered_map<std::uint32_t, Site> sites;
+
+    std::string msg;
+    std::size_t pos = header.headerSize;
+    while (pos + sizeof(RecordHeader) <= end) {
+        auto record = read<RecordHeader>(data.data() + pos);
+        if (record.size < sizeof(RecordHeader) || pos + record.size > end) {
+            break;  // end of the recorded data, or a record that was never completed
+        }
+        const std::byte* body = data.data() + pos + sizeof(RecordHeader);
+        if (record.kind == Kind::SITE) {
+            Site site;
+            site.line = read<std::uint32_t>(body);
+            body += 2 * sizeof(std::uint32_t);
+            site.file = read_string(body);
+            site.func = read_string(body);
+            site.fmt = read_string(body);
+            sites[record.site] = site;
+        } else if (auto it = sites.find(record.site); it != sites.end()) {
+            auto const& site = it->second;
+            msg.clear();
+            detail::format_payload(
+                msg,
+                site.fmt,
+                std::span<const std::byte>(body, record.size - sizeof(RecordHeader))
+            );
+            if (record.flags & FLAG_TRUNCATED) {
+                msg += " [truncated]";
+            }
+            if (timestamps) {
+                out << std::format("[{:.6f}] ", (record.timestamp - header.startTime) * 1e-9);
+            }
+            detail::write_line(out, site.file, site.line, site.func, msg);
+        }
+        pos += (record.size + 7) & ~std::size_t(7);
+    }
+    return true;
+}
@@ -0,0 +1,284 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace midi
+{
+/// @brief What a byte of a MIDI stream starts.
+enum class MessageType : std::uint8_t
+{
+    DATA,  ///< not a status byte
+    NOTE_OFF,
+    NOTE_ON,
+    POLY_PRESSURE,
+    CONTROL_CHANGE,
+    PROGRAM_CHANGE,
+    CHANNEL_PRESSURE,
+    PITCH_BEND,
+    SYSEX,
+    SYSEX_END,
+    SYSTEM_COMMON,  ///< MTC quarter frame, song position, song select, tune request
+    REALTIME,       ///< clock, start, continue, stop, active sensing, reset
+    UNDEFINED
+};
+
+struct StatusInfo
+{
+    MessageType type = MessageType::DATA;
+    std::uint8_t length = 0;  ///< data bytes following the status byte
+};
+
+namespace detail
+{
+constexpr std::array<StatusInfo, 256> make_status_table() {
+    std::array<StatusInfo, 256> table{};
+    constexpr StatusInfo CHANNEL[] = {
+        {MessageType::NOTE_OFF, 2},
+        {MessageType::NOTE_ON, 2},
+        {MessageType::POLY_PRESSURE, 2},
+        {MessageType::CONTROL_CHANGE, 2},
+        {MessageType::PROGRAM_CHANGE, 1},
+        {MessageType::CHANNEL_PRESSURE, 1},
+        {MessageType::PITCH_BEND, 2},
+    };
+    for (int status = 0x80; status < 0xF0; ++status) {
+        table[status] = CHANNEL[(status >> 4) - 8];
+    }
+    table[0xF0] = {MessageType::SYSEX, 0};
+    table[0xF1] = {MessageType::SYSTEM_COMMON, 1};
+    table[0xF2] = {MessageType::SYSTEM_COMMON, 2};
+    table[0xF3] = {MessageType::SYSTEM_COMMON, 1};
+    table[0xF4] = {MessageType::UNDEFINED, 0};
+    table[0xF5] = {MessageType::UNDEFINED, 0};
+    table[0xF6] = {MessageType::SYSTEM_COMMON, 0};
+    table[0xF7] = {MessageType::SYSEX_END, 0};
+    for (int status = 0xF8; status <= 0xFF; ++status) {
+        table[status] = {MessageType::REALTIME, 0};
+    }
+    return table;
+}
+}  // namespace detail
+
+/// @brief Type and data length of every byte value, built at compile time.
+inline constexpr std::array<StatusInfo, 256> STATUS_TABLE = detail::make_status_table();
+
+namespace detail
+{
+template <typename Handler>
+using Dispatch = void (*)(Handler& handler, std::uint8_t status, std::uint8_t d1, std::uint8_t d2);
+
+// One function per message type. A handler without the matching member ignores the message at
+// no cost; the check happens at compile time.
+template <typename Handler>
+void note_off(Handler& h, std::uint8_t status, std::uint8_t d1, std::uint8_t d2) {
+    if constexpr (requires { h.note_off(status, d1, d2); }) {
+        h.note_off(std::uint8_t(status & 0x0F), d1, d2);
+    }
+}
+
+template <typename Handler>
+void note_on(Handler& h, std::uint8_t status, std::uint8_t d1, std::uint8_t d2) {
+    if (d2 == 0) {  // note on with velocity 0 is a note off
+        note_off(h, status, d1, 0);
+    } else if constexpr (requires { h.note_on(status, d1, d2); }) {
+        h.note_on(std::uint8_t(status & 0x0F), d1, d2);
+    }
+}
+
+template <typename Handler>
+void poly_pressure(Handler& h, std::uint8_t status, std::uint8_t d1, std::uint8_t d2) {
+    if constexpr (requires { h.poly_pressure(status, d1, d2); }) {
+        h.poly_pressure(std::uint8_t(status & 0x0F), d1, d2);
+    }
+}
+
+template <typename Handler>
+void control_change(Handler& h, std::uint8_t status, std::uint8_t d1, std::uint8_t d2) {
+    if constexpr (requires { h.control_change(status, d1, d2); }) {
+        h.control_change(std::uint8_t(status & 0x0F), d1, d2);
+    }
+}
+
+template <typename Handler>
+void program_change(Handler& h, std::uint8_t status, std::uint8_t d1, std::uint8_t) {
+    if constexpr (requires { h.program_change(status, d1); }) {
+        h.program_change(std::uint8_t(status & 0x0F), d1);
+    }
+}
+
+template <typename Handler>
+void channel_pressure(Handler& h, std::uint8_t status, std::uint8_t d1, std::uint8_t) {
+    if constexpr (requires { h.channel_pressure(status, d1); }) {
+        h.channel_pressure(std::uint8_t(status & 0x0F), d1);
+    }
+}
+
+template <typename Handler>
+void pitch_bend(Handler& h, std::uint8_t status, std::uint8_t d1, std::uint8_t d2) {
+    if constexpr (requires { h.pitch_bend(status, std::uint16_t{}); }) {
+        h.pitch_bend(std::uint8_t(status & 0x0F), std::uint16_t(d1 | d2 << 7));
+    }
+}
+
+template <typename Handler>
+void system_common(Handler& h, std::uint8_t status, std::uint8_t d1, std::uint8_t d2) {
+    if constexpr (requires { h.system_common(status, d1, d2); }) {
+        h.system_common(status, d1, d2);
+    }
+}
+
+template <typename Handler>
+void realtime(Handler& h, std::uint8_t status, std::uint8_t, std::uint8_t) {
+    if constexpr (requires { h.realtime(status); }) {
+        h.realtime(status);
+    }
+}
+
+template <typename Handler>
+void ignore(Handler&, std::uint8_t, std::uint8_t, std::uint8_t) {}
+
+template <typename Handler>
+constexpr std::array<Dispatch<Handler>, 256> make_dispatch_table() {
+    std::array<Dispatch<Handler>, 256> table{};
+    for (std::size_t status = 0; status < table.size(); ++status) {
+        switch (STATUS_TABLE[status].type) {
+            case MessageType::NOTE_OFF:
+                table[status] = note_off<Handler>;
+                break;
+            case MessageType::NOTE_ON:
+                table[status] = note_on<Handler>;
+                break;
+            case MessageType::POLY_PRESSURE:
+                table[status] = poly_pressure<Handler>;
+                break;
+            case MessageType::CONTROL_CHANGE:
+                table[status] = control_change<Handler>;
+                break;
+            case MessageType::PROGRAM_CHANGE:
+                table[status] = program_change<Handler>;
+                break;
+            case MessageType::CHANNEL_PRESSURE:
+                table[status] = channel_pressure<Handler>;
+                break;
+            case MessageType::PITCH_BEND:
+                table[status] = pitch_bend<Handler>;
+                break;
+            case MessageType::SYSTEM_COMMON:
+                table[status] = system_common<Handler>;
+                break;
+            case MessageType::REALTIME:
+                table[status] = realtime<Handler>;
+                break;
+            default:
+                table[status] = ignore<Handler>;
+                break;
+        }
+    }
+    return table;
+}
+
+/// @brief Status byte to handler function, for one handler type.
+template <typename Handler>
+inline constexpr std::array<Dispatch<Handler>, 256> DISPATCH_TABLE = make_dispatch_table<Handler>();
+
+}  // namespace detail
+
+/// @brief Decodes a MIDI byte stream and calls the matching member of Handler for each message.
+///
+/// Handler members are all optional and called without virtual dispatch:
+///   note_on(channel, note, velocity), note_off(channel, note, velocity),
+///   poly_pressure(channel, note, pressure), control_change(channel, controller, value),
+///   program_change(channel, program), channel_pressure(channel, pressure),
+///   pitch_bend(channel, value) with value in [0, 16383], 8192 being the center,
+///   sysex(span of the bytes between F0 and F7), system_common(status, data1, data2),
+///   realtime(status).
+/// Running status is followed across messages and calls, realtime bytes may appear anywhere,
+/// and a note on with velocity 0 is reported as a note off. Nothing is allocated.
+template <typename Handler>
+class Decoder
+{
+public:
+    explicit Decoder(Handler& handler)
+    : handler(handler) {}
+
+    /// @brief Decode one or more messages. A message cut short is completed by the next call;
+    /// a sysex message is only reported when it starts and ends within one call.
+    void decode(std::span<const std::uint8_t> bytes) {
+        for (std::size_t i = 0; i < bytes.size(); ++i) {
+            std::uint8_t byte = bytes[i];
+            if (byte < 0x80) {
+                if (status == 0) {
+                    continue;  // no running status, or the rest of a sysex message
+                }
+                data[count++] = byte;
+                if (count == length) {
+                    dispatch();
+                }
+                continue;
+            }
+
+            StatusInfo const info = STATUS_TABLE[byte];
+            switch (info.type) {
+                case MessageType::REALTIME:
+                    detail::DISPATCH_TABLE<Handler>[byte](handler, byte, 0, 0);
+                    break;
+                case MessageType::SYSEX:
+                    status = 0;
+                    i = sysex(bytes, i);
+                    break;
+                case MessageType::SYSEX_END:
+                case MessageType::UNDEFINED:
+                    status = 0;
+                    break;
+                default:
+                    status = byte;
+                    length = info.length;
+                    count = 0;
+                    if (length == 0) {
+                        dispatch();
+                    }
+                    break;
+            }
+        }
+    }
+
+    /// @brief Forget the running status and any partial message.
+    void reset() {
+        status = 0;
+        count = 0;
+    }
+
+private:
+    void dispatch() {
+        detail::DISPATCH_TABLE<Handler>[status](handler, status, data[0], data[1]);
+        count = 0;
+        if (status >= 0xF0) {
+            status = 0;  // system common messages cancel running status
+        }
+    }
+
+    /// @brief Report the sysex message starting at bytes[start]. Returns the index of its F7,
+    /// or of the last byte if it does not end in this call.
+    std::size_t sysex(std::span<const std::uint8_t> bytes, std::size_t start) {
+        for (std::size_t end = start + 1; end < bytes.size(); ++end) {
+            if (bytes[end] == 0xF7) {
+                if constexpr (requires { handler.sysex(bytes); }) {
+                    handler.sysex(bytes.subspan(start + 1, end - start - 1));
+                }
+                return end;
+            }
+        }
+        return bytes.size() - 1;
+    }
+
+    Handler& handler;
+    std::uint8_t status = 0;  ///< running status, 0 for none
+    std::uint8_t length = 0;
+    std::uint8_t count = 0;
+    std::array<std::uint8_t, 2> data{};
+};
+
+}  // namespace midi
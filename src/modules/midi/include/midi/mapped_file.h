@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace midi
+{
+/// @brief Read-only memory mapping of a whole file. Pages are only loaded when they are read.
+class MappedFile
+{
+public:
+    /// @brief How the file will be read, to tune the kernel's read-ahead.
+    enum class Access
+    {
+        SEQUENTIAL,  ///< front to back, e.g. a MIDI file: read ahead aggressively
+        RANDOM       ///< scattered reads, e.g. sample banks: load only the pages touched
+    };
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    bool open(std::string const& path, Access access = Access::SEQUENTIAL);
+    void close();
+
+    /// @brief Start loading the pages of a range of bytes() in the background, without waiting.
+    void prefetch(std::span<const std::uint8_t> range) const;
+
+    std::span<const std::uint8_t> bytes() const { return {data, size}; }
+    bool is_open() const { return data != nullptr; }
+
+private:
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+};
+
+}  // namespace midi
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "midi/smf.h"
+#include "midi/tempo_map.h"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace midi
+{
+constexpr int NUM_CHANNELS = 16;
+
+/// @brief General MIDI power-on controller values.
+constexpr std::array<std::uint8_t, 128> default_controllers() {
+    std::array<std::uint8_t, 128> controllers{};
+    controllers[7] = 100;   // volume
+    controllers[10] = 64;   // pan
+    controllers[11] = 127;  // expression
+    return controllers;
+}
+
+/// @brief What a channel looks like after a sequence of events.
+struct ChannelState
+{
+    std::array<std::uint8_t, 128> controllers = default_controllers();
+    std::array<std::uint8_t, 128> notes{};  ///< velocity of each held note, 0 if released
+    std::uint16_t pitchBend = 8192;
+    std::uint8_t program = 0;
+    std::uint8_t pressure = 0;
+
+    bool operator==(ChannelState const&) const = default;
+};
+
+using ChannelStates = std::array<ChannelState, NUM_CHANNELS>;
+
+/// @brief Update the channel state with a channel event; other events are ignored.
+void apply_event(ChannelStates& channels, Event const& event);
+
+/// @brief Tempo map plus periodic snapshots of the channel state and track positions, so a file
+/// can be entered at any tick by replaying at most one interval of events.
+class SeekIndex
+{
+public:
+    static constexpr double DEFAULT_INTERVAL = 1.0;  ///< seconds between snapshots
+
+    /// @brief Scan the file once.
+    void build(File const& file, double interval = DEFAULT_INTERVAL);
+
+    /// @brief Use the sidecar index `<source>.idx` if it matches the file, otherwise build the
+    /// index and try to write the sidecar for next time.
+    void load_or_build(File const& file, std::string const& source);
+
+    /// @brief Write the index for source to path. Returns false and logs on error.
+    bool save(std::string const& path, std::string const& source) const;
+
+    /// @brief Read an index written by save(). Returns false if it is missing, unreadable or
+    /// was written for a different version of source.
+    bool load(std::string const& path, std::string const& source, File const& file);
+
+    /// @brief Position reader at the first event at or after tick, and set channels to the state
+    /// after every event before it.
+    void seek(std::uint64_t tick, EventReader& reader, ChannelStates& channels) const;
+
+    TempoMap const& tempo() const { return tempoMap; }
+    std::size_t num_snapshots() const { return snapshots.size(); }
+
+private:
+    struct Snapshot
+    {
+        std::uint64_t tick;  ///< the first tick not yet applied to channels
+        ChannelStates channels;
+    };
+
+    void take_snapshot(std::uint64_t tick, EventReader const& reader, ChannelStates const& state);
+
+    TempoMap tempoMap;
+    std::uint16_t division = 0;
+    std::size_t numTracks = 0;
+    std::vector<Snapshot> snapshots;
+    std::vector<TrackPosition> positions;  ///< numTracks entries per snapshot
+};
+
+}  // namespace midi
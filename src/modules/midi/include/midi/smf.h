@@ -0,0 +1,178 @@
+#pragma once
+
+#include "midi/mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace midi
+{
+enum class EventKind : std::uint8_t
+{
+    CHANNEL,
+    META,
+    SYSEX
+};
+
+/// @brief One event of a Standard MIDI File, decoded in place.
+struct Event
+{
+    std::uint64_t tick = 0;  ///< absolute, from the start of the track
+    std::uint16_t track = 0;
+    EventKind kind = EventKind::CHANNEL;
+    std::uint8_t status = 0;  ///< running status resolved; 0xFF for meta, 0xF0 or 0xF7 for sysex
+    std::uint8_t metaType = 0;
+    std::uint8_t data1 = 0;
+    std::uint8_t data2 = 0;
+    std::span<const std::uint8_t> payload;  ///< meta or sysex data, points into the file
+
+    std::uint8_t channel() const { return status & 0x0F; }
+    std::uint8_t command() const { return status & 0xF0; }
+};
+
+/// @brief Meta event types used by the player.
+enum MetaType : std::uint8_t
+{
+    META_TEXT = 0x01,
+    META_TRACK_NAME = 0x03,
+    META_END_OF_TRACK = 0x2F,
+    META_TEMPO = 0x51,
+    META_TIME_SIGNATURE = 0x58
+};
+
+/// @brief Reads a variable length quantity. Returns false if it runs past end or exceeds 4 bytes.
+bool read_vlq(const std::uint8_t*& pos, const std::uint8_t* end, std::uint32_t& value);
+
+/// @brief Where a TrackCursor is in its chunk, enough to resume decoding from there.
+struct TrackPosition
+{
+    std::uint64_t tick = 0;    ///< tick of the next event
+    std::uint32_t offset = 0;  ///< byte offset of the next event, past its delta time
+    std::uint8_t runningStatus = 0;
+    bool finished = true;
+};
+
+/// @brief Decodes events of a single MTrk chunk, one at a time.
+class TrackCursor
+{
+public:
+    TrackCursor() = default;
+    TrackCursor(std::span<const std::uint8_t> chunk, std::uint16_t track);
+    TrackCursor(std::span<const std::uint8_t> chunk, std::uint16_t track, TrackPosition position);
+
+    TrackPosition position() const;
+
+    /// @brief Tick of the next event. Only meaningful while !done().
+    std::uint64_t tick() const { return nextTick; }
+    bool done() const { return finished; }
+
+    /// @brief Decode the next event. Returns false at the end of the track or on malformed data.
+    bool next(Event& event);
+
+private:
+    void read_delta();
+
+    const std::uint8_t* begin = nullptr;
+    const std::uint8_t* pos = nullptr;
+    const std::uint8_t* end = nullptr;
+    std::uint64_t nextTick = 0;
+    std::uint16_t track = 0;
+    std::uint8_t runningStatus = 0;
+    bool finished = true;
+};
+
+class File;
+
+/// @brief Merges the tracks of a file in tick order (ties go to the lower track number).
+/// Storage for the cursors is allocated once on construction; iterating does not allocate.
+class EventReader
+{
+public:
+    explicit EventReader(File const& file);
+
+    bool next(Event& event);
+    void rewind();
+
+    /// @brief Tick of the event next() would return. Returns false at the end.
+    bool peek_tick(std::uint64_t& tick) const;
+
+    /// @brief Store the position of every track; positions must hold one entry per track.
+    void save(std::span<TrackPosition> positions) const;
+    /// @brief Resume from positions taken by save() on a reader of the same file.
+    void restore(std::span<const TrackPosition> positions);
+
+    class Iterator
+    {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Event;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Event*;
+        using reference = const Event&;
+
+        Iterator() = default;
+        explicit Iterator(EventReader* reader)
+        : reader(reader) {
+            ++*this;
+        }
+
+        reference operator*() const { return current; }
+        pointer operator->() const { return &current; }
+        Iterator& operator++() {
+            if (!reader->next(current)) {
+                reader = nullptr;
+            }
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+        bool operator==(std::default_sentinel_t) const { return reader == nullptr; }
+
+    private:
+        EventReader* reader = nullptr;
+        Event current;
+    };
+
+    Iterator begin() { return Iterator(this); }
+    std::default_sentinel_t end() const { return {}; }
+
+private:
+    bool before(std::uint16_t a, std::uint16_t b) const;
+    void sift_down(std::size_t index);
+    void build_heap();
+
+    File const& file;
+    std::vector<TrackCursor> cursors;
+    std::vector<std::uint16_t> heap;  ///< binary min-heap of track numbers, keyed on cursor tick
+};
+
+/// @brief A Standard MIDI File (format 0, 1 or 2). open() maps the file and only indexes the
+/// track chunks; events are decoded lazily by EventReader or TrackCursor.
+class File
+{
+public:
+    /// @brief Map and index a file. Returns false and logs if it is not a valid SMF.
+    bool open(std::string const& path);
+
+    /// @brief Index a file already in memory. The bytes must outlive this object.
+    bool parse(std::span<const std::uint8_t> bytes);
+
+    std::uint16_t format() const { return fileFormat; }
+    /// @brief Ticks per quarter note, or the raw SMPTE division if the top bit is set.
+    std::uint16_t division() const { return timeDivision; }
+    std::size_t num_tracks() const { return tracks.size(); }
+    std::span<const std::uint8_t> track(std::size_t index) const { return tracks[index]; }
+
+    EventReader events() const { return EventReader(*this); }
+
+private:
+    MappedFile mapping;
+    std::uint16_t fileFormat = 0;
+    std::uint16_t timeDivision = 0;
+    std::vector<std::span<const std::uint8_t>> tracks;
+};
+
+}  // namespace midi
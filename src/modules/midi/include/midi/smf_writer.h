@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace midi
+{
+/// @brief Writes timestamped raw messages, as they were received, to a format 0 Standard MIDI
+/// File. The tempo is fixed so that a tick is 0.1 ms.
+class SmfWriter
+{
+public:
+    static constexpr std::uint16_t DIVISION = 1000;  ///< ticks per quarter note
+    static constexpr std::uint32_t TEMPO = 100'000;  ///< µs per quarter note
+    static constexpr std::int64_t NS_PER_TICK = 1000LL * TEMPO / DIVISION;
+
+    SmfWriter() = default;
+    SmfWriter(SmfWriter const&) = delete;
+    SmfWriter& operator=(SmfWriter const&) = delete;
+    ~SmfWriter() { close(); }
+
+    bool open(std::string const& path);
+
+    /// @brief Append a message. The first message written is at tick 0, later ones relative to
+    /// it; timestamps are in ns. A change of port is marked with a MIDI port meta event. System
+    /// common and realtime messages are not allowed in a file and are skipped.
+    void write(std::int64_t timestamp, std::uint8_t port, std::span<const std::uint8_t> bytes);
+
+    /// @brief End the track and fill in its length.
+    void close();
+
+    bool is_open() const { return file.is_open(); }
+    std::uint64_t size() const { return fileSize; }
+
+private:
+    void write_event(std::uint64_t tick, std::span<const std::uint8_t> bytes);
+
+    std::ofstream file;
+    std::optional<std::int64_t> origin;
+    std::uint64_t lastTick = 0;
+    int lastPort = -1;
+    std::uint64_t fileSize = 0;
+};
+
+}  // namespace midi
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace midi
+{
+class File;
+
+/// @brief Piecewise linear mapping between ticks and seconds, one segment per tempo change.
+class TempoMap
+{
+public:
+    static constexpr std::uint32_t DEFAULT_TEMPO = 500'000;  ///< µs per quarter note, 120 bpm
+
+    struct Segment
+    {
+        std::uint64_t tick;
+        double seconds;         ///< time at tick
+        double secondsPerTick;  ///< until the next segment
+    };
+
+    /// @brief Start over for a file with the given division (see File::division).
+    void reset(std::uint16_t division);
+
+    /// @brief Add a tempo change. Ticks must not decrease. Ignored for SMPTE divisions.
+    void add(std::uint64_t tick, std::uint32_t microsPerQuarter);
+
+    /// @brief Scan every track of a file for tempo events.
+    void build(File const& file);
+
+    /// @brief Replace the map with segments saved from segments(), e.g. from a cache file.
+    bool restore(std::uint16_t division, std::span<const Segment> segments);
+
+    double seconds(std::uint64_t tick) const;
+    /// @brief The first tick at or after the given time.
+    std::uint64_t tick(double seconds) const;
+
+    std::span<const Segment> segments() const { return segmentList; }
+
+private:
+    std::uint16_t ticksPerQuarter = 0;  ///< 0 for SMPTE timing
+    std::vector<Segment> segmentList;
+};
+
+}  // namespace midi
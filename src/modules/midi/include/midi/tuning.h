@@ -0,0 +1,63 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace midi
+{
+constexpr std::uint16_t PITCH_BEND_CENTER = 8192;
+constexpr int DEFAULT_BEND_RANGE = 2;  ///< semitones at full deflection, the General MIDI default
+constexpr int MAX_BEND_RANGE = 24;
+constexpr int PITCH_STEPS = 64;  ///< table resolution per semitone, about 1.6 cents
+
+namespace detail
+{
+constexpr double SEMITONE_RATIO = 1.0594630943592953;  // 2^(1/12)
+constexpr double STEP_RATIO = 1.0009029427989777;      // 2^(1/768), 1/64 semitone
+
+// Equal tempered, A4 = 440 Hz, from MAX_BEND_RANGE below note 0 to MAX_BEND_RANGE above 127.
+constexpr std::size_t NUM_SEMITONES = 128 + 2 * MAX_BEND_RANGE;
+
+constexpr std::array<double, NUM_SEMITONES> make_semitones() {
+    std::array<double, NUM_SEMITONES> table{};
+    constexpr std::size_t A4 = 69 + MAX_BEND_RANGE;
+    table[A4] = 440.0;
+    for (std::size_t i = A4 + 1; i < NUM_SEMITONES; ++i) {
+        table[i] = table[i - 1] * SEMITONE_RATIO;
+    }
+    for (std::size_t i = A4; i-- > 0;) {
+        table[i] = table[i + 1] / SEMITONE_RATIO;
+    }
+    return table;
+}
+
+constexpr std::array<double, PITCH_STEPS> make_steps() {
+    std::array<double, PITCH_STEPS> table{};
+    table[0] = 1.0;
+    for (std::size_t i = 1; i < table.size(); ++i) {
+        table[i] = table[i - 1] * STEP_RATIO;
+    }
+    return table;
+}
+
+inline constexpr std::array<double, NUM_SEMITONES> SEMITONES = make_semitones();
+inline constexpr std::array<double, PITCH_STEPS> STEPS = make_steps();
+}  // namespace detail
+
+/// @brief Frequency in Hz of a note under a pitch bend, looked up in tables built at compile time.
+/// @param bend 14 bit pitch wheel position, PITCH_BEND_CENTER for none
+/// @param range semitones at full deflection, clamped to [0, MAX_BEND_RANGE]
+constexpr double frequency(
+    std::uint8_t note,
+    std::uint16_t bend = PITCH_BEND_CENTER,
+    int range = DEFAULT_BEND_RANGE
+) {
+    range = std::clamp(range, 0, MAX_BEND_RANGE);
+    int offset = (int(bend & 0x3FFF) - PITCH_BEND_CENTER) * range * PITCH_STEPS / 8192;
+    int pitch = ((note & 0x7F) + MAX_BEND_RANGE) * PITCH_STEPS + offset;
+    return detail::SEMITONES[pitch / PITCH_STEPS] * detail::STEPS[pitch % PITCH_STEPS];
+}
+
+}  // namespace midi
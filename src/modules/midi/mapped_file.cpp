@@ -0,0 +1,73 @@
+#include "midi/mapped_file.h"
+
+#include "logger/logger.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+midi::MappedFile::~MappedFile() {
+    close();
+}
+
+midi::MappedFile::MappedFile(MappedFile&& other) noexcept
+: data(std::exchange(other.data, nullptr))
+, size(std::exchange(other.size, 0)) {}
+
+midi::MappedFile& midi::MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        data = std::exchange(other.data, nullptr);
+        size = std::exchange(other.size, 0);
+    }
+    return *this;
+}
+
+bool midi::MappedFile::open(std::string const& path, Access access) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        logger::log("Could not open {}: {}", path, std::strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        logger::log("Could not map {}: empty or unreadable", path);
+        ::close(fd);
+        return false;
+    }
+    void* mapping = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // the mapping keeps the file alive
+    if (mapping == MAP_FAILED) {
+        logger::log("Could not map {}: {}", path, std::strerror(errno));
+        return false;
+    }
+    ::madvise(mapping, st.st_size, access == Access::RANDOM ? MADV_RANDOM : MADV_SEQUENTIAL);
+    data = static_cast<const std::uint8_t*>(mapping);
+    size = static_cast<std::size_t>(st.st_size);
+    return true;
+}
+
+void midi::MappedFile::prefetch(std::span<const std::uint8_t> range) const {
+    if (range.empty()) {
+        return;
+    }
+    // madvise wants page-aligned addresses.
+    auto const pageSize = static_cast<std::uintptr_t>(::sysconf(_SC_PAGESIZE));
+    auto const begin = reinterpret_cast<std::uintptr_t>(range.data()) & ~(pageSize - 1);
+    auto const end = reinterpret_cast<std::uintptr_t>(range.data() + range.size());
+    ::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_WILLNEED);
+}
+
+void midi::MappedFile::close() {
+    if (data) {
+        ::munmap(const_cast<std::uint8_t*>(data), size);
+        data = nullptr;
+        size = 0;
+    }
+}
@@ -0,0 +1,238 @@
+#include "midi/seek_index.h"
+
+#include "logger/logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <type_traits>
+
+namespace
+{
+// Sidecar layout: IndexHeader, then the tempo segments, snapshots and track positions as they
+// are in memory. It is a cache for this machine, not an interchange format.
+constexpr char INDEX_MAGIC[8] = {'M', 'T', 'S', 'E', 'E', 'K', '0', '1'};
+
+struct IndexHeader
+{
+    char magic[8];
+    std::uint64_t sourceSize;
+    std::int64_t sourceTime;
+    std::uint32_t numTracks;
+    std::uint32_t numSegments;
+    std::uint32_t numSnapshots;
+    std::uint16_t division;
+    std::uint16_t reserved;
+};
+
+/// @brief Size and modification time of the indexed file, to tell when the sidecar is stale.
+bool source_identity(std::string const& source, std::uint64_t& size, std::int64_t& time) {
+    std::error_code error;
+    size = std::filesystem::file_size(source, error);
+    if (error) {
+        return false;
+    }
+    time = std::filesystem::last_write_time(source, error).time_since_epoch().count();
+    return !error;
+}
+
+template <typename T>
+void write_array(std::ofstream& file, std::span<const T> items) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    file.write(reinterpret_cast<const char*>(items.data()), std::streamsize(items.size_bytes()));
+}
+
+template <typename T>
+bool read_array(std::span<const char>& bytes, std::vector<T>& items, std::size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (bytes.size() / sizeof(T) < count) {
+        return false;
+    }
+    items.resize(count);
+    std::memcpy(items.data(), bytes.data(), count * sizeof(T));
+    bytes = bytes.subspan(count * sizeof(T));
+    return true;
+}
+
+}  // namespace
+
+void midi::apply_event(ChannelStates& channels, Event const& event) {
+    if (event.kind != EventKind::CHANNEL) {
+        return;
+    }
+    ChannelState& channel = channels[event.channel()];
+    switch (event.command()) {
+        case 0x80:
+            channel.notes[event.data1] = 0;
+            break;
+        case 0x90:
+            channel.notes[event.data1] = event.data2;  // velocity 0 is a note off
+            break;
+        case 0xB0:
+            channel.controllers[event.data1] = event.data2;
+            if (event.data1 == 120 || event.data1 == 123) {  // all sound off, all notes off
+                channel.notes.fill(0);
+            } else if (event.data1 == 121) {  // reset all controllers
+                channel.controllers = default_controllers();
+                channel.pitchBend = 8192;
+                channel.pressure = 0;
+            }
+            break;
+        case 0xC0:
+            channel.program = event.data1;
+            break;
+        case 0xD0:
+            channel.pressure = event.data1;
+            break;
+        case 0xE0:
+            channel.pitchBend = std::uint16_t(event.data1 | event.data2 << 7);
+            break;
+        default:
+            break;
+    }
+}
+
+void midi::SeekIndex::take_snapshot(
+    std::uint64_t tick,
+    EventReader const& reader,
+    ChannelStates const& state
+) {
+    snapshots.push_back({.tick = tick, .channels = state});
+    positions.resize(positions.size() + numTracks);
+    reader.save(std::span(positions).last(numTracks));
+}
+
+void midi::SeekIndex::build(File const& file, double interval) {
+    tempoMap.reset(file.division());
+    division = file.division();
+    numTracks = file.num_tracks();
+    snapshots.clear();
+    positions.clear();
+
+    EventReader reader = file.events();
+    ChannelStates state{};
+    take_snapshot(0, reader, state);
+
+    double nextSnapshot = interval;
+    std::uint64_t lastTick = 0;
+    std::uint64_t tick;
+    Event event;
+    while (reader.peek_tick(tick)) {
+        // Only snapshot between ticks, so a snapshot never holds part of a tick's events.
+        if (tick > lastTick && tempoMap.seconds(tick) >= nextSnapshot) {
+            take_snapshot(tick, reader, state);
+            nextSnapshot = tempoMap.seconds(tick) + interval;
+        }
+        if (!reader.next(event)) {
+            break;
+        }
+        if (event.kind == EventKind::META && event.metaType == META_TEMPO &&
+            event.payload.size() == 3) {
+            auto const& p = event.payload;
+            tempoMap.add(event.tick, std::uint32_t(p[0]) << 16 | std::uint32_t(p[1]) << 8 | p[2]);
+        }
+        apply_event(state, event);
+        lastTick = event.tick;
+    }
+}
+
+void midi::SeekIndex::load_or_build(File const& file, std::string const& source) {
+    std::string path = source + ".idx";
+    if (load(path, source, file)) {
+        return;
+    }
+    build(file);
+    save(path, source);
+}
+
+bool midi::SeekIndex::save(std::string const& path, std::string const& source) const {
+    IndexHeader header{};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    if (!source_identity(source, header.sourceSize, header.sourceTime)) {
+        logger::log("Could not stat {}", source);
+        return false;
+    }
+    auto segments = tempoMap.segments();
+    header.numTracks = std::uint32_t(numTracks);
+    header.numSegments = std::uint32_t(segments.size());
+    header.numSnapshots = std::uint32_t(snapshots.size());
+    header.division = division;
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        logger::log("Could not write index {}", path);
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_array(file, segments);
+    write_array(file, std::span<const Snapshot>(snapshots));
+    write_array(file, std::span<const TrackPosition>(positions));
+    return file.good();
+}
+
+bool midi::SeekIndex::load(std::string const& path, std::string const& source, File const& file) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::vector<char> data{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    std::span<const char> bytes(data);
+
+    IndexHeader header;
+    if (bytes.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    bytes = bytes.subspan(sizeof(header));
+
+    std::uint64_t size;
+    std::int64_t time;
+    if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 ||
+        !source_identity(source, size, time) || header.sourceSize != size ||
+        header.sourceTime != time || header.numTracks != file.num_tracks() ||
+        header.division != file.division() || header.numSnapshots == 0) {
+        logger::log("Index {} is stale, rebuilding", path);
+        return false;
+    }
+
+    std::vector<TempoMap::Segment> segments;
+    if (!read_array(bytes, segments, header.numSegments) ||
+        !read_array(bytes, snapshots, header.numSnapshots) ||
+        !read_array(bytes, positions, std::size_t(header.numSnapshots) * header.numTracks) ||
+        !tempoMap.restore(file.division(), segments)) {
+        logger::log("Index {} is truncated, rebuilding", path);
+        snapshots.clear();
+        positions.clear();
+        return false;
+    }
+    division = header.division;
+    numTracks = header.numTracks;
+    return true;
+}
+
+void midi::SeekIndex::seek(std::uint64_t tick, EventReader& reader, ChannelStates& channels) const {
+    auto it = std::upper_bound(
+        snapshots.begin(),
+        snapshots.end(),
+        tick,
+        [](std::uint64_t t, Snapshot const& snapshot) { return t < snapshot.tick; }
+    );
+    if (it == snapshots.begin()) {  // not built: start from the top
+        reader.rewind();
+        channels = ChannelStates{};
+    } else {
+        --it;
+        std::size_t index = std::size_t(it - snapshots.begin());
+        channels = it->channels;
+        reader.restore(std::span(positions).subspan(index * numTracks, numTracks));
+    }
+
+    std::uint64_t next;
+    Event event;
+    while (reader.peek_tick(next) && next < tick && reader.next(event)) {
+        apply_event(channels, event);
+    }
+}
@@ -0,0 +1,308 @@
+#include "midi/smf.h"
+
+#include "logger/logger.h"
+#include "midi/decoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+std::uint32_t read_be32(const std::uint8_t* p) {
+    return std::uint32_t(p[0]) << 24 | std::uint32_t(p[1]) << 16 | std::uint32_t(p[2]) << 8 | p[3];
+}
+
+std::uint16_t read_be16(const std::uint8_t* p) {
+    return std::uint16_t(p[0] << 8 | p[1]);
+}
+
+constexpr std::size_t CHUNK_HEADER_SIZE = 8;
+
+}  // namespace
+
+bool midi::read_vlq(const std::uint8_t*& pos, const std::uint8_t* end, std::uint32_t& value) {
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (pos == end) {
+            return false;
+        }
+        std::uint8_t byte = *pos++;
+        value = value << 7 | (byte & 0x7F);
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+midi::TrackCursor::TrackCursor(std::span<const std::uint8_t> chunk, std::uint16_t track)
+: begin(chunk.data())
+, pos(chunk.data())
+, end(chunk.data() + chunk.size())
+, track(track)
+, finished(false) {
+    read_delta();
+}
+
+midi::TrackCursor::TrackCursor(
+    std::span<const std::uint8_t> chunk,
+    std::uint16_t track,
+    TrackPosition position
+)
+: begin(chunk.data())
+, pos(chunk.data() + std::min<std::size_t>(position.offset, chunk.size()))
+, end(chunk.data() + chunk.size())
+, nextTick(position.tick)
+, track(track)
+, runningStatus(position.runningStatus)
+, finished(position.finished) {}
+
+midi::TrackPosition midi::TrackCursor::position() const {
+    return {
+        .tick = nextTick,
+        .offset = std::uint32_t(pos - begin),
+        .runningStatus = runningStatus,
+        .finished = finished,
+    };
+}
+
+void midi::TrackCursor::read_delta() {
+    std::uint32_t delta;
+    if (pos == end || !read_vlq(pos, end, delta)) {
+        finished = true;
+        return;
+    }
+    nextTick += delta;
+}
+
+bool midi::TrackCursor::next(Event& event) {
+    if (finished) {
+        return false;
+    }
+    if (pos == end) {
+        finished = true;
+        return false;
+    }
+
+    event.tick = nextTick;
+    event.track = track;
+    event.payload = {};
+
+    std::uint8_t status = *pos;
+    if (status & 0x80) {
+        ++pos;
+    } else if (runningStatus) {
+        status = runningStatus;
+    } else {
+        finished = true;  // data byte without a running status
+        return false;
+    }
+
+    if (status == 0xFF) {
+        std::uint32_t length;
+        if (pos == end) {
+            finished = true;
+            return false;
+        }
+        event.metaType = *pos++;
+        if (!read_vlq(pos, end, length) || length > std::size_t(end - pos)) {
+            finished = true;
+            return false;
+        }
+        event.kind = EventKind::META;
+        event.status = status;
+        event.data1 = event.data2 = 0;
+        event.payload = {pos, length};
+        pos += length;
+        // The spec says meta and sysex events cancel running status, but files in the wild
+        // rely on it surviving them, so it is left alone; a valid file never notices.
+        if (event.metaType == META_END_OF_TRACK) {
+            finished = true;
+            return false;
+        }
+    } else if (status == 0xF0 || status == 0xF7) {
+        std::uint32_t length;
+        if (!read_vlq(pos, end, length) || length > std::size_t(end - pos)) {
+            finished = true;
+            return false;
+        }
+        event.kind = EventKind::SYSEX;
+        event.status = status;
+        event.metaType = 0;
+        event.data1 = event.data2 = 0;
+        event.payload = {pos, length};
+        pos += length;
+    } else if (status < 0xF0) {
+        int length = STATUS_TABLE[status].length;
+        if (end - pos < length) {
+            finished = true;
+            return false;
+        }
+        event.kind = EventKind::CHANNEL;
+        event.status = status;
+        event.metaType = 0;
+        event.data1 = pos[0] & 0x7F;
+        event.data2 = length == 2 ? pos[1] & 0x7F : 0;
+        pos += length;
+        runningStatus = status;
+    } else {
+        finished = true;  // system common/realtime messages are not valid in a file
+        return false;
+    }
+
+    read_delta();
+    return true;
+}
+
+midi::EventReader::EventReader(File const& file)
+: file(file) {
+    cursors.reserve(file.num_tracks());
+    heap.reserve(file.num_tracks());
+    rewind();
+}
+
+void midi::EventReader::rewind() {
+    cursors.clear();
+    for (std::size_t i = 0; i < file.num_tracks(); ++i) {
+        cursors.emplace_back(file.track(i), std::uint16_t(i));
+    }
+    build_heap();
+}
+
+bool midi::EventReader::peek_tick(std::uint64_t& tick) const {
+    if (heap.empty()) {
+        return false;
+    }
+    tick = cursors[heap.front()].tick();
+    return true;
+}
+
+void midi::EventReader::save(std::span<TrackPosition> positions) const {
+    for (std::size_t i = 0; i < cursors.size() && i < positions.size(); ++i) {
+        positions[i] = cursors[i].position();
+    }
+}
+
+void midi::EventReader::restore(std::span<const TrackPosition> positions) {
+    cursors.clear();
+    for (std::size_t i = 0; i < file.num_tracks(); ++i) {
+        cursors.emplace_back(
+            file.track(i),
+            std::uint16_t(i),
+            i < positions.size() ? positions[i] : TrackPosition{}
+        );
+    }
+    build_heap();
+}
+
+void midi::EventReader::build_heap() {
+    heap.clear();
+    for (std::size_t i = 0; i < cursors.size(); ++i) {
+        if (!cursors[i].done()) {
+            heap.push_back(std::uint16_t(i));
+        }
+    }
+    for (std::size_t i = heap.size() / 2; i-- > 0;) {
+        sift_down(i);
+    }
+}
+
+bool midi::EventReader::before(std::uint16_t a, std::uint16_t b) const {
+    std::uint64_t tickA = cursors[a].tick();
+    std::uint64_t tickB = cursors[b].tick();
+    return tickA < tickB || (tickA == tickB && a < b);
+}
+
+void midi::EventReader::sift_down(std::size_t index) {
+    std::size_t size = heap.size();
+    for (;;) {
+        std::size_t smallest = index;
+        std::size_t left = 2 * index + 1;
+        std::size_t right = left + 1;
+        if (left < size && before(heap[left], heap[smallest])) {
+            smallest = left;
+        }
+        if (right < size && before(heap[right], heap[smallest])) {
+            smallest = right;
+        }
+        if (smallest == index) {
+            return;
+        }
+        std::swap(heap[index], heap[smallest]);
+        index = smallest;
+    }
+}
+
+bool midi::EventReader::next(Event& event) {
+    while (!heap.empty()) {
+        TrackCursor& cursor = cursors[heap.front()];
+        bool decoded = cursor.next(event);
+        if (cursor.done()) {
+            heap.front() = heap.back();
+            heap.pop_back();
+        }
+        if (!heap.empty()) {
+            sift_down(0);
+        }
+        if (decoded) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool midi::File::open(std::string const& path) {
+    if (!mapping.open(path)) {
+        return false;
+    }
+    if (!parse(mapping.bytes())) {
+        logger::log("{} is not a Standard MIDI File", path);
+        mapping.close();
+        return false;
+    }
+    return true;
+}
+
+bool midi::File::parse(std::span<const std::uint8_t> bytes) {
+    tracks.clear();
+    const std::uint8_t* pos = bytes.data();
+    const std::uint8_t* end = pos + bytes.size();
+
+    if (bytes.size() < CHUNK_HEADER_SIZE + 6 || std::memcmp(pos, "MThd", 4) != 0) {
+        logger::log("Missing MThd header");
+        return false;
+    }
+    std::uint32_t headerLength = read_be32(pos + 4);
+    if (headerLength < 6 || headerLength > bytes.size() - CHUNK_HEADER_SIZE) {
+        logger::log("Bad MThd length {}", headerLength);
+        return false;
+    }
+    fileFormat = read_be16(pos + 8);
+    std::uint16_t declaredTracks = read_be16(pos + 10);
+    timeDivision = read_be16(pos + 12);
+    pos += CHUNK_HEADER_SIZE + headerLength;
+
+    if (fileFormat > 2) {
+        logger::log("Unsupported SMF format {}", fileFormat);
+        return false;
+    }
+
+    tracks.reserve(declaredTracks);
+    while (std::size_t(end - pos) >= CHUNK_HEADER_SIZE && tracks.size() < declaredTracks) {
+        std::uint32_t length = read_be32(pos + 4);
+        bool isTrack = std::memcmp(pos, "MTrk", 4) == 0;
+        pos += CHUNK_HEADER_SIZE;
+        if (length > std::size_t(end - pos)) {
+            logger::log("Chunk {} is truncated, keeping what is there", tracks.size());
+            length = std::uint32_t(end - pos);
+        }
+        if (isTrack) {
+            tracks.emplace_back(pos, length);
+        }  // unknown chunks are skipped, as the spec requires
+        pos += length;
+    }
+    if (tracks.size() != declaredTracks) {
+        logger::log("Header declares {} tracks, found {}", declaredTracks, tracks.size());
+    }
+    return true;
+}
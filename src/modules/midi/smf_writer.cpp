@@ -0,0 +1,121 @@
+#include "midi/smf_writer.h"
+
+#include "midi/decoder.h"
+#include "midi/smf.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+namespace
+{
+constexpr std::size_t HEADER_SIZE = 22;  // MThd chunk, then the MTrk chunk header
+constexpr std::size_t TRACK_LENGTH_OFFSET = 18;
+
+void append_be(std::vector<std::uint8_t>& out, std::uint32_t value, int size) {
+    for (int i = size - 1; i >= 0; --i) {
+        out.push_back(std::uint8_t(value >> (8 * i)));
+    }
+}
+
+/// @brief Append a variable length quantity, most significant group first.
+void append_vlq(std::vector<std::uint8_t>& out, std::uint32_t value) {
+    std::array<std::uint8_t, 5> groups;
+    int n = 0;
+    do {
+        groups[n++] = value & 0x7F;
+        value >>= 7;
+    } while (value);
+    while (n-- > 0) {
+        out.push_back(std::uint8_t(groups[n] | (n > 0 ? 0x80 : 0)));
+    }
+}
+}  // namespace
+
+bool midi::SmfWriter::open(std::string const& path) {
+    close();
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    origin.reset();
+    lastTick = 0;
+    lastPort = -1;
+
+    std::vector<std::uint8_t> header = {'M', 'T', 'h', 'd'};
+    append_be(header, 6, 4);
+    append_be(header, 0, 2);  // format 0
+    append_be(header, 1, 2);
+    append_be(header, DIVISION, 2);
+    header.insert(header.end(), {'M', 'T', 'r', 'k', 0, 0, 0, 0});  // length filled in by close()
+    file.write(reinterpret_cast<const char*>(header.data()), std::streamsize(header.size()));
+    fileSize = header.size();
+
+    std::vector<std::uint8_t> tempo = {0xFF, META_TEMPO, 3};
+    append_be(tempo, TEMPO, 3);
+    write_event(0, tempo);
+    return file.good();
+}
+
+void midi::SmfWriter::write(
+    std::int64_t timestamp,
+    std::uint8_t port,
+    std::span<const std::uint8_t> bytes
+) {
+    if (!file.is_open() || bytes.empty()) {
+        return;
+    }
+    StatusInfo const info = STATUS_TABLE[bytes[0]];
+    bool const channel =
+        info.type >= MessageType::NOTE_OFF && info.type <= MessageType::PITCH_BEND;
+    if (!channel && info.type != MessageType::SYSEX) {
+        return;
+    }
+    if (channel && bytes.size() != 1u + info.length) {
+        return;
+    }
+
+    if (!origin) {
+        origin = timestamp;
+    }
+    std::uint64_t tick = timestamp > *origin ? std::uint64_t(timestamp - *origin) / NS_PER_TICK : 0;
+    tick = std::max(tick, lastTick);
+
+    if (port != lastPort) {
+        const std::uint8_t portMeta[] = {0xFF, 0x21, 1, port};
+        write_event(tick, portMeta);
+        lastPort = port;
+    }
+    if (channel) {
+        write_event(tick, bytes);
+        return;
+    }
+    // Sysex: F0, the length, then the rest of the message including its F7.
+    std::vector<std::uint8_t> sysex = {0xF0};
+    append_vlq(sysex, std::uint32_t(bytes.size() - 1));
+    sysex.insert(sysex.end(), bytes.begin() + 1, bytes.end());
+    write_event(tick, sysex);
+}
+
+void midi::SmfWriter::write_event(std::uint64_t tick, std::span<const std::uint8_t> bytes) {
+    std::vector<std::uint8_t> delta;
+    append_vlq(delta, std::uint32_t(std::min<std::uint64_t>(tick - lastTick, 0x0FFF'FFFF)));
+    file.write(reinterpret_cast<const char*>(delta.data()), std::streamsize(delta.size()));
+    file.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+    fileSize += delta.size() + bytes.size();
+    lastTick = tick;
+}
+
+void midi::SmfWriter::close() {
+    if (!file.is_open()) {
+        return;
+    }
+    const std::uint8_t endOfTrack[] = {0xFF, META_END_OF_TRACK, 0};
+    write_event(lastTick, endOfTrack);
+
+    std::vector<std::uint8_t> length;
+    append_be(length, std::uint32_t(fileSize - HEADER_SIZE), 4);
+    file.seekp(TRACK_LENGTH_OFFSET);
+    file.write(reinterpret_cast<const char*>(length.data()), std::streamsize(length.size()));
+    file.close();
+}
@@ -0,0 +1,92 @@
+#include "midi/tempo_map.h"
+
+#include "midi/smf.h"
+
+#include <algorithm>
+#include <cmath>
+
+void midi::TempoMap::reset(std::uint16_t division) {
+    segmentList.clear();
+    double secondsPerTick;
+    if (division & 0x8000) {
+        // SMPTE: the high byte is minus the frame rate (-29 meaning 29.97), the low byte ticks
+        // per frame. Tempo events do not change the timing.
+        int fps = -static_cast<std::int8_t>(division >> 8);
+        double frameRate = fps == 29 ? 30'000.0 / 1001.0 : fps;
+        int ticksPerFrame = std::max(division & 0xFF, 1);
+        ticksPerQuarter = 0;
+        secondsPerTick = 1.0 / (frameRate * ticksPerFrame);
+    } else {
+        ticksPerQuarter = std::max<std::uint16_t>(division, 1);
+        secondsPerTick = DEFAULT_TEMPO * 1e-6 / ticksPerQuarter;
+    }
+    segmentList.push_back({.tick = 0, .seconds = 0.0, .secondsPerTick = secondsPerTick});
+}
+
+void midi::TempoMap::add(std::uint64_t tick, std::uint32_t microsPerQuarter) {
+    if (ticksPerQuarter == 0 || microsPerQuarter == 0) {
+        return;
+    }
+    double secondsPerTick = microsPerQuarter * 1e-6 / ticksPerQuarter;
+    Segment& last = segmentList.back();
+    if (tick <= last.tick) {
+        last.secondsPerTick = secondsPerTick;  // several changes on one tick: the last one wins
+        return;
+    }
+    if (secondsPerTick == last.secondsPerTick) {
+        return;
+    }
+    segmentList.push_back(
+        {.tick = tick, .seconds = seconds(tick), .secondsPerTick = secondsPerTick}
+    );
+}
+
+void midi::TempoMap::build(File const& file) {
+    reset(file.division());
+    for (Event const& event : file.events()) {
+        if (event.kind == EventKind::META && event.metaType == META_TEMPO &&
+            event.payload.size() == 3) {
+            auto const& p = event.payload;
+            add(event.tick, std::uint32_t(p[0]) << 16 | std::uint32_t(p[1]) << 8 | p[2]);
+        }
+    }
+}
+
+bool midi::TempoMap::restore(std::uint16_t division, std::span<const Segment> segments) {
+    if (segments.empty() || segments.front().tick != 0) {
+        return false;
+    }
+    reset(division);
+    segmentList.assign(segments.begin(), segments.end());
+    return true;
+}
+
+double midi::TempoMap::seconds(std::uint64_t tick) const {
+    if (segmentList.empty()) {
+        return 0.0;
+    }
+    auto it = std::upper_bound(
+        segmentList.begin(),
+        segmentList.end(),
+        tick,
+        [](std::uint64_t t, Segment const& segment) { return t < segment.tick; }
+    );
+    Segment const& segment = *(it - 1);
+    return segment.seconds + double(tick - segment.tick) * segment.secondsPerTick;
+}
+
+std::uint64_t midi::TempoMap::tick(double seconds) const {
+    if (segmentList.empty() || seconds <= 0.0) {
+        return 0;
+    }
+    auto it = std::upper_bound(
+        segmentList.begin(),
+        segmentList.end(),
+        seconds,
+        [](double s, Segment const& segment) { return s < segment.seconds; }
+    );
+    Segment const& segment = *(it - 1);
+    // Round away the error of the division so a tick's own time maps back to it.
+    double ticks = (seconds - segment.seconds) / segment.secondsPerTick;
+    return segment.tick + std::uint64_t(std::ceil(ticks - 1e-6));
+}
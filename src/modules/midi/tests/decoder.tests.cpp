@@ -0,0 +1,172 @@
+#include "midi/decoder.h"
+
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+struct Message
+{
+    midi::MessageType type;
+    int channel;
+    int data1;
+    int data2;
+
+    bool operator==(Message const&) const = default;
+};
+
+/// @brief Records every message, with all the optional handler members present.
+struct Recorder
+{
+    void note_on(std::uint8_t ch, std::uint8_t note, std::uint8_t velocity) {
+        messages.push_back({midi::MessageType::NOTE_ON, ch, note, velocity});
+    }
+    void note_off(std::uint8_t ch, std::uint8_t note, std::uint8_t velocity) {
+        messages.push_back({midi::MessageType::NOTE_OFF, ch, note, velocity});
+    }
+    void poly_pressure(std::uint8_t ch, std::uint8_t note, std::uint8_t pressure) {
+        messages.push_back({midi::MessageType::POLY_PRESSURE, ch, note, pressure});
+    }
+    void control_change(std::uint8_t ch, std::uint8_t controller, std::uint8_t value) {
+        messages.push_back({midi::MessageType::CONTROL_CHANGE, ch, controller, value});
+    }
+    void program_change(std::uint8_t ch, std::uint8_t program) {
+        messages.push_back({midi::MessageType::PROGRAM_CHANGE, ch, program, 0});
+    }
+    void channel_pressure(std::uint8_t ch, std::uint8_t pressure) {
+        messages.push_back({midi::MessageType::CHANNEL_PRESSURE, ch, pressure, 0});
+    }
+    void pitch_bend(std::uint8_t ch, std::uint16_t value) {
+        messages.push_back({midi::MessageType::PITCH_BEND, ch, value, 0});
+    }
+    void sysex(std::span<const std::uint8_t> data) {
+        messages.push_back({midi::MessageType::SYSEX, -1, int(data.size()), data[0]});
+    }
+    void system_common(std::uint8_t status, std::uint8_t d1, std::uint8_t d2) {
+        messages.push_back({midi::MessageType::SYSTEM_COMMON, status, d1, d2});
+    }
+    void realtime(std::uint8_t status) {
+        messages.push_back({midi::MessageType::REALTIME, status, 0, 0});
+    }
+
+    std::vector<Message> messages;
+};
+
+/// @brief Only cares about notes; everything else must compile away.
+struct NotesOnly
+{
+    void note_on(std::uint8_t, std::uint8_t, std::uint8_t) { ++notes; }
+    int notes = 0;
+};
+
+std::vector<Message> decode(std::vector<std::uint8_t> const& bytes) {
+    Recorder recorder;
+    midi::Decoder decoder(recorder);
+    decoder.decode(bytes);
+    return recorder.messages;
+}
+}  // namespace
+
+TEST_CASE("status table lengths") {
+    CHECK(midi::STATUS_TABLE[0x00].type == midi::MessageType::DATA);
+    CHECK(midi::STATUS_TABLE[0x7F].type == midi::MessageType::DATA);
+    CHECK(midi::STATUS_TABLE[0x9F].type == midi::MessageType::NOTE_ON);
+    CHECK(midi::STATUS_TABLE[0x9F].length == 2);
+    CHECK(midi::STATUS_TABLE[0xC3].length == 1);
+    CHECK(midi::STATUS_TABLE[0xD0].length == 1);
+    CHECK(midi::STATUS_TABLE[0xEF].type == midi::MessageType::PITCH_BEND);
+    CHECK(midi::STATUS_TABLE[0xF2].length == 2);
+    CHECK(midi::STATUS_TABLE[0xF8].type == midi::MessageType::REALTIME);
+    static_assert(midi::STATUS_TABLE[0xB5].type == midi::MessageType::CONTROL_CHANGE);
+}
+
+TEST_CASE("channel messages are decoded with their channel") {
+    using enum midi::MessageType;
+    // clang-format off
+    CHECK(
+        decode({
+            0x93, 60, 100,     // note on, channel 3
+            0x83, 60, 64,      // note off
+            0x9F, 61, 0,       // note on with velocity 0
+            0xA1, 62, 30,      // poly pressure
+            0xB2, 1, 127,      // mod wheel
+            0xC4, 5,           // program change
+            0xD5, 90,          // channel pressure
+            0xE6, 0x00, 0x40,  // pitch bend, centered
+            0xE6, 0x7F, 0x7F,  // pitch bend, full up
+        }) ==
+        std::vector<Message>{
+            {NOTE_ON, 3, 60, 100},
+            {NOTE_OFF, 3, 60, 64},
+            {NOTE_OFF, 15, 61, 0},
+            {POLY_PRESSURE, 1, 62, 30},
+            {CONTROL_CHANGE, 2, 1, 127},
+            {PROGRAM_CHANGE, 4, 5, 0},
+            {CHANNEL_PRESSURE, 5, 90, 0},
+            {PITCH_BEND, 6, 8192, 0},
+            {PITCH_BEND, 6, 16383, 0},
+        }
+    );
+    // clang-format on
+}
+
+TEST_CASE("running status survives realtime bytes and split calls") {
+    using enum midi::MessageType;
+    Recorder recorder;
+    midi::Decoder decoder(recorder);
+
+    const std::uint8_t first[] = {0xB0, 1, 10, 1, 0xF8, 20, 1};
+    const std::uint8_t second[] = {30, 0xC1, 7, 8};
+    decoder.decode(first);
+    decoder.decode(second);
+    CHECK(
+        recorder.messages ==
+        std::vector<Message>{
+            {CONTROL_CHANGE, 0, 1, 10},
+            {REALTIME, 0xF8, 0, 0},
+            {CONTROL_CHANGE, 0, 1, 20},
+            {CONTROL_CHANGE, 0, 1, 30},
+            {PROGRAM_CHANGE, 1, 7, 0},
+            {PROGRAM_CHANGE, 1, 8, 0},
+        }
+    );
+
+    recorder.messages.clear();
+    decoder.reset();
+    const std::uint8_t orphan[] = {60, 100};
+    decoder.decode(orphan);
+    CHECK(recorder.messages.empty());
+}
+
+TEST_CASE("sysex and system common messages cancel running status") {
+    using enum midi::MessageType;
+    // clang-format off
+    CHECK(
+        decode({
+            0x90, 60, 100,                 // note on
+            0xF0, 0x7E, 0x7F, 0x09, 0xF7,  // sysex
+            60, 0,                         // no running status any more
+            0xF2, 0x10, 0x20,              // song position
+            0x10, 0x20,                    // no running status either
+            0xF0, 0x43, 0x10,              // sysex cut short: dropped
+        }) ==
+        std::vector<Message>{
+            {NOTE_ON, 0, 60, 100},
+            {SYSEX, -1, 3, 0x7E},
+            {SYSTEM_COMMON, 0xF2, 0x10, 0x20},
+        }
+    );
+    // clang-format on
+}
+
+TEST_CASE("handlers only implement what they need") {
+    NotesOnly handler;
+    midi::Decoder decoder(handler);
+    const std::uint8_t bytes[] = {
+        0x90, 60, 100, 0xB0, 1, 2, 0xE0, 0, 64, 0xF0, 1, 0xF7, 0x91, 1, 1,
+    };
+    decoder.decode(bytes);
+    CHECK(handler.notes == 2);
+}
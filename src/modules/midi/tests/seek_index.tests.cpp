@@ -0,0 +1,146 @@
+#include "midi/seek_index.h"
+#include "midi/smf.h"
+#include "smf_builder.h"
+
+#include <doctest/doctest.h>
+
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+constexpr int STEP = 24;  // ticks between events, 0.125 s at 96 ticks per quarter and 120 bpm
+
+/// @brief A melody on channel 0 holding one note at a time and moving CC 7 along, a bass on
+/// channel 1, and a tempo change half way.
+Bytes test_file() {
+    Bytes melody;
+    Bytes bass;
+    for (int i = 0; i < 200; ++i) {
+        std::uint8_t note = std::uint8_t(40 + i % 50);
+        melody.insert(melody.end(), {STEP, 0x90, note, std::uint8_t(1 + i % 127)});
+        melody.insert(melody.end(), {0x00, 0x80, std::uint8_t(note - 1), 0});
+        melody.insert(melody.end(), {0x00, 0xB0, 7, std::uint8_t(i % 128)});
+        if (i == 100) {
+            melody.insert(melody.end(), {0x00, 0xFF, 0x51, 0x03, 0x03, 0xD0, 0x90});
+        }
+        if (i % 8 == 0) {
+            if (i == 0) {
+                bass.push_back(0x00);
+            } else {
+                bass.insert(bass.end(), {0x81, 0x40});  // 8 * STEP as a VLQ
+            }
+            bass.insert(bass.end(), {0xC1, std::uint8_t(i / 8)});
+        }
+    }
+    return smf(1, 96, {melody, bass});
+}
+
+/// @brief The reference: replay from the start up to tick.
+void replay(midi::File const& file, std::uint64_t tick, midi::ChannelStates& channels) {
+    channels = midi::ChannelStates{};
+    for (midi::Event const& event : file.events()) {
+        if (event.tick >= tick) {
+            break;
+        }
+        midi::apply_event(channels, event);
+    }
+}
+
+void check_seeks(midi::File const& file, midi::SeekIndex const& index) {
+    midi::EventReader reader = file.events();
+    for (std::uint64_t tick : {0, 1, 23, 24, 25, 500, 2400, 2401, 4799, 4800, 5000, 100'000}) {
+        midi::ChannelStates expected;
+        replay(file, tick, expected);
+        midi::ChannelStates channels;
+        index.seek(tick, reader, channels);
+        CHECK(channels == expected);
+
+        midi::Event event;
+        if (reader.next(event)) {
+            CHECK(event.tick >= tick);
+            CHECK(event.tick < tick + STEP + 8 * STEP);
+        } else {
+            CHECK(tick > 4800);
+        }
+    }
+}
+
+}  // namespace
+
+TEST_CASE("apply_event tracks notes, controllers, program and bend") {
+    midi::ChannelStates channels{};
+    auto channel = [](std::uint8_t status, std::uint8_t data1, std::uint8_t data2 = 0) {
+        midi::Event event;
+        event.status = status;
+        event.data1 = data1;
+        event.data2 = data2;
+        return event;
+    };
+    midi::apply_event(channels, channel(0x92, 60, 100));
+    midi::apply_event(channels, channel(0x92, 64, 90));
+    midi::apply_event(channels, channel(0x92, 64, 0));
+    midi::apply_event(channels, channel(0xC2, 5));
+    midi::apply_event(channels, channel(0xE2, 0x00, 0x50));
+    midi::apply_event(channels, channel(0xB2, 7, 30));
+    CHECK(channels[2].notes[60] == 100);
+    CHECK(channels[2].notes[64] == 0);
+    CHECK(channels[2].program == 5);
+    CHECK(channels[2].pitchBend == 0x50 << 7);
+    CHECK(channels[2].controllers[7] == 30);
+    CHECK(channels[0] == midi::ChannelState{});
+
+    midi::apply_event(channels, channel(0xB2, 123, 0));
+    CHECK(channels[2].notes[60] == 0);
+    midi::apply_event(channels, channel(0xB2, 121, 0));
+    CHECK(channels[2].controllers == midi::default_controllers());
+}
+
+TEST_CASE("Seeking restores the same state as replaying from the start") {
+    Bytes bytes = test_file();
+    midi::File file;
+    REQUIRE(file.parse(bytes));
+
+    midi::SeekIndex index;
+    index.build(file, 0.5);
+    CHECK(index.num_snapshots() > 10);
+    CHECK(index.tempo().segments().size() == 2);
+    check_seeks(file, index);
+
+    midi::SeekIndex coarse;
+    coarse.build(file, 1e9);  // only the snapshot at tick 0
+    CHECK(coarse.num_snapshots() == 1);
+    check_seeks(file, coarse);
+}
+
+TEST_CASE("The index round-trips through its sidecar file") {
+    auto path = std::filesystem::temp_directory_path() / "midi_seek_test.mid";
+    auto sidecar = path.string() + ".idx";
+    std::filesystem::remove(sidecar);
+    Bytes bytes = test_file();
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+    }
+    midi::File file;
+    REQUIRE(file.open(path.string()));
+
+    midi::SeekIndex built;
+    built.load_or_build(file, path.string());
+    REQUIRE(std::filesystem::exists(sidecar));
+
+    midi::SeekIndex loaded;
+    REQUIRE(loaded.load(sidecar, path.string(), file));
+    CHECK(loaded.num_snapshots() == built.num_snapshots());
+    CHECK(loaded.tempo().seconds(10'000) == built.tempo().seconds(10'000));
+    check_seeks(file, loaded);
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out.put(0);  // a different file now
+    }
+    CHECK_FALSE(loaded.load(sidecar, path.string(), file));
+
+    std::filesystem::remove(sidecar);
+    std::filesystem::remove(path);
+}
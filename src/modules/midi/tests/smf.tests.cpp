@@ -0,0 +1,227 @@
+#include "midi/smf.h"
+#include "smf_builder.h"
+
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <vector>
+
+namespace
+{
+thread_local bool countAllocations = false;
+thread_local int allocations = 0;
+
+std::vector<midi::Event> read_all(midi::File const& file) {
+    std::vector<midi::Event> events;
+    for (midi::Event const& event : file.events()) {
+        events.push_back(event);
+    }
+    return events;
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    if (countAllocations) {
+        ++allocations;
+    }
+    if (void* p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// noinline: keeps GCC from flagging free() on memory it saw come from operator new
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+TEST_CASE("read_vlq decodes 1 to 4 byte quantities") {
+    struct Case
+    {
+        Bytes bytes;
+        std::uint32_t value;
+    };
+    for (Case const& c : {
+             Case{{0x00}, 0},
+             Case{{0x7F}, 0x7F},
+             Case{{0x81, 0x00}, 0x80},
+             Case{{0xC0, 0x00}, 0x2000},
+             Case{{0xFF, 0xFF, 0x7F}, 0x1F'FFFF},
+             Case{{0xFF, 0xFF, 0xFF, 0x7F}, 0x0FFF'FFFF},
+         }) {
+        const std::uint8_t* pos = c.bytes.data();
+        std::uint32_t value;
+        CHECK(midi::read_vlq(pos, c.bytes.data() + c.bytes.size(), value));
+        CHECK(value == c.value);
+        CHECK(pos == c.bytes.data() + c.bytes.size());
+    }
+
+    Bytes tooLong = {0xFF, 0xFF, 0xFF, 0xFF, 0x7F};
+    const std::uint8_t* pos = tooLong.data();
+    std::uint32_t value;
+    CHECK_FALSE(midi::read_vlq(pos, tooLong.data() + tooLong.size(), value));
+
+    Bytes truncated = {0x81};
+    pos = truncated.data();
+    CHECK_FALSE(midi::read_vlq(pos, truncated.data() + truncated.size(), value));
+}
+
+TEST_CASE("Header fields are read and bad headers rejected") {
+    Bytes bytes = smf(1, 480, {{0x00, 0xFF, 0x2F, 0x00}, {0x00, 0xFF, 0x2F, 0x00}});
+    midi::File file;
+    REQUIRE(file.parse(bytes));
+    CHECK(file.format() == 1);
+    CHECK(file.division() == 480);
+    CHECK(file.num_tracks() == 2);
+    CHECK(read_all(file).empty());
+
+    Bytes notMidi = {'R', 'I', 'F', 'F', 0, 0, 0, 6, 0, 0, 0, 1, 0, 96};
+    CHECK_FALSE(file.parse(notMidi));
+
+    Bytes badFormat = smf(3, 96, {});
+    CHECK_FALSE(file.parse(badFormat));
+}
+
+TEST_CASE("Running status, meta and sysex events are decoded") {
+    // clang-format off
+    Bytes bytes = smf(0, 96, {{
+        0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20,  // tempo 500000
+        0x00, 0x90, 60, 100,                       // note on
+        0x10, 62, 101,                             // note on, running status
+        0x81, 0x00, 0xF0, 0x03, 0x7E, 0x7F, 0xF7,  // sysex at delta 128
+        0x00, 64, 0,                               // running status survives the sysex
+        0x05, 0xC3, 12,                            // program change, one data byte
+        0x00, 0xFF, 0x2F, 0x00,                    // end of track
+        0x00, 0x90, 70, 1,                         // after the end: ignored
+    }});
+    // clang-format on
+    midi::File file;
+    REQUIRE(file.parse(bytes));
+    std::vector<midi::Event> events = read_all(file);
+    REQUIRE(events.size() == 6);
+
+    CHECK(events[0].kind == midi::EventKind::META);
+    CHECK(events[0].metaType == midi::META_TEMPO);
+    REQUIRE(events[0].payload.size() == 3);
+    CHECK(events[0].payload[0] == 0x07);
+
+    CHECK(events[1].kind == midi::EventKind::CHANNEL);
+    CHECK(events[1].command() == 0x90);
+    CHECK(events[1].data1 == 60);
+    CHECK(events[1].data2 == 100);
+
+    CHECK(events[2].tick == 0x10);
+    CHECK(events[2].status == 0x90);
+    CHECK(events[2].data1 == 62);
+
+    CHECK(events[3].kind == midi::EventKind::SYSEX);
+    CHECK(events[3].tick == 0x10 + 128);
+    CHECK(events[3].payload.size() == 3);
+    CHECK(events[3].payload.data() > bytes.data());  // points into the file, no copy
+    CHECK(events[3].payload.data() < bytes.data() + bytes.size());
+
+    CHECK(events[4].status == 0x90);
+    CHECK(events[4].data1 == 64);
+    CHECK(events[4].data2 == 0);
+
+    CHECK(events[5].command() == 0xC0);
+    CHECK(events[5].channel() == 3);
+    CHECK(events[5].data1 == 12);
+    CHECK(events[5].tick == 0x10 + 128 + 5);
+}
+
+TEST_CASE("Tracks are merged in tick order, ties by track number") {
+    // clang-format off
+    Bytes bytes = smf(1, 96, {
+        {0x00, 0x90, 1, 1,  0x0A, 2, 1,  0x0A, 3, 1},           // ticks 0, 10, 20
+        {0x05, 0x91, 4, 1,  0x05, 5, 1,  0x0A, 6, 1},           // ticks 5, 10, 20
+        {},                                                     // empty track
+        {0x14, 0x92, 7, 1,  0x00, 0xFF, 0x2F, 0x00},            // tick 20
+    });
+    // clang-format on
+    midi::File file;
+    REQUIRE(file.parse(bytes));
+
+    std::vector<midi::Event> events = read_all(file);
+    std::vector<int> notes;
+    for (midi::Event const& event : events) {
+        notes.push_back(event.data1);
+    }
+    CHECK(notes == std::vector<int>{1, 4, 2, 5, 3, 6, 7});
+    for (std::size_t i = 1; i < events.size(); ++i) {
+        CHECK(events[i - 1].tick <= events[i].tick);
+    }
+
+    midi::EventReader reader = file.events();
+    midi::Event event;
+    REQUIRE(reader.next(event));
+    REQUIRE(reader.next(event));
+    reader.rewind();
+    REQUIRE(reader.next(event));
+    CHECK(event.data1 == 1);
+}
+
+TEST_CASE("Iterating and rewinding do not allocate") {
+    Bytes track;
+    for (int i = 0; i < 1000; ++i) {
+        track.insert(track.end(), {0x01, 0x90, std::uint8_t(i % 128), 100});
+    }
+    Bytes bytes = smf(1, 96, {track, track, track, track});
+    midi::File file;
+    REQUIRE(file.parse(bytes));
+    midi::EventReader reader = file.events();
+
+    allocations = 0;
+    countAllocations = true;
+    int count = 0;
+    for (int pass = 0; pass < 2; ++pass) {
+        reader.rewind();
+        for (midi::Event const& event : reader) {
+            count += event.data2 == 100;
+        }
+    }
+    countAllocations = false;
+    CHECK(allocations == 0);
+    CHECK(count == 8000);
+}
+
+TEST_CASE("Truncated data ends the track instead of reading past it") {
+    Bytes bytes = smf(0, 96, {{0x00, 0x90, 60, 100, 0x00, 0xFF, 0x01, 0x20, 'a'}});
+    midi::File file;
+    REQUIRE(file.parse(bytes));
+    std::vector<midi::Event> events = read_all(file);
+    REQUIRE(events.size() == 1);
+    CHECK(events[0].data1 == 60);
+
+    Bytes noStatus = smf(0, 96, {{0x00, 60, 100}});
+    REQUIRE(file.parse(noStatus));
+    CHECK(read_all(file).empty());
+}
+
+TEST_CASE("open maps a file from disk") {
+    Bytes bytes = smf(0, 480, {{0x00, 0x90, 60, 100, 0x60, 0x80, 60, 0}});
+    auto path = std::filesystem::temp_directory_path() / "midi_smf_test.mid";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(bytes.data()), std::streamsize(bytes.size()));
+    }
+
+    midi::File file;
+    REQUIRE(file.open(path.string()));
+    std::vector<midi::Event> events = read_all(file);
+    REQUIRE(events.size() == 2);
+    CHECK(events[1].tick == 0x60);
+    CHECK(events[1].command() == 0x80);
+
+    CHECK_FALSE(file.open((path.parent_path() / "does_not_exist.mid").string()));
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+using Bytes = std::vector<std::uint8_t>;
+
+inline void append_be(Bytes& out, std::uint32_t value, int size) {
+    for (int i = size - 1; i >= 0; --i) {
+        out.push_back(std::uint8_t(value >> (8 * i)));
+    }
+}
+
+/// @brief A Standard MIDI File with the given raw track chunks.
+inline Bytes smf(
+    std::uint16_t format,
+    std::uint16_t division,
+    std::initializer_list<Bytes> tracks
+) {
+    Bytes out = {'M', 'T', 'h', 'd'};
+    append_be(out, 6, 4);
+    append_be(out, format, 2);
+    append_be(out, std::uint32_t(tracks.size()), 2);
+    append_be(out, division, 2);
+    for (Bytes const& track : tracks) {
+        out.insert(out.end(), {'M', 'T', 'r', 'k'});
+        append_be(out, std::uint32_t(track.size()), 4);
+        out.insert(out.end(), track.begin(), track.end());
+    }
+    return out;
+}
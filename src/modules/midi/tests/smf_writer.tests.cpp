@@ -0,0 +1,107 @@
+#include "midi/smf.h"
+#include "midi/smf_writer.h"
+#include "midi/tempo_map.h"
+
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace
+{
+using Bytes = std::vector<std::uint8_t>;
+
+constexpr std::int64_t MS = 1'000'000;
+
+std::vector<midi::Event> read_all(midi::File const& file) {
+    std::vector<midi::Event> events;
+    for (midi::Event const& event : file.events()) {
+        events.push_back(event);
+    }
+    return events;
+}
+
+}  // namespace
+
+TEST_CASE("SmfWriter writes a file midi::File reads back") {
+    auto path = std::filesystem::temp_directory_path() / "midi_smf_writer_test.mid";
+    {
+        midi::SmfWriter writer;
+        REQUIRE(writer.open(path.string()));
+        // Timestamps start anywhere; the first message is tick 0.
+        writer.write(5000 * MS, 0, Bytes{0x90, 60, 100});
+        writer.write(5000 * MS + 250 * MS, 0, Bytes{0x80, 60, 0});
+        writer.write(5000 * MS + 300 * MS, 0, Bytes{0xF8});  // clock, skipped
+        writer.write(5000 * MS + 300 * MS, 0, Bytes{0x90, 60});  // truncated, skipped
+        writer.write(5000 * MS + 2000 * MS, 0, Bytes{0xE0, 0x00, 0x50});
+        writer.close();
+        CHECK_FALSE(writer.is_open());
+    }
+
+    midi::File file;
+    REQUIRE(file.open(path.string()));
+    CHECK(file.format() == 0);
+    CHECK(file.division() == midi::SmfWriter::DIVISION);
+
+    midi::TempoMap tempo;
+    tempo.build(file);
+
+    // close() filled in the track length, so the chunk ends with the end of track event.
+    REQUIRE(file.num_tracks() == 1);
+    std::span<const std::uint8_t> track = file.track(0);
+    CHECK(Bytes(track.end() - 3, track.end()) == Bytes{0xFF, midi::META_END_OF_TRACK, 0});
+
+    std::vector<midi::Event> channel;
+    for (midi::Event const& event : read_all(file)) {
+        if (event.kind == midi::EventKind::CHANNEL) {
+            channel.push_back(event);
+        }
+    }
+    REQUIRE(channel.size() == 3);
+    CHECK(channel[0].status == 0x90);
+    CHECK(tempo.seconds(channel[0].tick) == doctest::Approx(0.0));
+    CHECK(channel[1].status == 0x80);
+    CHECK(tempo.seconds(channel[1].tick) == doctest::Approx(0.25));
+    CHECK(channel[2].status == 0xE0);
+    CHECK(channel[2].data2 == 0x50);
+    CHECK(tempo.seconds(channel[2].tick) == doctest::Approx(2.0));
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("SmfWriter marks port changes and writes sysex with its length") {
+    auto path = std::filesystem::temp_directory_path() / "midi_smf_writer_sysex.mid";
+    {
+        midi::SmfWriter writer;
+        REQUIRE(writer.open(path.string()));
+        writer.write(0, 0, Bytes{0xB0, 7, 100});
+        writer.write(MS, 3, Bytes{0xF0, 0x7E, 0x7F, 0x09, 0x01, 0xF7});
+        writer.write(2 * MS, 3, Bytes{0xB0, 7, 90});
+    }  // closed by the destructor
+
+    midi::File file;
+    REQUIRE(file.open(path.string()));
+    std::vector<midi::Event> events = read_all(file);
+
+    std::vector<std::uint8_t> ports;
+    std::vector<midi::Event> sysex;
+    for (midi::Event const& event : events) {
+        if (event.kind == midi::EventKind::META && event.metaType == 0x21) {
+            REQUIRE(event.payload.size() == 1);
+            ports.push_back(event.payload[0]);
+        }
+        if (event.kind == midi::EventKind::SYSEX) {
+            sysex.push_back(event);
+        }
+    }
+    CHECK(ports == std::vector<std::uint8_t>{0, 3});
+    REQUIRE(sysex.size() == 1);
+    CHECK(sysex[0].status == 0xF0);
+    Bytes const payload(sysex[0].payload.begin(), sysex[0].payload.end());
+    CHECK(payload == Bytes{0x7E, 0x7F, 0x09, 0x01, 0xF7});
+    CHECK(sysex[0].tick == std::uint64_t(MS / midi::SmfWriter::NS_PER_TICK));
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,47 @@
+#include "midi/smf.h"
+#include "midi/tempo_map.h"
+#include "smf_builder.h"
+
+#include <doctest/doctest.h>
+
+TEST_CASE("Ticks map to seconds across tempo changes") {
+    midi::TempoMap tempo;
+    tempo.reset(480);
+    CHECK(tempo.seconds(960) == doctest::Approx(1.0));  // 120 bpm until told otherwise
+
+    tempo.add(960, 250'000);  // 240 bpm from 1 s on
+    tempo.add(960, 250'000);
+    CHECK(tempo.segments().size() == 2);
+    CHECK(tempo.seconds(480) == doctest::Approx(0.5));
+    CHECK(tempo.seconds(1920) == doctest::Approx(1.5));
+
+    for (std::uint64_t tick : {0, 1, 480, 959, 960, 961, 1920, 100'000}) {
+        CHECK(tempo.tick(tempo.seconds(tick)) == tick);
+    }
+    CHECK(tempo.tick(1.25) == 1440);
+    CHECK(tempo.tick(-1.0) == 0);
+}
+
+TEST_CASE("SMPTE divisions ignore tempo events") {
+    midi::TempoMap tempo;
+    tempo.reset(std::uint16_t(-25 << 8 | 40));  // 25 fps, 40 ticks per frame
+    tempo.add(100, 250'000);
+    CHECK(tempo.segments().size() == 1);
+    CHECK(tempo.seconds(1000) == doctest::Approx(1.0));
+}
+
+TEST_CASE("build collects tempo events from every track") {
+    // clang-format off
+    Bytes bytes = smf(1, 96, {
+        {0x60, 0xFF, 0x51, 0x03, 0x03, 0xD0, 0x90},  // 250000 at tick 96
+        {0x00, 0x90, 60, 100, 0x81, 0x40, 0x80, 60, 0},
+    });
+    // clang-format on
+    midi::File file;
+    REQUIRE(file.parse(bytes));
+    midi::TempoMap tempo;
+    tempo.build(file);
+    REQUIRE(tempo.segments().size() == 2);
+    CHECK(tempo.segments()[1].tick == 96);
+    CHECK(tempo.seconds(192) == doctest::Approx(0.75));
+}
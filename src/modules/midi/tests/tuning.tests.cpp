@@ -0,0 +1,35 @@
+#include "midi/tuning.h"
+
+#include <doctest/doctest.h>
+
+#include <cmath>
+
+namespace
+{
+double equal_tempered(double note) {
+    return 440.0 * std::pow(2.0, (note - 69.0) / 12.0);
+}
+}  // namespace
+
+TEST_CASE("note frequencies match equal temperament") {
+    static_assert(midi::frequency(69) == 440.0);
+    for (int note = 0; note < 128; ++note) {
+        CHECK(midi::frequency(std::uint8_t(note)) == doctest::Approx(equal_tempered(note)));
+    }
+}
+
+TEST_CASE("pitch bend follows the bend range") {
+    CHECK(midi::frequency(69, 16383) == doctest::Approx(equal_tempered(71)).epsilon(1e-3));
+    CHECK(midi::frequency(69, 0) == doctest::Approx(equal_tempered(67)));
+    CHECK(midi::frequency(69, 0, 12) == doctest::Approx(220.0));
+    CHECK(midi::frequency(69, 0, 48) == doctest::Approx(equal_tempered(69 - 24)));
+    CHECK(midi::frequency(69, 16383, 0) == 440.0);
+
+    // A quarter of the way up a 2 semitone range is half a semitone, within a table step.
+    double quarter = midi::frequency(69, midi::PITCH_BEND_CENTER + 2048);
+    CHECK(quarter == doctest::Approx(equal_tempered(69.5)).epsilon(1e-3));
+
+    // The extremes stay inside the tables.
+    CHECK(midi::frequency(0, 0, midi::MAX_BEND_RANGE) > 0.0);
+    CHECK(midi::frequency(127, 16383, midi::MAX_BEND_RANGE) < equal_tempered(127 + 24));
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <string_view>
+
+namespace oscillator
+{
+enum class Waveform
+{
+    SINE,
+    SAW,
+    SQUARE
+};
+
+/// @brief Instruction sets the kernels are built for.
+enum class Isa
+{
+    SCALAR,
+    SSE41,
+    AVX2
+};
+
+/// @brief Mix one band-limited oscillator into a buffer, with a linear gain ramp:
+/// `buffer[i] += (gain + i * gainStep) * wave(phase + i * increment)`.
+///
+/// @param phase normalized phase in [0, 1), advanced by numSamples * increment on return.
+/// @param increment cycles per sample, i.e. frequency / sample rate. Must be below 0.5.
+/// @param gainStep gain change per sample, 0 for a constant gain. Envelopes are applied as
+/// piecewise linear ramps this way, in the same pass as the oscillator.
+using Kernel = void (*)(
+    float* buffer,
+    int numSamples,
+    float& phase,
+    float increment,
+    float gain,
+    float gainStep
+);
+
+struct Kernels
+{
+    Isa isa;
+    Kernel sine;    ///< polynomial approximation, max error ~1e-6
+    Kernel saw;     ///< PolyBLEP
+    Kernel square;  ///< PolyBLEP
+
+    Kernel get(Waveform waveform) const {
+        switch (waveform) {
+            case Waveform::SINE:
+                return sine;
+            case Waveform::SAW:
+                return saw;
+            case Waveform::SQUARE:
+                return square;
+        }
+        return sine;
+    }
+};
+
+bool is_supported(Isa isa);
+
+/// @brief Kernels for the given instruction set. Falls back to scalar if it is not supported.
+Kernels const& kernels(Isa isa);
+
+/// @brief Kernels for the best instruction set of the running CPU, selected on the first call.
+Kernels const& kernels();
+
+std::string_view name(Isa isa);
+
+}  // namespace oscillator
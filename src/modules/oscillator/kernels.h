@@ -0,0 +1,165 @@
+#pragma once
+
+// Kernel bodies shared by all instruction sets. Each translation unit instantiates them with a
+// vector type V providing the handful of operations below. All lanes perform exactly the same
+// float operations as the scalar version, so every instruction set produces the same output.
+//
+// Everything here has internal linkage. The translation units are built with different -m flags,
+// so an instantiation shared between them, such as the scalar tail of mix(), could otherwise be
+// merged by the linker into a copy using instructions the running CPU does not have.
+
+#include "oscillator/oscillator.h"
+
+namespace oscillator::detail
+{
+namespace
+{
+// Taylor coefficients of sin(2 pi t), good to ~1e-6 for |t| <= 1/4.
+constexpr float S1 = 6.28318530718f;
+constexpr float S3 = -41.3417022404f;
+constexpr float S5 = 81.6052492761f;
+constexpr float S7 = -76.7058597531f;
+constexpr float S9 = 42.0586939449f;
+constexpr float S11 = -15.0946425768f;
+
+struct Scalar
+{
+    using type = float;
+    static constexpr int width = 1;
+
+    static type set1(float x) { return x; }
+    static type iota() { return 0.f; }
+    static type load(const float* p) { return *p; }
+    static void store(float* p, type x) { *p = x; }
+    static type add(type a, type b) { return a + b; }
+    static type sub(type a, type b) { return a - b; }
+    static type mul(type a, type b) { return a * b; }
+    // std::floor is an inline function of its own, so it would be shared: use the builtin.
+    static type floor(type a) { return __builtin_floorf(a); }
+    static bool lt(type a, type b) { return a < b; }
+    static bool gt(type a, type b) { return a > b; }
+    static type select(bool mask, type a, type b) { return mask ? a : b; }
+};
+
+/// @brief sin(2 pi p) for p in [0, 1)
+template <typename V>
+inline typename V::type sine(typename V::type p) {
+    using T = typename V::type;
+    // sin(2 pi p) = -sin(2 pi t) with t = p - 1/2 in [-1/2, 1/2), folded into [-1/4, 1/4].
+    T t = V::sub(p, V::set1(0.5f));
+    t = V::select(V::gt(t, V::set1(0.25f)), V::sub(V::set1(0.5f), t), t);
+    t = V::select(V::lt(t, V::set1(-0.25f)), V::sub(V::set1(-0.5f), t), t);
+    T t2 = V::mul(t, t);
+    T poly = V::set1(S11);
+    poly = V::add(V::mul(poly, t2), V::set1(S9));
+    poly = V::add(V::mul(poly, t2), V::set1(S7));
+    poly = V::add(V::mul(poly, t2), V::set1(S5));
+    poly = V::add(V::mul(poly, t2), V::set1(S3));
+    poly = V::add(V::mul(poly, t2), V::set1(S1));
+    return V::mul(V::mul(poly, t), V::set1(-1.f));
+}
+
+/// @brief PolyBLEP residual for a unit step at p = 0.
+template <typename V>
+inline typename V::type blep(typename V::type p, typename V::type dt, typename V::type invDt) {
+    using T = typename V::type;
+    T one = V::set1(1.f);
+    T x1 = V::mul(p, invDt);  // just after the step
+    T r1 = V::sub(V::sub(V::add(x1, x1), V::mul(x1, x1)), one);
+    T x2 = V::mul(V::sub(p, one), invDt);  // just before the step
+    T r2 = V::add(V::add(V::mul(x2, x2), V::add(x2, x2)), one);
+    T r = V::select(V::gt(p, V::sub(one, dt)), r2, V::set1(0.f));
+    return V::select(V::lt(p, dt), r1, r);
+}
+
+template <typename V>
+inline typename V::type saw(typename V::type p, typename V::type dt, typename V::type invDt) {
+    auto naive = V::sub(V::add(p, p), V::set1(1.f));
+    return V::sub(naive, blep<V>(p, dt, invDt));
+}
+
+template <typename V>
+inline typename V::type square(typename V::type p, typename V::type dt, typename V::type invDt) {
+    auto one = V::set1(1.f);
+    auto naive = V::select(V::lt(p, V::set1(0.5f)), one, V::set1(-1.f));
+    auto half = V::add(p, V::set1(0.5f));
+    half = V::select(V::lt(half, one), half, V::sub(half, one));
+    return V::sub(V::add(naive, blep<V>(p, dt, invDt)), blep<V>(half, dt, invDt));
+}
+
+/// @brief Phase of sample i, computed the same way by every instruction set.
+template <typename V>
+inline typename V::type phase_at(typename V::type index, float phase, float increment) {
+    auto p = V::add(V::set1(phase), V::mul(V::set1(increment), index));
+    return V::sub(p, V::floor(p));
+}
+
+/// @brief Gain of sample i on a linear ramp, computed the same way by every instruction set.
+template <typename V>
+inline typename V::type gain_at(typename V::type index, float gain, float gainStep) {
+    return V::add(V::set1(gain), V::mul(V::set1(gainStep), index));
+}
+
+struct SineShape
+{
+    template <typename V>
+    static typename V::type eval(typename V::type p, typename V::type, typename V::type) {
+        return sine<V>(p);
+    }
+};
+
+struct SawShape
+{
+    template <typename V>
+    static typename V::type eval(typename V::type p, typename V::type dt, typename V::type invDt) {
+        return saw<V>(p, dt, invDt);
+    }
+};
+
+struct SquareShape
+{
+    template <typename V>
+    static typename V::type eval(typename V::type p, typename V::type dt, typename V::type invDt) {
+        return square<V>(p, dt, invDt);
+    }
+};
+
+template <typename V, typename Shape>
+inline void mix_range(
+    float* buffer,
+    int begin,
+    int end,
+    float phase,
+    float increment,
+    float gain,
+    float gainStep
+) {
+    using T = typename V::type;
+    T dt = V::set1(increment);
+    T invDt = V::set1(1.f / increment);
+    T lanes = V::iota();
+    for (int i = begin; i + V::width <= end; i += V::width) {
+        T index = V::add(V::set1(static_cast<float>(i)), lanes);
+        T p = phase_at<V>(index, phase, increment);
+        T out = V::mul(gain_at<V>(index, gain, gainStep), Shape::template eval<V>(p, dt, invDt));
+        V::store(buffer + i, V::add(V::load(buffer + i), out));
+    }
+}
+
+template <typename V, typename Shape>
+void mix(float* buffer, int numSamples, float& phase, float increment, float gain, float gainStep) {
+    int vectorEnd = numSamples - numSamples % V::width;
+    mix_range<V, Shape>(buffer, 0, vectorEnd, phase, increment, gain, gainStep);
+    mix_range<Scalar, Shape>(buffer, vectorEnd, numSamples, phase, increment, gain, gainStep);
+
+    float p = phase + increment * static_cast<float>(numSamples);
+    phase = p - Scalar::floor(p);
+}
+
+template <typename V>
+constexpr Kernels make_kernels(Isa isa) {
+    return {isa, mix<V, SineShape>, mix<V, SawShape>, mix<V, SquareShape>};
+}
+
+}  // namespace
+}  // namespace oscillator::detail
@@ -0,0 +1,76 @@
+#include "oscillator/oscillator.h"
+
+#include "kernels.h"
+
+namespace oscillator::detail
+{
+#ifdef OSCILLATOR_X86
+// Defined in oscillator_sse41.cpp and oscillator_avx2.cpp
+extern Kernels const SSE41_KERNELS;
+extern Kernels const AVX2_KERNELS;
+#endif
+}  // namespace oscillator::detail
+
+namespace
+{
+constexpr oscillator::Kernels SCALAR_KERNELS =
+    oscillator::detail::make_kernels<oscillator::detail::Scalar>(oscillator::Isa::SCALAR);
+
+oscillator::Kernels const& select_best() {
+    if (oscillator::is_supported(oscillator::Isa::AVX2)) {
+        return oscillator::kernels(oscillator::Isa::AVX2);
+    }
+    if (oscillator::is_supported(oscillator::Isa::SSE41)) {
+        return oscillator::kernels(oscillator::Isa::SSE41);
+    }
+    return SCALAR_KERNELS;
+}
+}  // namespace
+
+bool oscillator::is_supported(Isa isa) {
+    switch (isa) {
+        case Isa::SCALAR:
+            return true;
+#ifdef OSCILLATOR_X86
+        case Isa::SSE41:
+            return __builtin_cpu_supports("sse4.1");
+        case Isa::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+oscillator::Kernels const& oscillator::kernels(Isa isa) {
+    if (!is_supported(isa)) {
+        return SCALAR_KERNELS;
+    }
+    switch (isa) {
+#ifdef OSCILLATOR_X86
+        case Isa::SSE41:
+            return detail::SSE41_KERNELS;
+        case Isa::AVX2:
+            return detail::AVX2_KERNELS;
+#endif
+        default:
+            return SCALAR_KERNELS;
+    }
+}
+
+oscillator::Kernels const& oscillator::kernels() {
+    static Kernels const& best = select_best();
+    return best;
+}
+
+std::string_view oscillator::name(Isa isa) {
+    switch (isa) {
+        case Isa::SCALAR:
+            return "scalar";
+        case Isa::SSE41:
+            return "sse4.1";
+        case Isa::AVX2:
+            return "avx2";
+    }
+    return "unknown";
+}
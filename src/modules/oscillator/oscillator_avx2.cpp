@@ -0,0 +1,30 @@
+#include "kernels.h"
+
+#include <immintrin.h>
+
+namespace
+{
+struct Avx2
+{
+    using type = __m256;
+    static constexpr int width = 8;
+
+    static type set1(float x) { return _mm256_set1_ps(x); }
+    static type iota() { return _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f); }
+    static type load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, type x) { _mm256_storeu_ps(p, x); }
+    static type add(type a, type b) { return _mm256_add_ps(a, b); }
+    static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+    static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+    static type floor(type a) { return _mm256_floor_ps(a); }
+    static type lt(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static type gt(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static type select(type mask, type a, type b) { return _mm256_blendv_ps(b, a, mask); }
+};
+}  // namespace
+
+namespace oscillator::detail
+{
+extern Kernels const AVX2_KERNELS;
+Kernels const AVX2_KERNELS = make_kernels<Avx2>(Isa::AVX2);
+}  // namespace oscillator::detail
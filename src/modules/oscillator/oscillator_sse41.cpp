@@ -0,0 +1,30 @@
+#include "kernels.h"
+
+#include <immintrin.h>
+
+namespace
+{
+struct Sse41
+{
+    using type = __m128;
+    static constexpr int width = 4;
+
+    static type set1(float x) { return _mm_set1_ps(x); }
+    static type iota() { return _mm_setr_ps(0.f, 1.f, 2.f, 3.f); }
+    static type load(const float* p) { return _mm_loadu_ps(p); }
+    static void store(float* p, type x) { _mm_storeu_ps(p, x); }
+    static type add(type a, type b) { return _mm_add_ps(a, b); }
+    static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+    static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+    static type floor(type a) { return _mm_floor_ps(a); }
+    static type lt(type a, type b) { return _mm_cmplt_ps(a, b); }
+    static type gt(type a, type b) { return _mm_cmpgt_ps(a, b); }
+    static type select(type mask, type a, type b) { return _mm_blendv_ps(b, a, mask); }
+};
+}  // namespace
+
+namespace oscillator::detail
+{
+extern Kernels const SSE41_KERNELS;
+Kernels const SSE41_KERNELS = make_kernels<Sse41>(Isa::SSE41);
+}  // namespace oscillator::detail
@@ -0,0 +1,151 @@
+#include "oscillator/oscillator.h"
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+constexpr int SAMPLE_RATE = 48'000;
+constexpr int BLOCK = 480;
+constexpr double TWO_PI = 6.283185307179586;
+
+constexpr oscillator::Isa ALL_ISAS[] = {
+    oscillator::Isa::SCALAR,
+    oscillator::Isa::SSE41,
+    oscillator::Isa::AVX2,
+};
+constexpr oscillator::Waveform ALL_WAVEFORMS[] = {
+    oscillator::Waveform::SINE,
+    oscillator::Waveform::SAW,
+    oscillator::Waveform::SQUARE,
+};
+
+/// @brief Render a few blocks of one oscillator, with an odd block size to exercise the tails.
+/// With a gain step, every block ramps up from 0.
+std::vector<float> render(
+    oscillator::Kernel kernel,
+    double freq,
+    int blocks,
+    int blockSize,
+    float gainStep = 0.f
+) {
+    std::vector<float> out(blocks * blockSize, 0.f);
+    float phase = 0.f;
+    float const gain = gainStep == 0.f ? 1.f : 0.f;
+    float const increment = float(freq / SAMPLE_RATE);
+    for (int b = 0; b < blocks; ++b) {
+        kernel(out.data() + b * blockSize, blockSize, phase, increment, gain, gainStep);
+    }
+    return out;
+}
+}  // namespace
+
+TEST_CASE("fast sine matches std::sin") {
+    for (double freq : {27.5, 440.0, 4186.0}) {
+        auto out = render(oscillator::kernels(oscillator::Isa::SCALAR).sine, freq, 10, BLOCK);
+
+        // Double precision reference, like the original gen_sine_wave().
+        double phase = 0.0;
+        double maxError = 0.0;
+        for (float sample : out) {
+            maxError = std::max(maxError, std::fabs(sample - std::sin(phase)));
+            phase += TWO_PI * freq / SAMPLE_RATE;
+        }
+        // The error is dominated by the float phase accumulator, not by the polynomial.
+        CHECK(maxError < 1e-3);
+    }
+
+    // Polynomial alone, on exact phases.
+    std::vector<float> out(1, 0.f);
+    double maxError = 0.0;
+    for (int i = 0; i < 1000; ++i) {
+        float phase = i / 1000.f;
+        out[0] = 0.f;
+        oscillator::kernels(oscillator::Isa::SCALAR).sine(out.data(), 1, phase, 0.01f, 1.f, 0.f);
+        maxError = std::max(maxError, std::fabs(out[0] - std::sin(TWO_PI * i / 1000.0)));
+    }
+    CHECK(maxError < 2e-6);
+}
+
+TEST_CASE("vector kernels match the scalar reference") {
+    auto const& scalar = oscillator::kernels(oscillator::Isa::SCALAR);
+    for (auto isa : ALL_ISAS) {
+        if (!oscillator::is_supported(isa)) {
+            MESSAGE("skipping unsupported " << oscillator::name(isa));
+            continue;
+        }
+        auto const& kernels = oscillator::kernels(isa);
+        CHECK(kernels.isa == isa);
+
+        for (auto waveform : ALL_WAVEFORMS) {
+            for (double freq : {55.0, 440.0, 3520.0, 12000.0}) {
+                for (int blockSize : {BLOCK, 37}) {
+                    for (float gainStep : {0.f, 1.f / 480}) {
+                        auto expected = render(scalar.get(waveform), freq, 7, blockSize, gainStep);
+                        auto actual = render(kernels.get(waveform), freq, 7, blockSize, gainStep);
+                        float maxError = 0.f;
+                        for (size_t i = 0; i < expected.size(); ++i) {
+                            maxError = std::max(maxError, std::fabs(expected[i] - actual[i]));
+                        }
+                        CHECK(maxError < 1e-6f);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("kernels accumulate into the buffer") {
+    auto const& kernels = oscillator::kernels();
+    std::vector<float> out(BLOCK, 0.25f);
+    float phase = 0.f;
+    kernels.square(out.data(), BLOCK, phase, 100.f / SAMPLE_RATE, 0.5f, 0.f);
+    CHECK(out[BLOCK / 4] == doctest::Approx(0.75));
+    CHECK(phase == doctest::Approx(std::fmod(100.0 * BLOCK / SAMPLE_RATE, 1.0)));
+}
+
+TEST_CASE("gain ramps linearly across the block") {
+    for (auto isa : ALL_ISAS) {
+        if (!oscillator::is_supported(isa)) {
+            continue;
+        }
+        // A square wave at 100 Hz is +1 for the first 240 samples: the output is the ramp itself.
+        auto const& kernels = oscillator::kernels(isa);
+        std::vector<float> out(BLOCK / 4, 0.f);
+        float phase = 0.1f;
+        kernels.square(out.data(), int(out.size()), phase, 100.f / SAMPLE_RATE, 0.2f, 0.004f);
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            CHECK(out[i] == doctest::Approx(0.2f + 0.004f * float(i)));
+        }
+    }
+}
+
+TEST_CASE("PolyBLEP smooths the discontinuities") {
+    constexpr double freq = 1000.0;
+    auto const& kernels = oscillator::kernels();
+
+    for (auto waveform : {oscillator::Waveform::SAW, oscillator::Waveform::SQUARE}) {
+        auto out = render(kernels.get(waveform), freq, 4, BLOCK);
+
+        float maxStep = 0.f;
+        double sum = 0.0;
+        for (size_t i = 1; i < out.size(); ++i) {
+            maxStep = std::max(maxStep, std::fabs(out[i] - out[i - 1]));
+            sum += out[i];
+            CHECK(std::fabs(out[i]) <= 1.05f);
+        }
+        // A naive waveform jumps by 2 at each discontinuity.
+        CHECK(maxStep < 1.5f);
+        CHECK(std::fabs(sum / out.size()) < 0.01);
+    }
+}
+
+TEST_CASE("best kernels are selected once") {
+    auto const& best = oscillator::kernels();
+    CHECK(&best == &oscillator::kernels());
+    CHECK(oscillator::is_supported(best.isa));
+    MESSAGE("using " << oscillator::name(best.isa) << " oscillator kernels");
+}
@@ -0,0 +1,204 @@
+#include "output/alsa_sink.h"
+
+#include "logger/logger.h"
+
+#include <alsa/asoundlib.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+namespace
+{
+snd_pcm_format_t alsa_format(synth::SampleFormat format) {
+    return format == synth::SampleFormat::F32 ? SND_PCM_FORMAT_FLOAT_LE : SND_PCM_FORMAT_S16_LE;
+}
+}  // namespace
+
+bool output::AlsaSink::open(Config const& requested) {
+    close();
+    if (!check_config(requested)) {
+        return false;
+    }
+    // Non-blocking: write() waits in poll() itself, with a timeout.
+    int err = snd_pcm_open(&pcm, device.c_str(), SND_PCM_STREAM_PLAYBACK, SND_PCM_NONBLOCK);
+    if (err < 0) {
+        logger::log("ALSA: could not open {}: {}", device, snd_strerror(err));
+        pcm = nullptr;
+        return false;
+    }
+    if (!configure(requested)) {
+        close();
+        return false;
+    }
+
+    int const count = snd_pcm_poll_descriptors_count(pcm);
+    descriptors.resize(std::max(count, 0));
+    snd_pcm_poll_descriptors(pcm, descriptors.data(), descriptors.size());
+    frames.store(0, std::memory_order_relaxed);
+    numXruns.store(0, std::memory_order_relaxed);
+    logger::log(
+        "ALSA: {} at {} Hz, {} periods of {} frames",
+        device,
+        current.sampleRate,
+        current.periods,
+        current.periodFrames
+    );
+    return true;
+}
+
+bool output::AlsaSink::configure(Config const& requested) {
+    auto check = [this](int err, std::string_view what) {
+        if (err < 0) {
+            logger::log("ALSA: {} cannot set {}: {}", device, what, snd_strerror(err));
+        }
+        return err >= 0;
+    };
+
+    snd_pcm_hw_params_t* hw;
+    snd_pcm_hw_params_alloca(&hw);
+    snd_pcm_hw_params_any(pcm, hw);
+    unsigned int rate = requested.sampleRate;
+    snd_pcm_uframes_t period = requested.periodFrames;
+    unsigned int periods = requested.periods;
+    // The *_near calls return which way they rounded in dir, so each gets its own: passed on,
+    // it would bias the next call's rounding.
+    int rateDir = 0;
+    int sizeDir = 0;
+    int periodsDir = 0;
+    // Each call narrows the configurations left, so the order is that of importance. With ALSA's
+    // resampling off, a plug device reports the hardware's rate rather than converting to ours.
+    if (!check(snd_pcm_hw_params_set_access(pcm, hw, SND_PCM_ACCESS_MMAP_INTERLEAVED), "access") ||
+        !check(snd_pcm_hw_params_set_format(pcm, hw, alsa_format(requested.format)), "format") ||
+        !check(snd_pcm_hw_params_set_channels(pcm, hw, requested.channels), "channels") ||
+        !check(snd_pcm_hw_params_set_rate_resample(pcm, hw, 0), "resampling") ||
+        !check(snd_pcm_hw_params_set_rate_near(pcm, hw, &rate, &rateDir), "rate") ||
+        !check(snd_pcm_hw_params_set_period_size_near(pcm, hw, &period, &sizeDir), "period size") ||
+        !check(snd_pcm_hw_params_set_periods_near(pcm, hw, &periods, &periodsDir), "periods") ||
+        !check(snd_pcm_hw_params(pcm, hw), "hardware parameters")) {
+        return false;
+    }
+    snd_pcm_uframes_t bufferSize = 0;
+    int dir = 0;
+    snd_pcm_hw_params_get_period_size(hw, &period, &dir);
+    snd_pcm_hw_params_get_buffer_size(hw, &bufferSize);
+
+    current = requested;
+    current.sampleRate = int(rate);
+    current.periodFrames = int(period);
+    current.periods = int(bufferSize / period);
+
+    snd_pcm_sw_params_t* sw;
+    snd_pcm_sw_params_alloca(&sw);
+    snd_pcm_sw_params_current(pcm, sw);
+    // Wake up once a whole period is free. write() starts the device itself once the buffer is
+    // full, which mmap transfers leave to the application anyway.
+    if (!check(snd_pcm_sw_params_set_avail_min(pcm, sw, period), "wakeup threshold") ||
+        !check(snd_pcm_sw_params_set_start_threshold(pcm, sw, bufferSize), "start threshold") ||
+        !check(snd_pcm_sw_params(pcm, sw), "software parameters")) {
+        return false;
+    }
+    // Long enough for the device to play the whole buffer a few times over.
+    pollTimeout = std::max(10, int(4 * bufferSize * 1000 / rate));
+    return true;
+}
+
+bool output::AlsaSink::write(RenderCallback render, void* context) {
+    if (!pcm) {
+        return false;
+    }
+    auto const period = snd_pcm_uframes_t(current.periodFrames);
+    for (;;) {
+        snd_pcm_sframes_t const avail = snd_pcm_avail_update(pcm);
+        if (avail < 0) {
+            if (!recover(int(avail))) {
+                return false;
+            }
+        } else if (snd_pcm_uframes_t(avail) >= period) {
+            break;
+        } else if (snd_pcm_state(pcm) == SND_PCM_STATE_PREPARED) {
+            // Filled up, at the start or after an xrun: start playing.
+            int const err = snd_pcm_start(pcm);
+            if (err < 0 && !recover(err)) {
+                return false;
+            }
+        } else if (!wait()) {
+            return false;
+        }
+    }
+
+    // Render straight into the ring buffer: in one go, or in two where the period wraps.
+    snd_pcm_uframes_t remaining = period;
+    while (remaining > 0) {
+        const snd_pcm_channel_area_t* areas = nullptr;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t size = remaining;
+        int const err = snd_pcm_mmap_begin(pcm, &areas, &offset, &size);
+        if (err < 0) {
+            if (!recover(err)) {
+                return false;
+            }
+            continue;
+        }
+        // Interleaved, the channels share one area, and the first one's samples start a frame.
+        auto* start = static_cast<std::byte*>(areas[0].addr) +
+                      (areas[0].first + offset * areas[0].step) / 8;
+        render(context, start, int(size));
+        snd_pcm_sframes_t const committed = snd_pcm_mmap_commit(pcm, offset, size);
+        if (committed < 0 || snd_pcm_uframes_t(committed) != size) {
+            if (!recover(committed < 0 ? int(committed) : -EPIPE)) {
+                return false;
+            }
+        }
+        remaining -= size;
+        frames.fetch_add(size, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+bool output::AlsaSink::wait() {
+    int const ready = poll(descriptors.data(), descriptors.size(), pollTimeout);
+    if (ready < 0) {
+        if (errno == EINTR) {
+            return true;
+        }
+        logger::log("ALSA: poll on {} failed: {}", device, std::strerror(errno));
+        return false;
+    }
+    if (ready == 0) {
+        logger::log("ALSA: {} stalled for {} ms", device, pollTimeout);
+        return false;
+    }
+    unsigned short revents = 0;
+    snd_pcm_poll_descriptors_revents(pcm, descriptors.data(), descriptors.size(), &revents);
+    if (revents & POLLERR) {
+        // The device stopped: it ran dry, or the system suspended it.
+        bool const suspended = snd_pcm_state(pcm) == SND_PCM_STATE_SUSPENDED;
+        return recover(suspended ? -ESTRPIPE : -EPIPE);
+    }
+    return true;
+}
+
+bool output::AlsaSink::recover(int error) {
+    if (error == -EPIPE || error == -ESTRPIPE) {
+        numXruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Silently: the xrun count is what gets reported, off the audio thread.
+    int const err = snd_pcm_recover(pcm, error, 1);
+    if (err < 0) {
+        logger::log("ALSA: {} did not recover: {}", device, snd_strerror(err));
+        return false;
+    }
+    return true;
+}
+
+void output::AlsaSink::close() {
+    if (pcm) {
+        snd_pcm_drop(pcm);
+        snd_pcm_close(pcm);
+        pcm = nullptr;
+    }
+    descriptors.clear();
+}
@@ -0,0 +1,57 @@
+#include "output/file_sink.h"
+
+#include "logger/logger.h"
+#include "output/wav.h"
+
+bool output::FileSink::open(Config const& requested) {
+    close();
+    if (!check_config(requested)) {
+        return false;
+    }
+    current = requested;
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        logger::log("Could not open {}", path);
+        return false;
+    }
+    wav = path.ends_with(".wav");
+    if (wav) {
+        write_wav_header(file, current.sampleRate, current.channels, current.format, 0);
+    }
+    buffer.resize(current.periodFrames * synth::bytes_per_frame(current.channels, current.format));
+    frames.store(0, std::memory_order_relaxed);
+    numXruns.store(0, std::memory_order_relaxed);
+    return true;
+}
+
+bool output::FileSink::write(RenderCallback render, void* context) {
+    if (!file.is_open()) {
+        return false;
+    }
+    render(context, buffer.data(), current.periodFrames);
+    file.write(reinterpret_cast<const char*>(buffer.data()), std::streamsize(buffer.size()));
+    if (!file) {
+        logger::log("Could not write to {}", path);
+        return false;
+    }
+    frames.fetch_add(current.periodFrames, std::memory_order_relaxed);
+    return true;
+}
+
+void output::FileSink::close() {
+    if (!file.is_open()) {
+        return;
+    }
+    if (wav) {
+        auto const frameBytes = synth::bytes_per_frame(current.channels, current.format);
+        file.seekp(0);
+        write_wav_header(
+            file,
+            current.sampleRate,
+            current.channels,
+            current.format,
+            static_cast<std::uint32_t>(position() * frameBytes)
+        );
+    }
+    file.close();
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "output/sink.h"
+
+#include <poll.h>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Keeps <alsa/asoundlib.h> out of the users of the sink.
+struct _snd_pcm;
+
+namespace output
+{
+/// @brief Plays on an ALSA PCM device through its mmap'ed ring buffer, with no GStreamer
+/// elements, no intermediate copy and no second thread in between.
+///
+/// The device is opened with the periods asked for, typically two of 1-2 ms, and its rate is
+/// left alone: on a plug device ALSA's own resampler is disabled, so the rate the hardware picks
+/// is the one config() reports and the caller renders at. write() polls the device until a
+/// period is free, renders it in place between snd_pcm_mmap_begin() and snd_pcm_mmap_commit(),
+/// and recovers from underruns and suspends on the spot.
+class AlsaSink : public Sink
+{
+public:
+    explicit AlsaSink(std::string device)
+    : device(std::move(device)) {}
+    ~AlsaSink() override { close(); }
+
+    AlsaSink(AlsaSink const&) = delete;
+    AlsaSink& operator=(AlsaSink const&) = delete;
+
+    bool open(Config const& requested) override;
+    bool write(RenderCallback render, void* context) override;
+    void close() override;
+
+private:
+    bool configure(Config const& requested);
+    bool wait();
+    bool recover(int error);
+
+    std::string device;
+    _snd_pcm* pcm = nullptr;
+    std::vector<pollfd> descriptors;
+    int pollTimeout = 0;  ///< ms, so that write() returns now and then even if the device stalls
+};
+
+}  // namespace output
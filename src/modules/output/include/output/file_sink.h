@@ -0,0 +1,35 @@
+#pragma once
+
+#include "output/sink.h"
+
+#include <cstddef>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace output
+{
+/// @brief Writes the stream to a file as fast as it is rendered: a WAV file if the name ends in
+/// .wav, raw interleaved samples otherwise. For headless runs and tests.
+class FileSink : public Sink
+{
+public:
+    explicit FileSink(std::string path)
+    : path(std::move(path)) {}
+    ~FileSink() override { close(); }
+
+    bool open(Config const& requested) override;
+    bool write(RenderCallback render, void* context) override;
+
+    /// @brief Completes the WAV header.
+    void close() override;
+
+private:
+    std::string path;
+    std::ofstream file;
+    bool wav = false;
+    std::vector<std::byte> buffer;
+};
+
+}  // namespace output
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "output/sink.h"
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace output
+{
+/// @brief Renders into a scratch buffer and drops it. Paced, it stands in for a device playing
+/// at the configured rate: write() sleeps until that device's buffer would have room for a
+/// period, so a render loop runs as it would against real hardware, and a period rendered after
+/// the device would have played it counts as an xrun. Unpaced, it renders as fast as it can.
+class NullSink : public Sink
+{
+public:
+    explicit NullSink(bool paced = true)
+    : paced(paced) {}
+
+    bool open(Config const& requested) override;
+    bool write(RenderCallback render, void* context) override;
+    void close() override;
+
+private:
+    bool paced;
+    std::vector<std::byte> buffer;
+    std::chrono::steady_clock::time_point start;  ///< when the device started playing
+    std::uint64_t startFrame = 0;                 ///< the frame it started on
+};
+
+}  // namespace output
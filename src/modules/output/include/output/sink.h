@@ -0,0 +1,68 @@
+#pragma once
+
+#include "synth/render.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace output
+{
+/// @brief Stream layout and buffering asked of a sink. Devices may adjust the rate and the
+/// period; the sink's config() holds what they settled on.
+struct Config
+{
+    int sampleRate = 48'000;
+    int channels = 2;
+    synth::SampleFormat format = synth::SampleFormat::F32;
+    int periodFrames = 96;  ///< frames per write(), 2 ms at 48 kHz
+    int periods = 2;        ///< periods the device buffers, its latency in periods
+};
+
+/// @brief Fill numFrames interleaved frames at buffer in the sink's layout. Called from write()
+/// on the thread calling it, once or, where the device buffer wraps, twice per period.
+using RenderCallback = void (*)(void* context, void* buffer, int numFrames);
+
+/// @brief Where the rendered audio goes. One thread calls write() in a loop, and each call
+/// waits for room for a period, has the callback render it straight into the destination and
+/// queues it.
+class Sink
+{
+public:
+    virtual ~Sink() = default;
+
+    /// @brief Returns false and logs on error.
+    virtual bool open(Config const& requested) = 0;
+
+    /// @brief Render and queue one period. Returns false once the sink has failed for good;
+    /// underruns are recovered from and counted.
+    virtual bool write(RenderCallback render, void* context) = 0;
+
+    virtual void close() = 0;
+
+    Config const& config() const { return current; }
+
+    /// @brief Frames queued since open(). Safe to read from any thread.
+    std::uint64_t position() const { return frames.load(std::memory_order_relaxed); }
+
+    /// @brief Underruns since open(): times the device ran out of periods to play. Safe to read
+    /// from any thread.
+    std::uint64_t xruns() const { return numXruns.load(std::memory_order_relaxed); }
+
+protected:
+    Config current;
+    std::atomic<std::uint64_t> frames{0};
+    std::atomic<std::uint64_t> numXruns{0};
+};
+
+/// @brief Logs and returns false if config does not describe a stream a sink can open.
+bool check_config(Config const& config);
+
+/// @brief The sink for a backend name: "alsa" plays on the PCM device, "null" discards the audio
+/// at the pace of a device, "file" writes it to device as a path as fast as it renders.
+/// @return nullptr if the name is unknown.
+std::unique_ptr<Sink> make_sink(std::string_view backend, std::string const& device);
+
+}  // namespace output
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "synth/render.h"
+
+#include <cstdint>
+#include <ostream>
+
+namespace output
+{
+/// @brief Write a canonical 44 byte WAV header. Call it again with the final size once all the
+/// samples are written.
+inline void write_wav_header(
+    std::ostream& out,
+    int sampleRate,
+    int channels,
+    synth::SampleFormat format,
+    std::uint32_t dataBytes
+) {
+    auto put16 = [&](std::uint16_t v) { out.write(reinterpret_cast<const char*>(&v), 2); };
+    auto put32 = [&](std::uint32_t v) { out.write(reinterpret_cast<const char*>(&v), 4); };
+
+    std::uint16_t bytesPerFrame = synth::bytes_per_frame(channels, format);
+    out.write("RIFF", 4);
+    put32(36 + dataBytes);
+    out.write("WAVEfmt ", 8);
+    put32(16);
+    put16(format == synth::SampleFormat::F32 ? 3 : 1);  // IEEE float or PCM
+    put16(channels);
+    put32(sampleRate);
+    put32(sampleRate * bytesPerFrame);
+    put16(bytesPerFrame);
+    put16(8 * synth::bytes_per_sample(format));
+    out.write("data", 4);
+    put32(dataBytes);
+}
+
+}  // namespace output
@@ -0,0 +1,48 @@
+#include "output/null_sink.h"
+
+#include <thread>
+
+bool output::NullSink::open(Config const& requested) {
+    if (!check_config(requested)) {
+        return false;
+    }
+    current = requested;
+    buffer.resize(current.periodFrames * synth::bytes_per_frame(current.channels, current.format));
+    frames.store(0, std::memory_order_relaxed);
+    numXruns.store(0, std::memory_order_relaxed);
+    startFrame = 0;
+    return true;
+}
+
+bool output::NullSink::write(RenderCallback render, void* context) {
+    if (paced) {
+        auto const period = std::uint64_t(current.periodFrames);
+        auto const buffered = period * std::uint64_t(current.periods);
+        std::uint64_t const queued = position() - startFrame;
+        if (queued == buffered) {
+            start = std::chrono::steady_clock::now();  // the buffer is full: playback starts
+        }
+        if (queued >= buffered) {
+            auto const played = [&](std::uint64_t frame) {
+                return start + std::chrono::nanoseconds(
+                                   std::int64_t(double(frame) * 1e9 / current.sampleRate)
+                               );
+            };
+            if (std::chrono::steady_clock::now() > played(queued)) {
+                // The device ran dry before this period came, so it stops and fills up again.
+                numXruns.fetch_add(1, std::memory_order_relaxed);
+                startFrame = position();
+            } else {
+                std::this_thread::sleep_until(played(queued - buffered + period));
+            }
+        }
+    }
+    render(context, buffer.data(), current.periodFrames);
+    frames.fetch_add(current.periodFrames, std::memory_order_relaxed);
+    return true;
+}
+
+void output::NullSink::close() {
+    buffer.clear();
+    buffer.shrink_to_fit();
+}
@@ -0,0 +1,39 @@
+#include "output/sink.h"
+
+#include "logger/logger.h"
+#include "output/alsa_sink.h"
+#include "output/file_sink.h"
+#include "output/null_sink.h"
+
+bool output::check_config(Config const& config) {
+    if (config.sampleRate <= 0 || config.periodFrames <= 0 || config.periods <= 0) {
+        logger::log(
+            "Invalid output: {} Hz, {} periods of {} frames",
+            config.sampleRate,
+            config.periods,
+            config.periodFrames
+        );
+        return false;
+    }
+    if (config.channels < 1 || config.channels > synth::MAX_CHANNELS) {
+        logger::log("Unsupported output layout: {} channels", config.channels);
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<output::Sink> output::make_sink(
+    std::string_view backend,
+    std::string const& device
+) {
+    if (backend == "alsa") {
+        return std::make_unique<AlsaSink>(device);
+    }
+    if (backend == "null") {
+        return std::make_unique<NullSink>();
+    }
+    if (backend == "file") {
+        return std::make_unique<FileSink>(device);
+    }
+    return nullptr;
+}
@@ -0,0 +1,43 @@
+#include "output/alsa_sink.h"
+
+#include <doctest/doctest.h>
+
+namespace
+{
+void silence(void* context, void* buffer, int numFrames) {
+    auto* out = static_cast<float*>(buffer);
+    for (int i = 0; i < 2 * numFrames; ++i) {
+        out[i] = 0.f;
+    }
+    *static_cast<int*>(context) += numFrames;
+}
+
+}  // namespace
+
+TEST_CASE("an ALSA sink plays periods through the mmap ring buffer") {
+    // ALSA's null device takes any configuration and plays nothing; machines without an ALSA
+    // configuration do not have it.
+    output::AlsaSink sink("null");
+    if (!sink.open({.sampleRate = 48'000, .channels = 2, .periodFrames = 96, .periods = 2})) {
+        MESSAGE("no ALSA null device, skipping");
+        return;
+    }
+    CHECK(sink.config().channels == 2);
+    CHECK(sink.config().periodFrames > 0);
+    int rendered = 0;
+    for (int i = 0; i < 20; ++i) {
+        REQUIRE(sink.write(silence, &rendered));
+    }
+    CHECK(sink.position() == std::uint64_t(20 * sink.config().periodFrames));
+    CHECK(rendered == 20 * sink.config().periodFrames);
+    sink.close();
+    CHECK_FALSE(sink.write(silence, &rendered));
+}
+
+TEST_CASE("an ALSA sink that cannot open its device says so") {
+    output::AlsaSink sink("no such device");
+    CHECK_FALSE(sink.open({}));
+    int rendered = 0;
+    CHECK_FALSE(sink.write(silence, &rendered));
+    CHECK(rendered == 0);
+}
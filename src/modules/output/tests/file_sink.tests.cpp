@@ -0,0 +1,92 @@
+#include "output/file_sink.h"
+
+#include "test_support/files.h"
+
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+namespace
+{
+using test_support::read_at;
+using test_support::read_file;
+using test_support::temp_path;
+
+/// @brief Stereo S16 frames counting up from *context, the same value in both channels.
+void ramp(void* context, void* buffer, int numFrames) {
+    auto* next = static_cast<std::int16_t*>(context);
+    auto* out = static_cast<std::int16_t*>(buffer);
+    for (int i = 0; i < numFrames; ++i) {
+        out[2 * i] = *next;
+        out[2 * i + 1] = *next;
+        ++*next;
+    }
+}
+
+}  // namespace
+
+TEST_CASE("a file sink writes a complete WAV file") {
+    auto const path = temp_path("output_file_sink.wav");
+    constexpr output::Config CONFIG = {
+        .sampleRate = 44'100,
+        .channels = 2,
+        .format = synth::SampleFormat::S16,
+        .periodFrames = 100,
+        .periods = 2,
+    };
+    {
+        output::FileSink sink(path);
+        REQUIRE(sink.open(CONFIG));
+        std::int16_t next = 0;
+        for (int i = 0; i < 5; ++i) {
+            REQUIRE(sink.write(ramp, &next));
+        }
+        CHECK(sink.position() == 500);
+    }
+
+    auto const bytes = read_file(path);
+    REQUIRE(bytes.size() == 44 + 500 * 4);
+    CHECK(std::memcmp(bytes.data(), "RIFF", 4) == 0);
+    CHECK(read_at<std::uint32_t>(bytes, 4) == 36 + 500 * 4);
+    CHECK(read_at<std::uint16_t>(bytes, 20) == 1);  // PCM
+    CHECK(read_at<std::uint16_t>(bytes, 22) == 2);
+    CHECK(read_at<std::uint32_t>(bytes, 24) == 44'100);
+    CHECK(read_at<std::uint32_t>(bytes, 40) == 500 * 4);
+    for (int i = 0; i < 500; ++i) {
+        CHECK(read_at<std::int16_t>(bytes, 44 + 4 * i) == i);
+        CHECK(read_at<std::int16_t>(bytes, 46 + 4 * i) == i);
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("a file sink writes raw samples to other names") {
+    auto const path = temp_path("output_file_sink.raw");
+    output::FileSink sink(path);
+    REQUIRE(sink.open({.channels = 2, .format = synth::SampleFormat::S16, .periodFrames = 64}));
+    std::int16_t next = 0;
+    REQUIRE(sink.write(ramp, &next));
+    sink.close();
+    CHECK_FALSE(sink.write(ramp, &next));
+
+    auto const bytes = read_file(path);
+    REQUIRE(bytes.size() == 64 * 4);
+    CHECK(read_at<std::int16_t>(bytes, 63 * 4) == 63);
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("the file backend writes to the device as a path") {
+    auto const path = temp_path("output_make_sink.raw");
+    auto sink = output::make_sink("file", path);
+    REQUIRE(sink);
+    REQUIRE(sink->open({.channels = 2, .format = synth::SampleFormat::S16, .periodFrames = 64}));
+    std::int16_t next = 0;
+    REQUIRE(sink->write(ramp, &next));
+    sink->close();
+
+    CHECK(read_file(path).size() == 64 * 4);
+    std::filesystem::remove(path);
+    CHECK_FALSE(output::make_sink("nonesuch", path));
+}
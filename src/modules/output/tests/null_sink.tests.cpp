@@ -0,0 +1,76 @@
+#include "output/null_sink.h"
+
+#include <doctest/doctest.h>
+
+#include <chrono>
+#include <thread>
+
+namespace
+{
+struct Counter
+{
+    int calls = 0;
+    int frames = 0;
+    int stallAt = -1;  ///< call to sleep through, -1 for none
+    std::chrono::milliseconds stall{0};
+};
+
+void count(void* context, void* buffer, int numFrames) {
+    auto* counter = static_cast<Counter*>(context);
+    if (counter->calls == counter->stallAt) {
+        std::this_thread::sleep_for(counter->stall);
+    }
+    ++counter->calls;
+    counter->frames += numFrames;
+}
+
+}  // namespace
+
+TEST_CASE("an unpaced null sink renders every period at once") {
+    output::NullSink sink(false);
+    REQUIRE(sink.open({.sampleRate = 48'000, .channels = 2, .periodFrames = 64, .periods = 2}));
+    Counter counter;
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 1000; ++i) {
+        REQUIRE(sink.write(count, &counter));
+    }
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500));
+    CHECK(counter.calls == 1000);
+    CHECK(counter.frames == 64'000);
+    CHECK(sink.position() == 64'000);
+    CHECK(sink.xruns() == 0);
+}
+
+TEST_CASE("a paced null sink plays at the device rate") {
+    // 1 ms periods, 8 of them buffered.
+    output::NullSink sink;
+    REQUIRE(sink.open({.sampleRate = 48'000, .channels = 1, .periodFrames = 48, .periods = 8}));
+    Counter counter;
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 28; ++i) {
+        REQUIRE(sink.write(count, &counter));
+    }
+    // The first 8 fill the buffer; each of the other 20 waits for a period to play.
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+    CHECK(elapsed >= std::chrono::milliseconds(19));
+    CHECK(sink.position() == 28 * 48);
+    CHECK(sink.xruns() == 0);
+}
+
+TEST_CASE("a period rendered too late is an xrun") {
+    output::NullSink sink;
+    REQUIRE(sink.open({.sampleRate = 48'000, .channels = 1, .periodFrames = 48, .periods = 2}));
+    Counter counter{.stallAt = 5, .stall = std::chrono::milliseconds(20)};
+    for (int i = 0; i < 10; ++i) {
+        REQUIRE(sink.write(count, &counter));
+    }
+    CHECK(sink.xruns() == 1);
+    CHECK(sink.position() == 10 * 48);
+}
+
+TEST_CASE("a null sink refuses a config without a stream") {
+    output::NullSink sink;
+    CHECK_FALSE(sink.open({.periodFrames = 0}));
+    CHECK_FALSE(sink.open({.channels = 3}));
+    CHECK_FALSE(sink.open({.sampleRate = 0}));
+}
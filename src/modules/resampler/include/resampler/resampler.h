@@ -0,0 +1,131 @@
+#pragma once
+
+#include "oscillator/oscillator.h"
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace resampler
+{
+/// @brief The instruction sets and CPU detection are the oscillator kernels'.
+using oscillator::Isa;
+
+/// @brief Trade-off between cost and aliasing. Every preset but LINEAR is a Kaiser-windowed sinc.
+enum class Quality
+{
+    LINEAR,  ///< 2 point linear interpolation, the cheapest
+    FAST,    ///< 8 taps, ~50 dB stopband
+    GOOD,    ///< 16 taps, ~75 dB stopband
+    BEST     ///< 32 taps, ~95 dB stopband
+};
+
+/// @brief Sub-sample positions tabulated per filter. Coefficients between two are interpolated
+/// linearly, so the table stays small with no audible phase quantization.
+constexpr int PHASES = 256;
+
+/// @brief Taps of the longest filter, BEST's.
+constexpr int MAX_TAPS = 32;
+
+/// @brief Ratios of input to output rate a filter table is designed for: 1 (and below), 2 and 4.
+/// Above 1 the cutoff drops with the ratio so that pitching up does not alias. A ratio gets the
+/// nearest table, which keeps what aliases in the top fifth of the band; ratios above the last
+/// alias more.
+constexpr int NUM_OCTAVES = 3;
+
+/// @brief One polyphase filter: PHASES + 1 rows of taps coefficients, the last row equal to the
+/// first shifted by one input frame, so every row can be interpolated with its successor.
+///
+/// Output at input position `p = i + f` is the sum over k of `in[i - taps/2 + 1 + k] * c(f, k)`:
+/// the filter is centred on p and reads taps/2 frames ahead of it.
+struct Filter
+{
+    int taps;
+    const float* coefficients;
+
+    const float* row(int phase) const { return coefficients + phase * taps; }
+};
+
+/// @brief The filter for a quality and a ratio of input frames per output frame. The tables are
+/// computed once, before main(); nothing here allocates. LINEAR is a 2 tap triangle, the same
+/// for every ratio.
+Filter const& filter(Quality quality, float ratio);
+
+/// @brief Add numSamples resampled frames of 16 bit input to out, with a linear gain ramp
+/// `gain + i * gainStep`, scaled to [-1, 1].
+///
+/// @param position frame in `in` of the first output, advanced by increment per output
+/// @param increment input frames per output frame
+/// The filter reads `in` from `position - taps/2 + 1` to `position + numSamples * increment +
+/// taps/2`; the caller makes sure that is all there.
+using SampleKernel = void (*)(
+    float* out,
+    int numSamples,
+    const std::int16_t* in,
+    double& position,
+    float increment,
+    Filter const& filter,
+    float gain,
+    float gainStep
+);
+
+/// @brief The same for float input, without gain, for stream conversion.
+using StreamKernel = void (*)(
+    float* out,
+    int numSamples,
+    const float* in,
+    double& position,
+    float increment,
+    Filter const& filter
+);
+
+/// @brief The kernels of one instruction set. They vectorize across taps, so instruction sets
+/// sum in a different order and differ in the last bits.
+struct Kernels
+{
+    Isa isa;
+    SampleKernel samples;
+    StreamKernel stream;
+};
+
+/// @brief Kernels for the given instruction set. Falls back to scalar if it is not supported.
+Kernels const& kernels(Isa isa);
+
+/// @brief Kernels for the best instruction set of the running CPU, selected on the first call.
+Kernels const& kernels();
+
+std::string_view name(Quality quality);
+
+/// @brief Converts a mono stream from one sample rate to another, block by block.
+///
+/// Each process() call produces exactly the number of frames asked for and takes the input it
+/// needs for them, which required() tells beforehand. The filter looks taps/2 frames ahead, so
+/// the output lags the input by that much. Storage is allocated at construction only.
+class Converter
+{
+public:
+    /// @param maxOutput most frames a single process() call will be asked for; larger requests
+    /// are cut to it
+    Converter(double inputRate, double outputRate, Quality quality, int maxOutput);
+
+    /// @brief Input frames the next process() call needs to produce numOutput frames.
+    int required(int numOutput) const;
+
+    /// @brief Take required(numOutput) frames of input and write numOutput frames of output.
+    void process(const float* input, float* output, int numOutput);
+
+    /// @brief Input frames per output frame.
+    double ratio() const { return increment; }
+
+private:
+    Filter const* filter;
+    StreamKernel kernel;
+    double increment;
+    int maxOutput;
+    int history;  ///< frames the filter reads behind the position
+    double position;  ///< of the next output, in buffer
+    int filled = 0;   ///< frames in buffer
+    std::vector<float> buffer;
+};
+
+}  // namespace resampler
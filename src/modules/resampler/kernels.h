@@ -0,0 +1,151 @@
+#pragma once
+
+// Kernel bodies shared by all instruction sets. Each translation unit instantiates them with a
+// vector type V providing the handful of operations below. The vectors run across the taps of one
+// output, so unlike the oscillator kernels the instruction sets sum in different orders.
+//
+// As with the oscillator kernels, everything here has internal linkage, and nothing calls out to
+// inline functions of other headers: the translation units are built with different -m flags,
+// and the linker must not pick a copy of shared code built for the wrong instruction set.
+
+#include "resampler/resampler.h"
+
+#include <cstdint>
+
+namespace resampler::detail
+{
+namespace
+{
+constexpr float SAMPLE_SCALE = 1.f / 32768.f;
+
+struct Scalar
+{
+    using type = float;
+    static constexpr int width = 1;
+
+    static type set1(float x) { return x; }
+    static type load(const float* p) { return *p; }
+    static type load(const std::int16_t* p) { return static_cast<float>(*p); }
+    static type add(type a, type b) { return a + b; }
+    static type sub(type a, type b) { return a - b; }
+    static type mul(type a, type b) { return a * b; }
+    static float hsum(type a) { return a; }
+};
+
+/// @brief Filter::row(), for this translation unit only.
+inline const float* row_of(Filter const& filter, int phase) {
+    return filter.coefficients + phase * filter.taps;
+}
+
+/// @brief One output: the dot product of TAPS input frames from `in` with the coefficients
+/// interpolated between two adjacent rows.
+template <typename V, int TAPS, typename T>
+inline float convolve(const T* in, const float* row, const float* next, float weight) {
+    using F = typename V::type;
+    F const w = V::set1(weight);
+    F acc = V::set1(0.f);
+    int k = 0;
+    for (; k + V::width <= TAPS; k += V::width) {
+        F const a = V::load(row + k);
+        F const c = V::add(a, V::mul(V::sub(V::load(next + k), a), w));
+        acc = V::add(acc, V::mul(c, V::load(in + k)));
+    }
+    float sum = V::hsum(acc);
+    for (; k < TAPS; ++k) {
+        sum += (row[k] + (next[k] - row[k]) * weight) * Scalar::load(in + k);
+    }
+    return sum;
+}
+
+/// @brief The filter length is a template parameter so that the tap loops unroll.
+template <typename V, int TAPS, typename T>
+void resample(
+    float* out,
+    int numSamples,
+    const T* in,
+    double& position,
+    float increment,
+    Filter const& filter,
+    float scale,
+    float gain,
+    float gainStep
+) {
+    constexpr int behind = TAPS / 2 - 1;
+    double pos = position;
+    for (int i = 0; i < numSamples; ++i) {
+        auto const frame = static_cast<std::int64_t>(pos);
+        double const phase = (pos - static_cast<double>(frame)) * PHASES;
+        int const row = static_cast<int>(phase);
+        float const weight = static_cast<float>(phase - row);
+        float const sum = convolve<V, TAPS>(
+            in + frame - behind, row_of(filter, row), row_of(filter, row + 1), weight
+        );
+        out[i] += sum * scale * (gain + gainStep * static_cast<float>(i));
+        pos += increment;
+    }
+    position = pos;
+}
+
+template <typename T>
+using Resample = void (*)(
+    float* out,
+    int numSamples,
+    const T* in,
+    double& position,
+    float increment,
+    Filter const& filter,
+    float scale,
+    float gain,
+    float gainStep
+);
+
+/// @brief resample() for a filter's length.
+template <typename V, typename T>
+Resample<T> resample_for(int taps) {
+    switch (taps) {
+        case 2:
+            return resample<V, 2, T>;
+        case 8:
+            return resample<V, 8, T>;
+        case 16:
+            return resample<V, 16, T>;
+        default:
+            return resample<V, MAX_TAPS, T>;
+    }
+}
+
+template <typename V>
+void resample_samples(
+    float* out,
+    int numSamples,
+    const std::int16_t* in,
+    double& position,
+    float increment,
+    Filter const& filter,
+    float gain,
+    float gainStep
+) {
+    auto const run = resample_for<V, std::int16_t>(filter.taps);
+    run(out, numSamples, in, position, increment, filter, SAMPLE_SCALE, gain, gainStep);
+}
+
+template <typename V>
+void resample_stream(
+    float* out,
+    int numSamples,
+    const float* in,
+    double& position,
+    float increment,
+    Filter const& filter
+) {
+    auto const run = resample_for<V, float>(filter.taps);
+    run(out, numSamples, in, position, increment, filter, 1.f, 1.f, 0.f);
+}
+
+template <typename V>
+constexpr Kernels make_kernels(Isa isa) {
+    return {isa, resample_samples<V>, resample_stream<V>};
+}
+
+}  // namespace
+}  // namespace resampler::detail
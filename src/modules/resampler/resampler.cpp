@@ -0,0 +1,206 @@
+#include "resampler/resampler.h"
+
+#include "kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace resampler::detail
+{
+#ifdef RESAMPLER_X86
+// Defined in resampler_sse41.cpp and resampler_avx2.cpp
+extern Kernels const SSE41_KERNELS;
+extern Kernels const AVX2_KERNELS;
+#endif
+}  // namespace resampler::detail
+
+namespace
+{
+using resampler::Filter;
+using resampler::PHASES;
+
+constexpr int NUM_QUALITIES = 4;
+constexpr double PI = 3.141592653589793;
+
+/// @brief Design of the windowed-sinc presets, indexed by Quality.
+struct Design
+{
+    int taps;
+    double cutoff;  ///< fraction of the Nyquist frequency at ratio 1
+    double beta;    ///< Kaiser window shape: higher is more stopband, wider transition
+};
+constexpr Design DESIGNS[NUM_QUALITIES] = {
+    {.taps = 2, .cutoff = 1.0, .beta = 0.0},  // unused: LINEAR is a triangle
+    {.taps = 8, .cutoff = 0.75, .beta = 5.0},
+    {.taps = 16, .cutoff = 0.85, .beta = 7.0},
+    {.taps = resampler::MAX_TAPS, .cutoff = 0.92, .beta = 9.0},
+};
+
+/// @brief Zeroth order modified Bessel function of the first kind, by its power series.
+double bessel_i0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; ++k) {
+        term *= (x / (2 * k)) * (x / (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+/// @brief Fill the PHASES + 1 rows of one filter. Row j is the response at the taps for an output
+/// j / PHASES of a frame past the frame before the centre, normalized to unity gain at DC.
+void design(Design const& d, double ratio, bool linear, float* coefficients) {
+    int const half = d.taps / 2;
+    double const cutoff = d.cutoff / ratio;
+    double const windowScale = 1.0 / bessel_i0(d.beta);
+    for (int j = 0; j <= PHASES; ++j) {
+        double const fraction = double(j) / PHASES;
+        float* row = coefficients + j * d.taps;
+        double sum = 0.0;
+        for (int k = 0; k < d.taps; ++k) {
+            double const x = k - half + 1 - fraction;  // input frame minus output position
+            double h;
+            if (linear) {
+                h = std::max(0.0, 1.0 - std::abs(x));
+            } else {
+                double const t = std::clamp(x / half, -1.0, 1.0);
+                double const window = bessel_i0(d.beta * std::sqrt(1.0 - t * t)) * windowScale;
+                double const arg = PI * cutoff * x;
+                h = (x == 0.0 ? 1.0 : std::sin(arg) / arg) * window;
+            }
+            row[k] = float(h);
+            sum += h;
+        }
+        for (int k = 0; k < d.taps; ++k) {
+            row[k] = float(row[k] / sum);
+        }
+    }
+}
+
+/// @brief Every filter, in one allocation made during static initialization.
+struct Tables
+{
+    Tables() {
+        std::size_t size = 0;
+        for (Design const& d : DESIGNS) {
+            size += std::size_t(d.taps) * (PHASES + 1) * resampler::NUM_OCTAVES;
+        }
+        coefficients.resize(size);
+        float* next = coefficients.data();
+        for (int q = 0; q < NUM_QUALITIES; ++q) {
+            for (int octave = 0; octave < resampler::NUM_OCTAVES; ++octave) {
+                design(DESIGNS[q], double(1 << octave), q == 0, next);
+                filters[q][octave] = {.taps = DESIGNS[q].taps, .coefficients = next};
+                next += DESIGNS[q].taps * (PHASES + 1);
+            }
+        }
+    }
+
+    std::vector<float> coefficients;
+    std::array<std::array<Filter, resampler::NUM_OCTAVES>, NUM_QUALITIES> filters;
+};
+
+Tables const TABLES;
+
+constexpr resampler::Kernels SCALAR_KERNELS =
+    resampler::detail::make_kernels<resampler::detail::Scalar>(resampler::Isa::SCALAR);
+
+resampler::Kernels const& select_best() {
+    if (oscillator::is_supported(resampler::Isa::AVX2)) {
+        return resampler::kernels(resampler::Isa::AVX2);
+    }
+    if (oscillator::is_supported(resampler::Isa::SSE41)) {
+        return resampler::kernels(resampler::Isa::SSE41);
+    }
+    return SCALAR_KERNELS;
+}
+}  // namespace
+
+resampler::Filter const& resampler::filter(Quality quality, float ratio) {
+    // Nearest table on a log scale: the boundaries are at sqrt(2) and 2 sqrt(2).
+    int const octave = ratio < 1.4142135f ? 0 : ratio < 2.8284271f ? 1 : 2;
+    return TABLES.filters[int(quality)][octave];
+}
+
+resampler::Kernels const& resampler::kernels(Isa isa) {
+    if (!oscillator::is_supported(isa)) {
+        return SCALAR_KERNELS;
+    }
+    switch (isa) {
+#ifdef RESAMPLER_X86
+        case Isa::SSE41:
+            return detail::SSE41_KERNELS;
+        case Isa::AVX2:
+            return detail::AVX2_KERNELS;
+#endif
+        default:
+            return SCALAR_KERNELS;
+    }
+}
+
+resampler::Kernels const& resampler::kernels() {
+    static Kernels const& best = select_best();
+    return best;
+}
+
+std::string_view resampler::name(Quality quality) {
+    switch (quality) {
+        case Quality::LINEAR:
+            return "linear";
+        case Quality::FAST:
+            return "fast";
+        case Quality::GOOD:
+            return "good";
+        case Quality::BEST:
+            return "best";
+    }
+    return "unknown";
+}
+
+resampler::Converter::Converter(
+    double inputRate,
+    double outputRate,
+    Quality quality,
+    int maxOutput
+)
+: filter(&resampler::filter(quality, float(inputRate / outputRate)))
+, kernel(kernels().stream)
+, increment(double(float(inputRate / outputRate)))
+, maxOutput(maxOutput)
+, history(filter->taps / 2 - 1)
+, position(history)
+, filled(history)
+, buffer(std::size_t(2 * filter->taps + std::ceil(maxOutput * increment) + 4), 0.f) {}
+
+int resampler::Converter::required(int numOutput) const {
+    numOutput = std::min(numOutput, maxOutput);
+    if (numOutput <= 0) {
+        return 0;
+    }
+    // Step the way the kernel does, so that the last frame is the one it will read.
+    double last = position;
+    for (int i = 1; i < numOutput; ++i) {
+        last += float(increment);
+    }
+    auto const end = static_cast<int>(last) + filter->taps / 2 + 1;
+    return std::max(end - filled, 0);
+}
+
+void resampler::Converter::process(const float* input, float* output, int numOutput) {
+    numOutput = std::min(numOutput, maxOutput);
+    int const needed = required(numOutput);
+    std::copy_n(input, needed, buffer.data() + filled);
+    filled += needed;
+
+    std::fill_n(output, numOutput, 0.f);
+    kernel(output, numOutput, buffer.data(), position, float(increment), *filter);
+
+    // Drop what no later output reads.
+    int const consumed = std::min(static_cast<int>(position) - history, filled);
+    if (consumed > 0) {
+        std::copy(buffer.begin() + consumed, buffer.begin() + filled, buffer.begin());
+        filled -= consumed;
+        position -= consumed;
+    }
+}
@@ -0,0 +1,34 @@
+#include "kernels.h"
+
+#include <immintrin.h>
+
+namespace
+{
+struct Avx2
+{
+    using type = __m256;
+    static constexpr int width = 8;
+
+    static type set1(float x) { return _mm256_set1_ps(x); }
+    static type load(const float* p) { return _mm256_loadu_ps(p); }
+    static type load(const std::int16_t* p) {
+        auto const frames = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        return _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(frames));
+    }
+    static type add(type a, type b) { return _mm256_add_ps(a, b); }
+    static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+    static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+    static float hsum(type a) {
+        __m128 x = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+        x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+        x = _mm_add_ss(x, _mm_movehdup_ps(x));
+        return _mm_cvtss_f32(x);
+    }
+};
+}  // namespace
+
+namespace resampler::detail
+{
+extern Kernels const AVX2_KERNELS;
+Kernels const AVX2_KERNELS = make_kernels<Avx2>(Isa::AVX2);
+}  // namespace resampler::detail
@@ -0,0 +1,33 @@
+#include "kernels.h"
+
+#include <immintrin.h>
+
+namespace
+{
+struct Sse41
+{
+    using type = __m128;
+    static constexpr int width = 4;
+
+    static type set1(float x) { return _mm_set1_ps(x); }
+    static type load(const float* p) { return _mm_loadu_ps(p); }
+    static type load(const std::int16_t* p) {
+        auto const frames = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+        return _mm_cvtepi32_ps(_mm_cvtepi16_epi32(frames));
+    }
+    static type add(type a, type b) { return _mm_add_ps(a, b); }
+    static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+    static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+    static float hsum(type a) {
+        __m128 x = _mm_add_ps(a, _mm_movehl_ps(a, a));
+        x = _mm_add_ss(x, _mm_movehdup_ps(x));
+        return _mm_cvtss_f32(x);
+    }
+};
+}  // namespace
+
+namespace resampler::detail
+{
+extern Kernels const SSE41_KERNELS;
+Kernels const SSE41_KERNELS = make_kernels<Sse41>(Isa::SSE41);
+}  // namespace resampler::detail
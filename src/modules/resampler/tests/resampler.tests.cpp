@@ -0,0 +1,210 @@
+#include "resampler/resampler.h"
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+constexpr double SAMPLE_RATE = 48'000.0;
+constexpr double TWO_PI = 6.283185307179586;
+constexpr double AMPLITUDE = 16'384.0;
+
+constexpr resampler::Quality ALL_QUALITIES[] = {
+    resampler::Quality::LINEAR,
+    resampler::Quality::FAST,
+    resampler::Quality::GOOD,
+    resampler::Quality::BEST,
+};
+constexpr resampler::Isa ALL_ISAS[] = {
+    resampler::Isa::SCALAR,
+    resampler::Isa::SSE41,
+    resampler::Isa::AVX2,
+};
+
+std::vector<std::int16_t> sine(double freq, int numFrames) {
+    std::vector<std::int16_t> data(numFrames);
+    for (int i = 0; i < numFrames; ++i) {
+        data[i] = std::int16_t(std::lround(AMPLITUDE * std::sin(TWO_PI * freq * i / SAMPLE_RATE)));
+    }
+    return data;
+}
+
+/// @brief Resample a 16 bit sine from frame 64 on and return the largest deviation from the
+/// exact sine at the same positions, relative to the amplitude.
+double sine_error(resampler::Quality quality, double freq, float increment) {
+    constexpr int NUM_OUTPUT = 256;
+    auto const data = sine(freq, 1024);
+    auto const& filter = resampler::filter(quality, increment);
+    std::vector<float> out(NUM_OUTPUT);
+    double position = 64.0;
+    resampler::kernels().samples(
+        out.data(), NUM_OUTPUT, data.data(), position, increment, filter, 1.f, 0.f
+    );
+    double error = 0.0;
+    double expectedPosition = 64.0;
+    for (int i = 0; i < NUM_OUTPUT; ++i) {
+        double const expected = 0.5 * std::sin(TWO_PI * freq * expectedPosition / SAMPLE_RATE);
+        error = std::max(error, std::abs(out[i] - expected) / 0.5);
+        expectedPosition += increment;
+    }
+    CHECK(position == doctest::Approx(expectedPosition));
+    return error;
+}
+
+}  // namespace
+
+TEST_CASE("filter rows have unity gain and join up across frames") {
+    for (auto quality : ALL_QUALITIES) {
+        for (float ratio : {1.f, 2.f, 4.f}) {
+            auto const& filter = resampler::filter(quality, ratio);
+            CHECK(filter.taps >= 2);
+            for (int j = 0; j <= resampler::PHASES; ++j) {
+                double sum = 0.0;
+                for (int k = 0; k < filter.taps; ++k) {
+                    sum += filter.row(j)[k];
+                }
+                CHECK(sum == doctest::Approx(1.0).epsilon(1e-5));
+            }
+            // A whole frame on, the taps have moved one frame along.
+            for (int k = 0; k + 1 < filter.taps; ++k) {
+                CHECK(
+                    filter.row(resampler::PHASES)[k + 1] ==
+                    doctest::Approx(filter.row(0)[k]).epsilon(1e-5)
+                );
+            }
+        }
+    }
+    CHECK(resampler::filter(resampler::Quality::GOOD, 0.5f).taps == 16);
+    CHECK(resampler::filter(resampler::Quality::BEST, 8.f).taps == 32);
+}
+
+TEST_CASE("every quality reproduces a sine between the samples") {
+    for (float increment : {0.77f, 1.f, 1.3f}) {
+        CHECK(sine_error(resampler::Quality::LINEAR, 1'000.0, increment) < 3e-3);
+        CHECK(sine_error(resampler::Quality::FAST, 1'000.0, increment) < 1e-3);
+        CHECK(sine_error(resampler::Quality::GOOD, 1'000.0, increment) < 3e-4);
+        CHECK(sine_error(resampler::Quality::BEST, 1'000.0, increment) < 1e-4);
+    }
+    // Higher up, only the windowed sincs stay accurate.
+    CHECK(sine_error(resampler::Quality::LINEAR, 8'000.0, 0.77f) > 2e-2);
+    CHECK(sine_error(resampler::Quality::GOOD, 8'000.0, 0.77f) < 1e-3);
+    CHECK(sine_error(resampler::Quality::BEST, 8'000.0, 0.77f) < 2e-4);
+}
+
+TEST_CASE("pitching up filters what would alias") {
+    // 18 kHz an octave up is 36 kHz, which would fold back to 12 kHz.
+    auto const data = sine(18'000.0, 2048);
+    auto peak = [&](resampler::Quality quality) {
+        std::vector<float> out(512);
+        double position = 64.0;
+        resampler::kernels().samples(
+            out.data(), 512, data.data(), position, 2.f, resampler::filter(quality, 2.f), 1.f, 0.f
+        );
+        float largest = 0.f;
+        for (float x : out) {
+            largest = std::max(largest, std::abs(x));
+        }
+        return largest / 0.5f;
+    };
+    CHECK(peak(resampler::Quality::LINEAR) > 0.5f);
+    CHECK(peak(resampler::Quality::FAST) < 0.01f);
+    CHECK(peak(resampler::Quality::GOOD) < 1e-3f);
+    CHECK(peak(resampler::Quality::BEST) < 1e-4f);
+}
+
+TEST_CASE("instruction sets agree with scalar") {
+    auto const data = sine(3'000.0, 1024);
+    std::vector<float> floats(data.begin(), data.end());
+    for (auto quality : ALL_QUALITIES) {
+        auto const& filter = resampler::filter(quality, 1.1f);
+        std::vector<float> expected(300, 0.25f);
+        double expectedPosition = 40.3;
+        auto const& scalar = resampler::kernels(resampler::Isa::SCALAR);
+        scalar.samples(
+            expected.data(), 300, data.data(), expectedPosition, 1.1f, filter, 0.5f, 1e-3f
+        );
+        std::vector<float> expectedStream(300, 0.f);
+        double streamPosition = 40.3;
+        scalar.stream(expectedStream.data(), 300, floats.data(), streamPosition, 1.1f, filter);
+
+        for (auto isa : ALL_ISAS) {
+            auto const& kernels = resampler::kernels(isa);
+            std::vector<float> out(300, 0.25f);
+            double position = 40.3;
+            kernels.samples(out.data(), 300, data.data(), position, 1.1f, filter, 0.5f, 1e-3f);
+            CHECK(position == expectedPosition);
+            std::vector<float> stream(300, 0.f);
+            position = 40.3;
+            kernels.stream(stream.data(), 300, floats.data(), position, 1.1f, filter);
+            for (int i = 0; i < 300; ++i) {
+                CHECK(std::abs(out[i] - expected[i]) < 1e-6f);
+                CHECK(std::abs(stream[i] - expectedStream[i]) < 2e-2f);  // of 16384
+            }
+        }
+    }
+}
+
+TEST_CASE("the converter changes the rate of a stream") {
+    constexpr double OUTPUT_RATE = 44'100.0;
+    constexpr double FREQ = 1'000.0;
+    constexpr int BLOCK = 441;
+    resampler::Converter converter(SAMPLE_RATE, OUTPUT_RATE, resampler::Quality::GOOD, BLOCK);
+    CHECK(converter.ratio() == doctest::Approx(SAMPLE_RATE / OUTPUT_RATE));
+
+    std::int64_t consumed = 0;
+    std::vector<float> input;
+    std::vector<float> output(BLOCK);
+    double error = 0.0;
+    for (int block = 0; block < 20; ++block) {
+        int const needed = converter.required(BLOCK);
+        input.resize(needed);
+        for (int i = 0; i < needed; ++i) {
+            input[i] = float(std::sin(TWO_PI * FREQ * double(consumed + i) / SAMPLE_RATE));
+        }
+        consumed += needed;
+        converter.process(input.data(), output.data(), BLOCK);
+        for (int i = 0; i < BLOCK; ++i) {
+            double const t = double(block * BLOCK + i) / OUTPUT_RATE;
+            if (block > 0) {  // past the start, where the filter still reads zeros before it
+                error = std::max(error, std::abs(output[i] - std::sin(TWO_PI * FREQ * t)));
+            }
+        }
+        // It takes no more than it needs: the input runs taps/2 frames ahead of the output.
+        double const aheadOfOutput = double(consumed) - (block + 1) * BLOCK * converter.ratio();
+        CHECK(aheadOfOutput >= 0.0);
+        CHECK(aheadOfOutput < 10.0);
+    }
+    CHECK(error < 1e-3);
+}
+
+TEST_CASE("the converter's output does not depend on the block sizes") {
+    constexpr int TOTAL = 2000;
+    std::vector<float> input(5000);
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        input[i] = float(std::sin(0.01 * double(i)) + 0.3 * std::sin(0.37 * double(i)));
+    }
+    auto convert = [&](std::vector<int> const& sizes) {
+        resampler::Converter converter(48'000, 22'050, resampler::Quality::BEST, 512);
+        std::vector<float> output(TOTAL);
+        std::size_t consumed = 0;
+        int produced = 0;
+        for (std::size_t b = 0; produced < TOTAL; ++b) {
+            int const size = std::min(sizes[b % sizes.size()], TOTAL - produced);
+            int const needed = converter.required(size);
+            REQUIRE(consumed + needed <= input.size());
+            converter.process(input.data() + consumed, output.data() + produced, size);
+            consumed += needed;
+            produced += size;
+        }
+        return output;
+    };
+    auto const whole = convert({512});
+    auto const pieces = convert({1, 7, 300, 0, 64, 129});
+    for (int i = 0; i < TOTAL; ++i) {
+        CHECK(std::abs(pieces[i] - whole[i]) < 1e-6f);
+    }
+}
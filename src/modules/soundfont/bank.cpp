@@ -0,0 +1,427 @@
+#include "soundfont/bank.h"
+
+#include "logger/logger.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <optional>
+
+namespace
+{
+constexpr std::size_t CHUNK_HEADER_SIZE = 8;
+
+// Record sizes of the pdta sub-chunks
+constexpr std::size_t PHDR_SIZE = 38;
+constexpr std::size_t BAG_SIZE = 4;
+constexpr std::size_t GEN_SIZE = 4;
+constexpr std::size_t INST_SIZE = 22;
+constexpr std::size_t SHDR_SIZE = 46;
+
+constexpr std::uint16_t PERCUSSION_BANK = 128;
+constexpr std::uint16_t ROM_SAMPLE = 0x8000;  // sampleType flag: data is in a synth's ROM
+
+/// @brief Generator operators the bank resolves, as numbered by the SoundFont 2.04 spec.
+enum Generator : std::uint16_t
+{
+    START_OFFSET = 0,
+    END_OFFSET = 1,
+    LOOP_START_OFFSET = 2,
+    LOOP_END_OFFSET = 3,
+    START_COARSE_OFFSET = 4,
+    END_COARSE_OFFSET = 12,
+    INSTRUMENT = 41,
+    KEY_RANGE = 43,
+    VELOCITY_RANGE = 44,
+    LOOP_START_COARSE_OFFSET = 45,
+    INITIAL_ATTENUATION = 48,
+    LOOP_END_COARSE_OFFSET = 50,
+    COARSE_TUNE = 51,
+    FINE_TUNE = 52,
+    SAMPLE_ID = 53,
+    SAMPLE_MODES = 54,
+    OVERRIDING_ROOT_KEY = 58,
+    NUM_GENERATORS = 61
+};
+
+constexpr std::int32_t COARSE_OFFSET = 32768;  // frames per unit of the coarse address offsets
+
+std::uint16_t read_le16(const std::uint8_t* p) {
+    return std::uint16_t(p[0] | p[1] << 8);
+}
+
+std::uint32_t read_le32(const std::uint8_t* p) {
+    return std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 | std::uint32_t(p[2]) << 16 |
+           std::uint32_t(p[3]) << 24;
+}
+
+/// @brief The data of the first chunk with this id among the chunks of a RIFF list.
+std::optional<std::span<const std::uint8_t>> find_chunk(
+    std::span<const std::uint8_t> list,
+    char const (&id)[5]
+) {
+    const std::uint8_t* pos = list.data();
+    const std::uint8_t* end = pos + list.size();
+    while (std::size_t(end - pos) >= CHUNK_HEADER_SIZE) {
+        std::uint32_t const size = read_le32(pos + 4);
+        if (size > std::size_t(end - pos) - CHUNK_HEADER_SIZE) {
+            return std::nullopt;
+        }
+        if (std::memcmp(pos, id, 4) == 0) {
+            return std::span(pos + CHUNK_HEADER_SIZE, size);
+        }
+        pos += CHUNK_HEADER_SIZE + size + (size & 1);  // chunks are padded to an even size
+    }
+    return std::nullopt;
+}
+
+/// @brief The content of the LIST chunk of this type, past the type.
+std::optional<std::span<const std::uint8_t>> find_list(
+    std::span<const std::uint8_t> list,
+    char const (&type)[5]
+) {
+    const std::uint8_t* pos = list.data();
+    const std::uint8_t* end = pos + list.size();
+    while (std::size_t(end - pos) >= CHUNK_HEADER_SIZE + 4) {
+        std::uint32_t const size = read_le32(pos + 4);
+        if (size > std::size_t(end - pos) - CHUNK_HEADER_SIZE) {
+            return std::nullopt;
+        }
+        if (std::memcmp(pos, "LIST", 4) == 0 && size >= 4 &&
+            std::memcmp(pos + CHUNK_HEADER_SIZE, type, 4) == 0) {
+            return std::span(pos + CHUNK_HEADER_SIZE + 4, size - 4);
+        }
+        pos += CHUNK_HEADER_SIZE + size + (size & 1);
+    }
+    return std::nullopt;
+}
+
+/// @brief The generators of one zone, global zone defaults applied.
+struct Generators
+{
+    std::array<std::int16_t, NUM_GENERATORS> value{};
+    std::array<bool, NUM_GENERATORS> set{};
+
+    bool has(Generator g) const { return set[g]; }
+    std::int32_t operator[](Generator g) const { return value[g]; }
+    std::uint8_t low(Generator g) const { return std::uint8_t(value[g] & 0xFF); }
+    std::uint8_t high(Generator g) const { return std::uint8_t(std::uint16_t(value[g]) >> 8); }
+};
+
+/// @brief The records of the preset (phdr, pbag, pgen) or instrument (inst, ibag, igen) level.
+struct Level
+{
+    std::span<const std::uint8_t> headers;
+    std::size_t headerSize;
+    std::size_t bagOffset;  ///< of the first bag index within a header
+    std::span<const std::uint8_t> bags;
+    std::span<const std::uint8_t> gens;
+
+    /// @brief Headers, without the terminal record.
+    std::size_t size() const { return headers.size() / headerSize - 1; }
+    const std::uint8_t* header(std::size_t i) const { return headers.data() + i * headerSize; }
+    std::size_t num_bags() const { return bags.size() / BAG_SIZE; }
+    std::size_t num_gens() const { return gens.size() / GEN_SIZE; }
+
+    std::size_t first_bag(std::size_t i) const { return read_le16(header(i) + bagOffset); }
+
+    /// @brief Read zone `bag` over the defaults. Returns false if its generators are out of range.
+    bool read_zone(std::size_t bag, Generators& out) const {
+        if (bag + 1 >= num_bags()) {
+            return false;
+        }
+        std::size_t const first = read_le16(bags.data() + bag * BAG_SIZE);
+        std::size_t const last = read_le16(bags.data() + (bag + 1) * BAG_SIZE);
+        if (first > last || last > num_gens()) {
+            return false;
+        }
+        for (std::size_t g = first; g < last; ++g) {
+            const std::uint8_t* gen = gens.data() + g * GEN_SIZE;
+            std::uint16_t const op = read_le16(gen);
+            if (op < NUM_GENERATORS) {
+                out.value[op] = std::int16_t(read_le16(gen + 2));
+                out.set[op] = true;
+            }
+        }
+        return true;
+    }
+};
+
+bool valid(Level const& level) {
+    return level.headers.size() % level.headerSize == 0 &&
+           level.headers.size() >= 2 * level.headerSize && level.bags.size() % BAG_SIZE == 0 &&
+           level.gens.size() % GEN_SIZE == 0;
+}
+
+/// @brief Intersect the ranges of generator g with each other and with 0-127. Returns false if
+/// nothing is left: the file's bytes go up to 255, but keys and velocities do not.
+bool intersect(Generators const& a, Generators const& b, Generator g, std::uint8_t (&out)[2]) {
+    out[0] = std::max(a.has(g) ? a.low(g) : 0, b.has(g) ? b.low(g) : 0);
+    out[1] = std::min<int>(
+        std::min<int>(a.has(g) ? a.high(g) : 127, 127),
+        std::min<int>(b.has(g) ? b.high(g) : 127, 127)
+    );
+    return out[0] <= out[1];
+}
+
+}  // namespace
+
+bool soundfont::Bank::open(std::string const& path) {
+    // Random access: the kernel must not read ahead through hundreds of MB of samples.
+    if (!mapping.open(path, midi::MappedFile::Access::RANDOM)) {
+        return false;
+    }
+    if (!parse(mapping.bytes())) {
+        logger::log("{} is not a SoundFont 2 bank", path);
+        mapping.close();
+        return false;
+    }
+    return true;
+}
+
+bool soundfont::Bank::parse(std::span<const std::uint8_t> bytes) {
+    zones.clear();
+    keyZones.clear();
+    keyIndex.assign(NUM_PROGRAMS * NUM_KEYS + 1, 0);
+    sampleData = nullptr;
+    numSamples = 0;
+
+    if (bytes.size() < CHUNK_HEADER_SIZE + 4 || std::memcmp(bytes.data(), "RIFF", 4) != 0 ||
+        std::memcmp(bytes.data() + CHUNK_HEADER_SIZE, "sfbk", 4) != 0) {
+        logger::log("Missing RIFF sfbk header");
+        return false;
+    }
+    std::size_t const riffSize = std::min<std::size_t>(
+        read_le32(bytes.data() + 4),
+        bytes.size() - CHUNK_HEADER_SIZE
+    );
+    if (riffSize < 4) {
+        logger::log("Empty RIFF chunk");
+        return false;
+    }
+    auto const riff = bytes.subspan(CHUNK_HEADER_SIZE + 4, riffSize - 4);
+
+    auto const sdta = find_list(riff, "sdta");
+    auto const pdta = find_list(riff, "pdta");
+    if (!sdta || !pdta) {
+        logger::log("Missing sdta or pdta list");
+        return false;
+    }
+    if (auto smpl = find_chunk(*sdta, "smpl")) {
+        if (reinterpret_cast<std::uintptr_t>(smpl->data()) % alignof(std::int16_t) != 0) {
+            logger::log("Misaligned smpl chunk");
+            return false;
+        }
+        sampleData = reinterpret_cast<const std::int16_t*>(smpl->data());
+        numSamples = smpl->size() / sizeof(std::int16_t);
+    }
+
+    auto chunk = [&](char const (&id)[5]) {
+        return find_chunk(*pdta, id).value_or(std::span<const std::uint8_t>{});
+    };
+    Level const presets{chunk("phdr"), PHDR_SIZE, 24, chunk("pbag"), chunk("pgen")};
+    Level const instruments{chunk("inst"), INST_SIZE, 20, chunk("ibag"), chunk("igen")};
+    auto const samples = chunk("shdr");
+    if (!valid(presets) || !valid(instruments) || samples.size() < 2 * SHDR_SIZE) {
+        logger::log("Missing or malformed preset, instrument or sample records");
+        return false;
+    }
+    std::size_t const numSampleHeaders = samples.size() / SHDR_SIZE - 1;
+
+    // The preset of each lookup slot: bank 0 if there, else the lowest bank. The percussion slot
+    // takes the lowest program of bank 128.
+    std::array<std::size_t, NUM_PROGRAMS> chosen;
+    std::array<int, NUM_PROGRAMS> rank;
+    chosen.fill(presets.size());
+    rank.fill(std::numeric_limits<int>::max());
+    for (std::size_t p = 0; p < presets.size(); ++p) {
+        std::uint16_t const program = read_le16(presets.header(p) + 20);
+        std::uint16_t const bank = read_le16(presets.header(p) + 22);
+        int slot = program;
+        int slotRank = bank;
+        if (bank == PERCUSSION_BANK) {
+            slot = PERCUSSION;
+            slotRank = program;
+        } else if (program >= NUM_KEYS || bank > PERCUSSION_BANK) {
+            continue;
+        }
+        if (slotRank < rank[slot]) {
+            rank[slot] = slotRank;
+            chosen[slot] = p;
+        }
+    }
+
+    std::vector<std::uint16_t> zoneSlots;
+    for (int slot = 0; slot < NUM_PROGRAMS; ++slot) {
+        std::size_t const p = chosen[slot];
+        if (p == presets.size()) {
+            continue;
+        }
+        // A first zone without an instrument is the global zone, defaults for the others.
+        Generators presetGlobal;
+        std::size_t bag = presets.first_bag(p);
+        std::size_t const presetBagEnd = presets.first_bag(p + 1);
+        for (; bag < presetBagEnd; ++bag) {
+            Generators presetZone = presetGlobal;
+            if (!presets.read_zone(bag, presetZone)) {
+                break;
+            }
+            if (!presetZone.has(INSTRUMENT)) {
+                if (bag == presets.first_bag(p)) {
+                    presetGlobal = presetZone;
+                }
+                continue;
+            }
+            std::size_t const inst = std::uint16_t(presetZone[INSTRUMENT]);
+            if (inst >= instruments.size()) {
+                continue;
+            }
+
+            Generators instrumentGlobal;
+            std::size_t const instBagBegin = instruments.first_bag(inst);
+            std::size_t const instBagEnd = instruments.first_bag(inst + 1);
+            for (std::size_t ibag = instBagBegin; ibag < instBagEnd; ++ibag) {
+                Generators gens = instrumentGlobal;
+                if (!instruments.read_zone(ibag, gens)) {
+                    break;
+                }
+                if (!gens.has(SAMPLE_ID)) {
+                    if (ibag == instBagBegin) {
+                        instrumentGlobal = gens;
+                    }
+                    continue;
+                }
+                std::size_t const id = std::uint16_t(gens[SAMPLE_ID]);
+                std::uint8_t keys[2];
+                std::uint8_t velocities[2];
+                if (id >= numSampleHeaders || !intersect(presetZone, gens, KEY_RANGE, keys) ||
+                    !intersect(presetZone, gens, VELOCITY_RANGE, velocities)) {
+                    continue;
+                }
+
+                const std::uint8_t* shdr = samples.data() + id * SHDR_SIZE;
+                if (read_le16(shdr + 44) & ROM_SAMPLE) {
+                    continue;
+                }
+                auto offset = [&](std::uint32_t base, Generator fine, Generator coarse) {
+                    std::int64_t const frame = std::int64_t(base) + gens[fine] +
+                                               std::int64_t(gens[coarse]) * COARSE_OFFSET;
+                    return std::uint32_t(std::clamp<std::int64_t>(frame, 0, numSamples));
+                };
+                Zone zone{
+                    .start = offset(read_le32(shdr + 20), START_OFFSET, START_COARSE_OFFSET),
+                    .end = offset(read_le32(shdr + 24), END_OFFSET, END_COARSE_OFFSET),
+                    .loopStart = offset(
+                        read_le32(shdr + 28),
+                        LOOP_START_OFFSET,
+                        LOOP_START_COARSE_OFFSET
+                    ),
+                    .loopEnd = offset(
+                        read_le32(shdr + 32),
+                        LOOP_END_OFFSET,
+                        LOOP_END_COARSE_OFFSET
+                    ),
+                    .rootKey = 0.f,
+                    .sampleRate = float(read_le32(shdr + 36)),
+                    .gain = 1.f,
+                    .loop = LoopMode::NONE,
+                    .keyLow = keys[0],
+                    .keyHigh = keys[1],
+                    .velocityLow = velocities[0],
+                    .velocityHigh = velocities[1],
+                };
+                if (zone.end < zone.start + 2 || zone.sampleRate <= 0.f) {
+                    continue;  // interpolation needs two frames
+                }
+
+                // Tuning raises the pitch, which is the same as lowering the root key.
+                int root = shdr[40] <= 127 ? shdr[40] : 60;
+                if (gens.has(OVERRIDING_ROOT_KEY) && gens[OVERRIDING_ROOT_KEY] >= 0) {
+                    root = gens[OVERRIDING_ROOT_KEY];
+                }
+                int const cents = (gens[COARSE_TUNE] + presetZone[COARSE_TUNE]) * 100 +
+                                  gens[FINE_TUNE] + presetZone[FINE_TUNE] +
+                                  std::int8_t(shdr[41]);
+                zone.rootKey = float(root) - float(cents) / 100.f;
+
+                // Attenuation is in centibels, and only ever attenuates.
+                int const attenuation =
+                    std::max(0, gens[INITIAL_ATTENUATION] + presetZone[INITIAL_ATTENUATION]);
+                zone.gain = std::pow(10.f, float(-attenuation) / 200.f);
+
+                int const mode = gens[SAMPLE_MODES] & 3;
+                bool const loopValid = zone.start <= zone.loopStart &&
+                                       zone.loopStart + 1 < zone.loopEnd &&
+                                       zone.loopEnd <= zone.end;
+                if (loopValid && mode == 1) {
+                    zone.loop = LoopMode::CONTINUOUS;
+                } else if (loopValid && mode == 3) {
+                    zone.loop = LoopMode::UNTIL_RELEASE;
+                }
+
+                zones.push_back(zone);
+                zoneSlots.push_back(std::uint16_t(slot));
+            }
+        }
+    }
+
+    // Counting sort of the zones into one group per (program, key), keeping file order.
+    for (std::size_t z = 0; z < zones.size(); ++z) {
+        for (int key = zones[z].keyLow; key <= zones[z].keyHigh; ++key) {
+            ++keyIndex[zoneSlots[z] * NUM_KEYS + key + 1];
+        }
+    }
+    for (std::size_t i = 1; i < keyIndex.size(); ++i) {
+        keyIndex[i] += keyIndex[i - 1];
+    }
+    keyZones.resize(keyIndex.back());
+    std::vector<std::uint32_t> fill(keyIndex.begin(), keyIndex.end() - 1);
+    for (std::size_t z = 0; z < zones.size(); ++z) {
+        for (int key = zones[z].keyLow; key <= zones[z].keyHigh; ++key) {
+            keyZones[fill[zoneSlots[z] * NUM_KEYS + key]++] = std::uint32_t(z);
+        }
+    }
+    return true;
+}
+
+std::span<const std::uint32_t> soundfont::Bank::zones_for(int program, std::uint8_t key) const {
+    if (program < 0 || program >= NUM_PROGRAMS || key >= NUM_KEYS || keyIndex.empty()) {
+        return {};
+    }
+    std::size_t const slot = std::size_t(program) * NUM_KEYS + key;
+    return std::span(keyZones).subspan(keyIndex[slot], keyIndex[slot + 1] - keyIndex[slot]);
+}
+
+soundfont::Zone const* soundfont::Bank::find(
+    int program,
+    std::uint8_t key,
+    std::uint8_t velocity
+) const {
+    for (std::uint32_t z : zones_for(program, key)) {
+        Zone const& zone = zones[z];
+        if (velocity >= zone.velocityLow && velocity <= zone.velocityHigh) {
+            return &zone;
+        }
+    }
+    return nullptr;
+}
+
+void soundfont::Bank::prefetch(int program) const {
+    if (!mapping.is_open()) {
+        return;
+    }
+    for (int key = 0; key < NUM_KEYS; ++key) {
+        for (std::uint32_t z : zones_for(program, std::uint8_t(key))) {
+            Zone const& zone = zones[z];
+            if (zone.keyLow != key) {
+                continue;  // already done at its lowest key
+            }
+            mapping.prefetch({
+                reinterpret_cast<const std::uint8_t*>(sampleData + zone.start),
+                (zone.end - zone.start) * sizeof(std::int16_t),
+            });
+        }
+    }
+}
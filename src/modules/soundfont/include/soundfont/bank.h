@@ -0,0 +1,89 @@
+#pragma once
+
+#include "midi/mapped_file.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace soundfont
+{
+/// @brief Lookup slot of the percussion kit, bank 128 program 0 in the SoundFont, which General
+/// MIDI plays on channel 10. Programs 0 to 127 are the melodic presets of bank 0.
+constexpr int PERCUSSION = 128;
+constexpr int NUM_PROGRAMS = 129;
+constexpr int NUM_KEYS = 128;
+
+/// @brief How a zone's sample loops, from the sampleModes generator.
+enum class LoopMode : std::uint8_t
+{
+    NONE,
+    CONTINUOUS,     ///< loops for as long as the voice sounds
+    UNTIL_RELEASE,  ///< loops while the key is held, then plays on to the end of the sample
+};
+
+/// @brief What to play for a range of keys and velocities of a preset. Resolved at load time from
+/// the preset, instrument and sample records, so playing a note needs nothing else.
+struct Zone
+{
+    std::uint32_t start;      ///< frames into Bank::samples()
+    std::uint32_t end;        ///< one past the last frame
+    std::uint32_t loopStart;  ///< first frame of the loop
+    std::uint32_t loopEnd;    ///< one past the last frame of the loop
+    float rootKey;            ///< key the sample sounds at its recorded pitch, tuning included
+    float sampleRate;
+    float gain;  ///< from the initial attenuation
+    LoopMode loop;
+    std::uint8_t keyLow;
+    std::uint8_t keyHigh;
+    std::uint8_t velocityLow;
+    std::uint8_t velocityHigh;
+};
+
+/// @brief A SoundFont 2 bank, resolved into zones looked up by (program, key, velocity).
+///
+/// The file is memory-mapped: opening it reads only the preset data (pdta), and sample data is
+/// paged in as voices play it, so memory use follows the samples actually played rather than the
+/// size of the bank. The first note of a sample may still wait for the disk; prefetch() the
+/// programs about to be used to avoid that on the audio thread.
+///
+/// Only what the engine plays is resolved: key and velocity ranges, the sample with its offsets,
+/// loop and root key, tuning and initial attenuation. Envelopes, filters and modulators are left to
+/// the engine. Where several zones overlap, e.g. the two halves of a stereo sample, the first one
+/// is played.
+class Bank
+{
+public:
+    /// @brief Map and index a .sf2 file. Returns false if it cannot be read or is not a SoundFont.
+    bool open(std::string const& path);
+
+    /// @brief Index a SoundFont held in memory; bytes must outlive the bank. Samples are 16 bit
+    /// little-endian, like the host.
+    bool parse(std::span<const std::uint8_t> bytes);
+
+    /// @brief The zone to play, or nullptr if the program has nothing for this key and velocity.
+    /// Programs missing from bank 0 fall back to the same program of the lowest other bank.
+    Zone const* find(int program, std::uint8_t key, std::uint8_t velocity) const;
+
+    /// @brief Start paging in every sample the program plays, in the background.
+    void prefetch(int program) const;
+
+    std::span<const std::int16_t> samples() const { return {sampleData, numSamples}; }
+    std::size_t num_zones() const { return zones.size(); }
+
+private:
+    std::span<const std::uint32_t> zones_for(int program, std::uint8_t key) const;
+
+    midi::MappedFile mapping;
+    const std::int16_t* sampleData = nullptr;
+    std::size_t numSamples = 0;
+
+    std::vector<Zone> zones;
+    /// @brief Indices into zones, grouped by program then key, each group in file order.
+    std::vector<std::uint32_t> keyZones;
+    /// @brief Where the group of each (program, key) starts in keyZones, plus an end marker.
+    std::vector<std::uint32_t> keyIndex;
+};
+
+}  // namespace soundfont
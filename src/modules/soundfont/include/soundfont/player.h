@@ -0,0 +1,34 @@
+#pragma once
+
+#include "resampler/resampler.h"
+#include "soundfont/bank.h"
+
+#include <cstdint>
+#include <span>
+
+namespace soundfont
+{
+/// @brief Add a zone's sample to a buffer, resampled at the given quality, with the gain ramping
+/// linearly from gain by gainStep per sample like the oscillator kernels.
+///
+/// @param samples Bank::samples() of the bank the zone belongs to
+/// @param position frame in samples, fractional; advanced by increment per output sample
+/// @param looping whether to wrap from the zone's loop end to its loop start; ignored if the zone
+/// has no loop
+/// @param quality LINEAR interpolates between two frames; the others filter, which pitching up
+/// needs not to alias. Frames the filter reads before the sample start or past its end are silent.
+/// @return samples rendered, fewer than numSamples once the end of the sample is reached
+int play(
+    float* buffer,
+    int numSamples,
+    std::span<const std::int16_t> samples,
+    Zone const& zone,
+    double& position,
+    float increment,
+    float gain,
+    float gainStep,
+    bool looping,
+    resampler::Quality quality = resampler::Quality::LINEAR
+);
+
+}  // namespace soundfont
@@ -0,0 +1,141 @@
+#include "soundfont/player.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr float SAMPLE_SCALE = 1.f / 32768.f;
+
+int play_linear(
+    float* buffer,
+    int numSamples,
+    const std::int16_t* data,
+    soundfont::Zone const& zone,
+    double& position,
+    float increment,
+    float gain,
+    float gainStep,
+    bool looping
+) {
+    double const loopLength = double(zone.loopEnd - zone.loopStart);
+    // Interpolating frame i needs frame i + 1: the loop start past the loop end, else the next.
+    double const last = looping ? double(zone.loopEnd) : double(zone.end - 1);
+
+    double pos = position;
+    int i = 0;
+    for (; i < numSamples; ++i) {
+        if (pos >= last) {
+            if (!looping) {
+                break;
+            }
+            pos -= loopLength * std::floor((pos - zone.loopStart) / loopLength);
+        }
+        auto const frame = static_cast<std::uint32_t>(pos);
+        std::uint32_t const next =
+            looping && frame + 1 == zone.loopEnd ? zone.loopStart : frame + 1;
+        auto const fraction = static_cast<float>(pos - frame);
+        float const a = data[frame];
+        float const b = data[next];
+        buffer[i] += (a + (b - a) * fraction) * SAMPLE_SCALE * (gain + gainStep * float(i));
+        pos += increment;
+    }
+    position = pos;
+    return i;
+}
+
+/// @brief Polyphase playback. Runs of outputs whose filter stays inside the sample, or inside the
+/// loop, go straight to the vector kernel; the few near an edge get their taps copied out with the
+/// loop wrapped and silence outside the sample.
+int play_filtered(
+    float* buffer,
+    int numSamples,
+    const std::int16_t* data,
+    soundfont::Zone const& zone,
+    double& position,
+    float increment,
+    float gain,
+    float gainStep,
+    bool looping,
+    resampler::Filter const& filter
+) {
+    auto const kernel = resampler::kernels().samples;
+    int const ahead = filter.taps / 2;
+    int const behind = ahead - 1;
+    std::int64_t const loopLength = std::int64_t(zone.loopEnd) - zone.loopStart;
+    // Same end as linear interpolation, so both qualities play a sample for as long.
+    double const last = looping ? double(zone.loopEnd) : double(zone.end - 1);
+    double const limit = looping ? double(zone.loopEnd) : double(zone.end);
+
+    double pos = position;
+    int i = 0;
+    while (i < numSamples) {
+        if (pos >= last) {
+            if (!looping) {
+                break;
+            }
+            pos -= double(loopLength) * std::floor((pos - zone.loopStart) / double(loopLength));
+        }
+        auto const frame = static_cast<std::int64_t>(pos);
+
+        if (frame - behind >= zone.start) {
+            // One output short of the edge, to stay clear of rounding in the kernel's stepping.
+            double const room = std::ceil((limit - ahead - pos) / increment) - 1.0;
+            int const run = static_cast<int>(std::min(room, double(numSamples - i)));
+            if (run > 0) {
+                float const runGain = gain + gainStep * float(i);
+                kernel(buffer + i, run, data, pos, increment, filter, runGain, gainStep);
+                i += run;
+                continue;
+            }
+        }
+
+        std::int16_t window[resampler::MAX_TAPS];
+        for (int k = 0; k < filter.taps; ++k) {
+            std::int64_t f = frame - behind + k;
+            if (looping && f >= zone.loopEnd) {
+                f -= loopLength * (1 + (f - zone.loopEnd) / loopLength);
+            }
+            window[k] = f >= zone.start && f < zone.end ? data[f] : std::int16_t(0);
+        }
+        double local = behind + (pos - double(frame));
+        kernel(buffer + i, 1, window, local, increment, filter, gain + gainStep * float(i), 0.f);
+        pos += increment;
+        ++i;
+    }
+    position = pos;
+    return i;
+}
+}  // namespace
+
+int soundfont::play(
+    float* buffer,
+    int numSamples,
+    std::span<const std::int16_t> samples,
+    Zone const& zone,
+    double& position,
+    float increment,
+    float gain,
+    float gainStep,
+    bool looping,
+    resampler::Quality quality
+) {
+    looping = looping && zone.loop != LoopMode::NONE;
+    if (quality == resampler::Quality::LINEAR) {
+        return play_linear(
+            buffer, numSamples, samples.data(), zone, position, increment, gain, gainStep, looping
+        );
+    }
+    return play_filtered(
+        buffer,
+        numSamples,
+        samples.data(),
+        zone,
+        position,
+        increment,
+        gain,
+        gainStep,
+        looping,
+        resampler::filter(quality, increment)
+    );
+}
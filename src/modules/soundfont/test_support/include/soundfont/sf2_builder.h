@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using Bytes = std::vector<std::uint8_t>;
+
+// Generator operators used by the tests, numbered as in the SoundFont 2.04 spec
+constexpr std::uint16_t GEN_START_OFFSET = 0;
+constexpr std::uint16_t GEN_INSTRUMENT = 41;
+constexpr std::uint16_t GEN_KEY_RANGE = 43;
+constexpr std::uint16_t GEN_VELOCITY_RANGE = 44;
+constexpr std::uint16_t GEN_INITIAL_ATTENUATION = 48;
+constexpr std::uint16_t GEN_COARSE_TUNE = 51;
+constexpr std::uint16_t GEN_FINE_TUNE = 52;
+constexpr std::uint16_t GEN_SAMPLE_ID = 53;
+constexpr std::uint16_t GEN_SAMPLE_MODES = 54;
+constexpr std::uint16_t GEN_OVERRIDING_ROOT_KEY = 58;
+
+struct Generator
+{
+    std::uint16_t op;
+    std::uint16_t amount;
+};
+
+using Zone = std::vector<Generator>;
+
+constexpr std::uint16_t range(std::uint8_t low, std::uint8_t high) {
+    return std::uint16_t(low | high << 8);
+}
+
+struct Sample
+{
+    std::uint32_t start;
+    std::uint32_t end;
+    std::uint32_t loopStart;
+    std::uint32_t loopEnd;
+    std::uint32_t rate = 48'000;
+    std::uint8_t pitch = 60;
+    std::int8_t correction = 0;
+};
+
+struct Preset
+{
+    std::uint16_t program;
+    std::uint16_t bank;
+    std::vector<Zone> zones;
+};
+
+/// @brief size bytes of value, little-endian; bytes past the 4th are zero padding.
+inline void append_le(Bytes& out, std::uint32_t value, int size) {
+    for (int i = 0; i < size; ++i) {
+        out.push_back(i < 4 ? std::uint8_t(value >> (8 * i)) : 0);
+    }
+}
+
+inline void append_name(Bytes& out, std::string const& name) {
+    char field[20] = {};
+    std::memcpy(field, name.data(), std::min<std::size_t>(name.size(), 19));
+    out.insert(out.end(), field, field + 20);
+}
+
+inline void append_chunk(Bytes& out, char const* id, Bytes const& data) {
+    out.insert(out.end(), id, id + 4);
+    append_le(out, std::uint32_t(data.size()), 4);
+    out.insert(out.end(), data.begin(), data.end());
+    if (data.size() % 2) {
+        out.push_back(0);
+    }
+}
+
+inline void append_list(Bytes& out, char const* type, Bytes const& content) {
+    Bytes data(type, type + 4);
+    data.insert(data.end(), content.begin(), content.end());
+    append_chunk(out, "LIST", data);
+}
+
+/// @brief Bag and generator chunks for a level of zones, starting at the given indices.
+inline void append_zones(
+    std::vector<Zone> const& zones,
+    Bytes& bags,
+    Bytes& gens,
+    std::size_t& numBags,
+    std::size_t& numGens
+) {
+    for (Zone const& zone : zones) {
+        append_le(bags, std::uint32_t(numGens), 2);
+        append_le(bags, 0, 2);
+        ++numBags;
+        for (Generator const& g : zone) {
+            append_le(gens, g.op, 2);
+            append_le(gens, g.amount, 2);
+            ++numGens;
+        }
+    }
+}
+
+/// @brief The content of the pdta list: sample headers, instruments as lists of zones, and
+/// presets whose zones refer to the instruments by index.
+inline Bytes pdta(
+    std::vector<Sample> const& headers,
+    std::vector<std::vector<Zone>> const& instruments,
+    std::vector<Preset> const& presets
+) {
+    Bytes phdr, pbag, pgen, inst, ibag, igen, shdr;
+    std::size_t numBags = 0, numGens = 0;
+    for (Preset const& preset : presets) {
+        append_name(phdr, "preset");
+        append_le(phdr, preset.program, 2);
+        append_le(phdr, preset.bank, 2);
+        append_le(phdr, std::uint32_t(numBags), 2);
+        append_le(phdr, 0, 12);
+        append_zones(preset.zones, pbag, pgen, numBags, numGens);
+    }
+    append_name(phdr, "EOP");
+    append_le(phdr, 0, 4);
+    append_le(phdr, std::uint32_t(numBags), 2);
+    append_le(phdr, 0, 12);
+    append_le(pbag, std::uint32_t(numGens), 2);
+    append_le(pbag, 0, 2);
+    append_le(pgen, 0, 4);
+
+    numBags = numGens = 0;
+    for (std::vector<Zone> const& zones : instruments) {
+        append_name(inst, "instrument");
+        append_le(inst, std::uint32_t(numBags), 2);
+        append_zones(zones, ibag, igen, numBags, numGens);
+    }
+    append_name(inst, "EOI");
+    append_le(inst, std::uint32_t(numBags), 2);
+    append_le(ibag, std::uint32_t(numGens), 2);
+    append_le(ibag, 0, 2);
+    append_le(igen, 0, 4);
+
+    for (Sample const& s : headers) {
+        append_name(shdr, "sample");
+        for (std::uint32_t v : {s.start, s.end, s.loopStart, s.loopEnd, s.rate}) {
+            append_le(shdr, v, 4);
+        }
+        shdr.push_back(s.pitch);
+        shdr.push_back(std::uint8_t(s.correction));
+        append_le(shdr, 0, 2);  // sample link
+        append_le(shdr, 1, 2);  // mono
+    }
+    append_name(shdr, "EOS");
+    append_le(shdr, 0, 26);
+
+    Bytes out;
+    append_chunk(out, "phdr", phdr);
+    append_chunk(out, "pbag", pbag);
+    append_chunk(out, "pmod", Bytes(10, 0));
+    append_chunk(out, "pgen", pgen);
+    append_chunk(out, "inst", inst);
+    append_chunk(out, "ibag", ibag);
+    append_chunk(out, "imod", Bytes(10, 0));
+    append_chunk(out, "igen", igen);
+    append_chunk(out, "shdr", shdr);
+    return out;
+}
+
+/// @brief A SoundFont 2 bank with the given 16 bit samples, see pdta() for the rest.
+inline Bytes sf2(
+    std::vector<std::int16_t> const& samples,
+    std::vector<Sample> const& headers,
+    std::vector<std::vector<Zone>> const& instruments,
+    std::vector<Preset> const& presets
+) {
+    Bytes info;
+    append_chunk(info, "ifil", {2, 0, 4, 0});
+    append_chunk(info, "INAM", {'t', 'e', 's', 't', 0, 0});
+
+    Bytes smpl;
+    for (std::int16_t s : samples) {
+        append_le(smpl, std::uint16_t(s), 2);
+    }
+    Bytes sdta;
+    append_chunk(sdta, "smpl", smpl);
+
+    Bytes body = {'s', 'f', 'b', 'k'};
+    append_list(body, "INFO", info);
+    append_list(body, "sdta", sdta);
+    append_list(body, "pdta", pdta(headers, instruments, presets));
+    Bytes out;
+    append_chunk(out, "RIFF", body);
+    return out;
+}
@@ -0,0 +1,259 @@
+#include "soundfont/bank.h"
+#include "soundfont/sf2_builder.h"
+
+#include <doctest/doctest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+// Four 100 frame samples, each filled with its index + 1
+std::vector<std::int16_t> sample_data() {
+    std::vector<std::int16_t> data;
+    for (int s = 0; s < 4; ++s) {
+        data.insert(data.end(), 100, std::int16_t(s + 1));
+    }
+    return data;
+}
+
+std::vector<Sample> sample_headers() {
+    std::vector<Sample> headers;
+    for (std::uint32_t s = 0; s < 4; ++s) {
+        headers.push_back({
+            .start = s * 100,
+            .end = s * 100 + 90,
+            .loopStart = s * 100 + 10,
+            .loopEnd = s * 100 + 80,
+        });
+    }
+    return headers;
+}
+
+/// @brief The sample a zone plays, by the value it is filled with.
+int sample_of(soundfont::Zone const* zone, soundfont::Bank const& bank) {
+    return zone ? bank.samples()[zone->start] - 1 : -1;
+}
+
+}  // namespace
+
+TEST_CASE("zones resolve by key and velocity") {
+    // Sample 0 below middle C, sample 1 from it up at low velocity, sample 2 loud.
+    Bytes bytes = sf2(
+        sample_data(),
+        sample_headers(),
+        {{
+            {{GEN_KEY_RANGE, range(0, 59)}, {GEN_SAMPLE_ID, 0}},
+            {{GEN_KEY_RANGE, range(60, 127)},
+             {GEN_VELOCITY_RANGE, range(0, 63)},
+             {GEN_SAMPLE_ID, 1}},
+            {{GEN_KEY_RANGE, range(60, 127)},
+             {GEN_VELOCITY_RANGE, range(64, 127)},
+             {GEN_SAMPLE_ID, 2}},
+        }},
+        {{.program = 0, .bank = 0, .zones = {{{GEN_INSTRUMENT, 0}}}}}
+    );
+    soundfont::Bank bank;
+    REQUIRE(bank.parse(bytes));
+    CHECK(bank.num_zones() == 3);
+    CHECK(bank.samples().size() == 400);
+
+    CHECK(sample_of(bank.find(0, 40, 100), bank) == 0);
+    CHECK(sample_of(bank.find(0, 59, 1), bank) == 0);
+    CHECK(sample_of(bank.find(0, 60, 63), bank) == 1);
+    CHECK(sample_of(bank.find(0, 60, 64), bank) == 2);
+    CHECK(sample_of(bank.find(0, 127, 127), bank) == 2);
+    CHECK(bank.find(1, 60, 100) == nullptr);  // no such program
+
+    soundfont::Zone const& zone = *bank.find(0, 40, 100);
+    CHECK(zone.start == 0);
+    CHECK(zone.end == 90);
+    CHECK(zone.loopStart == 10);
+    CHECK(zone.loopEnd == 80);
+    CHECK(zone.loop == soundfont::LoopMode::NONE);
+    CHECK(zone.sampleRate == 48'000.f);
+    CHECK(zone.rootKey == 60.f);
+    CHECK(zone.gain == 1.f);
+}
+
+TEST_CASE("preset ranges narrow the instrument's") {
+    Bytes bytes = sf2(
+        sample_data(),
+        sample_headers(),
+        {{{{GEN_KEY_RANGE, range(40, 80)}, {GEN_SAMPLE_ID, 0}}}},
+        {{.program = 0,
+          .bank = 0,
+          .zones = {{{GEN_KEY_RANGE, range(60, 100)}, {GEN_INSTRUMENT, 0}}}}}
+    );
+    soundfont::Bank bank;
+    REQUIRE(bank.parse(bytes));
+    CHECK(bank.find(0, 59, 100) == nullptr);
+    CHECK(bank.find(0, 60, 100) != nullptr);
+    CHECK(bank.find(0, 80, 100) != nullptr);
+    CHECK(bank.find(0, 81, 100) == nullptr);
+    CHECK(bank.find(0, 60, 100)->keyLow == 60);
+    CHECK(bank.find(0, 60, 100)->keyHigh == 80);
+}
+
+TEST_CASE("global zones, tuning and attenuation") {
+    std::vector<Sample> headers = sample_headers();
+    headers[1].pitch = 69;
+    headers[1].correction = -10;
+    headers[1].rate = 44'100;
+    Bytes bytes = sf2(
+        sample_data(),
+        headers,
+        {{
+            // Global zone: 6 dB down, looping
+            {{GEN_INITIAL_ATTENUATION, 60}, {GEN_SAMPLE_MODES, 1}},
+            {{GEN_KEY_RANGE, range(0, 63)}, {GEN_SAMPLE_ID, 1}},
+            {{GEN_KEY_RANGE, range(64, 127)},
+             {GEN_OVERRIDING_ROOT_KEY, 72},
+             {GEN_SAMPLE_MODES, 3},
+             {GEN_START_OFFSET, 5},
+             {GEN_SAMPLE_ID, 1}},
+        }},
+        {{.program = 0,
+          .bank = 0,
+          .zones = {
+              {{GEN_COARSE_TUNE, 1}, {GEN_FINE_TUNE, 50}},  // global: 150 cents up
+              {{GEN_INSTRUMENT, 0}},
+          }}}
+    );
+    soundfont::Bank bank;
+    REQUIRE(bank.parse(bytes));
+
+    // The sample is 10 cents flat, which the pitch correction undoes; 150 cents of tuning on top.
+    soundfont::Zone const& low = *bank.find(0, 60, 100);
+    CHECK(low.rootKey == doctest::Approx(69 - 1.4));
+    CHECK(low.sampleRate == 44'100.f);
+    CHECK(low.gain == doctest::Approx(std::pow(10.0, -0.3)));
+    CHECK(low.loop == soundfont::LoopMode::CONTINUOUS);
+
+    soundfont::Zone const& high = *bank.find(0, 64, 100);
+    CHECK(high.rootKey == doctest::Approx(72 - 1.4));
+    CHECK(high.loop == soundfont::LoopMode::UNTIL_RELEASE);
+    CHECK(high.start == 105);
+    CHECK(high.gain == doctest::Approx(std::pow(10.0, -0.3)));
+}
+
+TEST_CASE("key ranges past 127 are cut to the MIDI keys") {
+    // Both levels set the range, so neither falls back to 0-127.
+    auto preset = [](std::uint16_t program, std::uint16_t bank, std::uint16_t keys) {
+        return Preset{
+            .program = program,
+            .bank = bank,
+            .zones = {{{GEN_KEY_RANGE, keys}, {GEN_INSTRUMENT, 0}}}
+        };
+    };
+    Bytes bytes = sf2(
+        sample_data(),
+        sample_headers(),
+        {{{{GEN_KEY_RANGE, range(100, 255)}, {GEN_SAMPLE_ID, 0}}}},
+        {
+            preset(3, 0, range(64, 250)),
+            preset(0, 128, range(64, 255)),
+            preset(5, 0, range(200, 255)),
+        }
+    );
+    soundfont::Bank bank;
+    REQUIRE(bank.parse(bytes));
+    CHECK(bank.num_zones() == 2);
+    REQUIRE(bank.find(3, 127, 100) != nullptr);
+    CHECK(bank.find(3, 127, 100)->keyHigh == 127);
+    CHECK(bank.find(soundfont::PERCUSSION, 127, 100) != nullptr);
+    // Nothing spilled into the next program's keys.
+    CHECK(bank.find(4, 0, 100) == nullptr);
+    CHECK(bank.find(4, 27, 100) == nullptr);
+    CHECK(bank.find(5, 127, 100) == nullptr);
+}
+
+TEST_CASE("programs prefer bank 0 and percussion comes from bank 128") {
+    auto preset = [](std::uint16_t program, std::uint16_t bank, std::uint16_t instrument) {
+        return Preset{.program = program, .bank = bank, .zones = {{{GEN_INSTRUMENT, instrument}}}};
+    };
+    Bytes bytes = sf2(
+        sample_data(),
+        sample_headers(),
+        {
+            {{{GEN_SAMPLE_ID, 0}}},
+            {{{GEN_SAMPLE_ID, 1}}},
+            {{{GEN_SAMPLE_ID, 2}}},
+            {{{GEN_SAMPLE_ID, 3}}},
+        },
+        {preset(5, 8, 0), preset(3, 1, 1), preset(3, 0, 2), preset(0, 128, 3), preset(7, 300, 0)}
+    );
+    soundfont::Bank bank;
+    REQUIRE(bank.parse(bytes));
+    CHECK(sample_of(bank.find(5, 60, 100), bank) == 0);  // only in bank 8
+    CHECK(sample_of(bank.find(3, 60, 100), bank) == 2);
+    CHECK(sample_of(bank.find(soundfont::PERCUSSION, 36, 100), bank) == 3);
+    CHECK(bank.find(0, 60, 100) == nullptr);
+    CHECK(bank.find(7, 60, 100) == nullptr);
+}
+
+TEST_CASE("invalid loops and sample references are dropped") {
+    std::vector<Sample> headers = sample_headers();
+    headers[0].loopEnd = headers[0].loopStart;
+    Bytes bytes = sf2(
+        sample_data(),
+        headers,
+        {{
+            {{GEN_KEY_RANGE, range(0, 63)}, {GEN_SAMPLE_MODES, 1}, {GEN_SAMPLE_ID, 0}},
+            {{GEN_KEY_RANGE, range(64, 127)}, {GEN_SAMPLE_ID, 9}},
+        }},
+        {{.program = 0, .bank = 0, .zones = {{{GEN_INSTRUMENT, 0}}, {{GEN_INSTRUMENT, 4}}}}}
+    );
+    soundfont::Bank bank;
+    REQUIRE(bank.parse(bytes));
+    CHECK(bank.num_zones() == 1);
+    CHECK(bank.find(0, 60, 100)->loop == soundfont::LoopMode::NONE);
+    CHECK(bank.find(0, 64, 100) == nullptr);
+}
+
+TEST_CASE("malformed banks are rejected") {
+    Bytes valid = sf2(
+        sample_data(),
+        sample_headers(),
+        {{{{GEN_SAMPLE_ID, 0}}}},
+        {{.program = 0, .bank = 0, .zones = {{{GEN_INSTRUMENT, 0}}}}}
+    );
+    soundfont::Bank bank;
+    CHECK_FALSE(bank.parse(Bytes{'R', 'I', 'F', 'F'}));
+    CHECK_FALSE(bank.parse(Bytes(64, 0)));
+
+    // Truncated anywhere, parsing fails or yields a bank that is safe to query.
+    for (std::size_t size = 0; size < valid.size(); size += 7) {
+        Bytes truncated(valid.begin(), valid.begin() + std::ptrdiff_t(size));
+        if (bank.parse(truncated)) {
+            CHECK(bank.find(0, 60, 100) == nullptr);
+        }
+    }
+    CHECK(bank.parse(valid));
+    CHECK(bank.find(0, 60, 100) != nullptr);
+}
+
+TEST_CASE("banks are mapped from disk") {
+    auto path = std::filesystem::temp_directory_path() / "soundfont_bank_test.sf2";
+    {
+        Bytes bytes = sf2(
+            sample_data(),
+            sample_headers(),
+            {{{{GEN_SAMPLE_ID, 3}}}},
+            {{.program = 0, .bank = 0, .zones = {{{GEN_INSTRUMENT, 0}}}}}
+        );
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<char const*>(bytes.data()), std::streamsize(bytes.size()));
+    }
+    soundfont::Bank bank;
+    REQUIRE(bank.open(path.string()));
+    CHECK(sample_of(bank.find(0, 60, 100), bank) == 3);
+    bank.prefetch(0);
+    bank.prefetch(soundfont::PERCUSSION);  // nothing there
+    std::filesystem::remove(path);
+
+    CHECK_FALSE(bank.open((std::filesystem::temp_directory_path() / "missing.sf2").string()));
+}
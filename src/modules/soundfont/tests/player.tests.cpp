@@ -0,0 +1,155 @@
+#include "soundfont/player.h"
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+constexpr float SCALE = 1.f / 32768.f;
+
+// A ramp 0, 100, 200, ... over 16 frames; the loop is frames 4 to 11.
+std::vector<std::int16_t> ramp() {
+    std::vector<std::int16_t> data;
+    for (int i = 0; i < 16; ++i) {
+        data.push_back(std::int16_t(i * 100));
+    }
+    return data;
+}
+
+soundfont::Zone zone(soundfont::LoopMode loop) {
+    return {
+        .start = 0,
+        .end = 16,
+        .loopStart = 4,
+        .loopEnd = 12,
+        .rootKey = 60.f,
+        .sampleRate = 48'000.f,
+        .gain = 1.f,
+        .loop = loop,
+        .keyLow = 0,
+        .keyHigh = 127,
+        .velocityLow = 0,
+        .velocityHigh = 127,
+    };
+}
+
+}  // namespace
+
+TEST_CASE("samples play at their recorded rate and end with the sample") {
+    auto const data = ramp();
+    std::array<float, 32> out{};
+    double position = 0.0;
+    auto const once = zone(soundfont::LoopMode::NONE);
+    int const rendered = soundfont::play(out.data(), 32, data, once, position, 1.f, 1.f, 0.f, true);
+    // The last frame has nothing to interpolate towards, so it is not played.
+    CHECK(rendered == 15);
+    for (int i = 0; i < rendered; ++i) {
+        CHECK(out[i] == doctest::Approx(i * 100 * SCALE));
+    }
+    CHECK(out[15] == 0.f);
+    CHECK(position == 15.0);
+}
+
+TEST_CASE("samples are interpolated between frames") {
+    auto const data = ramp();
+    std::array<float, 8> out{};
+    double position = 2.0;
+    auto const once = zone(soundfont::LoopMode::NONE);
+    soundfont::play(out.data(), 8, data, once, position, 0.25f, 2.f, 0.f, false);
+    for (int i = 0; i < 8; ++i) {
+        CHECK(out[i] == doctest::Approx(2.f * (200 + i * 25) * SCALE));
+    }
+    CHECK(position == 4.0);
+}
+
+TEST_CASE("loops wrap until released") {
+    auto const data = ramp();
+    std::array<float, 20> out{};
+    double position = 0.0;
+    auto const looped = zone(soundfont::LoopMode::UNTIL_RELEASE);
+    CHECK(soundfont::play(out.data(), 20, data, looped, position, 1.f, 1.f, 0.f, true) == 20);
+    // 0..11, then the loop again from 4
+    for (int i = 0; i < 20; ++i) {
+        int const frame = i < 12 ? i : 4 + (i - 12) % 8;
+        CHECK(out[i] == doctest::Approx(frame * 100 * SCALE));
+    }
+    CHECK(position == doctest::Approx(12.0));
+
+    // Between the loop end and the loop start the interpolation wraps too.
+    std::array<float, 1> between{};
+    position = 11.5;
+    soundfont::play(between.data(), 1, data, looped, position, 1.f, 1.f, 0.f, true);
+    CHECK(between[0] == doctest::Approx(750 * SCALE));
+
+    // Released, it plays on past the loop to the end of the sample.
+    out.fill(0.f);
+    position = 8.0;
+    CHECK(soundfont::play(out.data(), 20, data, looped, position, 1.f, 1.f, 0.f, false) == 7);
+    CHECK(out[6] == doctest::Approx(1400 * SCALE));
+}
+
+TEST_CASE("the gain ramps across the buffer") {
+    std::vector<std::int16_t> const data(64, 16384);
+    std::array<float, 8> out{};
+    out.fill(1.f);  // played samples are added
+    double position = 0.0;
+    auto const once = zone(soundfont::LoopMode::NONE);
+    soundfont::play(out.data(), 8, data, once, position, 1.f, 0.f, 0.125f, false);
+    for (int i = 0; i < 8; ++i) {
+        CHECK(out[i] == doctest::Approx(1.f + 0.5f * 0.125f * i));
+    }
+}
+
+TEST_CASE("filtered playback follows a sine across the loop") {
+    // 1 kHz: 48 frames a period, 10 of them in the loop, so the wrap is seamless.
+    constexpr double TWO_PI = 6.283185307179586;
+    std::vector<std::int16_t> data(1000);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = std::int16_t(std::lround(16384.0 * std::sin(TWO_PI * double(i) / 48.0)));
+    }
+    auto looped = zone(soundfont::LoopMode::CONTINUOUS);
+    looped.end = 1000;
+    looped.loopStart = 240;
+    looped.loopEnd = 720;
+
+    for (auto quality : {resampler::Quality::FAST, resampler::Quality::BEST}) {
+        std::array<float, 2000> out{};
+        double position = 100.0;
+        int const rendered = soundfont::play(
+            out.data(), 2000, data, looped, position, 0.9f, 1.f, 0.f, true, quality
+        );
+        CHECK(rendered == 2000);
+        CHECK(position >= 240.0);
+        CHECK(position < 720.0);
+        double expectedPosition = 100.0;
+        double error = 0.0;
+        for (float sample : out) {
+            double const expected = 0.5 * std::sin(TWO_PI * expectedPosition / 48.0);
+            error = std::max(error, std::abs(sample - expected));
+            expectedPosition += 0.9f;
+        }
+        CHECK(error < 2e-3);
+    }
+}
+
+TEST_CASE("filtered playback ends where linear playback does") {
+    auto const data = ramp();
+    auto const once = zone(soundfont::LoopMode::NONE);
+    std::array<float, 32> out{};
+    double position = 0.0;
+    int const rendered = soundfont::play(
+        out.data(), 32, data, once, position, 1.f, 1.f, 0.f, true, resampler::Quality::FAST
+    );
+    CHECK(rendered == 15);
+    CHECK(position == 15.0);
+    // Away from the edges, where the filter reads silence, a ramp comes through unchanged.
+    for (int i = 4; i < rendered - 4; ++i) {
+        CHECK(out[i] == doctest::Approx(i * 100 * SCALE).epsilon(1e-3));
+    }
+    CHECK(out[15] == 0.f);
+}
@@ -0,0 +1,22 @@
+#include "stats/deadline.h"
+
+std::uint64_t stats::DeadlineWatchdog::block_budget(int numFrames, int sampleRate) {
+    if (numFrames <= 0 || sampleRate <= 0) {
+        return 0;
+    }
+    return std::uint64_t(numFrames) * 1'000'000'000 / std::uint64_t(sampleRate);
+}
+
+void stats::DeadlineWatchdog::record(std::uint64_t elapsed, std::uint64_t budget) {
+    renderTime.record(elapsed);
+    lastBudget.store(budget, std::memory_order_relaxed);
+    if (elapsed > budget) {
+        numMisses.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void stats::DeadlineWatchdog::reset() {
+    renderTime.reset();
+    numMisses.store(0, std::memory_order_relaxed);
+    lastBudget.store(0, std::memory_order_relaxed);
+}
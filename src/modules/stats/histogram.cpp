@@ -0,0 +1,93 @@
+#include "stats/histogram.h"
+
+#include <bit>
+#include <format>
+
+int stats::Histogram::bucket(std::uint64_t value) {
+    if (value < 2 * SUB_BUCKETS) {
+        return int(value);
+    }
+    // Keep the top five bits: the leading one and four bits of mantissa.
+    int exponent = std::bit_width(value) - 5;
+    return SUB_BUCKETS * exponent + int(value >> exponent);
+}
+
+std::uint64_t stats::Histogram::bucket_upper(int index) {
+    if (index < 2 * SUB_BUCKETS) {
+        return std::uint64_t(index);
+    }
+    int exponent = index / SUB_BUCKETS - 1;
+    std::uint64_t mantissa = std::uint64_t(index % SUB_BUCKETS + SUB_BUCKETS);
+    return ((mantissa + 1) << exponent) - 1;
+}
+
+void stats::Histogram::record(std::uint64_t value) {
+    buckets[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+    // Single writer: plain load/store is enough to keep the extremes.
+    if (value < minValue.load(std::memory_order_relaxed)) {
+        minValue.store(value, std::memory_order_relaxed);
+    }
+    if (value > maxValue.load(std::memory_order_relaxed)) {
+        maxValue.store(value, std::memory_order_relaxed);
+    }
+}
+
+std::uint64_t stats::Histogram::min() const {
+    return count() ? minValue.load(std::memory_order_relaxed) : 0;
+}
+
+double stats::Histogram::mean() const {
+    auto n = count();
+    return n ? double(sum.load(std::memory_order_relaxed)) / double(n) : 0.0;
+}
+
+std::uint64_t stats::Histogram::percentile(double p) const {
+    std::uint64_t n = count();
+    if (n == 0) {
+        return 0;
+    }
+    auto rank = std::uint64_t(p / 100.0 * double(n) + 0.5);
+    rank = std::max<std::uint64_t>(rank, 1);
+    std::uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; ++i) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(bucket_upper(i), max());
+        }
+    }
+    return max();
+}
+
+std::uint64_t stats::Histogram::count_at_most(std::uint64_t value) const {
+    int last = bucket(value);
+    if (bucket_upper(last) > value) {
+        --last;
+    }
+    std::uint64_t n = 0;
+    for (int i = 0; i <= last; ++i) {
+        n += buckets[i].load(std::memory_order_relaxed);
+    }
+    return n;
+}
+
+void stats::Histogram::reset() {
+    for (auto& b : buckets) {
+        b.store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    minValue.store(UINT64_MAX, std::memory_order_relaxed);
+    maxValue.store(0, std::memory_order_relaxed);
+}
+
+std::string stats::summary(Histogram const& histogram) {
+    return std::format(
+        "n={}, p50={:.2f} ms, p99={:.2f} ms, max={:.2f} ms",
+        histogram.count(),
+        double(histogram.percentile(50)) * 1e-6,
+        double(histogram.percentile(99)) * 1e-6,
+        double(histogram.max()) * 1e-6
+    );
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "stats/histogram.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace stats
+{
+/// @brief Times the callbacks of a real-time thread against their deadlines. A callback rendering
+/// a block of audio has as long as the block takes to play, 10 ms for 480 frames at 48 kHz; one
+/// that takes longer is a likely dropout.
+///
+/// Like Histogram, meant for a single writer; the readers may run on any thread.
+class DeadlineWatchdog
+{
+public:
+    /// @brief Times the callback from construction to destruction.
+    class Timer
+    {
+    public:
+        Timer(DeadlineWatchdog& watchdog, std::uint64_t budget)
+        : watchdog(watchdog)
+        , budget(budget)
+        , start(std::chrono::steady_clock::now()) {}
+
+        ~Timer() {
+            std::chrono::nanoseconds const elapsed = std::chrono::steady_clock::now() - start;
+            watchdog.record(std::uint64_t(elapsed.count()), budget);
+        }
+
+        Timer(Timer const&) = delete;
+        Timer& operator=(Timer const&) = delete;
+
+    private:
+        DeadlineWatchdog& watchdog;
+        std::uint64_t budget;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    /// @brief The time numFrames take to play at sampleRate, in ns.
+    static std::uint64_t block_budget(int numFrames, int sampleRate);
+
+    /// @brief A callback ran for elapsed ns out of budget ns.
+    void record(std::uint64_t elapsed, std::uint64_t budget);
+
+    std::uint64_t callbacks() const { return renderTime.count(); }
+    std::uint64_t misses() const { return numMisses.load(std::memory_order_relaxed); }
+    /// @brief The budget of the last callback, in ns.
+    std::uint64_t last_budget() const { return lastBudget.load(std::memory_order_relaxed); }
+    /// @brief Time taken per callback, in ns.
+    Histogram const& render_time() const { return renderTime; }
+
+    void reset();
+
+private:
+    Histogram renderTime;
+    std::atomic<std::uint64_t> numMisses{0};
+    std::atomic<std::uint64_t> lastBudget{0};
+};
+
+}  // namespace stats
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace stats
+{
+/// @brief Log-linear histogram of non-negative integers (typically nanoseconds): exact below 32,
+/// then 16 buckets per power of two, so any value is reported within 6.25%.
+///
+/// record() is wait-free and meant for a single writer, such as the audio thread; the readers
+/// may run on any thread and see a consistent-enough view for reporting.
+class Histogram
+{
+public:
+    static constexpr int SUB_BUCKETS = 16;
+    static constexpr int NUM_BUCKETS = SUB_BUCKETS * 61;
+
+    void record(std::uint64_t value);
+
+    std::uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    std::uint64_t min() const;
+    std::uint64_t max() const { return maxValue.load(std::memory_order_relaxed); }
+    double mean() const;
+
+    /// @brief The smallest bucket bound with at least p percent of the values at or below it,
+    /// clamped to max(). Returns 0 if empty.
+    std::uint64_t percentile(double p) const;
+
+    /// @brief The number of values in the buckets wholly at or below value: exact at a bucket
+    /// bound, otherwise short of those in value's own bucket.
+    std::uint64_t count_at_most(std::uint64_t value) const;
+
+    void reset();
+
+    static int bucket(std::uint64_t value);
+    static std::uint64_t bucket_upper(int index);
+
+private:
+    std::array<std::atomic<std::uint64_t>, NUM_BUCKETS> buckets{};
+    std::atomic<std::uint64_t> total{0};
+    std::atomic<std::uint64_t> sum{0};
+    std::atomic<std::uint64_t> minValue{UINT64_MAX};
+    std::atomic<std::uint64_t> maxValue{0};
+};
+
+/// @brief "n=…, p50=…, p99=…, max=…" for a histogram of nanoseconds, printed in milliseconds.
+std::string summary(Histogram const& histogram);
+
+}  // namespace stats
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "stats/histogram.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace stats
+{
+/// @brief A page of metrics in the Prometheus text exposition format, for a scraper to pick up
+/// from a file, e.g. node_exporter's textfile collector.
+///
+/// Names are written as given: they should follow the Prometheus conventions, base units and
+/// a _total suffix on counters.
+class PrometheusText
+{
+public:
+    void counter(std::string_view name, std::string_view help, std::uint64_t value);
+    void gauge(std::string_view name, std::string_view help, double value);
+
+    /// @brief A histogram of nanoseconds, exported in seconds: one cumulative bucket per bound
+    /// (in ns, ascending, see Histogram::count_at_most), +Inf, _sum and _count.
+    void histogram(
+        std::string_view name,
+        std::string_view help,
+        Histogram const& histogram,
+        std::span<std::uint64_t const> bounds
+    );
+
+    std::string const& text() const { return page; }
+    void clear() { page.clear(); }
+
+    /// @brief Replace the file at path with the page. It is written next to it and renamed over
+    /// it, so a reader never sees half a page. Returns false and logs on error.
+    bool write(std::string const& path) const;
+
+private:
+    void header(std::string_view name, std::string_view help, std::string_view type);
+
+    std::string page;
+};
+
+}  // namespace stats
@@ -0,0 +1,79 @@
+#include "stats/prometheus.h"
+
+#include "logger/logger.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <format>
+#include <fstream>
+#include <iterator>
+
+void stats::PrometheusText::counter(
+    std::string_view name,
+    std::string_view help,
+    std::uint64_t value
+) {
+    header(name, help, "counter");
+    std::format_to(std::back_inserter(page), "{} {}\n", name, value);
+}
+
+void stats::PrometheusText::gauge(std::string_view name, std::string_view help, double value) {
+    header(name, help, "gauge");
+    std::format_to(std::back_inserter(page), "{} {}\n", name, value);
+}
+
+void stats::PrometheusText::histogram(
+    std::string_view name,
+    std::string_view help,
+    Histogram const& histogram,
+    std::span<std::uint64_t const> bounds
+) {
+    header(name, help, "histogram");
+    // The audio thread may record meanwhile: keep the buckets cumulative and +Inf equal to
+    // _count, as scrapers expect, whatever was read first.
+    std::uint64_t const count = histogram.count();
+    std::uint64_t cumulative = 0;
+    for (std::uint64_t bound : bounds) {
+        cumulative = std::max(cumulative, histogram.count_at_most(bound));
+        std::format_to(
+            std::back_inserter(page),
+            "{}_bucket{{le=\"{}\"}} {}\n",
+            name,
+            double(bound) * 1e-9,
+            cumulative
+        );
+    }
+    cumulative = std::max(cumulative, count);
+    std::format_to(std::back_inserter(page), "{}_bucket{{le=\"+Inf\"}} {}\n", name, cumulative);
+    std::format_to(
+        std::back_inserter(page), "{}_sum {}\n", name, histogram.mean() * double(count) * 1e-9
+    );
+    std::format_to(std::back_inserter(page), "{}_count {}\n", name, cumulative);
+}
+
+void stats::PrometheusText::header(
+    std::string_view name,
+    std::string_view help,
+    std::string_view type
+) {
+    std::format_to(
+        std::back_inserter(page), "# HELP {} {}\n# TYPE {} {}\n", name, help, name, type
+    );
+}
+
+bool stats::PrometheusText::write(std::string const& path) const {
+    std::string const temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        file << page;
+        if (!file.flush()) {
+            logger::log("Could not write {}", temporary);
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        logger::log("Could not rename {} to {}", temporary, path);
+        return false;
+    }
+    return true;
+}
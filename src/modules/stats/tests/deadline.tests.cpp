@@ -0,0 +1,42 @@
+#include "stats/deadline.h"
+
+#include <doctest/doctest.h>
+
+#include <memory>
+
+TEST_CASE("Block budgets") {
+    CHECK(stats::DeadlineWatchdog::block_budget(480, 48'000) == 10'000'000);
+    CHECK(stats::DeadlineWatchdog::block_budget(96, 48'000) == 2'000'000);
+    CHECK(stats::DeadlineWatchdog::block_budget(441, 44'100) == 10'000'000);
+    CHECK(stats::DeadlineWatchdog::block_budget(480, 0) == 0);
+}
+
+TEST_CASE("Callbacks over budget are misses") {
+    auto watchdog = std::make_unique<stats::DeadlineWatchdog>();
+    watchdog->record(2'000'000, 10'000'000);
+    watchdog->record(10'000'000, 10'000'000);  // just in time
+    watchdog->record(12'000'000, 10'000'000);
+    CHECK(watchdog->callbacks() == 3);
+    CHECK(watchdog->misses() == 1);
+    CHECK(watchdog->last_budget() == 10'000'000);
+    CHECK(watchdog->render_time().max() == 12'000'000);
+
+    watchdog->reset();
+    CHECK(watchdog->callbacks() == 0);
+    CHECK(watchdog->misses() == 0);
+}
+
+TEST_CASE("Timer records the callback it spans") {
+    auto watchdog = std::make_unique<stats::DeadlineWatchdog>();
+    {
+        stats::DeadlineWatchdog::Timer timer(*watchdog, 0);
+    }
+    CHECK(watchdog->callbacks() == 1);
+    CHECK(watchdog->last_budget() == 0);
+    {
+        stats::DeadlineWatchdog::Timer timer(*watchdog, 1'000'000'000);
+    }
+    CHECK(watchdog->callbacks() == 2);
+    CHECK(watchdog->misses() <= 1);  // the first may have taken no time at all
+    CHECK(watchdog->render_time().max() < 1'000'000'000);
+}
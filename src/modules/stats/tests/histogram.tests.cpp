@@ -0,0 +1,66 @@
+#include "stats/histogram.h"
+
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <memory>
+
+TEST_CASE("Buckets are exact for small values and within 1/16 above") {
+    for (std::uint64_t v = 0; v < 32; ++v) {
+        CHECK(stats::Histogram::bucket(v) == int(v));
+        CHECK(stats::Histogram::bucket_upper(int(v)) == v);
+    }
+    constexpr std::uint64_t values[] = {32, 33, 63, 64, 1000, 123'456, 1ull << 40, UINT64_MAX};
+    int previous = -1;
+    for (std::uint64_t v : values) {
+        int index = stats::Histogram::bucket(v);
+        CHECK(index >= previous);
+        CHECK(index < stats::Histogram::NUM_BUCKETS);
+        std::uint64_t upper = stats::Histogram::bucket_upper(index);
+        CHECK(upper >= v);
+        CHECK(double(upper - v) <= double(v) / 16.0);
+        previous = index;
+    }
+    CHECK(stats::Histogram::bucket(32) == 32);
+    CHECK(stats::Histogram::bucket_upper(stats::Histogram::bucket(64)) == 67);  // 64..67
+}
+
+TEST_CASE("Percentiles, extremes and reset") {
+    auto histogram = std::make_unique<stats::Histogram>();
+    CHECK(histogram->percentile(50) == 0);
+    CHECK(histogram->min() == 0);
+
+    for (std::uint64_t v = 1; v <= 10'000; ++v) {
+        histogram->record(v * 1000);  // 1 µs .. 10 ms
+    }
+    CHECK(histogram->count() == 10'000);
+    CHECK(histogram->min() == 1000);
+    CHECK(histogram->max() == 10'000'000);
+    CHECK(histogram->mean() == doctest::Approx(5'000'500.0));
+
+    auto p50 = double(histogram->percentile(50));
+    auto p99 = double(histogram->percentile(99));
+    CHECK(p50 >= 5'000'000.0);
+    CHECK(p50 <= 5'000'000.0 * 1.0625);
+    CHECK(p99 >= 9'900'000.0);
+    CHECK(p99 <= 9'900'000.0 * 1.0625);
+    CHECK(histogram->percentile(100) == 10'000'000);
+
+    histogram->reset();
+    CHECK(histogram->count() == 0);
+    CHECK(histogram->max() == 0);
+}
+
+TEST_CASE("Counts at or below a bound") {
+    auto histogram = std::make_unique<stats::Histogram>();
+    CHECK(histogram->count_at_most(UINT64_MAX) == 0);
+    for (std::uint64_t v : {0, 10, 31, 64, 67, 68, 1000}) {
+        histogram->record(v);
+    }
+    CHECK(histogram->count_at_most(0) == 1);
+    CHECK(histogram->count_at_most(31) == 3);
+    CHECK(histogram->count_at_most(66) == 3);  // 64 shares a bucket with 67
+    CHECK(histogram->count_at_most(67) == 5);
+    CHECK(histogram->count_at_most(999) == 6);
+    CHECK(histogram->count_at_most(UINT64_MAX) == 7);
+}
@@ -0,0 +1,70 @@
+#include "stats/prometheus.h"
+
+#include "test_support/files.h"
+
+#include <doctest/doctest.h>
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+
+TEST_CASE("Counters and gauges") {
+    stats::PrometheusText text;
+    text.counter("app_misses_total", "Deadline misses.", 3);
+    text.gauge("app_voices", "Voices playing.", 12);
+    CHECK(
+        text.text() ==
+        "# HELP app_misses_total Deadline misses.\n"
+        "# TYPE app_misses_total counter\n"
+        "app_misses_total 3\n"
+        "# HELP app_voices Voices playing.\n"
+        "# TYPE app_voices gauge\n"
+        "app_voices 12\n"
+    );
+    text.clear();
+    CHECK(text.text().empty());
+}
+
+TEST_CASE("Histograms are cumulative, in seconds") {
+    auto histogram = std::make_unique<stats::Histogram>();
+    for (std::uint64_t v : {1'000'000, 1'000'000, 3'000'000, 20'000'000}) {
+        histogram->record(v);
+    }
+    // Bucket bounds, so the counts are exact.
+    std::array<std::uint64_t, 2> const bounds = {
+        stats::Histogram::bucket_upper(stats::Histogram::bucket(1'000'000)),
+        stats::Histogram::bucket_upper(stats::Histogram::bucket(3'000'000)),
+    };
+    stats::PrometheusText text;
+    text.histogram("app_render_seconds", "Render time.", *histogram, bounds);
+    std::string const& page = text.text();
+    CHECK(page.starts_with("# HELP app_render_seconds Render time.\n"));
+    CHECK(page.find("# TYPE app_render_seconds histogram\n") != std::string::npos);
+    CHECK(page.find("} 2\napp_render_seconds_bucket{le=") != std::string::npos);
+    CHECK(page.find("} 3\napp_render_seconds_bucket{le=\"+Inf\"} 4\n") != std::string::npos);
+    CHECK(page.find("app_render_seconds_sum 0.025\n") != std::string::npos);
+    CHECK(page.ends_with("app_render_seconds_count 4\n"));
+}
+
+TEST_CASE("The page replaces the file") {
+    std::string const path = test_support::temp_path("prometheus_test.prom");
+    stats::PrometheusText text;
+    text.counter("app_first_total", "First.", 1);
+    REQUIRE(text.write(path));
+    text.clear();
+    text.counter("app_second_total", "Second.", 2);
+    REQUIRE(text.write(path));
+
+    std::ifstream file(path);
+    std::stringstream contents;
+    contents << file.rdbuf();
+    CHECK(contents.str() == text.text());
+    CHECK(!std::ifstream(path + ".tmp"));
+    std::remove(path.c_str());
+
+    CHECK(!text.write("no/such/directory/metrics.prom"));
+}
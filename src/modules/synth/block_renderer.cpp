@@ -0,0 +1,46 @@
+#include "synth/block_renderer.h"
+
+#include <algorithm>
+
+synth::BlockRenderer::BlockRenderer(RenderFunction render, std::size_t bytesPerFrame)
+: renderFunction(render)
+, bytesPerFrame(bytesPerFrame) {}
+
+bool synth::BlockRenderer::schedule(std::uint64_t at, events::Event const& event) {
+    if (numPending == CAPACITY) {
+        return false;
+    }
+    // Events mostly arrive in order, so the insertion point is found from the back.
+    std::size_t i = numPending;
+    for (; i > 0 && scheduled[i - 1].frame > at; --i) {
+        scheduled[i] = scheduled[i - 1];
+    }
+    scheduled[i] = {.frame = at, .event = event};
+    ++numPending;
+    return true;
+}
+
+void synth::BlockRenderer::render(VoiceEngine& engine, void* buffer, int numFrames) {
+    auto* out = static_cast<std::byte*>(buffer);
+    std::uint64_t const end = frame + numFrames;
+    std::size_t applied = 0;
+    int rendered = 0;
+    for (; applied < numPending && scheduled[applied].frame < end; ++applied) {
+        Scheduled const& next = scheduled[applied];
+        int at = next.frame > frame ? static_cast<int>(next.frame - frame) : 0;
+        if (at > rendered) {
+            renderFunction(engine, out + rendered * bytesPerFrame, at - rendered);
+            rendered = at;
+        }
+        engine.handle(next.event);
+    }
+    if (rendered < numFrames) {
+        renderFunction(engine, out + rendered * bytesPerFrame, numFrames - rendered);
+    }
+
+    if (applied > 0) {
+        std::copy(scheduled.begin() + applied, scheduled.begin() + numPending, scheduled.begin());
+        numPending -= applied;
+    }
+    frame = end;
+}
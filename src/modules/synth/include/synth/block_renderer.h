@@ -0,0 +1,51 @@
+#pragma once
+
+#include "events/event.h"
+#include "synth/render.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace synth
+{
+/// @brief Renders a VoiceEngine block by block and applies scheduled events at their exact frame.
+///
+/// A block with events due inside it is split at each of them, so note timing does not depend on
+/// the block size. A block with none is a single call to the render function. Events due after
+/// the block stay pending for a later one. Storage is fixed; nothing is allocated after
+/// construction.
+class BlockRenderer
+{
+public:
+    static constexpr std::size_t CAPACITY = 1024;
+
+    BlockRenderer(RenderFunction render, std::size_t bytesPerFrame);
+
+    /// @brief Apply an event at an absolute frame. An event for a frame already rendered is
+    /// applied at the start of the next block.
+    /// @return false, dropping the event, if CAPACITY events are already pending.
+    bool schedule(std::uint64_t frame, events::Event const& event);
+
+    /// @brief Render numFrames interleaved frames from position(), then advance position().
+    void render(VoiceEngine& engine, void* buffer, int numFrames);
+
+    /// @brief Frame the next render() starts at.
+    std::uint64_t position() const { return frame; }
+    std::size_t pending() const { return numPending; }
+
+private:
+    struct Scheduled
+    {
+        std::uint64_t frame;
+        events::Event event;
+    };
+
+    RenderFunction renderFunction;
+    std::size_t bytesPerFrame;
+    std::uint64_t frame = 0;
+    std::array<Scheduled, CAPACITY> scheduled;  ///< sorted by frame, then by arrival
+    std::size_t numPending = 0;
+};
+
+}  // namespace synth
@@ -0,0 +1,15 @@
+#pragma once
+
+namespace synth
+{
+/// @brief Linear ADSR envelope, shared by all voices of an engine. Each stage is a straight
+/// ramp, so a block renders as a few linear gain segments fused into the oscillator kernels.
+struct Envelope
+{
+    float attack = 0.002f;  ///< seconds from 0 to full level
+    float decay = 0.05f;    ///< seconds from full level down to sustain
+    float sustain = 1.f;    ///< level while the note is held, [0, 1]
+    float release = 0.01f;  ///< seconds from full level down to 0
+};
+
+}  // namespace synth
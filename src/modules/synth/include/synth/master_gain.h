@@ -0,0 +1,31 @@
+#pragma once
+
+#include <atomic>
+
+namespace synth
+{
+/// @brief Output level of the engine. It can be set from any thread; the render loop moves
+/// towards it in a linear ramp of at most full scale per RAMP_SECONDS, so changes never click.
+class MasterGain
+{
+public:
+    static constexpr double RAMP_SECONDS = 0.02;
+
+    explicit MasterGain(double sampleRate, float gain = 1.f);
+
+    /// @brief Ramp to a new gain.
+    void set(float gain) { target.store(gain, std::memory_order_relaxed); }
+    /// @brief Jump to a new gain without a ramp; only before rendering starts.
+    void reset(float gain);
+    float get() const { return target.load(std::memory_order_relaxed); }
+
+    /// @brief Ramp for the next numFrames frames: frame i gets start + i * step. Audio thread only.
+    void next(int numFrames, float& start, float& step);
+
+private:
+    std::atomic<float> target;
+    float current;
+    float maxStep;  ///< per frame
+};
+
+}  // namespace synth
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "synth/voice_engine.h"
+
+#include <cstddef>
+
+namespace synth
+{
+enum class SampleFormat
+{
+    F32,  ///< 32 bit float, [-1.0, 1.0]
+    S16   ///< 16 bit signed integer
+};
+
+constexpr int MAX_CHANNELS = 2;
+
+/// @brief Render numFrames interleaved frames from the engine into buffer.
+using RenderFunction = void (*)(VoiceEngine& engine, void* buffer, int numFrames);
+
+/// @brief Fully specialized render loop. The waveform, channel count and sample format are
+/// template parameters, so the inner loops carry no per-sample branches. Instantiated in
+/// render.cpp for every combination renderer() can return.
+template <Waveform WAVEFORM, int CHANNELS, SampleFormat FORMAT>
+void render(VoiceEngine& engine, void* buffer, int numFrames);
+
+/// @brief Look up the specialized render loop for a layout, once, at startup.
+/// @return nullptr if the combination is not supported.
+RenderFunction renderer(Waveform waveform, int channels, SampleFormat format);
+
+/// @brief Convert a mono mix, master gain already applied, to an interleaved layout. For output
+/// rendered as mono F32 and processed further, e.g. converted to another sample rate.
+void interleave(const float* mono, void* out, int numFrames, int channels, SampleFormat format);
+
+constexpr std::size_t bytes_per_sample(SampleFormat format) {
+    return format == SampleFormat::F32 ? 4 : 2;
+}
+
+constexpr std::size_t bytes_per_frame(int channels, SampleFormat format) {
+    return channels * bytes_per_sample(format);
+}
+
+}  // namespace synth
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "events/event.h"
+#include "midi/tuning.h"
+#include "oscillator/oscillator.h"
+#include "resampler/resampler.h"
+#include "soundfont/bank.h"
+#include "synth/envelope.h"
+#include "synth/master_gain.h"
+#include "synth/voice_pool.h"
+#include "synth/worker_pool.h"
+
+#include <array>
+#include <cstdint>
+
+namespace synth
+{
+using oscillator::Waveform;
+
+/// @brief Polyphonic synthesizer fed with events::Event and rendered block by block.
+///
+/// Voices play the oscillator waveform, or with a SoundFont set, the zone its bank has for the
+/// channel's program, key and velocity. Every voice is shaped by the engine's ADSR envelope and
+/// scaled by its velocity, and the mix by the master gain. handle() and render() must be called
+/// from the same (audio) thread. Neither allocates. With a WorkerPool set, a block with many
+/// voices playing is mixed on all threads of the pool: each thread mixes the voices it takes into
+/// a partial mix of its own, and the partial mixes are summed at the end.
+class VoiceEngine
+{
+public:
+    explicit VoiceEngine(double sampleRate, Waveform waveform = Waveform::SQUARE);
+
+    void handle(events::Event const& event);
+
+    void note_on(std::uint8_t channel, std::uint8_t note, std::uint8_t velocity);
+    void note_off(std::uint8_t channel, std::uint8_t note);
+    void all_notes_off() { voices.release_all(); }
+    /// @brief Silence every voice at once, skipping the release.
+    void all_sound_off() { voices.stop_all(); }
+    void program_change(std::uint8_t channel, std::uint8_t value);
+
+    /// @brief Retune the channel's playing voices. value is 14 bit, midi::PITCH_BEND_CENTER for
+    /// none; the range is set per channel through RPN 0 and defaults to 2 semitones.
+    void pitch_bend(std::uint8_t channel, std::uint16_t value);
+
+    /// @brief Mix all playing voices into a mono buffer, overwriting its content, and apply the
+    /// master gain.
+    void render(float* buffer, int numSamples);
+
+    /// @brief Add all playing voices, rendered with the given kernel, to a mono buffer. The
+    /// master gain is left to the caller, see master_gain().
+    void mix(float* buffer, int numSamples, oscillator::Kernel kernel);
+
+    /// @brief Mix on the pool's threads from PARALLEL_VOICES voices up; nullptr to mix on the
+    /// calling thread only. The pool must outlive its use here.
+    void set_workers(WorkerPool* pool) { workers = pool; }
+
+    /// @brief Play notes from a SoundFont instead of the oscillators; nullptr to go back to them.
+    /// Stops all voices. The bank must outlive its use here.
+    void set_soundfont(soundfont::Bank const* bank);
+    /// @brief How SoundFont samples are resampled to pitch. Applies to voices already playing.
+    void set_resampling(resampler::Quality q) { resampling = q; }
+
+    void set_waveform(Waveform w) { kernel = oscillator::kernels().get(w); }
+    void set_amplitude(float a) { amplitude = a; }
+    /// @brief Applies to notes already playing from their next stage on.
+    void set_envelope(Envelope const& e);
+
+    MasterGain& master_gain() { return master; }
+    MasterGain const& master_gain() const { return master; }
+
+    VoicePool const& pool() const { return voices; }
+
+    /// @brief Below this many voices a block is mixed on the calling thread alone.
+    static constexpr int PARALLEL_VOICES = 32;
+    /// @brief Voices per WorkerPool task: few enough to balance, enough to amortize stealing.
+    static constexpr int VOICES_PER_TASK = 8;
+
+private:
+    static constexpr int NUM_CHANNELS = 16;
+    static constexpr std::uint8_t PERCUSSION_CHANNEL = 9;  ///< channel 10, General MIDI drums
+    static constexpr int MIX_FRAMES = 256;  ///< frames per parallel pass
+
+    static void mix_task(void* context, int thread, int task);
+
+    /// @brief Add one voice to the buffer, one fused kernel call per envelope segment.
+    void mix_voice(float* buffer, int numSamples, int voice, oscillator::Kernel kernel);
+
+    void control_change(std::uint8_t channel, std::uint8_t controller, std::uint8_t value);
+    float increment(std::uint8_t channel, std::uint8_t note, soundfont::Zone const* zone) const;
+
+    double sampleRate;
+    oscillator::Kernel kernel;
+    float amplitude = 0.3f;  // per voice at full velocity, range [0.0, 1.0]
+    VoicePool voices;
+    MasterGain master;
+    soundfont::Bank const* bank = nullptr;
+    resampler::Quality resampling = resampler::Quality::GOOD;
+
+    // Envelope, and its stages as level change per sample
+    Envelope envelope;
+    float attackStep;
+    float decayStep;
+    float releaseStep;
+
+    // Per channel pitch state
+    std::array<std::uint16_t, NUM_CHANNELS> bend;
+    std::array<std::uint8_t, NUM_CHANNELS> bendRange;
+    std::array<std::uint16_t, NUM_CHANNELS> rpn;  ///< selected registered parameter
+    std::array<std::uint8_t, NUM_CHANNELS> program{};
+
+    // Parallel mixing: the voices playing this block, and one partial mix per thread
+    WorkerPool* workers = nullptr;
+    std::array<std::uint16_t, MAX_VOICES> playing;
+    int numPlaying = 0;
+    oscillator::Kernel passKernel = nullptr;
+    int passFrames = 0;
+    alignas(64) std::array<std::array<float, MIX_FRAMES>, WorkerPool::MAX_THREADS> partials;
+};
+
+}  // namespace synth
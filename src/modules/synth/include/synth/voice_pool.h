@@ -0,0 +1,71 @@
+#pragma once
+
+#include "soundfont/bank.h"
+
+#include <array>
+#include <cstdint>
+
+namespace synth
+{
+constexpr int MAX_VOICES = 256;
+
+/// @brief Where a voice is in its envelope. Everything but FREE is sounding.
+enum class VoiceState : std::uint8_t
+{
+    FREE,
+    ATTACK,
+    DECAY,
+    SUSTAIN,
+    RELEASE
+};
+
+/// @brief Fixed-capacity voice storage, laid out as structure-of-arrays so the render loop can
+/// stream through one field at a time.
+///
+/// Nothing is allocated after construction: note on picks a free slot, or steals a voice when the
+/// pool is full, preferring the oldest released one.
+struct VoicePool
+{
+    alignas(64) std::array<float, MAX_VOICES> phase{};           ///< normalized, [0, 1)
+    alignas(64) std::array<float, MAX_VOICES> phaseIncrement{};  ///< cycles, or frames, per sample
+    alignas(64) std::array<float, MAX_VOICES> gain{};   ///< from the velocity
+    alignas(64) std::array<float, MAX_VOICES> level{};  ///< envelope, [0, 1]
+    alignas(64) std::array<std::uint64_t, MAX_VOICES> startedAt{};  ///< note on order, for stealing
+    alignas(64) std::array<std::uint8_t, MAX_VOICES> note{};
+    alignas(64) std::array<std::uint8_t, MAX_VOICES> channel{};
+    alignas(64) std::array<VoiceState, MAX_VOICES> state{};
+    // Sample voices: the zone playing, nullptr for an oscillator, and the frame reached in it
+    alignas(64) std::array<soundfont::Zone const*, MAX_VOICES> zone{};
+    alignas(64) std::array<double, MAX_VOICES> position{};
+
+    /// @brief Return the voice to use for a new note: the voice already sounding this note on
+    /// this channel, a free voice, the oldest released voice, or the oldest voice.
+    int allocate(std::uint8_t channel, std::uint8_t note);
+
+    /// @brief Return the voice holding this note on this channel (not yet released), or -1.
+    int find(std::uint8_t channel, std::uint8_t note) const;
+
+    void start(
+        int voice,
+        std::uint8_t channel,
+        std::uint8_t note,
+        float phaseIncrement,
+        float gain,
+        soundfont::Zone const* zone = nullptr
+    );
+    /// @brief Start the release stage; the voice is freed once its envelope reaches 0.
+    void release(int voice);
+    void release_all();
+    /// @brief Silence at once, without a release.
+    void stop_all() { state.fill(VoiceState::FREE); }
+
+    /// @brief Voices sounding, released ones included.
+    int active() const;
+
+    std::uint64_t steals = 0;
+
+private:
+    std::uint64_t noteCounter = 0;
+};
+
+}  // namespace synth
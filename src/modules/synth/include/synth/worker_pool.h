@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace synth
+{
+/// @brief Threads that help the audio thread through one block of independent tasks at a time.
+///
+/// run() deals the tasks out evenly, one contiguous range per thread, and every thread works
+/// from the front of its own range. A thread that runs out steals from the back of another's.
+/// Each range is a single atomic word, so taking or stealing a task is one compare-and-swap.
+/// run() returns once every thread has checked in at the end of the block. Idle workers spin
+/// briefly for the next block, then sleep on an atomic wait. Nothing is allocated or locked
+/// after construction.
+class WorkerPool
+{
+public:
+    static constexpr int MAX_THREADS = 16;
+
+    /// @brief Task function: context as given to run(), the thread running it (0 is the caller
+    /// of run()), and the task index.
+    using Task = void (*)(void* context, int thread, int task);
+
+    /// @brief Called first on every worker thread, with its index, e.g. to pin and schedule it.
+    using ThreadInit = std::function<void(int thread)>;
+
+    /// @param numThreads threads taking part in run(), the calling thread included
+    explicit WorkerPool(int numThreads, ThreadInit init = {});
+    ~WorkerPool();
+
+    WorkerPool(WorkerPool const&) = delete;
+    WorkerPool& operator=(WorkerPool const&) = delete;
+
+    int size() const { return numThreads; }
+
+    /// @brief Run tasks 0 to numTasks - 1 on every thread of the pool, including the caller, and
+    /// return when all are done. Only one thread may call run() at a time.
+    void run(int numTasks, Task task, void* context);
+
+    /// @brief Tasks run by a thread other than the one they were dealt to.
+    std::uint64_t steals() const { return stealCount.load(std::memory_order_relaxed); }
+
+private:
+    /// @brief One thread's tasks: [begin, end) packed into a word, begin in the low half.
+    struct alignas(64) Range
+    {
+        std::atomic<std::uint64_t> tasks{0};
+    };
+
+    void worker(int thread, ThreadInit const& init);
+    void work(int thread);
+    int take(int thread);
+    int steal(int victim);
+
+    int numThreads;
+    std::vector<Range> ranges;
+    std::vector<std::thread> threads;
+
+    Task task = nullptr;
+    void* context = nullptr;
+
+    alignas(64) std::atomic<std::uint32_t> generation{0};  ///< bumped to start a block
+    alignas(64) std::atomic<int> remaining{0};  ///< workers still in the current block
+    std::atomic<bool> stopping{false};
+    std::atomic<std::uint64_t> stealCount{0};
+};
+
+}  // namespace synth
@@ -0,0 +1,27 @@
+#include "synth/master_gain.h"
+
+#include <algorithm>
+#include <cmath>
+
+synth::MasterGain::MasterGain(double sampleRate, float gain)
+: target(gain)
+, current(gain)
+, maxStep(static_cast<float>(1.0 / (RAMP_SECONDS * sampleRate))) {}
+
+void synth::MasterGain::reset(float gain) {
+    target.store(gain, std::memory_order_relaxed);
+    current = gain;
+}
+
+void synth::MasterGain::next(int numFrames, float& start, float& step) {
+    start = current;
+    float const goal = target.load(std::memory_order_relaxed);
+    if (goal == current || numFrames <= 0) {
+        step = 0.f;
+        return;
+    }
+    float const limit = maxStep * static_cast<float>(numFrames);
+    float const delta = std::clamp(goal - current, -limit, limit);
+    step = delta / static_cast<float>(numFrames);
+    current = std::abs(goal - current) <= limit ? goal : current + delta;
+}
@@ -0,0 +1,132 @@
+#include "synth/render.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+// Frames mixed at once on the stack before conversion to the output layout.
+constexpr int CHUNK_FRAMES = 256;
+
+template <synth::SampleFormat FORMAT>
+struct Sample;
+
+template <>
+struct Sample<synth::SampleFormat::F32>
+{
+    using type = float;
+    static type convert(float x) { return x; }
+};
+
+template <>
+struct Sample<synth::SampleFormat::S16>
+{
+    using type = std::int16_t;
+    static type convert(float x) { return static_cast<type>(std::clamp(x, -1.f, 1.f) * 32'767.f); }
+};
+
+/// @brief Apply the master gain ramp and convert, in the one pass over the mix.
+template <int CHANNELS, synth::SampleFormat FORMAT>
+void write_interleaved(
+    const float* mix,
+    typename Sample<FORMAT>::type* out,
+    int numFrames,
+    float gain,
+    float gainStep
+) {
+    for (int i = 0; i < numFrames; ++i) {
+        auto sample = Sample<FORMAT>::convert(mix[i] * (gain + gainStep * static_cast<float>(i)));
+        for (int c = 0; c < CHANNELS; ++c) {
+            out[i * CHANNELS + c] = sample;
+        }
+    }
+}
+
+using synth::SampleFormat;
+using synth::Waveform;
+
+/// @brief The kernel member of a waveform, bound at compile time. Only the instruction set is
+/// left to the run time.
+template <Waveform WAVEFORM>
+constexpr oscillator::Kernel oscillator::Kernels::*kernel_of() {
+    if constexpr (WAVEFORM == Waveform::SINE) {
+        return &oscillator::Kernels::sine;
+    } else if constexpr (WAVEFORM == Waveform::SAW) {
+        return &oscillator::Kernels::saw;
+    } else {
+        return &oscillator::Kernels::square;
+    }
+}
+
+constexpr int NUM_WAVEFORMS = 3;
+constexpr int NUM_FORMATS = 2;
+
+template <Waveform WAVEFORM, int CHANNELS>
+constexpr std::array<synth::RenderFunction, NUM_FORMATS> formats() {
+    return {
+        synth::render<WAVEFORM, CHANNELS, SampleFormat::F32>,
+        synth::render<WAVEFORM, CHANNELS, SampleFormat::S16>,
+    };
+}
+
+template <Waveform WAVEFORM>
+constexpr std::array<std::array<synth::RenderFunction, NUM_FORMATS>, synth::MAX_CHANNELS>
+layouts() {
+    return {formats<WAVEFORM, 1>(), formats<WAVEFORM, 2>()};
+}
+
+// Indexed by [waveform][channels - 1][format]
+constexpr std::array<
+    std::array<std::array<synth::RenderFunction, NUM_FORMATS>, synth::MAX_CHANNELS>,
+    NUM_WAVEFORMS>
+RENDERERS = {
+    layouts<Waveform::SINE>(),
+    layouts<Waveform::SAW>(),
+    layouts<Waveform::SQUARE>(),
+};
+}  // namespace
+
+template <synth::Waveform WAVEFORM, int CHANNELS, synth::SampleFormat FORMAT>
+void synth::render(VoiceEngine& engine, void* buffer, int numFrames) {
+    static oscillator::Kernel const kernel = oscillator::kernels().*kernel_of<WAVEFORM>();
+    auto* out = static_cast<typename Sample<FORMAT>::type*>(buffer);
+
+    alignas(64) float mix[CHUNK_FRAMES];
+    for (int frame = 0; frame < numFrames; frame += CHUNK_FRAMES) {
+        int n = std::min(CHUNK_FRAMES, numFrames - frame);
+        std::memset(mix, 0, n * sizeof(float));
+        engine.mix(mix, n, kernel);
+        float gain, gainStep;
+        engine.master_gain().next(n, gain, gainStep);
+        write_interleaved<CHANNELS, FORMAT>(mix, out + frame * CHANNELS, n, gain, gainStep);
+    }
+}
+
+synth::RenderFunction synth::renderer(Waveform waveform, int channels, SampleFormat format) {
+    if (channels < 1 || channels > MAX_CHANNELS) {
+        return nullptr;
+    }
+    return RENDERERS[static_cast<int>(waveform)][channels - 1][static_cast<int>(format)];
+}
+
+void synth::interleave(
+    const float* mono,
+    void* out,
+    int numFrames,
+    int channels,
+    SampleFormat format
+) {
+    auto* f32 = static_cast<float*>(out);
+    auto* s16 = static_cast<std::int16_t*>(out);
+    if (format == SampleFormat::F32 && channels == 1) {
+        write_interleaved<1, SampleFormat::F32>(mono, f32, numFrames, 1.f, 0.f);
+    } else if (format == SampleFormat::F32) {
+        write_interleaved<2, SampleFormat::F32>(mono, f32, numFrames, 1.f, 0.f);
+    } else if (channels == 1) {
+        write_interleaved<1, SampleFormat::S16>(mono, s16, numFrames, 1.f, 0.f);
+    } else {
+        write_interleaved<2, SampleFormat::S16>(mono, s16, numFrames, 1.f, 0.f);
+    }
+}
@@ -0,0 +1,124 @@
+#include "synth/block_renderer.h"
+
+#include <doctest/doctest.h>
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+constexpr int SAMPLE_RATE = 48'000;
+constexpr int FRAMES = 1920;
+
+events::Event note_on(std::uint8_t note) {
+    return {.type = events::EventType::NOTE_ON, .data1 = note, .data2 = 100};
+}
+
+events::Event note_off(std::uint8_t note) {
+    return {.type = events::EventType::NOTE_OFF, .data1 = note};
+}
+
+/// @brief Render FRAMES mono frames in blocks of blockFrames with the same events scheduled.
+std::vector<float> render_in_blocks(int blockFrames) {
+    synth::VoiceEngine engine(SAMPLE_RATE, synth::Waveform::SAW);
+    synth::BlockRenderer blocks(
+        synth::renderer(synth::Waveform::SAW, 1, synth::SampleFormat::F32),
+        synth::bytes_per_frame(1, synth::SampleFormat::F32)
+    );
+    blocks.schedule(37, note_on(60));
+    blocks.schedule(500, note_on(64));
+    blocks.schedule(501, note_off(60));
+    blocks.schedule(1500, note_off(64));
+
+    std::vector<float> out(FRAMES);
+    for (int frame = 0; frame < FRAMES; frame += blockFrames) {
+        blocks.render(engine, out.data() + frame, blockFrames);
+    }
+    return out;
+}
+
+int first_sound(std::vector<float> const& out) {
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        if (out[i] != 0.f) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+}  // namespace
+
+TEST_CASE("events take effect at their frame, not at the block boundary") {
+    std::vector<float> out = render_in_blocks(480);
+    CHECK(first_sound(out) == 38);  // a note starts at phase 0, where the saw crosses zero
+    // The last note off at 1500 starts the release; silence follows once it is over.
+    int const silentFrom = 1500 + static_cast<int>(synth::Envelope{}.release * SAMPLE_RATE) + 1;
+    for (int i = silentFrom; i < FRAMES; ++i) {
+        CHECK(out[i] == 0.f);
+    }
+    CHECK(out[1499] != 0.f);
+    CHECK(out[1501] != 0.f);
+}
+
+TEST_CASE("output does not depend on the block size") {
+    std::vector<float> reference = render_in_blocks(FRAMES);
+    for (int blockFrames : {480, 64, 32}) {
+        std::vector<float> out = render_in_blocks(blockFrames);
+        int mismatches = 0;
+        for (int i = 0; i < FRAMES; ++i) {
+            mismatches += std::fabs(out[i] - reference[i]) > 1e-4f ? 1 : 0;
+        }
+        CHECK(mismatches == 0);
+    }
+}
+
+TEST_CASE("future events stay pending and late ones apply at the next block") {
+    synth::VoiceEngine engine(SAMPLE_RATE);
+    synth::BlockRenderer blocks(
+        synth::renderer(synth::Waveform::SQUARE, 2, synth::SampleFormat::S16),
+        synth::bytes_per_frame(2, synth::SampleFormat::S16)
+    );
+    std::array<std::int16_t, 2 * 480> out;
+
+    blocks.schedule(1000, note_on(60));
+    blocks.render(engine, out.data(), 480);
+    CHECK(blocks.position() == 480);
+    CHECK(blocks.pending() == 1);
+    CHECK(engine.pool().active() == 0);
+
+    blocks.render(engine, out.data(), 480);
+    CHECK(blocks.pending() == 1);
+    blocks.render(engine, out.data(), 480);
+    CHECK(blocks.pending() == 0);
+    CHECK(engine.pool().active() == 1);
+    CHECK(out[2 * (1000 - 960 - 1)] == 0);
+    CHECK(out[2 * (1000 - 960 + 1)] != 0);
+
+    blocks.schedule(0, note_off(60));  // already rendered
+    blocks.render(engine, out.data(), 480);
+    CHECK(engine.pool().find(0, 60) == -1);  // released at the start of the block
+    blocks.render(engine, out.data(), 480);
+    CHECK(engine.pool().active() == 0);
+    CHECK(out[0] == 0);
+}
+
+TEST_CASE("events at the same frame keep their order") {
+    synth::VoiceEngine engine(SAMPLE_RATE);
+    synth::BlockRenderer blocks(
+        synth::renderer(synth::Waveform::SINE, 1, synth::SampleFormat::F32),
+        synth::bytes_per_frame(1, synth::SampleFormat::F32)
+    );
+    std::array<float, 480> out;
+
+    blocks.schedule(100, note_on(60));
+    blocks.schedule(10, note_on(62));
+    blocks.schedule(100, note_off(60));
+    blocks.render(engine, out.data(), 480);
+    CHECK(engine.pool().active() == 1);
+    CHECK(engine.pool().find(0, 62) >= 0);
+
+    for (std::size_t i = 0; i < synth::BlockRenderer::CAPACITY; ++i) {
+        CHECK(blocks.schedule(10'000 + i, note_on(60)));
+    }
+    CHECK_FALSE(blocks.schedule(20'000, note_on(60)));
+}
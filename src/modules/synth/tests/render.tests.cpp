@@ -0,0 +1,75 @@
+#include "synth/render.h"
+
+#include <doctest/doctest.h>
+
+#include <array>
+#include <cstdint>
+
+namespace
+{
+constexpr int FRAMES = 480;
+}  // namespace
+
+TEST_CASE("renderer covers all supported layouts") {
+    for (auto waveform : {synth::Waveform::SINE, synth::Waveform::SAW, synth::Waveform::SQUARE}) {
+        for (int channels : {1, 2}) {
+            for (auto format : {synth::SampleFormat::F32, synth::SampleFormat::S16}) {
+                CHECK(synth::renderer(waveform, channels, format) != nullptr);
+            }
+        }
+        CHECK(synth::renderer(waveform, 0, synth::SampleFormat::F32) == nullptr);
+        CHECK(synth::renderer(waveform, 3, synth::SampleFormat::F32) == nullptr);
+    }
+    CHECK(synth::bytes_per_frame(2, synth::SampleFormat::S16) == 4);
+    CHECK(synth::bytes_per_frame(1, synth::SampleFormat::F32) == 4);
+}
+
+TEST_CASE("stereo output is interleaved and matches mono") {
+    synth::VoiceEngine mono(48'000, synth::Waveform::SAW);
+    synth::VoiceEngine stereo(48'000, synth::Waveform::SAW);
+    mono.note_on(0, 69, 127);
+    stereo.note_on(0, 69, 127);
+
+    std::array<float, FRAMES> monoOut;
+    std::array<float, 2 * FRAMES> stereoOut;
+    auto renderMono = synth::renderer(synth::Waveform::SAW, 1, synth::SampleFormat::F32);
+    auto renderStereo = synth::renderer(synth::Waveform::SAW, 2, synth::SampleFormat::F32);
+    renderMono(mono, monoOut.data(), FRAMES);
+    renderStereo(stereo, stereoOut.data(), FRAMES);
+
+    int mismatches = 0;
+    for (int i = 0; i < FRAMES; ++i) {
+        mismatches += stereoOut[2 * i] != monoOut[i] ? 1 : 0;
+        mismatches += stereoOut[2 * i + 1] != monoOut[i] ? 1 : 0;
+    }
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE("s16 output is scaled and clipped") {
+    synth::VoiceEngine engine(48'000, synth::Waveform::SQUARE);
+    engine.set_amplitude(1.f);
+    for (std::uint8_t note = 60; note < 72; ++note) {
+        engine.note_on(0, note, 127);  // sums well above full scale
+    }
+
+    std::array<std::int16_t, 2 * FRAMES> out;
+    auto render = synth::renderer(synth::Waveform::SQUARE, 2, synth::SampleFormat::S16);
+    render(engine, out.data(), FRAMES);
+
+    int clipped = 0;
+    for (auto s : out) {
+        clipped += s == 32'767 || s == -32'767 ? 1 : 0;
+    }
+    CHECK(clipped > 0);
+}
+
+TEST_CASE("a mono mix is interleaved to any layout") {
+    std::array<float, 4> const mono = {0.f, 0.5f, -1.f, 2.f};
+    std::array<float, 8> f32{};
+    synth::interleave(mono.data(), f32.data(), 4, 2, synth::SampleFormat::F32);
+    CHECK(f32 == std::array<float, 8>{0.f, 0.f, 0.5f, 0.5f, -1.f, -1.f, 2.f, 2.f});
+
+    std::array<std::int16_t, 4> s16{};
+    synth::interleave(mono.data(), s16.data(), 4, 1, synth::SampleFormat::S16);
+    CHECK(s16 == std::array<std::int16_t, 4>{0, 16'383, -32'767, 32'767});
+}
@@ -0,0 +1,371 @@
+#include "soundfont/sf2_builder.h"
+#include "synth/render.h"
+#include "synth/voice_engine.h"
+
+#include <doctest/doctest.h>
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace
+{
+thread_local bool countAllocations = false;
+thread_local int allocations = 0;
+
+constexpr int BLOCK = 480;
+
+float peak(std::array<float, BLOCK> const& buffer) {
+    float p = 0.f;
+    for (float s : buffer) {
+        p = std::max(p, std::fabs(s));
+    }
+    return p;
+}
+
+/// @brief A bank of flat samples at 24 kHz: a quarter scale loop on program 0, a half scale one
+/// on program 1, and a 100 frame hit in the percussion kit for key 36 only.
+Bytes flat_bank() {
+    std::vector<std::int16_t> data(2000, 8192);
+    std::fill(data.begin() + 1000, data.end(), 16384);
+    return sf2(
+        data,
+        {
+            {.start = 0, .end = 900, .loopStart = 100, .loopEnd = 800, .rate = 24'000},
+            {.start = 1000, .end = 1900, .loopStart = 1100, .loopEnd = 1800, .rate = 24'000},
+            {.start = 1000, .end = 1100, .loopStart = 0, .loopEnd = 0, .rate = 24'000},
+        },
+        {
+            {{{GEN_SAMPLE_MODES, 1}, {GEN_SAMPLE_ID, 0}}},
+            {{{GEN_SAMPLE_MODES, 1}, {GEN_SAMPLE_ID, 1}}},
+            {{{GEN_KEY_RANGE, range(36, 36)}, {GEN_OVERRIDING_ROOT_KEY, 36}, {GEN_SAMPLE_ID, 2}}},
+        },
+        {
+            {.program = 0, .bank = 0, .zones = {{{GEN_INSTRUMENT, 0}}}},
+            {.program = 1, .bank = 0, .zones = {{{GEN_INSTRUMENT, 1}}}},
+            {.program = 0, .bank = 128, .zones = {{{GEN_INSTRUMENT, 2}}}},
+        }
+    );
+}
+}  // namespace
+
+void* operator new(std::size_t size) {
+    if (countAllocations) {
+        ++allocations;
+    }
+    if (void* p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+// noinline: keeps GCC from flagging free() on memory it saw come from operator new
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+TEST_CASE("voice engine is silent without notes") {
+    synth::VoiceEngine engine(48'000);
+    std::array<float, BLOCK> buffer;
+    buffer.fill(1.f);
+    engine.render(buffer.data(), BLOCK);
+    CHECK(peak(buffer) == 0.f);
+}
+
+TEST_CASE("voice engine plays chords") {
+    synth::VoiceEngine engine(48'000, synth::Waveform::SQUARE);
+    engine.set_amplitude(0.25f);
+    std::array<float, BLOCK> buffer;
+
+    engine.note_on(0, 60, 127);
+    engine.render(buffer.data(), BLOCK);
+    CHECK(peak(buffer) == doctest::Approx(0.25));
+
+    engine.note_on(0, 64, 127);
+    engine.note_on(0, 67, 127);
+    CHECK(engine.pool().active() == 3);
+    engine.render(buffer.data(), BLOCK);
+    CHECK(peak(buffer) > 0.25f);
+    CHECK(peak(buffer) <= 0.75f + 1e-6f);
+
+    engine.note_off(0, 64);
+    CHECK(engine.pool().find(0, 64) == -1);
+    engine.render(buffer.data(), BLOCK);
+    engine.render(buffer.data(), BLOCK);  // past the release
+    CHECK(engine.pool().active() == 2);
+
+    // note off on another channel does not release the note
+    engine.note_off(1, 60);
+    CHECK(engine.pool().find(0, 60) >= 0);
+
+    engine.handle({.type = events::EventType::CONTROL_CHANGE, .data1 = 123});
+    CHECK(engine.pool().find(0, 60) == -1);
+    CHECK(engine.pool().find(0, 67) == -1);
+    engine.render(buffer.data(), BLOCK);
+    engine.render(buffer.data(), BLOCK);
+    CHECK(engine.pool().active() == 0);
+}
+
+TEST_CASE("voice engine retriggers instead of doubling a note") {
+    synth::VoiceEngine engine(48'000);
+    engine.note_on(0, 60, 100);
+    engine.note_on(0, 60, 50);
+    CHECK(engine.pool().active() == 1);
+    engine.note_on(1, 60, 50);
+    CHECK(engine.pool().active() == 2);
+}
+
+TEST_CASE("voice engine steals the oldest voice") {
+    synth::VoiceEngine engine(48'000);
+    // Fill the pool with distinct notes, 128 per channel.
+    for (int n = 0; n < synth::MAX_VOICES; ++n) {
+        engine.note_on(std::uint8_t(n / 128), std::uint8_t(n % 128), 100);
+    }
+    CHECK(engine.pool().active() == synth::MAX_VOICES);
+    CHECK(engine.pool().steals == 0);
+
+    engine.note_on(15, 100, 100);
+    CHECK(engine.pool().active() == synth::MAX_VOICES);
+    CHECK(engine.pool().steals == 1);
+    CHECK(engine.pool().find(0, 0) == -1);  // the first note was stolen
+    CHECK(engine.pool().find(0, 1) >= 0);
+    CHECK(engine.pool().find(15, 100) >= 0);
+}
+
+TEST_CASE("voice engine does not allocate on note on or render") {
+    synth::VoiceEngine engine(48'000, synth::Waveform::SAW);
+    std::array<float, BLOCK> buffer;
+
+    allocations = 0;
+    countAllocations = true;
+    for (int n = 0; n < 2 * synth::MAX_VOICES; ++n) {
+        engine.handle({.type = events::EventType::NOTE_ON, .data1 = std::uint8_t(n), .data2 = 90});
+        engine.render(buffer.data(), BLOCK);
+    }
+    for (int n = 0; n < 2 * synth::MAX_VOICES; ++n) {
+        engine.handle({.type = events::EventType::NOTE_OFF, .data1 = std::uint8_t(n)});
+    }
+    engine.render(buffer.data(), BLOCK);
+    engine.render(buffer.data(), BLOCK);
+    countAllocations = false;
+
+    CHECK(allocations == 0);
+    CHECK(engine.pool().active() == 0);
+}
+
+TEST_CASE("pitch bend retunes the channel within its bend range") {
+    constexpr double RATE = 48'000;
+    synth::VoiceEngine engine(RATE);
+    engine.note_on(0, 69, 100);
+    engine.note_on(1, 69, 100);
+    int voice = engine.pool().find(0, 69);
+    int other = engine.pool().find(1, 69);
+    CHECK(engine.pool().phaseIncrement[voice] == doctest::Approx(440.0 / RATE));
+
+    engine.handle({.type = events::EventType::PITCH_BEND, .data1 = 0x7F, .data2 = 0x7F});
+    CHECK(engine.pool().phaseIncrement[voice] == doctest::Approx(493.88 / RATE).epsilon(1e-3));
+    CHECK(engine.pool().phaseIncrement[other] == doctest::Approx(440.0 / RATE));
+
+    // RPN 0: bend range of 12 semitones
+    for (auto [cc, value] : {std::pair{101, 0}, std::pair{100, 0}, std::pair{6, 12}}) {
+        engine.handle(
+            {.type = events::EventType::CONTROL_CHANGE,
+             .data1 = std::uint8_t(cc),
+             .data2 = std::uint8_t(value)}
+        );
+    }
+    CHECK(engine.pool().phaseIncrement[voice] == doctest::Approx(880.0 / RATE).epsilon(1e-3));
+
+    // New notes start bent
+    engine.note_on(0, 57, 100);
+    int low = engine.pool().find(0, 57);
+    CHECK(engine.pool().phaseIncrement[low] == doctest::Approx(440.0 / RATE).epsilon(1e-3));
+
+    engine.handle({.type = events::EventType::CONTROL_CHANGE, .data1 = 121});
+    CHECK(engine.pool().phaseIncrement[voice] == doctest::Approx(440.0 / RATE));
+}
+
+TEST_CASE("mixing on a worker pool matches mixing on one thread") {
+    constexpr int VOICES = 200;
+    auto serial = std::make_unique<synth::VoiceEngine>(48'000, synth::Waveform::SAW);
+    auto parallel = std::make_unique<synth::VoiceEngine>(48'000, synth::Waveform::SAW);
+    synth::WorkerPool workers(4);
+    parallel->set_workers(&workers);
+    for (int n = 0; n < VOICES; ++n) {
+        auto channel = std::uint8_t(n % 16);
+        auto note = std::uint8_t(24 + n / 16 * 7 + n % 16);
+        serial->note_on(channel, note, 100);
+        parallel->note_on(channel, note, 100);
+    }
+
+    // A few blocks, so the voices' phases carry across passes and blocks. The renderer mixes in
+    // chunks the size of a parallel pass, so both engines advance their phases in the same steps.
+    auto render = synth::renderer(synth::Waveform::SAW, 1, synth::SampleFormat::F32);
+    std::array<float, BLOCK> expected, actual;
+    for (int block = 0; block < 4; ++block) {
+        render(*serial, expected.data(), BLOCK);
+        render(*parallel, actual.data(), BLOCK);
+        // Only the order of the additions differs.
+        float error = 0.f;
+        for (int i = 0; i < BLOCK; ++i) {
+            error = std::max(error, std::fabs(actual[i] - expected[i]));
+        }
+        CHECK(error < 1e-4f);
+    }
+    CHECK(peak(actual) > 0.f);
+}
+
+TEST_CASE("notes fade in and out instead of gating") {
+    constexpr int RATE = 48'000;
+    synth::VoiceEngine engine(RATE, synth::Waveform::SQUARE);
+    engine.set_amplitude(1.f);
+    engine.set_envelope({.attack = 0.005f, .decay = 0.f, .sustain = 1.f, .release = 0.005f});
+    std::array<float, BLOCK> buffer;
+
+    // 240 samples of attack: the square wave's amplitude grows linearly to full level.
+    engine.note_on(0, 60, 127);
+    engine.render(buffer.data(), BLOCK);
+    CHECK(std::fabs(buffer[1]) < 0.01f);
+    CHECK(std::fabs(buffer[60]) == doctest::Approx(0.25f).epsilon(0.02));
+    CHECK(std::fabs(buffer[120]) == doctest::Approx(0.5f).epsilon(0.02));
+    CHECK(std::fabs(buffer[300]) == doctest::Approx(1.f).epsilon(0.02));
+
+    // And 240 samples of release, then the voice is free.
+    engine.note_off(0, 60);
+    engine.render(buffer.data(), BLOCK);
+    CHECK(std::fabs(buffer[0]) == doctest::Approx(1.f).epsilon(0.02));
+    CHECK(std::fabs(buffer[120]) == doctest::Approx(0.5f).epsilon(0.02));
+    CHECK(buffer[300] == 0.f);
+    CHECK(engine.pool().active() == 0);
+}
+
+TEST_CASE("the envelope decays to the sustain level and velocity scales it") {
+    synth::VoiceEngine engine(48'000, synth::Waveform::SQUARE);
+    engine.set_amplitude(1.f);
+    engine.set_envelope({.attack = 0.f, .decay = 0.002f, .sustain = 0.5f, .release = 0.01f});
+    std::array<float, BLOCK> buffer;
+
+    engine.note_on(0, 60, 127);
+    engine.render(buffer.data(), BLOCK);
+    CHECK(std::fabs(buffer[1]) > 0.9f);  // no attack: the decay starts at full level
+    CHECK(std::fabs(buffer[200]) == doctest::Approx(0.5f));
+
+    engine.note_on(1, 60, 64);
+    engine.note_off(0, 60);
+    engine.render(buffer.data(), BLOCK);
+    engine.render(buffer.data(), BLOCK);
+    CHECK(engine.pool().active() == 1);
+    CHECK(peak(buffer) == doctest::Approx(0.5f * 64 / 127).epsilon(0.01));
+}
+
+TEST_CASE("all sound off cuts without a release") {
+    synth::VoiceEngine engine(48'000);
+    std::array<float, BLOCK> buffer;
+    engine.note_on(0, 60, 100);
+    engine.render(buffer.data(), BLOCK);
+    engine.handle({.type = events::EventType::CONTROL_CHANGE, .data1 = 120});
+    CHECK(engine.pool().active() == 0);
+    engine.render(buffer.data(), BLOCK);
+    CHECK(peak(buffer) == 0.f);
+}
+
+TEST_CASE("master gain changes are ramped") {
+    synth::VoiceEngine engine(48'000, synth::Waveform::SQUARE);
+    engine.set_amplitude(1.f);
+    engine.set_envelope({.attack = 0.f, .decay = 0.f, .sustain = 1.f, .release = 0.01f});
+    std::array<float, BLOCK> buffer;
+    engine.note_on(0, 60, 127);
+    engine.render(buffer.data(), BLOCK);
+    CHECK(peak(buffer) == doctest::Approx(1.f));
+
+    // Full scale takes 20 ms, 960 samples: a drop to 0 is halfway after one block.
+    engine.master_gain().set(0.f);
+    engine.render(buffer.data(), BLOCK);
+    CHECK(std::fabs(buffer[0]) == doctest::Approx(1.f).epsilon(0.01));
+    CHECK(std::fabs(buffer[BLOCK - 1]) == doctest::Approx(0.5f).epsilon(0.01));
+    engine.render(buffer.data(), BLOCK);
+    engine.render(buffer.data(), BLOCK);
+    CHECK(peak(buffer) == 0.f);
+
+    engine.master_gain().reset(0.25f);
+    engine.render(buffer.data(), BLOCK);
+    CHECK(peak(buffer) == doctest::Approx(0.25f));
+}
+
+TEST_CASE("sample voices play the zone of the channel's program") {
+    Bytes const bytes = flat_bank();
+    soundfont::Bank bank;
+    REQUIRE(bank.parse(bytes));
+    synth::VoiceEngine engine(48'000);
+    engine.set_amplitude(1.f);
+    engine.set_envelope({.attack = 0.f, .decay = 0.f, .sustain = 1.f, .release = 0.001f});
+    engine.set_soundfont(&bank);
+    std::array<float, BLOCK> buffer;
+
+    engine.note_on(0, 60, 127);
+    engine.render(buffer.data(), BLOCK);
+    engine.render(buffer.data(), BLOCK);  // through the loop
+    CHECK(buffer[0] == doctest::Approx(0.25f));
+    CHECK(buffer[BLOCK - 1] == doctest::Approx(0.25f));
+    engine.note_off(0, 60);
+
+    engine.handle({.type = events::EventType::PROGRAM_CHANGE, .channel = 1, .data1 = 1});
+    engine.note_on(1, 60, 127);
+    engine.render(buffer.data(), BLOCK);
+    CHECK(engine.pool().active() == 1);
+    CHECK(buffer[BLOCK - 1] == doctest::Approx(0.5f));
+    engine.all_sound_off();
+
+    // Channel 10 plays the percussion kit; a key without a zone plays nothing.
+    engine.note_on(9, 35, 127);
+    CHECK(engine.pool().active() == 0);
+    engine.note_on(9, 36, 127);
+    CHECK(engine.pool().active() == 1);
+    engine.render(buffer.data(), BLOCK);
+    // Clear of its edges, which the resampling filter softens
+    CHECK(buffer[20] == doctest::Approx(0.5f));
+
+    // The hit is not looped: the voice ends with it, 100 frames at half speed.
+    CHECK(buffer[180] == doctest::Approx(0.5f));
+    CHECK(buffer[200] == 0.f);
+    CHECK(engine.pool().active() == 0);
+}
+
+TEST_CASE("sample voices are pitched from the root key") {
+    Bytes const bytes = flat_bank();
+    soundfont::Bank bank;
+    REQUIRE(bank.parse(bytes));
+    synth::VoiceEngine engine(48'000);
+    engine.set_soundfont(&bank);
+
+    // Recorded at 24 kHz for key 60: half a frame per sample there, a whole frame an octave up.
+    engine.note_on(0, 60, 100);
+    engine.note_on(0, 72, 100);
+    engine.note_on(0, 70, 100);
+    CHECK(engine.pool().phaseIncrement[engine.pool().find(0, 60)] == doctest::Approx(0.5f));
+    CHECK(engine.pool().phaseIncrement[engine.pool().find(0, 72)] == doctest::Approx(1.f));
+
+    engine.pitch_bend(0, 0x3FFF);  // 2 semitones up
+    CHECK(
+        engine.pool().phaseIncrement[engine.pool().find(0, 70)] ==
+        doctest::Approx(1.f).epsilon(0.001)
+    );
+
+    // Without the bank the oscillators play again.
+    engine.set_soundfont(nullptr);
+    engine.pitch_bend(0, midi::PITCH_BEND_CENTER);
+    CHECK(engine.pool().active() == 0);
+    engine.note_on(0, 69, 100);
+    CHECK(
+        engine.pool().phaseIncrement[engine.pool().find(0, 69)] ==
+        doctest::Approx(440.0 / 48'000)
+    );
+}
@@ -0,0 +1,86 @@
+#include "synth/worker_pool.h"
+
+#include <doctest/doctest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <thread>
+
+namespace
+{
+constexpr int NUM_TASKS = 100;
+
+struct Counts
+{
+    std::array<std::atomic<int>, NUM_TASKS> runs{};
+    std::array<std::atomic<int>, NUM_TASKS> thread{};
+};
+
+void count(void* context, int thread, int task) {
+    auto& counts = *static_cast<Counts*>(context);
+    counts.runs[task].fetch_add(1, std::memory_order_relaxed);
+    counts.thread[task].store(thread, std::memory_order_relaxed);
+}
+}  // namespace
+
+TEST_CASE("every task runs exactly once per block") {
+    synth::WorkerPool workers(4);
+    CHECK(workers.size() == 4);
+    for (int block = 0; block < 1000; ++block) {
+        Counts counts;
+        int const numTasks = block % NUM_TASKS + 1;
+        workers.run(numTasks, count, &counts);
+        for (int t = 0; t < NUM_TASKS; ++t) {
+            REQUIRE(counts.runs[t].load() == (t < numTasks ? 1 : 0));
+        }
+    }
+}
+
+TEST_CASE("a single thread pool runs tasks on the caller") {
+    synth::WorkerPool workers(1);
+    Counts counts;
+    workers.run(NUM_TASKS, count, &counts);
+    for (int t = 0; t < NUM_TASKS; ++t) {
+        CHECK(counts.runs[t].load() == 1);
+        CHECK(counts.thread[t].load() == 0);
+    }
+    CHECK(workers.steals() == 0);
+}
+
+TEST_CASE("idle threads steal tasks from a busy one") {
+    synth::WorkerPool workers(4);
+    // Every task of thread 0's share is slow: the caller would take 25 ms alone.
+    struct Slow
+    {
+        std::array<std::atomic<int>, NUM_TASKS> thread{};
+    } slow;
+    auto task = [](void* context, int thread, int task) {
+        static_cast<Slow*>(context)->thread[task].store(thread);
+        if (task < NUM_TASKS / 4) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+    workers.run(NUM_TASKS, task, &slow);
+
+    std::set<int> threads;
+    for (int t = 0; t < NUM_TASKS / 4; ++t) {
+        threads.insert(slow.thread[t].load());
+    }
+    CHECK(threads.size() > 1);
+    CHECK(workers.steals() > 0);
+}
+
+TEST_CASE("the thread init hook runs once on every worker") {
+    std::array<std::atomic<int>, synth::WorkerPool::MAX_THREADS> started{};
+    {
+        synth::WorkerPool workers(3, [&started](int thread) { started[thread].fetch_add(1); });
+        Counts counts;
+        workers.run(NUM_TASKS, count, &counts);
+    }
+    CHECK(started[0].load() == 0);  // the caller's own thread is left alone
+    CHECK(started[1].load() == 1);
+    CHECK(started[2].load() == 1);
+    CHECK(started[3].load() == 0);
+}
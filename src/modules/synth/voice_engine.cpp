@@ -0,0 +1,301 @@
+#include "synth/voice_engine.h"
+
+#include "soundfont/player.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+// CC numbers handled by the engine
+constexpr std::uint8_t CC_DATA_ENTRY = 6;
+constexpr std::uint8_t CC_RPN_LSB = 100;
+constexpr std::uint8_t CC_RPN_MSB = 101;
+constexpr std::uint8_t CC_ALL_SOUND_OFF = 120;
+constexpr std::uint8_t CC_RESET_ALL_CONTROLLERS = 121;
+constexpr std::uint8_t CC_ALL_NOTES_OFF = 123;
+
+constexpr std::uint16_t RPN_PITCH_BEND_RANGE = 0;
+constexpr std::uint16_t RPN_NULL = 0x3FFF;
+}  // namespace
+
+synth::VoiceEngine::VoiceEngine(double sampleRate, Waveform waveform)
+: sampleRate(sampleRate)
+, kernel(oscillator::kernels().get(waveform))
+, master(sampleRate) {
+    set_envelope(Envelope{});
+    bend.fill(midi::PITCH_BEND_CENTER);
+    bendRange.fill(midi::DEFAULT_BEND_RANGE);
+    rpn.fill(RPN_NULL);
+}
+
+void synth::VoiceEngine::handle(events::Event const& event) {
+    switch (event.type) {
+        case events::EventType::NOTE_ON:
+            note_on(event.channel, event.data1, event.data2);
+            break;
+        case events::EventType::NOTE_OFF:
+            note_off(event.channel, event.data1);
+            break;
+        case events::EventType::CONTROL_CHANGE:
+            control_change(event.channel, event.data1, event.data2);
+            break;
+        case events::EventType::PITCH_BEND:
+            pitch_bend(event.channel, std::uint16_t(event.data1 | event.data2 << 7));
+            break;
+        case events::EventType::PROGRAM_CHANGE:
+            program_change(event.channel, event.data1);
+            break;
+        default:
+            break;
+    }
+}
+
+void synth::VoiceEngine::control_change(
+    std::uint8_t channel,
+    std::uint8_t controller,
+    std::uint8_t value
+) {
+    channel &= NUM_CHANNELS - 1;
+    switch (controller) {
+        case CC_RPN_MSB:
+            rpn[channel] = std::uint16_t((rpn[channel] & 0x7F) | value << 7);
+            break;
+        case CC_RPN_LSB:
+            rpn[channel] = std::uint16_t((rpn[channel] & ~0x7F) | value);
+            break;
+        case CC_DATA_ENTRY:
+            if (rpn[channel] == RPN_PITCH_BEND_RANGE) {
+                bendRange[channel] = std::min<std::uint8_t>(value, midi::MAX_BEND_RANGE);
+                pitch_bend(channel, bend[channel]);
+            }
+            break;
+        case CC_RESET_ALL_CONTROLLERS:
+            rpn[channel] = RPN_NULL;
+            pitch_bend(channel, midi::PITCH_BEND_CENTER);
+            break;
+        case CC_ALL_SOUND_OFF:
+            all_sound_off();
+            break;
+        case CC_ALL_NOTES_OFF:
+            all_notes_off();
+            break;
+        default:
+            break;
+    }
+}
+
+float synth::VoiceEngine::increment(
+    std::uint8_t channel,
+    std::uint8_t note,
+    soundfont::Zone const* zone
+) const {
+    double const frequency = midi::frequency(note, bend[channel], bendRange[channel]);
+    if (!zone) {
+        return static_cast<float>(frequency / sampleRate);
+    }
+    // Frames per sample: the sample's rate, sped up by how far the note is from its root key.
+    double const root = midi::frequency(69) * std::exp2((zone->rootKey - 69.0) / 12.0);
+    return static_cast<float>(frequency / root * zone->sampleRate / sampleRate);
+}
+
+void synth::VoiceEngine::note_on(std::uint8_t channel, std::uint8_t note, std::uint8_t velocity) {
+    channel &= NUM_CHANNELS - 1;
+    float gain = amplitude * velocity / 127.f;
+    soundfont::Zone const* zone = nullptr;
+    if (bank) {
+        int const slot = channel == PERCUSSION_CHANNEL ? soundfont::PERCUSSION : program[channel];
+        zone = bank->find(slot, note, velocity);
+        if (!zone) {
+            return;  // nothing to play for this key
+        }
+        gain *= zone->gain;
+    }
+    voices.start(
+        voices.allocate(channel, note),
+        channel,
+        note,
+        increment(channel, note, zone),
+        gain,
+        zone
+    );
+}
+
+void synth::VoiceEngine::program_change(std::uint8_t channel, std::uint8_t value) {
+    // Only new notes change sound; playing ones keep their zone.
+    program[channel & (NUM_CHANNELS - 1)] = value & 0x7F;
+}
+
+void synth::VoiceEngine::set_soundfont(soundfont::Bank const* b) {
+    voices.stop_all();
+    bank = b;
+}
+
+void synth::VoiceEngine::pitch_bend(std::uint8_t channel, std::uint16_t value) {
+    channel &= NUM_CHANNELS - 1;
+    bend[channel] = value;
+    for (int v = 0; v < MAX_VOICES; ++v) {
+        if (voices.state[v] != VoiceState::FREE && voices.channel[v] == channel) {
+            voices.phaseIncrement[v] = increment(channel, voices.note[v], voices.zone[v]);
+        }
+    }
+}
+
+void synth::VoiceEngine::note_off(std::uint8_t channel, std::uint8_t note) {
+    int voice = voices.find(channel, note);
+    if (voice >= 0) {
+        voices.release(voice);
+    }
+}
+
+void synth::VoiceEngine::set_envelope(Envelope const& e) {
+    envelope = e;
+    envelope.sustain = std::clamp(envelope.sustain, 0.f, 1.f);
+    // A stage lasts at least one sample, so a zero time is a jump, not a division by zero.
+    auto samples = [this](float seconds) {
+        return static_cast<float>(std::max(1.0, seconds * sampleRate));
+    };
+    attackStep = 1.f / samples(envelope.attack);
+    decayStep = (1.f - envelope.sustain) / samples(envelope.decay);
+    releaseStep = 1.f / samples(envelope.release);
+}
+
+void synth::VoiceEngine::render(float* buffer, int numSamples) {
+    std::memset(buffer, 0, numSamples * sizeof(float));
+    mix(buffer, numSamples, kernel);
+    float gain, step;
+    master.next(numSamples, gain, step);
+    for (int i = 0; i < numSamples; ++i) {
+        buffer[i] *= gain + step * static_cast<float>(i);
+    }
+}
+
+void synth::VoiceEngine::mix(float* buffer, int numSamples, oscillator::Kernel kernel) {
+    numPlaying = 0;
+    for (int v = 0; v < MAX_VOICES; ++v) {
+        if (voices.state[v] != VoiceState::FREE) {
+            playing[numPlaying++] = std::uint16_t(v);
+        }
+    }
+    if (!workers || workers->size() == 1 || numPlaying < PARALLEL_VOICES) {
+        for (int i = 0; i < numPlaying; ++i) {
+            mix_voice(buffer, numSamples, playing[i], kernel);
+        }
+        return;
+    }
+
+    int const numTasks = (numPlaying + VOICES_PER_TASK - 1) / VOICES_PER_TASK;
+    int const numThreads = workers->size();
+    passKernel = kernel;
+    for (int frame = 0; frame < numSamples; frame += MIX_FRAMES) {
+        passFrames = std::min(MIX_FRAMES, numSamples - frame);
+        for (int t = 0; t < numThreads; ++t) {
+            std::memset(partials[t].data(), 0, passFrames * sizeof(float));
+        }
+        workers->run(numTasks, &VoiceEngine::mix_task, this);
+        for (int t = 0; t < numThreads; ++t) {
+            float const* partial = partials[t].data();
+            for (int i = 0; i < passFrames; ++i) {
+                buffer[frame + i] += partial[i];
+            }
+        }
+    }
+}
+
+void synth::VoiceEngine::mix_task(void* context, int thread, int task) {
+    auto& engine = *static_cast<VoiceEngine*>(context);
+    float* partial = engine.partials[thread].data();
+    int const last = std::min((task + 1) * VOICES_PER_TASK, engine.numPlaying);
+    for (int i = task * VOICES_PER_TASK; i < last; ++i) {
+        engine.mix_voice(partial, engine.passFrames, engine.playing[i], engine.passKernel);
+    }
+}
+
+void synth::VoiceEngine::mix_voice(
+    float* buffer,
+    int numSamples,
+    int voice,
+    oscillator::Kernel kernel
+) {
+    float& level = voices.level[voice];
+    float const gain = voices.gain[voice];
+    soundfont::Zone const* zone = voices.zone[voice];
+    int done = 0;
+    while (done < numSamples) {
+        float target = 0.f;
+        float step = 0.f;
+        VoiceState next = VoiceState::FREE;
+        switch (voices.state[voice]) {
+            case VoiceState::FREE:
+                return;
+            case VoiceState::ATTACK:
+                target = 1.f;
+                step = attackStep;
+                next = VoiceState::DECAY;
+                break;
+            case VoiceState::DECAY:
+                target = envelope.sustain;
+                step = -decayStep;
+                next = VoiceState::SUSTAIN;
+                break;
+            case VoiceState::SUSTAIN:
+                target = level;
+                next = VoiceState::SUSTAIN;
+                break;
+            case VoiceState::RELEASE:
+                step = -releaseStep;
+                break;
+        }
+
+        // Samples left in this stage. Sustain lasts the rest of the buffer; a stage with nothing
+        // to ramp, e.g. a decay to a sustain of 1, ends at once.
+        int const remaining = numSamples - done;
+        int stageLeft = remaining;
+        if (step != 0.f) {
+            float const distance = (target - level) / step;
+            stageLeft = distance > 0.f ? static_cast<int>(std::ceil(distance)) : 0;
+        } else if (voices.state[voice] != VoiceState::SUSTAIN) {
+            stageLeft = 0;
+        }
+        int const n = std::min(stageLeft, remaining);
+        if (n > 0 && zone) {
+            // A sample voice ends with its sample, whatever its envelope stage.
+            bool const looping = zone->loop == soundfont::LoopMode::CONTINUOUS ||
+                                 voices.state[voice] != VoiceState::RELEASE;
+            int const played = soundfont::play(
+                buffer + done,
+                n,
+                bank->samples(),
+                *zone,
+                voices.position[voice],
+                voices.phaseIncrement[voice],
+                gain * level,
+                gain * step,
+                looping,
+                resampling
+            );
+            if (played < n) {
+                voices.state[voice] = VoiceState::FREE;
+                return;
+            }
+        } else if (n > 0) {
+            kernel(
+                buffer + done,
+                n,
+                voices.phase[voice],
+                voices.phaseIncrement[voice],
+                gain * level,
+                gain * step
+            );
+        }
+        if (n > 0) {
+            level += step * static_cast<float>(n);
+            done += n;
+        }
+        if (n == stageLeft && next != voices.state[voice]) {
+            level = target;
+            voices.state[voice] = next;
+        }
+    }
+}
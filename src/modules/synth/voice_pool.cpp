@@ -0,0 +1,80 @@
+#include "synth/voice_pool.h"
+
+int synth::VoicePool::allocate(std::uint8_t channel, std::uint8_t note) {
+    for (int v = 0; v < MAX_VOICES; ++v) {
+        if (state[v] != VoiceState::FREE && this->note[v] == note && this->channel[v] == channel) {
+            return v;  // retrigger, even while releasing
+        }
+    }
+
+    int oldest = 0;
+    int oldestReleased = -1;
+    for (int v = 0; v < MAX_VOICES; ++v) {
+        if (state[v] == VoiceState::FREE) {
+            return v;
+        }
+        if (startedAt[v] < startedAt[oldest]) {
+            oldest = v;
+        }
+        if (state[v] == VoiceState::RELEASE &&
+            (oldestReleased < 0 || startedAt[v] < startedAt[oldestReleased])) {
+            oldestReleased = v;
+        }
+    }
+    ++steals;
+    return oldestReleased >= 0 ? oldestReleased : oldest;
+}
+
+int synth::VoicePool::find(std::uint8_t channel, std::uint8_t note) const {
+    for (int v = 0; v < MAX_VOICES; ++v) {
+        if (state[v] != VoiceState::FREE && state[v] != VoiceState::RELEASE &&
+            this->note[v] == note && this->channel[v] == channel) {
+            return v;
+        }
+    }
+    return -1;
+}
+
+void synth::VoicePool::release(int voice) {
+    if (state[voice] != VoiceState::FREE) {
+        state[voice] = VoiceState::RELEASE;
+    }
+}
+
+void synth::VoicePool::release_all() {
+    for (int v = 0; v < MAX_VOICES; ++v) {
+        release(v);
+    }
+}
+
+void synth::VoicePool::start(
+    int voice,
+    std::uint8_t channel,
+    std::uint8_t note,
+    float phaseIncrement,
+    float gain,
+    soundfont::Zone const* zone
+) {
+    if (state[voice] == VoiceState::FREE) {
+        // A retriggered or stolen voice keeps its phase and envelope level to avoid a click.
+        phase[voice] = 0.f;
+        level[voice] = 0.f;
+    }
+    // A sample always starts over: its attack is part of the recording.
+    this->zone[voice] = zone;
+    position[voice] = zone ? zone->start : 0.0;
+    this->phaseIncrement[voice] = phaseIncrement;
+    this->gain[voice] = gain;
+    this->note[voice] = note;
+    this->channel[voice] = channel;
+    startedAt[voice] = ++noteCounter;
+    state[voice] = VoiceState::ATTACK;
+}
+
+int synth::VoicePool::active() const {
+    int count = 0;
+    for (auto s : state) {
+        count += s != VoiceState::FREE ? 1 : 0;
+    }
+    return count;
+}
@@ -0,0 +1,229 @@
+#include "player.h"
+
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace py = pybind11;
+
+namespace
+{
+using bindings::Player;
+
+/// @brief Float frames, one row per frame and one column per channel, as render() returns them.
+using Frames = py::array_t<float, py::array::c_style>;
+
+synth::Waveform parse_waveform(std::string_view name) {
+    if (name == "sine") {
+        return synth::Waveform::SINE;
+    }
+    if (name == "saw") {
+        return synth::Waveform::SAW;
+    }
+    if (name == "square") {
+        return synth::Waveform::SQUARE;
+    }
+    throw py::value_error("unknown waveform: " + std::string(name));
+}
+
+resampler::Quality parse_quality(std::string_view name) {
+    for (auto quality : {
+             resampler::Quality::LINEAR,
+             resampler::Quality::FAST,
+             resampler::Quality::GOOD,
+             resampler::Quality::BEST,
+         }) {
+        if (resampler::name(quality) == name) {
+            return quality;
+        }
+    }
+    throw py::value_error("unknown resampling: " + std::string(name));
+}
+
+std::uint8_t check_range(int value, int limit, char const* what) {
+    if (value < 0 || value >= limit) {
+        throw py::value_error(std::string(what) + " out of range");
+    }
+    return static_cast<std::uint8_t>(value);
+}
+
+/// @brief Queue a channel event; Python code sends them one at a time, so a full queue means the
+/// audio is not being rendered.
+void send(Player& player, events::EventType type, int channel, int data1, int data2) {
+    events::Event event;
+    event.type = type;
+    event.channel = check_range(channel, 16, "channel");
+    event.data1 = check_range(data1, 128, "data byte");
+    event.data2 = check_range(data2, 128, "data byte");
+    if (!player.send(event)) {
+        throw std::runtime_error("event queue full: is the synth rendering?");
+    }
+}
+
+void render_into(Player& player, Frames out) {
+    if (out.ndim() != 2 || out.shape(1) != player.channels()) {
+        throw py::value_error("expected an array of shape (frames, channels)");
+    }
+    float* data = out.mutable_data();
+    auto const numFrames = static_cast<int>(out.shape(0));
+    bool rendered;
+    {
+        // The engine touches no Python objects: other Python threads run meanwhile.
+        py::gil_scoped_release release;
+        rendered = player.render(data, numFrames);
+    }
+    if (!rendered) {
+        throw std::runtime_error("cannot render while playing");
+    }
+}
+
+}  // namespace
+
+PYBIND11_MODULE(midisynth, m) {
+    m.doc() = "The midi-tools synthesizer: play MIDI into a numpy buffer or out of an audio device";
+    m.attr("BLOCK_FRAMES") = Player::BLOCK_FRAMES;
+
+    py::class_<Player>(m, "Synth")
+        .def(
+            py::init([](int sampleRate,
+                        int channels,
+                        std::string_view waveform,
+                        float volume,
+                        std::string soundFont,
+                        std::string_view resampling) {
+                auto player = std::make_unique<Player>(bindings::PlayerOptions{
+                    .sampleRate = sampleRate,
+                    .channels = channels,
+                    .waveform = parse_waveform(waveform),
+                    .volume = volume,
+                    .soundFont = std::move(soundFont),
+                    .resampling = parse_quality(resampling),
+                });
+                if (!player->open()) {
+                    throw std::runtime_error("could not create the synth, see the log");
+                }
+                return player;
+            }),
+            py::arg("sample_rate") = 48'000,
+            py::arg("channels") = 2,
+            py::arg("waveform") = "saw",
+            py::arg("volume") = 0.1f,
+            py::arg("soundfont") = "",
+            py::arg("resampling") = "good",
+            "Waveform is sine, saw or square, unless a SoundFont 2 bank is given. Resampling, "
+            "for the bank's samples, is linear, fast, good or best."
+        )
+        .def(
+            "note_on",
+            [](Player& player, int channel, int note, int velocity) {
+                send(player, events::EventType::NOTE_ON, channel, note, velocity);
+            },
+            py::arg("channel"),
+            py::arg("note"),
+            py::arg("velocity") = 100
+        )
+        .def(
+            "note_off",
+            [](Player& player, int channel, int note) {
+                send(player, events::EventType::NOTE_OFF, channel, note, 0);
+            },
+            py::arg("channel"),
+            py::arg("note")
+        )
+        .def(
+            "control_change",
+            [](Player& player, int channel, int controller, int value) {
+                send(player, events::EventType::CONTROL_CHANGE, channel, controller, value);
+            },
+            py::arg("channel"),
+            py::arg("controller"),
+            py::arg("value")
+        )
+        .def(
+            "program_change",
+            [](Player& player, int channel, int program) {
+                send(player, events::EventType::PROGRAM_CHANGE, channel, program, 0);
+            },
+            py::arg("channel"),
+            py::arg("program")
+        )
+        .def(
+            "pitch_bend",
+            [](Player& player, int channel, int value) {
+                if (value < 0 || value >= 1 << 14) {
+                    throw py::value_error("pitch bend out of range");
+                }
+                send(player, events::EventType::PITCH_BEND, channel, value & 0x7F, value >> 7);
+            },
+            py::arg("channel"),
+            py::arg("value"),
+            "value is 14 bit, 8192 for none."
+        )
+        .def(
+            "send",
+            [](Player& player, py::bytes message) {
+                std::string_view const bytes = message;
+                auto const* data = reinterpret_cast<const std::uint8_t*>(bytes.data());
+                return player.send(data, bytes.size());
+            },
+            py::arg("message"),
+            "Queue a raw MIDI channel message, e.g. from mido's Message.bin(). Returns False if "
+            "it is not one, or if the queue is full."
+        )
+        .def(
+            "render",
+            [](Player& player, int numFrames) {
+                if (numFrames < 0) {
+                    throw py::value_error("negative frame count");
+                }
+                Frames out({py::ssize_t(numFrames), py::ssize_t(player.channels())});
+                render_into(player, out);
+                return out;
+            },
+            py::arg("frames"),
+            "Render the next frames as a float32 array of shape (frames, channels). Events sent "
+            "before the call take effect at its first frame."
+        )
+        .def(
+            "render_into",
+            &render_into,
+            py::arg("out").noconvert(),
+            "Render into a C-contiguous float32 array of shape (frames, channels)."
+        )
+        .def(
+            "open_inputs",
+            &Player::open_inputs,
+            py::arg("patterns") = std::vector<std::string>{},
+            "Play the MIDI input ports whose names contain one of the patterns, or every port. "
+            "Their messages reach the synth without going through Python. Returns the number of "
+            "ports open."
+        )
+        .def(
+            "start",
+            [](Player& player, std::string_view backend, std::string const& device, int period) {
+                if (!player.start(backend, device, period)) {
+                    throw std::runtime_error("could not start playing, see the log");
+                }
+            },
+            py::arg("backend") = "alsa",
+            py::arg("device") = "default",
+            py::arg("period") = 96,
+            "Play from a native render thread until stop(): on an ALSA device, in periods of "
+            "period frames, or on the null backend, paced like one. render() is not available "
+            "meanwhile."
+        )
+        .def("stop", &Player::stop)
+        .def_property_readonly("playing", &Player::playing)
+        .def_property("volume", &Player::volume, &Player::set_volume)
+        .def_property_readonly("sample_rate", &Player::sample_rate)
+        .def_property_readonly("channels", &Player::channels)
+        .def_property_readonly("position", &Player::position, "Frames rendered so far.")
+        .def_property_readonly("xruns", &Player::xruns, "Underruns of the device since start().");
+}
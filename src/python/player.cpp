@@ -0,0 +1,167 @@
+#include "player.h"
+
+#include "logger/logger.h"
+#include "synth/render.h"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace
+{
+std::int64_t now_ns() {
+    return std::chrono::nanoseconds(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}  // namespace
+
+bindings::Player::Player(PlayerOptions options)
+: options(std::move(options))
+, engine(this->options.sampleRate, this->options.waveform)
+, source(queue.add_source()) {
+    engine.set_resampling(this->options.resampling);
+    engine.master_gain().reset(this->options.volume);
+}
+
+bool bindings::Player::open() {
+    auto const render =
+        synth::renderer(options.waveform, options.channels, synth::SampleFormat::F32);
+    if (!render || options.sampleRate <= 0) {
+        logger::log(
+            "Unsupported output layout: {} channels at {} Hz", options.channels, options.sampleRate
+        );
+        return false;
+    }
+    blocks.emplace(render, synth::bytes_per_frame(options.channels, synth::SampleFormat::F32));
+
+    if (!options.soundFont.empty()) {
+        if (!bank.open(options.soundFont)) {
+            return false;
+        }
+        // Page in what a General MIDI file starts with; other programs load as they are played.
+        bank.prefetch(0);
+        bank.prefetch(soundfont::PERCUSSION);
+        engine.set_soundfont(&bank);
+    }
+    return true;
+}
+
+bool bindings::Player::send(events::Event event) {
+    event.timestamp = now_ns();
+    return queue.push(source, event);
+}
+
+bool bindings::Player::send(const std::uint8_t* data, std::size_t size) {
+    events::Event event;
+    return events::parse(data, size, now_ns(), event) && queue.push(source, event);
+}
+
+std::size_t bindings::Player::open_inputs(std::vector<std::string> patterns) {
+    if (!inputs) {
+        inputs = std::make_unique<input::MidiInputs>(queue);
+    }
+    return inputs->open(std::move(patterns));
+}
+
+bool bindings::Player::render(float* out, int numFrames) {
+    if (!blocks || running.exchange(true)) {
+        return false;
+    }
+    for (int done = 0; done < numFrames; done += BLOCK_FRAMES) {
+        int const n = std::min(BLOCK_FRAMES, numFrames - done);
+        render_block(out + std::size_t(done) * options.channels, n, false);
+    }
+    running.store(false);
+    return true;
+}
+
+bool bindings::Player::start(
+    std::string_view backend,
+    std::string const& device,
+    int periodFrames
+) {
+    if (!blocks) {
+        logger::log("Not open");
+        return false;
+    }
+    if (running.exchange(true)) {
+        logger::log("Already playing");
+        return false;
+    }
+    if (renderer.joinable()) {
+        // The last render thread stopped on a sink error and left it open.
+        renderer.join();
+        sink->close();
+    }
+    output::Config const config = {
+        .sampleRate = options.sampleRate,
+        .channels = options.channels,
+        .format = synth::SampleFormat::F32,
+        .periodFrames = periodFrames,
+        .periods = 2,
+    };
+    sink = output::make_sink(backend, device);
+    if (!sink) {
+        logger::log("Unknown backend: {}", backend);
+    } else if (!sink->open(config)) {
+        sink.reset();
+    } else if (sink->config().sampleRate != options.sampleRate) {
+        logger::log(
+            "{} runs at {} Hz, not at {} Hz", device, sink->config().sampleRate, options.sampleRate
+        );
+        sink->close();
+        sink.reset();
+    }
+    if (!sink) {
+        running.store(false);
+        return false;
+    }
+
+    streaming.store(true);
+    renderer = std::thread([this] {
+        // write() waits for the device to free a period, which paces the loop.
+        while (streaming.load(std::memory_order_relaxed) && sink->write(render_period, this)) {
+        }
+        // Whether stopped or failed, hand the engine back to render().
+        streaming.store(false);
+        running.store(false);
+    });
+    return true;
+}
+
+void bindings::Player::stop() {
+    if (!renderer.joinable()) {
+        return;
+    }
+    streaming.store(false);
+    renderer.join();
+    sink->close();
+}
+
+void bindings::Player::render_period(void* context, void* buffer, int numFrames) {
+    auto* player = static_cast<Player*>(context);
+    auto* out = static_cast<float*>(buffer);
+    for (int done = 0; done < numFrames; done += BLOCK_FRAMES) {
+        int const n = std::min(BLOCK_FRAMES, numFrames - done);
+        player->render_block(out + std::size_t(done) * player->options.channels, n, true);
+    }
+}
+
+void bindings::Player::render_block(float* out, int numFrames, bool live) {
+    std::uint64_t const firstFrame = blocks->position();
+    auto const now = now_ns();
+    events::Event event;
+    while (queue.pop(event)) {
+        std::int64_t offset = 0;
+        if (live) {
+            // An event lands as far before the end of this block as it arrived before now, so
+            // events keep their spacing at the cost of up to one block of latency.
+            std::int64_t age = (now - event.timestamp) * options.sampleRate / 1'000'000'000;
+            offset = std::clamp<std::int64_t>(numFrames - age, 0, numFrames - 1);
+        }
+        if (!blocks->schedule(firstFrame + offset, event)) {
+            engine.handle(event);
+        }
+    }
+    blocks->render(engine, out, numFrames);
+    frames.fetch_add(numFrames, std::memory_order_relaxed);
+}
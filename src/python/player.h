@@ -0,0 +1,111 @@
+#pragma once
+
+#include "events/merged_queue.h"
+#include "input/midi_inputs.h"
+#include "output/sink.h"
+#include "resampler/resampler.h"
+#include "soundfont/bank.h"
+#include "synth/block_renderer.h"
+#include "synth/voice_engine.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace bindings
+{
+struct PlayerOptions
+{
+    int sampleRate = 48'000;
+    int channels = 2;
+    synth::Waveform waveform = synth::Waveform::SAW;
+    float volume = 0.1f;
+    std::string soundFont;  ///< SF2 bank to play instead of the waveform, if not empty
+    resampler::Quality resampling = resampler::Quality::GOOD;
+};
+
+/// @brief The engine behind the midisynth Python module: a VoiceEngine fed through a
+/// MergedQueue, rendering interleaved F32.
+///
+/// Events reach the engine through lock-free queues only: send() from Python, and the MIDI input
+/// threads from open_inputs() without going through Python at all. The audio comes out either of
+/// render(), into a buffer the caller owns, or of a render thread of its own writing to an
+/// output::Sink between start() and stop(). The module releases the GIL around both, so Python
+/// threads keep running while a block renders and never hold up the audio thread.
+class Player
+{
+public:
+    static constexpr int BLOCK_FRAMES = 480;
+
+    explicit Player(PlayerOptions options);
+    ~Player() { stop(); }
+
+    Player(Player const&) = delete;
+    Player& operator=(Player const&) = delete;
+
+    /// @brief Check the layout and load the SoundFont, if any. Returns false and logs on error.
+    bool open();
+
+    /// @brief Queue an event, stamped now. Never blocks or allocates. Calls must not overlap:
+    /// the queue has one producer, and from Python the GIL serializes them.
+    /// @return false if the queue is full and the event was dropped.
+    bool send(events::Event event);
+
+    /// @brief Queue a raw MIDI channel message. Returns false if it is not one or was dropped.
+    bool send(const std::uint8_t* data, std::size_t size);
+
+    /// @brief Play the MIDI input ports whose names contain one of the patterns, or every port
+    /// if there are none, and those plugged in later that match.
+    /// @return the number of ports open
+    std::size_t open_inputs(std::vector<std::string> patterns);
+
+    /// @brief Render numFrames interleaved frames into out. Events queued before the call take
+    /// effect at its first frame. Returns false, rendering nothing, while playing.
+    bool render(float* out, int numFrames);
+
+    /// @brief Play on the sink for backend (see output::make_sink) from a render thread, events
+    /// landing in the block as far from its end as they arrived before it was rendered. The
+    /// thread runs until stop(), or until the sink fails and playing() turns false.
+    /// Returns false and logs if the sink cannot be opened at the player's rate.
+    bool start(std::string_view backend, std::string const& device, int periodFrames);
+    void stop();
+
+    /// @brief Master gain, ramped to in the engine; safe while playing.
+    void set_volume(float volume) { engine.master_gain().set(volume); }
+    float volume() const { return engine.master_gain().get(); }
+
+    /// @brief Whether the render thread runs: from start() until stop(), or until the sink fails.
+    bool playing() const { return streaming.load(); }
+    int sample_rate() const { return options.sampleRate; }
+    int channels() const { return options.channels; }
+    /// @brief Frames rendered so far.
+    std::uint64_t position() const { return frames.load(std::memory_order_relaxed); }
+    /// @brief Underruns of the sink since start().
+    std::uint64_t xruns() const { return sink ? sink->xruns() : 0; }
+
+private:
+    static void render_period(void* context, void* buffer, int numFrames);
+    void render_block(float* out, int numFrames, bool live);
+
+    PlayerOptions options;
+    soundfont::Bank bank;
+    synth::VoiceEngine engine;
+    std::optional<synth::BlockRenderer> blocks;
+    events::MergedQueue queue{1024};
+    std::size_t source;  ///< of the events from send()
+    std::unique_ptr<input::MidiInputs> inputs;
+    std::atomic<std::uint64_t> frames{0};
+
+    std::unique_ptr<output::Sink> sink;
+    std::thread renderer;
+    std::atomic<bool> running{false};  ///< render() or the render thread has the engine
+    std::atomic<bool> streaming{false};  ///< the render thread is to keep going
+};
+
+}  // namespace bindings
@@ -0,0 +1,134 @@
+#include "player.h"
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace
+{
+constexpr int SAMPLE_RATE = 48'000;
+
+bindings::PlayerOptions options() {
+    return {.sampleRate = SAMPLE_RATE, .channels = 2, .volume = 0.5f};
+}
+
+events::Event note_on(std::uint8_t note) {
+    events::Event event;
+    event.type = events::EventType::NOTE_ON;
+    event.data1 = note;
+    event.data2 = 100;
+    return event;
+}
+
+bool silent(std::vector<float> const& frames) {
+    return std::all_of(frames.begin(), frames.end(), [](float x) { return x == 0.f; });
+}
+
+/// @brief Poll until done() or a couple of seconds have passed.
+bool wait_for(std::function<bool()> const& done) {
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE("render fills the caller's buffer, events taking effect at its start") {
+    bindings::Player player(options());
+    REQUIRE(player.open());
+
+    // Not a multiple of the block: the last block is partial.
+    std::vector<float> frames(1000 * 2);
+    REQUIRE(player.render(frames.data(), 1000));
+    CHECK(silent(frames));
+    CHECK(player.position() == 1000);
+
+    REQUIRE(player.send(note_on(69)));
+    REQUIRE(player.render(frames.data(), 1000));
+    auto const sounding = [](float x) { return x != 0.f; };
+    CHECK(std::any_of(frames.begin(), frames.begin() + 2 * 16, sounding));
+    CHECK(player.position() == 2000);
+}
+
+TEST_CASE("raw messages must be channel messages") {
+    bindings::Player player(options());
+    REQUIRE(player.open());
+    std::uint8_t const noteOn[] = {0x90, 60, 100};
+    std::uint8_t const truncated[] = {0x90, 60};
+    CHECK(player.send(noteOn, sizeof(noteOn)));
+    CHECK_FALSE(player.send(truncated, sizeof(truncated)));
+
+    std::vector<float> frames(480 * 2);
+    REQUIRE(player.render(frames.data(), 480));
+    CHECK_FALSE(silent(frames));
+}
+
+TEST_CASE("volume is the master gain") {
+    bindings::Player player(options());
+    CHECK(player.volume() == 0.5f);
+    player.set_volume(0.25f);
+    CHECK(player.volume() == 0.25f);
+}
+
+TEST_CASE("a layout the synth cannot render does not open") {
+    auto unsupported = options();
+    unsupported.channels = 0;
+    bindings::Player player(unsupported);
+    CHECK_FALSE(player.open());
+    float frame = 0.f;
+    CHECK_FALSE(player.render(&frame, 1));
+    CHECK_FALSE(player.start("null", "", 96));
+}
+
+TEST_CASE("start plays on a sink until stop, and render waits for it") {
+    bindings::Player player(options());
+    REQUIRE(player.open());
+    CHECK_FALSE(player.start("nonesuch", "", 96));
+    CHECK_FALSE(player.playing());
+
+    REQUIRE(player.start("null", "", 96));
+    CHECK(player.playing());
+    CHECK_FALSE(player.start("null", "", 96));
+    std::vector<float> frames(480 * 2);
+    CHECK_FALSE(player.render(frames.data(), 480));
+
+    // 20 ms at 48 kHz, and the null sink plays in real time.
+    CHECK(wait_for([&] { return player.position() >= 960; }));
+    player.stop();
+    CHECK_FALSE(player.playing());
+    CHECK(player.xruns() == 0);
+
+    std::uint64_t const played = player.position();
+    CHECK(player.render(frames.data(), 480));
+    CHECK(player.position() == played + 480);
+
+    REQUIRE(player.start("null", "", 96));
+    player.stop();
+    player.stop();
+}
+
+TEST_CASE("the render thread hands the engine back when the sink fails") {
+    bindings::Player player(options());
+    REQUIRE(player.open());
+
+    // Writes to /dev/full fail once the file's buffer is flushed.
+    REQUIRE(player.start("file", "/dev/full", 96));
+    REQUIRE(wait_for([&] { return !player.playing(); }));
+    std::vector<float> frames(480 * 2);
+    CHECK(player.render(frames.data(), 480));
+
+    REQUIRE(player.start("null", "", 96));
+    CHECK(player.playing());
+    player.stop();
+    CHECK_FALSE(player.playing());
+}
@@ -1,11 +1,13 @@
 
+#include "audio/buffer_pool.h"
 #include "logger/logger.h"
+#include "oscillator/oscillator.h"
 
 #include <gst/app/gstappsrc.h>
 #include <gst/audio/audio-info.h>
 #include <gst/gst.h>
 
-#include <cmath>
+#include <cstring>
 #include <iostream>
 #include <vector>
 
@@ -15,46 +17,34 @@ namespace
 {
 constexpr int SAMPLE_RATE = 48'000;
 constexpr int CHANNELS = 1;
-constexpr double TWO_PI = 6.283185307179586;
-constexpr double freq = 400.;
-constexpr double amplitude = 0.3;  // range [0.0, 1.0]
-
-void gen_sine_wave(
-    float* buffer,
-    int numSamples,
-    double phase,
-    double frequency,
-    double amplitude
-) {
-    double phaseStep = TWO_PI * frequency / SAMPLE_RATE;
-    for (int i = 0; i < numSamples; ++i) {
-        buffer[i] = static_cast<float>(amplitude * std::sin(phase));
-        phase += phaseStep;
-        if (phase > TWO_PI) {
-            phase -= TWO_PI;
-        }
-    }
-}
+constexpr float freq = 400.f;
+constexpr float amplitude = 0.3f;  // range [0.0, 1.0]
 
-static void need_data(GstElement* appsrc, guint, gpointer) {
-    constexpr int numSamples = 480;
-    gsize bufSize = numSamples * sizeof(float) * CHANNELS;
+constexpr int numSamples = 480;
+constexpr gsize bufSize = numSamples * sizeof(float) * CHANNELS;
+
+// Blocks in flight: at most QUEUED_BLOCKS wait in appsrc, the rest are with the sink.
+constexpr guint POOL_BUFFERS = 8;
+constexpr guint QUEUED_BLOCKS = 4;
+audio::BufferPool bufferPool;
 
-    auto gstBuffer = gst_buffer_new_allocate(nullptr, bufSize, nullptr);
+static void need_data(GstElement* appsrc, guint, gpointer) {
+    auto gstBuffer = bufferPool.acquire();
     if (!gstBuffer) {
-        log("Failed to allocate gstreamer buffer of size={}", bufSize);
+        log("No buffer available from the pool");
         return;
     }
 
     GstMapInfo map;
     gst_buffer_map(gstBuffer, &map, GST_MAP_WRITE);
 
-    static double phase = 0.0;
-    phase += (TWO_PI * freq * numSamples) / SAMPLE_RATE;
-    phase = std::fmod(phase, TWO_PI);
+    static float phase = 0.f;
+    static auto const& kernels = oscillator::kernels();
 
     if (CHANNELS == 1) {
-        gen_sine_wave(reinterpret_cast<float*>(map.data), numSamples, phase, freq, amplitude);
+        std::memset(map.data, 0, bufSize);
+        auto* out = reinterpret_cast<float*>(map.data);
+        kernels.sine(out, numSamples, phase, freq / SAMPLE_RATE, amplitude, 0.f);
     } else {
         logger::log("Stereo not implemented");
     }
@@ -109,7 +99,18 @@ int main(int argc, char* argv[]) {
             auto* caps = gst_audio_info_to_caps(audioInfo);
             gst_audio_info_free(audioInfo);
 
-            g_object_set(G_OBJECT(appsrc), "caps", caps, nullptr);
+            if (!bufferPool.start(caps, bufSize, POOL_BUFFERS)) {
+                return EXIT_FAILURE;
+            }
+            // Bound the appsrc queue below the pool size so need_data always finds a buffer.
+            g_object_set(
+                G_OBJECT(appsrc),
+                "caps",
+                caps,
+                "max-bytes",
+                guint64{QUEUED_BLOCKS * bufSize},
+                nullptr
+            );
             gst_caps_unref(caps);
         }
     }
@@ -161,6 +162,8 @@ int main(int argc, char* argv[]) {
     gst_object_unref(autoaudiosink);
     gst_object_unref(appsrc);
     g_main_loop_unref(loop);
+    log("Buffer pool: {} hits, {} misses", bufferPool.hits(), bufferPool.misses());
+    bufferPool.stop();
 
     log("Application exiting");
     return EXIT_SUCCESS;
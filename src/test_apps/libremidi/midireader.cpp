@@ -1,114 +1,119 @@
-#include <libremidi/../../examples/utils.hpp>
-#include <libremidi/libremidi.hpp>
+#include "events/merged_queue.h"
+#include "input/midi_inputs.h"
+#include "input/recorder.h"
 
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
-
-// Set the configuration of our MIDI port
-// Note that the callback will be invoked from a separate thread,
-// it is up to you to protect your data structures afterwards.
-// For instance if you are using a GUI toolkit, don't do GUI actions
-// in that callback !
-auto my_callback = [](const libremidi::message& message) {
-    std::cout << "Received MIDI message with " << message.size() << " bytes : { ";
-    std::cout << std::hex;
-    for (auto byte : message) {
-        std::cout << " 0x" << static_cast<int>(byte) << ", ";
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+const char* type_name(events::EventType type) {
+    switch (type) {
+        case events::EventType::NOTE_ON:
+            return "note on";
+        case events::EventType::NOTE_OFF:
+            return "note off";
+        case events::EventType::CONTROL_CHANGE:
+            return "control change";
+        case events::EventType::PROGRAM_CHANGE:
+            return "program change";
+        case events::EventType::CHANNEL_PRESSURE:
+            return "channel pressure";
+        case events::EventType::POLY_PRESSURE:
+            return "poly pressure";
+        case events::EventType::PITCH_BEND:
+            return "pitch bend";
     }
-    std::cout << " } at timestamp " << std::dec << message.timestamp << "\n";
-};
-
-// inline std::ostream& operator<<(std::ostream& s, const libremidi::container_identifier& id) {
-//     struct
-//     {
-//         std::ostream& s;
-//         void operator()(libremidi::uuid u) { s << "uuid"; }
-//         void operator()(std::string u) { s << u; }
-//         void operator()(uint64_t u) { s << u; }
-//         void operator()(std::monostate) {}
-//     } vis{s};
-//     std::visit(vis, id);
-//     return s;
-// }
-
+    return "?";
+}
+}  // namespace
+
+// Usage: midireader [--record PATH [--smf] [--rotate-mb N] [--rotate-seconds N]]
+//                   [port name pattern...]
+//
+// Opens every input port whose name contains one of the patterns, or every input port if none
+// are given, and prints their events merged in timestamp order until all of them are unplugged.
+//
+// With --record, the raw messages are written to PATH-0001.capture (or .mid with --smf) instead,
+// starting a new file when the current one reaches the given size or age. Play a capture back
+// with replay.
 int main(int argc, char** argv) {
-    libremidi::input_port input_port;
-
-    bool removed = false;
-    std::string_view display_name;
-    libremidi::container_identifier id;
-
-    std::string_view device_name = "Traktor Kontrol S4";
-    if (argc > 1) {
-        device_name = argv[1];
-    }
-
-    // constexpr auto api_to_use = libremidi::API::ALSA_RAW;
-    constexpr auto api_to_use = libremidi::API::ALSA_SEQ;
-
-    std::vector<libremidi::observer> observers;
-    for (auto api : libremidi::available_apis()) {
-        if (api != api_to_use) continue;
-        std::string_view api_name = libremidi::get_api_display_name(api);
-
-        std::cout << "Displaying ports for: " << api_name << std::endl;
-        libremidi::observer_configuration cbs;
-        cbs.input_added = [=](const libremidi::input_port& p) {
-            std::cout << api_name << " : input added " << p << "\n";
-        };
-        cbs.input_removed = [&](const libremidi::input_port& p) {
-            // std::cout << api_name << " : input removed " << p << "\n";
-            if (id == p.container) {
-                std::cout << device_name << " was removed by ID\n";
-                removed = true;
-            }
-            if (display_name == p.display_name) {
-                std::cout << device_name << " was removed by name\n";
-                removed = true;
-            }
-        };
-        cbs.output_added = [=](const libremidi::output_port& p) {
-            std::cout << api_name << " : output added " << p << "\n";
-        };
-        cbs.output_removed = [=](const libremidi::output_port& p) {
-            std::cout << api_name << " : output removed " << p << "\n";
-        };
-        observers.emplace_back(cbs, libremidi::observer_configuration_for(api));
-        std::cout << "\n" << std::endl;
+    std::vector<std::string> patterns;
+    input::RecordOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--record" && i + 1 < argc) {
+            options.path = argv[++i];
+        } else if (arg == "--smf") {
+            options.format = input::RecordFormat::SMF;
+        } else if (arg == "--rotate-mb" && i + 1 < argc) {
+            std::string_view value = argv[++i];
+            std::from_chars(value.data(), value.data() + value.size(), options.rotateBytes);
+            options.rotateBytes *= 1024 * 1024;
+        } else if (arg == "--rotate-seconds" && i + 1 < argc) {
+            std::string_view value = argv[++i];
+            long seconds = 0;
+            std::from_chars(value.data(), value.data() + value.size(), seconds);
+            options.rotateSeconds = std::chrono::seconds(seconds);
+        } else {
+            patterns.emplace_back(arg);
+        }
     }
 
-    for (auto const& obs : observers) {
-        if (obs.get_current_api() != api_to_use) continue;
-        for (auto const& port : obs.get_input_ports()) {
-            if (std::string::npos != port.display_name.find(device_name)) {
-                std::cout << "Using port " << port.display_name << std::endl;
-                input_port = port;
-                id = input_port.container;
-                display_name = input_port.display_name;
-                break;
-            }
+    events::MergedQueue queue;
+    std::optional<input::Recorder> recorder;
+    input::MidiInputs::Listener listener;
+    if (!options.path.empty()) {
+        recorder.emplace(options);
+        if (!recorder->start()) {
+            std::cerr << "Could not open " << recorder->file_name(1) << "\n";
+            return EXIT_FAILURE;
         }
-        if (!input_port.port_name.empty()) break;
+        listener = [&recorder](std::size_t port, libremidi::message const& message) {
+            recorder->record(port, message.timestamp, message.bytes);
+        };
     }
 
-    if (input_port.display_name.empty()) {
-        std::cerr << "Could not find " << device_name << "\n";
+    input::MidiInputs inputs(queue, listener);
+    if (inputs.open(patterns) == 0) {
+        std::cerr << "Could not find a matching input port\n";
         return EXIT_FAILURE;
     }
 
-    // Create the midi object
-    libremidi::midi_in midi{libremidi::input_configuration{.on_message = my_callback}};
-
-    // Open a given midi port.
-    midi.open_port(input_port);
-
-    while (!removed) {
-        // Keep the application alive while receiving messages
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto lastReport = std::chrono::steady_clock::now();
+    while (inputs.removed() < inputs.size()) {
+        events::Event event;
+        std::size_t port;
+        while (queue.pop(event, &port)) {
+            if (recorder) {
+                continue;
+            }
+            std::cout << inputs.name(port) << ": " << type_name(event.type) << ", channel "
+                      << int(event.channel) << ", " << int(event.data1) << ", "
+                      << int(event.data2) << " at timestamp " << event.timestamp << "\n";
+        }
+        if (recorder && std::chrono::steady_clock::now() - lastReport >= std::chrono::seconds(1)) {
+            lastReport = std::chrono::steady_clock::now();
+            std::cout << "Recorded " << recorder->recorded() << " messages to "
+                      << recorder->files() << " files, " << recorder->dropped() << " dropped"
+                      << std::endl;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
     }
 
-    std::cout << "Closing the MIDI port" << std::endl;
-
-    // midi.close_port();
-
+    std::cout << "All ports were removed" << std::endl;
+    if (recorder) {
+        recorder->stop();
+        std::cout << "Recorded " << recorder->recorded() << " messages, " << recorder->dropped()
+                  << " dropped" << std::endl;
+    }
+    inputs.log_stats();
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,65 @@
+#include "events/capture.h"
+
+#include <libremidi/libremidi.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+#include <thread>
+
+// Usage: replay CAPTURE [--port NAME] [--wait]
+//
+// Plays a capture recorded by midireader --record back out of a virtual output port, keeping the
+// original spacing between messages. Connect the port to midiplayer (or anything else) first, or
+// pass --wait to start only once Enter is pressed.
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: replay CAPTURE [--port NAME] [--wait]\n";
+        return EXIT_FAILURE;
+    }
+    std::string_view portName = "midi-tools replay";
+    bool wait = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--port" && i + 1 < argc) {
+            portName = argv[++i];
+        } else if (arg == "--wait") {
+            wait = true;
+        }
+    }
+
+    events::CaptureReader reader;
+    if (!reader.open(argv[1])) {
+        std::cerr << "Could not read capture " << argv[1] << "\n";
+        return EXIT_FAILURE;
+    }
+
+    auto output = libremidi::midi_out{{}, libremidi::alsa_seq::output_configuration{}};
+    if (output.open_virtual_port(portName) != stdx::error{}) {
+        std::cerr << "Error opening virtual port" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (wait) {
+        std::cout << "Opened " << portName << ", press Enter to start..." << std::endl;
+        std::cin.get();
+    }
+
+    // Capture timestamps are on the recording machine's monotonic clock; only their differences
+    // matter here.
+    events::CapturedMessage message;
+    std::size_t sent = 0;
+    auto const start = std::chrono::steady_clock::now();
+    std::int64_t first = 0;
+    while (reader.next(message)) {
+        if (sent == 0) {
+            first = message.timestamp;
+        }
+        std::this_thread::sleep_until(start + std::chrono::nanoseconds(message.timestamp - first));
+        output.send_message(message.bytes.data(), message.bytes.size());
+        ++sent;
+    }
+
+    std::cout << "Sent " << sent << " messages" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -1,6 +1,125 @@
+#include "stats/histogram.h"
+
 #include <libremidi/libremidi.hpp>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
 #include <iostream>
+#include <memory>
+#include <string_view>
+#include <thread>
+
+namespace
+{
+// Every message carries a 14 bit sequence number in two data bytes, so the receiver can tell
+// drops from reordering and look up when the message was sent.
+constexpr std::uint32_t SEQUENCE_MODULO = 1 << 14;
+constexpr std::size_t MAX_SYSEX_BYTES = 4096;
+constexpr std::uint8_t NON_COMMERCIAL_ID = 0x7D;
+
+enum class Mix
+{
+    NOTES,  ///< note on, note off, ...
+    CC,     ///< control changes back to back, as from a fader or an encoder
+    SYSEX,  ///< sysex of --sysex-bytes bytes
+    MIXED   ///< mostly notes and control changes, every 16th a sysex
+};
+
+struct Options
+{
+    Mix mix = Mix::MIXED;
+    double rate = 10'000.0;  ///< messages per second, on average
+    int burst = 1;           ///< messages sent back to back
+    std::uint64_t count = 100'000;
+    std::size_t sysexBytes = 32;  ///< F0 and F7 included
+    std::string_view portName = "midi-tools flood";
+};
+
+/// @brief State shared by the sending thread and the libremidi input thread.
+struct Loopback
+{
+    std::array<std::atomic<std::int64_t>, SEQUENCE_MODULO> sentAt{};  ///< steady clock, ns
+    std::atomic<std::uint64_t> sent{0};
+    std::atomic<std::uint64_t> received{0};
+    std::atomic<std::uint64_t> reordered{0};
+    std::atomic<std::uint64_t> malformed{0};
+    std::uint64_t next = 0;  ///< input thread: the sequence number expected next
+    stats::Histogram latency;
+};
+
+std::int64_t now_ns() {
+    return std::chrono::nanoseconds(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// @brief Build message number n of the mix into bytes and return its size.
+std::size_t make_message(Options const& options, std::uint64_t n, std::uint8_t* bytes) {
+    auto const sequence = static_cast<std::uint32_t>(n % SEQUENCE_MODULO);
+    auto const high = static_cast<std::uint8_t>(sequence >> 7);
+    auto const low = static_cast<std::uint8_t>(sequence & 0x7F);
+    Mix mix = options.mix;
+    if (mix == Mix::MIXED) {
+        mix = n % 16 == 15 ? Mix::SYSEX : n % 2 == 1 ? Mix::CC : Mix::NOTES;
+    }
+    switch (mix) {
+        case Mix::SYSEX: {
+            std::size_t const size = options.sysexBytes;
+            bytes[0] = 0xF0;
+            bytes[1] = NON_COMMERCIAL_ID;
+            bytes[2] = high;
+            bytes[3] = low;
+            std::fill(bytes + 4, bytes + size - 1, std::uint8_t(0x55));
+            bytes[size - 1] = 0xF7;
+            return size;
+        }
+        case Mix::CC:
+            bytes[0] = 0xB0;
+            break;
+        default:
+            // Ons and offs alternate, the way a player's notes would.
+            bytes[0] = (n / 2) % 2 == 0 ? 0x90 : 0x80;
+            break;
+    }
+    bytes[1] = high;
+    bytes[2] = low;
+    return 3;
+}
+
+/// @brief Input thread: check the sequence number and time the message.
+void receive(Loopback& loopback, libremidi::message const& message) {
+    auto const& bytes = message.bytes;
+    std::uint32_t sequence;
+    if (bytes.size() >= 5 && bytes[0] == 0xF0 && bytes[1] == NON_COMMERCIAL_ID) {
+        sequence = (std::uint32_t(bytes[2]) << 7) | bytes[3];
+    } else if (bytes.size() == 3 && bytes[0] < 0xF0) {
+        sequence = (std::uint32_t(bytes[1]) << 7) | bytes[2];
+    } else {
+        loopback.malformed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    loopback.received.fetch_add(1, std::memory_order_relaxed);
+
+    // The full sequence number is the one nearest to the next expected with these low bits.
+    std::uint32_t const expected = loopback.next % SEQUENCE_MODULO;
+    std::int64_t delta = std::int64_t((sequence - expected) % SEQUENCE_MODULO);
+    if (delta >= SEQUENCE_MODULO / 2) {
+        delta -= SEQUENCE_MODULO;
+    }
+    if (delta < 0) {
+        // Behind one already received: overtaken on the way.
+        loopback.reordered.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        loopback.next += delta + 1;
+    }
+
+    std::int64_t const sentAt = loopback.sentAt[sequence].load(std::memory_order_relaxed);
+    loopback.latency.record(std::uint64_t(std::max<std::int64_t>(message.timestamp - sentAt, 0)));
+}
 
 libremidi::input_port find_virtual_port_by_name(libremidi_api api, std::string_view const& name) {
     libremidi::observer obs(
@@ -17,29 +136,105 @@ libremidi::input_port find_virtual_port_by_name(libremidi_api api, std::string_v
     return {};
 }
 
-int main() {
-    constexpr std::string_view port_name = "My virtual output port";
+void report(Loopback const& loopback, Options const& options, double seconds) {
+    std::uint64_t const sent = loopback.sent.load();
+    std::uint64_t const received = loopback.received.load();
+    std::cout << std::format(
+        "Sent {} messages in {:.2f} s: {:.0f} messages/s, asked for {:.0f}\n",
+        sent,
+        seconds,
+        double(sent) / seconds,
+        options.rate
+    );
+    std::cout << std::format(
+        "Received {}: {} dropped, {} reordered, {} malformed\n",
+        received,
+        sent - std::min(sent, received),
+        loopback.reordered.load(),
+        loopback.malformed.load()
+    );
+    stats::Histogram const& latency = loopback.latency;
+    std::cout << "Latency " << stats::summary(latency) << "\n";
+    if (latency.count() > 0) {
+        std::cout << "  ";
+        for (double p : {10.0, 50.0, 90.0, 99.0, 99.9, 99.99}) {
+            std::cout << std::format("p{}={:.1f} us  ", p, double(latency.percentile(p)) * 1e-3);
+        }
+        std::cout << std::format("min={:.1f} us\n", double(latency.min()) * 1e-3);
+    }
+}
+
+}  // namespace
+
+// Usage: virtual [--mix notes|cc|sysex|mixed] [--rate N] [--burst N] [--count N]
+//                [--sysex-bytes N] [--port NAME]
+//
+// Floods a virtual ALSA sequencer output port and reads it back through an input connected to
+// it, to qualify a host and its kernel settings without a controller. --count messages of the
+// mix go out at --rate per second on average, in bursts of --burst sent back to back. Each one
+// carries a sequence number; the report gives the throughput, the messages dropped and
+// overtaken, and the histogram of the latency from sending to the input's timestamp.
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        std::string_view value = i + 1 < argc ? argv[i + 1] : "";
+        auto const* first = value.data();
+        auto const* last = value.data() + value.size();
+        if (arg == "--mix" && i + 1 < argc) {
+            ++i;
+            if (value == "notes") {
+                options.mix = Mix::NOTES;
+            } else if (value == "cc") {
+                options.mix = Mix::CC;
+            } else if (value == "sysex") {
+                options.mix = Mix::SYSEX;
+            } else if (value != "mixed") {
+                std::cerr << "Unknown mix: " << value << ", using mixed\n";
+            }
+        } else if (arg == "--rate" && i + 1 < argc) {
+            ++i;
+            std::from_chars(first, last, options.rate);
+        } else if (arg == "--burst" && i + 1 < argc) {
+            ++i;
+            std::from_chars(first, last, options.burst);
+        } else if (arg == "--count" && i + 1 < argc) {
+            ++i;
+            std::from_chars(first, last, options.count);
+        } else if (arg == "--sysex-bytes" && i + 1 < argc) {
+            ++i;
+            std::from_chars(first, last, options.sysexBytes);
+        } else if (arg == "--port" && i + 1 < argc) {
+            options.portName = argv[++i];
+        } else {
+            std::cerr << "Unknown argument: " << arg << "\n";
+            return EXIT_FAILURE;
+        }
+    }
+    options.rate = std::max(options.rate, 1.0);
+    options.burst = std::max(options.burst, 1);
+    options.sysexBytes = std::clamp<std::size_t>(options.sysexBytes, 6, MAX_SYSEX_BYTES);
 
     auto virtualOutput = libremidi::midi_out{{}, libremidi::alsa_seq::output_configuration{}};
-    if (virtualOutput.open_virtual_port(port_name) != stdx::error{}) {
+    if (virtualOutput.open_virtual_port(options.portName) != stdx::error{}) {
         std::cerr << "Error opening virtual port" << std::endl;
         return EXIT_FAILURE;
     }
 
+    auto loopback = std::make_unique<Loopback>();
     auto input = libremidi::midi_in{
-        {.on_message =
-             [](libremidi::message const& message) {
-                 std::cout << "Received MIDI message with " << message.size() << " bytes : { ";
-                 std::cout << std::hex;
-                 for (auto byte : message) {
-                     std::cout << "0x" << static_cast<int>(byte) << ", ";
-                 }
-                 std::cout << "} at timestamp " << std::dec << message.timestamp << std::endl;
-             }},
+        libremidi::input_configuration{
+            .on_message = [&loopback](libremidi::message const& message) {
+                receive(*loopback, message);
+            },
+            .ignore_sysex = false,
+            // Comparable with the steady clock the send times are taken from.
+            .timestamps = libremidi::timestamp_mode::SystemMonotonic
+        },
         libremidi::alsa_seq::input_configuration{}
     };
     auto err = input.open_port(
-        find_virtual_port_by_name(libremidi::API::ALSA_SEQ, port_name),
+        find_virtual_port_by_name(libremidi::API::ALSA_SEQ, options.portName),
         "Virtual output loopback"
     );
     if (err != stdx::error{}) {
@@ -49,11 +244,34 @@ int main() {
         std::cout << "Successfully connected to virtual output port" << std::endl;
     }
 
-    virtualOutput.send_message({0x90, 60, 127});
-    virtualOutput.send_message({0x80, 60, 0});
+    // Bursts are due at fixed times from the start, so a late one does not delay the others.
+    std::array<std::uint8_t, MAX_SYSEX_BYTES> bytes;
+    auto const interval = std::chrono::duration<double>(options.burst / options.rate);
+    auto const start = std::chrono::steady_clock::now();
+    for (std::uint64_t n = 0; n < options.count;) {
+        std::this_thread::sleep_until(
+            start + std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        interval * double(n / std::uint64_t(options.burst))
+                    )
+        );
+        for (int b = 0; b < options.burst && n < options.count; ++b, ++n) {
+            std::size_t const size = make_message(options, n, bytes.data());
+            loopback->sentAt[n % SEQUENCE_MODULO].store(now_ns(), std::memory_order_relaxed);
+            virtualOutput.send_message(bytes.data(), size);
+            loopback->sent.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
 
-    std::cout << "Press Enter to exit..." << std::endl;
-    std::cin.get();
+    // Give the stragglers a second to arrive.
+    auto const deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (loopback->received.load() < options.count &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    // Stops the input thread, so that the histogram is no longer recorded into while it is read.
+    input.close_port();
 
+    report(*loopback, options, elapsed.count());
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "synth/render.h"
+
+#include <gst/audio/audio-info.h>
+#include <gst/gst.h>
+
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// @brief Raw audio caps for the appsrc, matching the synth::render output layout.
+inline GstCaps* make_audio_caps(int sampleRate, int channels, synth::SampleFormat format) {
+    auto* audioInfo = gst_audio_info_new();
+    std::vector<GstAudioChannelPosition> chanPositions;
+    if (channels == 2) {
+        chanPositions = {
+            GST_AUDIO_CHANNEL_POSITION_FRONT_LEFT,
+            GST_AUDIO_CHANNEL_POSITION_FRONT_RIGHT
+        };
+    } else {
+        chanPositions = {GST_AUDIO_CHANNEL_POSITION_MONO};
+    }
+    gst_audio_info_set_format(
+        audioInfo,
+        format == synth::SampleFormat::S16 ? GST_AUDIO_FORMAT_S16 : GST_AUDIO_FORMAT_F32,
+        sampleRate,
+        channels,
+        chanPositions.data()
+    );
+
+    auto* caps = gst_audio_info_to_caps(audioInfo);
+    gst_audio_info_free(audioInfo);
+    return caps;
+}
+
+/// @brief Move best, if not yet set (0 or less), to the rate value allows that is nearest to
+/// preferred. value is a rate field of caps: an int, an int range or a list of either.
+inline void nearest_rate(const GValue* value, int preferred, int& best) {
+    auto consider = [&](int rate) {
+        if (best <= 0 || std::abs(rate - preferred) < std::abs(best - preferred)) {
+            best = rate;
+        }
+    };
+    if (G_VALUE_HOLDS_INT(value)) {
+        consider(g_value_get_int(value));
+    } else if (GST_VALUE_HOLDS_INT_RANGE(value)) {
+        int const low = gst_value_get_int_range_min(value);
+        int const high = gst_value_get_int_range_max(value);
+        consider(preferred < low ? low : preferred > high ? high : preferred);
+    } else if (GST_VALUE_HOLDS_LIST(value)) {
+        for (guint i = 0; i < gst_value_list_get_size(value); ++i) {
+            nearest_rate(gst_value_list_get_value(value, i), preferred, best);
+        }
+    }
+}
+
+/// @brief The rate of the sink's device nearest to preferred, as it reports it in READY. Leaves
+/// the sink in NULL. Returns preferred if the device cannot be opened.
+inline int reported_rate(GstElement* sink, int preferred) {
+    if (gst_element_set_state(sink, GST_STATE_READY) == GST_STATE_CHANGE_FAILURE) {
+        return preferred;
+    }
+    int best = -1;
+    auto* pad = gst_element_get_static_pad(sink, "sink");
+    if (auto* caps = gst_pad_query_caps(pad, nullptr)) {
+        for (guint i = 0; i < gst_caps_get_size(caps); ++i) {
+            if (auto* rate = gst_structure_get_value(gst_caps_get_structure(caps, i), "rate")) {
+                nearest_rate(rate, preferred, best);
+            }
+        }
+        gst_caps_unref(caps);
+    }
+    gst_object_unref(pad);
+    gst_element_set_state(sink, GST_STATE_NULL);
+    return best > 0 ? best : preferred;
+}
+
+/// @brief The rate the ALSA sink's device supports that is nearest to preferred, so that nothing
+/// between us and the hardware converts. A plughw device takes any rate, so for one the hw device
+/// under it is asked instead: the plug layer is then left to convert the sample format and the
+/// channels only. Leaves the sink in NULL. Returns preferred if the device cannot be opened.
+inline int device_rate(GstElement* sink, int preferred) {
+    gchar* name = nullptr;
+    g_object_get(G_OBJECT(sink), "device", &name, nullptr);
+    std::string_view const device = name ? name : "";
+    constexpr std::string_view PLUG = "plug";
+    int rate = preferred;
+    if (device.starts_with("plughw:")) {
+        if (auto* hardware = gst_element_factory_make("alsasink", nullptr)) {
+            std::string const hw(device.substr(PLUG.size()));
+            g_object_set(G_OBJECT(hardware), "device", hw.c_str(), nullptr);
+            rate = reported_rate(hardware, preferred);
+            gst_object_unref(hardware);
+        }
+    } else {
+        rate = reported_rate(sink, preferred);
+    }
+    g_free(name);
+    return rate;
+}
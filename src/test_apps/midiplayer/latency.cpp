@@ -0,0 +1,79 @@
+#include "latency.h"
+
+#include "logger/logger.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+std::uint64_t non_negative(std::int64_t ns) {
+    return static_cast<std::uint64_t>(std::max<std::int64_t>(ns, 0));
+}
+}  // namespace
+
+void LatencyTracker::note_on(std::int64_t timestamp, std::int64_t delay) {
+    if (numPending < MAX_PENDING) {
+        pending[numPending++] = {.timestamp = timestamp, .delay = delay};
+    }
+}
+
+std::int64_t LatencyTracker::block_rendered(GstElement* element, GstClockTime pts) {
+    GstClock* clock = gst_element_get_clock(element);
+    if (!clock) {  // not playing yet, nothing to measure against
+        numPending = 0;
+        return 0;
+    }
+    // Everything is relative to this instant; record() reads the steady clock right after it.
+    GstClockTime clockNow = gst_clock_get_time(clock);
+    gst_object_unref(clock);
+
+    GstClockTime playAt = gst_element_get_base_time(element) + pts +
+                          pipelineLatency.load(std::memory_order_relaxed);
+    std::int64_t const ahead =
+        static_cast<std::int64_t>(playAt) - static_cast<std::int64_t>(clockNow);
+    block_queued(ahead);
+    return ahead;
+}
+
+void LatencyTracker::block_queued(std::int64_t ahead) {
+    if (numPending > 0) {
+        record(ahead);
+    }
+}
+
+void LatencyTracker::record(std::int64_t ahead) {
+    auto steadyNow = std::chrono::steady_clock::now().time_since_epoch();
+    for (int i = 0; i < numPending; ++i) {
+        std::int64_t waited = std::chrono::nanoseconds(steadyNow).count() - pending[i].timestamp;
+        std::int64_t const sounds = ahead + pending[i].delay;
+        input.record(non_negative(waited));
+        output.record(non_negative(sounds));
+        total.record(non_negative(waited + sounds));
+    }
+    numPending = 0;
+}
+
+void LatencyTracker::update_latency(GstElement* pipeline) {
+    GstQuery* query = gst_query_new_latency();
+    if (gst_element_query(pipeline, query)) {
+        gboolean live;
+        GstClockTime min;
+        GstClockTime max;
+        gst_query_parse_latency(query, &live, &min, &max);
+        if (GST_CLOCK_TIME_IS_VALID(min)) {
+            pipelineLatency.store(min, std::memory_order_relaxed);
+        }
+    }
+    gst_query_unref(query);
+}
+
+void LatencyTracker::dump() const {
+    if (total.count() == 0) {
+        logger::log("Latency: no note ons measured yet");
+        return;
+    }
+    logger::log("Latency input:  {}", stats::summary(input));
+    logger::log("Latency output: {}", stats::summary(output));
+    logger::log("Latency total:  {}", stats::summary(total));
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "stats/histogram.h"
+
+#include <gst/gst.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/// @brief Note on to sound latency, split in two and measured per note:
+/// - input: from the MIDI timestamp to the audio thread filling the block that plays the note,
+/// - output: from then until the sink's clock reaches the note's sample, which is the block's
+///   first sample plus the note's offset into the block.
+///
+/// MIDI timestamps must come from the monotonic clock (libremidi::timestamp_mode::SystemMonotonic)
+/// so they can be compared with std::chrono::steady_clock.
+class LatencyTracker
+{
+public:
+    static constexpr int MAX_PENDING = 64;  ///< note ons per block; more are not measured
+
+    /// @brief Audio thread: a note on with this timestamp goes into the block being rendered,
+    /// and sounds delay nanoseconds after its first sample.
+    void note_on(std::int64_t timestamp, std::int64_t delay);
+
+    /// @brief Audio thread: the block was stamped with pts and is about to be pushed from
+    /// element. Records the note ons it contains.
+    /// @return how long before its play time the block is pushed, in ns: negative if the sink
+    /// will play it late, 0 if the pipeline has no clock yet
+    std::int64_t block_rendered(GstElement* element, GstClockTime pts);
+
+    /// @brief Audio thread: the block was written to an output::Sink, and its first sample plays
+    /// ahead nanoseconds from now. Records the note ons it contains.
+    void block_queued(std::int64_t ahead);
+
+    /// @brief Main thread: refresh the pipeline latency the sink adds to every timestamp.
+    void update_latency(GstElement* pipeline);
+
+    void dump() const;
+
+private:
+    void record(std::int64_t ahead);
+
+    struct Pending
+    {
+        std::int64_t timestamp;
+        std::int64_t delay;
+    };
+
+    std::array<Pending, MAX_PENDING> pending{};
+    int numPending = 0;
+    std::atomic<GstClockTime> pipelineLatency{0};
+    stats::Histogram input;
+    stats::Histogram output;
+    stats::Histogram total;
+};
@@ -1,190 +1,538 @@
+#include "audio/buffer_pool.h"
+#include "audio/realtime.h"
+#include "audio_caps.h"
+#include "events/merged_queue.h"
+#include "input/midi_inputs.h"
+#include "latency.h"
 #include "logger/logger.h"
+#include "logger/trace.h"
+#include "offline.h"
+#include "output/sink.h"
+#include "resampler/resampler.h"
+#include "soundfont/bank.h"
+#include "synth/block_renderer.h"
+#include "synth/render.h"
+#include "synth/voice_engine.h"
+#include "synth/worker_pool.h"
+#include "telemetry.h"
 
 #include <gst/app/gstappsrc.h>
-#include <gst/audio/audio-info.h>
 #include <gst/gst.h>
 
-#include <libremidi/libremidi.hpp>
+#include <glib-unix.h>
 
-#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
 #include <iostream>
-#include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
 #include <vector>
 
 using logger::log;
 
 namespace
 {
-constexpr int SAMPLE_RATE = 48'000;
-constexpr int CHANNELS = 1;
-constexpr double TWO_PI = 6.283185307179586;
-constexpr double amplitude = 0.3;  // range [0.0, 1.0]
-
-enum class Waveform
-{
-    SINE,
-    SAW,
-    SQUARE
-};
-Waveform waveform = Waveform::SQUARE;
-
-std::mutex mutex;
-int previousNote = -1;
-double nextFreq = 0.0;
-
-auto midi_callback = [](const libremidi::message& message) {
-    std::unique_lock lock(mutex);
-    if (message[0] == 0x90 && message[2] != 0) {  // Note on
-        previousNote = message[1];
-        nextFreq = 440.0 * std::pow(2.0, (previousNote - 69) / 12.0);
-        logger::log("Note on: {}, freq: {}", previousNote, nextFreq);
-    } else if (message[0] == 0x80 || (message[0] == 0x90 && message[2] == 0)) {  // Note off
-        int note = message[1];
-        if (note != previousNote) {
-            return;  // ignore, we only handle one note at a time
-        }
-        previousNote = -1;
-        nextFreq = 0;
-        logger::log("Note off: {}", note);
-    }
-};
-
-[[maybe_unused]]
-void gen_sine_wave(
-    float* buffer,
-    int numSamples,
-    double phase,
-    double frequency,
-    double amplitude
-) {
-    double phaseStep = TWO_PI * frequency / SAMPLE_RATE;
-    for (int i = 0; i < numSamples; ++i) {
-        buffer[i] = static_cast<float>(amplitude * std::sin(phase));
-        phase += phaseStep;
-        if (phase > TWO_PI) {
-            phase -= TWO_PI;
+constexpr int DEFAULT_SAMPLE_RATE = 48'000;
+constexpr int BLOCK_FRAMES = 480;
+
+// ALSA device and rates; see --device, --rate and --resampling. The engine renders at the rate
+// the device runs at natively unless told otherwise, so a plughw device has no rate to convert.
+// If the device cannot take the engine's rate, the resampler converts here instead.
+std::string device = "plughw:0,3";
+int engineRate = 0;  ///< 0: the device's
+int deviceRate = 0;
+resampler::Quality resampling = resampler::Quality::GOOD;
+std::unique_ptr<resampler::Converter> converter;
+std::vector<float> engineBlock;  ///< mono mix at the engine rate, before conversion
+std::vector<float> deviceBlock;  ///< the same at the device rate
+
+// Where the audio goes; see --backend and --period. "gstreamer" pushes blocks through appsrc to
+// an alsasink. "alsa" has the render thread write periods of periodFrames straight into the mmap'ed
+// ring buffer of the device, two periods deep, and "null" paces it the same way without a device.
+// "file" writes the periods to --device as a path, as fast as they render.
+std::string backend = "gstreamer";
+int periodFrames = 96;  ///< 2 ms at 48 kHz
+std::int64_t sinkLatency = 0;  ///< ns from writing a period to the device playing it
+
+// Blocks in flight: at most queuedBlocks wait in appsrc, up to SINK_BLOCKS more are with the sink.
+constexpr guint SINK_BLOCKS = 4;
+guint queuedBlocks = 4;
+audio::BufferPool bufferPool;
+
+// Push mode: a render thread of our own, scheduled as asked, keeps queuedBlocks blocks rendered
+// ahead in appsrc. Otherwise blocks are rendered on demand in appsrc's need-data signal.
+bool renderThread = false;
+audio::RealtimeOptions realtime;
+std::atomic<bool> rendering{false};
+std::atomic<bool> sinkFailed{false};  ///< the render thread gave up on the sink
+
+// The main loop, while run_main_loop() runs it.
+GMainLoop* mainLoop = nullptr;
+
+// Threads mixing the voices of a block, the audio thread included; see --workers.
+int numWorkers = 1;
+std::unique_ptr<synth::WorkerPool> workers;
+
+// Master gain of the live output, ramped in the engine; see --volume.
+float volume = 0.01f;
+
+// Instruments to play instead of the waveform, if a bank is given; see --soundfont.
+std::string soundFontPath;
+soundfont::Bank soundFont;
+
+// Output layout, chosen on the command line.
+synth::Waveform waveform = synth::Waveform::SQUARE;
+int channels = 1;
+synth::SampleFormat sampleFormat = synth::SampleFormat::F32;
+
+// Specialized render loop for the layout above, selected once at startup.
+synth::RenderFunction render_block = nullptr;
+
+// One source per MIDI input port, each filled by its libremidi thread, drained in timestamp
+// order by the audio thread.
+events::MergedQueue eventQueue{1024};
+std::vector<std::string> inputPatterns;  ///< empty: every input port
+
+// Written by the audio thread, dumped from the main loop.
+LatencyTracker latency;
+constexpr guint LATENCY_REPORT_SECONDS = 10;
+
+// Render deadlines and dropouts, dumped with the latency. With --metrics, also written to a
+// Prometheus text file every METRICS_SECONDS, for a scraper to correlate glitches with load.
+Telemetry telemetry;
+std::string metricsPath;
+constexpr guint METRICS_SECONDS = 1;
+
+bool parse_quality(std::string_view value, resampler::Quality& quality) {
+    constexpr resampler::Quality QUALITIES[] = {
+        resampler::Quality::LINEAR,
+        resampler::Quality::FAST,
+        resampler::Quality::GOOD,
+        resampler::Quality::BEST,
+    };
+    for (auto q : QUALITIES) {
+        if (resampler::name(q) == value) {
+            quality = q;
+            return true;
         }
     }
+    return false;
 }
 
-[[maybe_unused]]
-void gen_saw_wave(float* buffer, int numSamples, double phase, double frequency, double amplitude) {
-    double phaseStep = TWO_PI * frequency / SAMPLE_RATE;
-    for (int i = 0; i < numSamples; ++i) {
-        buffer[i] = static_cast<float>(amplitude * (2.0 * (phase / TWO_PI) - 1.0));
-        phase += phaseStep;
-        if (phase > TWO_PI) {
-            phase -= TWO_PI;
-        }
+/// @brief Settle on the rate the device runs at, and convert to it if the engine runs at another.
+void set_device_rate(int rate) {
+    deviceRate = rate;
+    if (engineRate <= 0) {
+        engineRate = deviceRate;
+    }
+    if (engineRate != deviceRate) {
+        converter = std::make_unique<resampler::Converter>(
+            engineRate, deviceRate, resampling, BLOCK_FRAMES
+        );
+        // A device block takes ratio times as many engine frames, give or take the filter's reach.
+        engineBlock.resize(std::size_t(BLOCK_FRAMES * converter->ratio()) + resampler::MAX_TAPS);
+        deviceBlock.resize(BLOCK_FRAMES);
+        render_block = synth::renderer(waveform, 1, synth::SampleFormat::F32);
+        log("{} runs at {} Hz: converting from {} Hz", device, deviceRate, engineRate);
+    } else {
+        log("{} runs at {} Hz", device, deviceRate);
     }
 }
 
-[[maybe_unused]]
-void gen_square_wave(
-    float* buffer,
-    int numSamples,
-    double phase,
-    double frequency,
-    double amplitude
-) {
-    double phaseStep = TWO_PI * frequency / SAMPLE_RATE;
-    for (int i = 0; i < numSamples; ++i) {
-        buffer[i] = static_cast<float>(amplitude * (phase < M_PI ? 1.0 : -1.0));
-        phase += phaseStep;
-        if (phase > TWO_PI) {
-            phase -= TWO_PI;
+/// @brief Render up to BLOCK_FRAMES frames at the device rate into out, in the output layout,
+/// with the MIDI events that arrived so far. periodFrame is where out starts in the buffer the
+/// latency is measured to. Only the audio thread touches the engine, so it needs no locking.
+void render(void* out, int numFrames, int periodFrame = 0) {
+    static synth::VoiceEngine engine(engineRate, waveform);
+    static bool const configured = [] {
+        engine.set_workers(workers.get());
+        engine.set_resampling(resampling);
+        engine.master_gain().reset(volume);
+        if (!soundFontPath.empty()) {
+            engine.set_soundfont(&soundFont);
+        }
+        return true;
+    }();
+    (void)configured;
+    static synth::BlockRenderer blocks(
+        render_block,
+        converter ? sizeof(float) : synth::bytes_per_frame(channels, sampleFormat)
+    );
+    std::uint64_t const firstFrame = blocks.position();
+    int const engineFrames = converter ? converter->required(numFrames) : numFrames;
+    auto const now =
+        std::chrono::nanoseconds(std::chrono::steady_clock::now().time_since_epoch()).count();
+    events::Event event;
+    while (eventQueue.pop(event)) {
+        // An event lands as far before the end of this block as it arrived before now. Blocks
+        // are rendered once per block period, so events keep their spacing at the cost of up to
+        // one block of latency, instead of all snapping to the block start.
+        std::int64_t age = (now - event.timestamp) * engineRate / 1'000'000'000;
+        std::int64_t offset =
+            std::clamp<std::int64_t>(engineFrames - age, 0, std::max(engineFrames - 1, 0));
+        if (!blocks.schedule(firstFrame + offset, event)) {
+            engine.handle(event);
+            offset = 0;
+        }
+        if (event.type == events::EventType::NOTE_ON) {
+            latency.note_on(
+                event.timestamp,
+                std::int64_t(periodFrame) * 1'000'000'000 / deviceRate +
+                    offset * 1'000'000'000 / engineRate
+            );
         }
     }
-}
 
-static void need_data(GstElement* appsrc, guint, gpointer) {
-    constexpr int numSamples = 480;
-    gsize bufSize = numSamples * sizeof(float) * CHANNELS;
+    if (converter) {
+        blocks.render(engine, engineBlock.data(), engineFrames);
+        converter->process(engineBlock.data(), deviceBlock.data(), numFrames);
+        synth::interleave(deviceBlock.data(), out, numFrames, channels, sampleFormat);
+    } else {
+        blocks.render(engine, out, numFrames);
+    }
+    telemetry.set_voices(engine.pool().active());
+    logger::trace("block at sample {}, {} voices", firstFrame, engine.pool().active());
+}
 
-    auto gstBuffer = gst_buffer_new_allocate(nullptr, bufSize, nullptr);
+/// @brief Render the next block into a pooled buffer and hand it to appsrc. Blocks while appsrc
+/// already holds queuedBlocks blocks.
+GstFlowReturn push_block(GstElement* appsrc) {
+    auto gstBuffer = bufferPool.acquire();
     if (!gstBuffer) {
-        log("Failed to allocate gstreamer buffer of size={}", bufSize);
-        return;
+        log("No buffer available from the pool");
+        return GST_FLOW_ERROR;
     }
 
     GstMapInfo map;
     gst_buffer_map(gstBuffer, &map, GST_MAP_WRITE);
-
-    double freq = nextFreq;
-    if (0 == freq) {
-        // silence
-        std::memset(map.data, 0, bufSize);
-    } else {
-        static double phase = 0.0;
-        phase += (TWO_PI * freq * numSamples) / SAMPLE_RATE;
-        phase = std::fmod(phase, TWO_PI);
-
-        if (CHANNELS == 1) {
-            switch (waveform) {
-                case Waveform::SINE:
-                    gen_sine_wave(
-                        reinterpret_cast<float*>(map.data),
-                        numSamples,
-                        phase,
-                        freq,
-                        amplitude
-                    );
-                    break;
-                case Waveform::SAW:
-                    gen_saw_wave(
-                        reinterpret_cast<float*>(map.data),
-                        numSamples,
-                        phase,
-                        freq,
-                        amplitude
-                    );
-                    break;
-                case Waveform::SQUARE:
-                    gen_square_wave(
-                        reinterpret_cast<float*>(map.data),
-                        numSamples,
-                        phase,
-                        freq,
-                        amplitude
-                    );
-                    break;
-            }
-        } else {
-            // Stereo, write interleaved data.
-        }
+    {
+        // The block has to be ready before the one ahead of it has played.
+        stats::DeadlineWatchdog::Timer timer(
+            telemetry.render, stats::DeadlineWatchdog::block_budget(BLOCK_FRAMES, deviceRate)
+        );
+        render(map.data, BLOCK_FRAMES);
     }
 
-    static int samples_pushed = 0;
-    GST_BUFFER_PTS(gstBuffer) = gst_util_uint64_scale(samples_pushed, GST_SECOND, SAMPLE_RATE);
-    GST_BUFFER_DURATION(gstBuffer) = gst_util_uint64_scale(numSamples, GST_SECOND, SAMPLE_RATE);
-    samples_pushed += numSamples;
+    static std::uint64_t deviceFrame = 0;
+    auto pts = gst_util_uint64_scale(deviceFrame, GST_SECOND, deviceRate);
+    deviceFrame += BLOCK_FRAMES;
+    GST_BUFFER_PTS(gstBuffer) = pts;
+    GST_BUFFER_DURATION(gstBuffer) = gst_util_uint64_scale(BLOCK_FRAMES, GST_SECOND, deviceRate);
+    telemetry.block_pushed(latency.block_rendered(appsrc, pts));
 
     gst_buffer_unmap(gstBuffer, &map);
-    GstFlowReturn ret{GST_FLOW_ERROR};
-    g_signal_emit_by_name(appsrc, "push-buffer", gstBuffer, &ret);
-    if (ret != GST_FLOW_OK) {
+    // appsrc takes our reference; the buffer returns to the pool once the sink is done with it.
+    auto ret = gst_app_src_push_buffer(GST_APP_SRC(appsrc), gstBuffer);
+    if (ret != GST_FLOW_OK && ret != GST_FLOW_FLUSHING) {
         log("error pushing buffer to appsrc");
+        telemetry.push_failed();
+    }
+    return ret;
+}
+
+static void need_data(GstElement* appsrc, guint, gpointer) {
+    push_block(appsrc);
+}
+
+void render_loop(GstElement* appsrc) {
+    audio::make_realtime(realtime);
+    log("Render thread running {} blocks ahead", queuedBlocks);
+    // push_block() blocks while appsrc is full, which paces the loop to the sink. Stopping the
+    // pipeline makes the push return FLUSHING and ends it.
+    while (rendering.load(std::memory_order_relaxed)) {
+        if (push_block(appsrc) != GST_FLOW_OK) {
+            break;
+        }
+    }
+    log("Render thread stopped");
+}
+
+/// @brief output::RenderCallback of the sink backends. The device may have settled on periods
+/// longer than a block.
+void render_period(void*, void* buffer, int numFrames) {
+    stats::DeadlineWatchdog::Timer timer(
+        telemetry.render, stats::DeadlineWatchdog::block_budget(numFrames, deviceRate)
+    );
+    auto* out = static_cast<std::byte*>(buffer);
+    std::size_t const frameBytes = synth::bytes_per_frame(channels, sampleFormat);
+    for (int done = 0; done < numFrames; done += BLOCK_FRAMES) {
+        render(out + done * frameBytes, std::min(BLOCK_FRAMES, numFrames - done), done);
+    }
+    latency.block_queued(sinkLatency);
+}
+
+void sink_loop(output::Sink* sink) {
+    audio::make_realtime(realtime);
+    log("Render thread writing periods of {} frames", sink->config().periodFrames);
+    // write() waits for the device to free a period, which paces the loop.
+    while (rendering.load(std::memory_order_relaxed)) {
+        if (!sink->write(render_period, nullptr)) {
+            // Nothing plays any more: end the main loop rather than sit there silent.
+            sinkFailed = true;
+            g_idle_add(
+                [](gpointer) -> gboolean {
+                    g_main_loop_quit(mainLoop);
+                    return G_SOURCE_REMOVE;
+                },
+                nullptr
+            );
+            break;
+        }
+    }
+    log("Render thread stopped");
+}
+
+/// @brief Start the threads mixing voices with the audio thread, if --workers asks for any.
+void start_workers() {
+    if (numWorkers > 1) {
+        // Each worker is scheduled like the audio thread and, if --cpu pins that one, pinned to a
+        // CPU of its own, counting up from the audio thread's.
+        int const numCpus = std::max(1, int(std::thread::hardware_concurrency()));
+        workers = std::make_unique<synth::WorkerPool>(numWorkers, [numCpus](int thread) {
+            audio::RealtimeOptions options = realtime;
+            if (realtime.cpu >= 0) {
+                options.cpu = (realtime.cpu + thread) % numCpus;
+            }
+            audio::make_realtime(options);
+        });
+        log("Mixing voices on {} threads", workers->size());
+    }
+}
+
+/// @brief Run the main loop until SIGINT or SIGTERM, calling report every
+/// LATENCY_REPORT_SECONDS and once more on the way out, and publishing the telemetry if asked.
+void run_main_loop(GSourceFunc report, gpointer data) {
+    log("Running main loop");
+    mainLoop = g_main_loop_new(nullptr, FALSE);
+    g_timeout_add_seconds(LATENCY_REPORT_SECONDS, report, data);
+    if (!metricsPath.empty()) {
+        g_timeout_add_seconds(
+            METRICS_SECONDS,
+            [](gpointer) -> gboolean {
+                // Logged once: stop trying rather than fill the log.
+                return telemetry.publish(metricsPath) ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+            },
+            nullptr
+        );
+    }
+    for (int signal : {SIGINT, SIGTERM}) {
+        g_unix_signal_add(
+            signal,
+            [](gpointer) -> gboolean {
+                g_main_loop_quit(mainLoop);
+                return G_SOURCE_REMOVE;
+            },
+            nullptr
+        );
+    }
+    g_main_loop_run(mainLoop);
+    g_main_loop_unref(mainLoop);
+    mainLoop = nullptr;
+    report(data);
+    if (!metricsPath.empty()) {
+        telemetry.publish(metricsPath);
+    }
+}
+
+/// @brief Play through an output::Sink from a render thread of our own instead of a GStreamer
+/// pipeline: --backend alsa or null.
+int run_sink() {
+    auto sink = output::make_sink(backend, device);
+    if (!sink) {
+        log("Unknown backend: {}", backend);
+        return EXIT_FAILURE;
     }
-    gst_buffer_unref(gstBuffer);
+    output::Config const requested = {
+        .sampleRate = engineRate > 0 ? engineRate : DEFAULT_SAMPLE_RATE,
+        .channels = channels,
+        .format = sampleFormat,
+        .periodFrames = periodFrames,
+        .periods = 2,
+    };
+    if (!sink->open(requested)) {
+        return EXIT_FAILURE;
+    }
+    auto const& config = sink->config();
+    set_device_rate(config.sampleRate);
+    // The period being written plays once the ones ahead of it in the device buffer have.
+    sinkLatency = std::int64_t(config.periods - 1) * config.periodFrames * 1'000'000'000 /
+                  config.sampleRate;
+    telemetry.watch_sink(sink.get());
+    start_workers();
+
+    log("Setting up MIDI input");
+    input::MidiInputs inputs(eventQueue);
+    if (inputs.open(inputPatterns) == 0) {
+        std::cerr << "Could not find a matching MIDI input port\n";
+        return EXIT_FAILURE;
+    }
+
+    rendering = true;
+    std::thread renderer(sink_loop, sink.get());
+    struct Report
+    {
+        output::Sink* sink;
+        input::MidiInputs* inputs;
+    } report{sink.get(), &inputs};
+    run_main_loop(
+        [](gpointer data) -> gboolean {
+            auto* report = static_cast<Report*>(data);
+            latency.dump();
+            telemetry.dump();
+            log("{}: {} frames written", backend, report->sink->position());
+            report->inputs->log_stats();
+            return G_SOURCE_CONTINUE;
+        },
+        &report
+    );
+
+    log("Stopping {}", backend);
+    rendering = false;
+    renderer.join();
+    sink->close();
+    workers.reset();
+
+    if (sinkFailed) {
+        log("{} failed, exiting", backend);
+    } else {
+        log("Application exiting");
+    }
+    logger::stop_trace();
+    logger::stop_async();
+    return sinkFailed ? EXIT_FAILURE : EXIT_SUCCESS;
 }
+
 }  // namespace
 
 int main(int argc, char* argv[]) {
-    if (argc > 1) {
-        std::string_view waveArg = argv[1];
-        if (waveArg == "sine") {
-            waveform = Waveform::SINE;
-        } else if (waveArg == "saw") {
-            waveform = Waveform::SAW;
-        } else if (waveArg == "square") {
-            waveform = Waveform::SQUARE;
+    OfflineOptions offline;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--channels" && i + 1 < argc) {
+            std::string_view value = argv[++i];
+            std::from_chars(value.data(), value.data() + value.size(), channels);
+        } else if (arg == "--format" && i + 1 < argc) {
+            std::string_view value = argv[++i];
+            if (value == "s16") {
+                sampleFormat = synth::SampleFormat::S16;
+            } else if (value != "f32") {
+                logger::log("Unknown sample format: {}, using f32", value);
+            }
+        } else if (arg == "--offline" && i + 1 < argc) {
+            offline.capture = argv[++i];
+        } else if (arg == "--start" && i + 1 < argc) {
+            std::string_view value = argv[++i];
+            std::from_chars(value.data(), value.data() + value.size(), offline.start);
+        } else if (arg == "--output" && i + 1 < argc) {
+            offline.output = argv[++i];
+        } else if (arg == "--gst-sink" && i + 1 < argc) {
+            offline.gstSink = argv[++i];
+        } else if (arg == "--render-thread") {
+            renderThread = true;
+        } else if (arg == "--periods" && i + 1 < argc) {
+            std::string_view value = argv[++i];
+            std::from_chars(value.data(), value.data() + value.size(), queuedBlocks);
+            queuedBlocks = std::max(queuedBlocks, 1u);
+        } else if (arg == "--rt-priority" && i + 1 < argc) {
+            std::string_view value = argv[++i];
+            std::from_chars(value.data(), value.data() + value.size(), realtime.priority);
+            renderThread = true;
+        } else if (arg == "--cpu" && i + 1 < argc) {
+            std::string_view value = argv[++i];
+            std::from_chars(value.data(), value.data() + value.size(), realtime.cpu);
+            renderThread = true;
+        } else if (arg == "--workers" && i + 1 < argc) {
+            std::string_view value = argv[++i];
+            std::from_chars(value.data(), value.data() + value.size(), numWorkers);
+        } else if (arg == "--soundfont" && i + 1 < argc) {
+            soundFontPath = argv[++i];
+        } else if (arg == "--backend" && i + 1 < argc) {
+            backend = argv[++i];
+        } else if (arg == "--period" && i + 1 < argc) {
+            std::string_view value = argv[++i];
+            std::from_chars(value.data(), value.data() + value.size(), periodFrames);
+        } else if (arg == "--device" && i + 1 < argc) {
+            device = argv[++i];
+        } else if (arg == "--rate" && i + 1 < argc) {
+            std::string_view value = argv[++i];
+            std::from_chars(value.data(), value.data() + value.size(), engineRate);
+        } else if (arg == "--resampling" && i + 1 < argc) {
+            std::string_view value = argv[++i];
+            if (!parse_quality(value, resampling)) {
+                logger::log("Unknown resampling: {}, using {}", value, resampler::name(resampling));
+            }
+        } else if (arg == "--volume" && i + 1 < argc) {
+            std::string_view value = argv[++i];
+            std::from_chars(value.data(), value.data() + value.size(), volume);
+        } else if (arg == "--mlock") {
+            audio::lock_memory();
+        } else if (arg == "--input" && i + 1 < argc) {
+            inputPatterns.emplace_back(argv[++i]);
+        } else if (arg == "--metrics" && i + 1 < argc) {
+            metricsPath = argv[++i];
+        } else if (arg == "--trace" && i + 1 < argc) {
+            logger::start_trace(argv[++i]);
+        } else if (arg == "sine") {
+            waveform = synth::Waveform::SINE;
+        } else if (arg == "saw") {
+            waveform = synth::Waveform::SAW;
+        } else if (arg == "square") {
+            waveform = synth::Waveform::SQUARE;
         } else {
-            logger::log("Unknown waveform: {}, using square", waveArg);
-            waveform = Waveform::SQUARE;
+            logger::log("Unknown waveform: {}, using square", arg);
+            waveform = synth::Waveform::SQUARE;
         }
     }
 
+    render_block = synth::renderer(waveform, channels, sampleFormat);
+    if (!render_block) {
+        logger::log("Unsupported output layout: {} channels", channels);
+        return EXIT_FAILURE;
+    }
+
+    if (!soundFontPath.empty()) {
+        auto const start = std::chrono::steady_clock::now();
+        if (!soundFont.open(soundFontPath)) {
+            return EXIT_FAILURE;
+        }
+        std::chrono::duration<double, std::milli> const loaded =
+            std::chrono::steady_clock::now() - start;
+        logger::log(
+            "{}: {} zones, {} MB of samples, loaded in {:.2f} ms",
+            soundFontPath,
+            soundFont.num_zones(),
+            soundFont.samples().size_bytes() >> 20,
+            loaded.count()
+        );
+        // Page in what a General MIDI file starts with; other programs load as they are played.
+        soundFont.prefetch(0);
+        soundFont.prefetch(soundfont::PERCUSSION);
+        offline.soundFont = &soundFont;
+    }
+
+    if (!offline.capture.empty()) {
+        gst_init(&argc, &argv);
+        offline.sampleRate = engineRate > 0 ? engineRate : DEFAULT_SAMPLE_RATE;
+        offline.channels = channels;
+        offline.waveform = waveform;
+        offline.format = sampleFormat;
+        offline.resampling = resampling;
+        int ret = run_offline(offline);
+        logger::stop_trace();
+        return ret;
+    }
+
+    // The MIDI and audio threads log, so keep formatting and terminal I/O off them.
+    logger::start_async();
     log("Starting application");
+    if (backend != "gstreamer") {
+        return run_sink();
+    }
 
     // set up the gstreamer
     gst_init(&argc, &argv);
@@ -195,35 +543,9 @@ int main(int argc, char* argv[]) {
         log("GStreamer: 'appsrc' could not be created.\n");
     }
 
-    {
-        auto* audioInfo = gst_audio_info_new();
-        std::vector<GstAudioChannelPosition> chanPositions;
-        if (CHANNELS == 2) {
-            chanPositions = {
-                GST_AUDIO_CHANNEL_POSITION_FRONT_LEFT,
-                GST_AUDIO_CHANNEL_POSITION_FRONT_RIGHT
-            };
-        } else {
-            chanPositions = {GST_AUDIO_CHANNEL_POSITION_MONO};
-        }
-        gst_audio_info_set_format(
-            audioInfo,
-            GST_AUDIO_FORMAT_F32,
-            SAMPLE_RATE,
-            CHANNELS,
-            chanPositions.data()
-        );
-
-        {
-            auto* caps = gst_audio_info_to_caps(audioInfo);
-            gst_audio_info_free(audioInfo);
-
-            g_object_set(G_OBJECT(appsrc), "caps", caps, nullptr);
-            gst_caps_unref(caps);
-        }
+    if (!renderThread) {
+        g_signal_connect(appsrc, "need-data", G_CALLBACK(need_data), nullptr);
     }
-
-    g_signal_connect(appsrc, "need-data", G_CALLBACK(need_data), nullptr);
     g_object_set(
         G_OBJECT(appsrc),
         "format",
@@ -243,22 +565,35 @@ int main(int argc, char* argv[]) {
     g_object_set(
         G_OBJECT(alsasink),
         "device",
-        "plughw:0,3",
-        // "plughw:TraktorKontrolS,0",
+        device.c_str(),
         "buffer-time",
         24'000,  // 24 ms
         "period-time",
         3'000,  // 3 ms
+        "qos",
+        TRUE,  // post QoS messages about the buffers it drops for lateness
         nullptr
     );
 
-    GstElement* volume = gst_element_factory_make("volume", "volume");
-    if (!volume) {
-        log("GStreamer: 'volume' element could not be created.\n");
-    }
+    set_device_rate(device_rate(alsasink, engineRate > 0 ? engineRate : DEFAULT_SAMPLE_RATE));
 
-    // Set the volume (0.0 = silent, 1.0 = full scale)
-    g_object_set(G_OBJECT(volume), "volume", 0.01, nullptr);  // 20% volume
+    {
+        auto* caps = make_audio_caps(deviceRate, channels, sampleFormat);
+        guint blockBytes = BLOCK_FRAMES * synth::bytes_per_frame(channels, sampleFormat);
+        if (!bufferPool.start(caps, blockBytes, queuedBlocks + SINK_BLOCKS)) {
+            return EXIT_FAILURE;
+        }
+        // Bound the appsrc queue below the pool size so a free buffer is always coming back.
+        g_object_set(
+            G_OBJECT(appsrc),
+            "caps",
+            caps,
+            "max-bytes",
+            guint64{queuedBlocks * blockBytes},
+            nullptr
+        );
+        gst_caps_unref(caps);
+    }
 
     // Create the empty pipeline
     GstElement* pipeline = gst_pipeline_new("test-pipeline");
@@ -268,94 +603,68 @@ int main(int argc, char* argv[]) {
     }
 
     // Build the pipeline
-    gst_bin_add_many(GST_BIN(pipeline), appsrc, volume, alsasink, nullptr);
-    if (gst_element_link_many(appsrc, volume, alsasink, nullptr) == FALSE) {
+    gst_bin_add_many(GST_BIN(pipeline), appsrc, alsasink, nullptr);
+    if (gst_element_link_many(appsrc, alsasink, nullptr) == FALSE) {
         log("GStreamer: Elements could not be linked.\n");
         gst_object_unref(pipeline);
         return EXIT_FAILURE;
     }
 
     log("gst pipeline built!");
+    telemetry.watch_bus(pipeline);
 
-    log("Setting up MIDI input");
+    start_workers();
 
-    libremidi::input_port input_port;
-
-    bool removed = false;
-    std::string_view port_name;
-    libremidi::container_identifier id;
-
-    std::vector<libremidi::observer> observers;
-    for (auto api : libremidi::available_apis()) {
-        if (api != libremidi::API::ALSA_SEQ) continue;
-        std::string_view api_name = libremidi::get_api_display_name(api);
-
-        logger::log("Displaying ports for: {}", api_name);
-        libremidi::observer_configuration cbs;
-        cbs.input_added = [=](const libremidi::input_port& p) {
-            logger::log("{} : input added {}", api_name, p.display_name);
-        };
-        cbs.input_removed = [&](const libremidi::input_port& p) {
-            if (id == p.container) {
-                logger::log("The CASIO port was removed by ID");
-                removed = true;
-            }
-            if (port_name == p.port_name) {
-                logger::log("The CASIO port was removed by name");
-                removed = true;
-            }
-        };
-        cbs.output_added = [=](const libremidi::output_port& p) {
-            logger::log("{} : output added {}", api_name, p.display_name);
-        };
-        cbs.output_removed = [=](const libremidi::output_port& p) {
-            logger::log("{} : output removed {}", api_name, p.display_name);
-        };
-        observers.emplace_back(cbs, libremidi::observer_configuration_for(api));
-    }
-
-    for (auto const& obs : observers) {
-        if (obs.get_current_api() != libremidi::API::ALSA_SEQ) continue;
-        for (auto const& port : obs.get_input_ports()) {
-            if (std::string::npos != port.port_name.find("CASIO")) {
-                logger::log("Using port {}", port.port_name);
-                input_port = port;
-                id = input_port.container;
-                port_name = input_port.port_name;
-                break;
-            }
-        }
-        if (!input_port.port_name.empty()) break;
-    }
+    log("Setting up MIDI input");
 
-    if (input_port.port_name.empty()) {
-        std::cerr << "Could not find the CASIO port\n";
+    input::MidiInputs inputs(eventQueue);
+    if (inputs.open(inputPatterns) == 0) {
+        std::cerr << "Could not find a matching MIDI input port\n";
         return EXIT_FAILURE;
     }
 
-    // Create the midi object
-    libremidi::midi_in midi{libremidi::input_configuration{.on_message = midi_callback}};
-
-    // Open a given midi port.
-    midi.open_port(input_port);
-
     // Start playing
     gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    std::thread renderer;
+    if (renderThread) {
+        rendering = true;
+        renderer = std::thread(render_loop, appsrc);
+    }
 
-    // Run main loop
-    log("Running main loop");
-    GMainLoop* loop = g_main_loop_new(nullptr, FALSE);
-    g_main_loop_run(loop);
+    // Run main loop until interrupted, reporting latency as we go
+    struct Report
+    {
+        GstElement* pipeline;
+        input::MidiInputs* inputs;
+    } report{pipeline, &inputs};
+    run_main_loop(
+        [](gpointer data) -> gboolean {
+            auto* report = static_cast<Report*>(data);
+            latency.update_latency(report->pipeline);
+            latency.dump();
+            telemetry.dump();
+            log("Buffer pool: {} hits, {} misses", bufferPool.hits(), bufferPool.misses());
+            report->inputs->log_stats();
+            return G_SOURCE_CONTINUE;
+        },
+        &report
+    );
 
     // Cleanup
     log("Stopping pipeline");
+    rendering = false;
     gst_element_set_state(pipeline, GST_STATE_NULL);
+    if (renderer.joinable()) {
+        renderer.join();
+    }
+    workers.reset();
     gst_object_unref(pipeline);
     gst_object_unref(alsasink);
-    gst_object_unref(volume);
     gst_object_unref(appsrc);
-    g_main_loop_unref(loop);
+    bufferPool.stop();
 
     log("Application exiting");
+    logger::stop_trace();
+    logger::stop_async();
     return EXIT_SUCCESS;
 }
@@ -1,86 +1,101 @@
 #!/usr/bin/env python3
-
-import mido
-import gi
-
-gi.require_version('Gst', '1.0')
-from gi.repository import Gst, GLib
-
-Gst.init(None)
-
-# --- Find the CASIO USB-MIDI port ---
-ports = mido.get_input_names()
-casio_port = None
-for port in ports:
-    if "CASIO" in port.upper():
-        casio_port = port
-        break
-
-if casio_port is None:
-    raise RuntimeError(f"CASIO USB-MIDI not found. Available ports: {ports}")
-
-print(f"Connecting to CASIO USB-MIDI: {casio_port}")
-inport = mido.open_input(casio_port)
-
-# --- Main pipeline ---
-pipeline = Gst.Pipeline.new("synth")
-mixer = Gst.ElementFactory.make("audiomixer", "mixer")
-sink = Gst.ElementFactory.make("autoaudiosink", "sink")
-pipeline.add(mixer)
-pipeline.add(sink)
-mixer.link(sink)
-
-active_notes = {}
-
-def midi_to_freq(note):
-    return 440.0 * 2.0 ** ((note - 69) / 12.0)
-
-def handle_midi(msg):
-    global pipeline, mixer, active_notes
-
-    if msg.type == 'note_on' and msg.velocity > 0:
-        note = msg.note
-        if note in active_notes:
-            return
-        freq = midi_to_freq(note)
-        print(f"Note ON: {note}, freq {freq:.2f} Hz")
-
-        src = Gst.ElementFactory.make("audiotestsrc", f"src_{note}")
-        src.set_property("wave", "saw")
-        src.set_property("freq", freq)
-        src.set_property("volume", msg.velocity / 127.0)
-
-        conv = Gst.ElementFactory.make("audioconvert", f"conv_{note}")
-
-        pipeline.add(src)
-        pipeline.add(conv)
-        src.link(conv)
-        conv.link(mixer)
-
-        src.sync_state_with_parent()
-        conv.sync_state_with_parent()
-
-        active_notes[note] = (src, conv)
-
-    elif msg.type in ('note_off', 'note_on') and (msg.type == 'note_off' or msg.velocity == 0):
-        note = msg.note
-        if note in active_notes:
-            print(f"Note OFF: {note}")
-            src, conv = active_notes[note]
-            conv.unlink(mixer)
-            src.set_state(Gst.State.NULL)
-            conv.set_state(Gst.State.NULL)
-            pipeline.remove(src)
-            pipeline.remove(conv)
-            del active_notes[note]
-
-pipeline.set_state(Gst.State.PLAYING)
-print("Listening to CASIO USB-MIDI... Press Ctrl+C to stop.")
-
-try:
-    for msg in inport:
-        handle_midi(msg)
-except KeyboardInterrupt:
-    print("Stopping...")
-finally:
-    pipeline.set_state(Gst.State.NULL)
+"""Play a MIDI keyboard through the midisynth extension module.
+
+MIDI input is read and the audio rendered in C++: the input ports feed the engine from their own
+threads, and render() releases the GIL while the engine runs, so Python only moves finished
+blocks around. By default they go out through a GStreamer appsrc; with --alsa or --null, a
+native render thread writes them to the device and Python only waits.
+
+midisynth is built along with everything else when CMake finds Python 3. Put the directory
+holding it on the module path, e.g. PYTHONPATH=build/release/lib.
+"""
+
+import argparse
+import time
+
+import midisynth
+
+REPORT_SECONDS = 10
+
+
+def play_gstreamer(synth):
+    import gi
+
+    gi.require_version('Gst', '1.0')
+    from gi.repository import Gst, GLib
+
+    Gst.init(None)
+    pipeline = Gst.parse_launch(
+        "appsrc name=src format=time is-live=true block=true "
+        "! audioconvert ! audioresample ! autoaudiosink"
+    )
+    src = pipeline.get_by_name("src")
+    src.set_property("caps", Gst.Caps.from_string(
+        "audio/x-raw,format=F32LE,layout=interleaved,"
+        f"rate={synth.sample_rate},channels={synth.channels}"
+    ))
+    frames = midisynth.BLOCK_FRAMES
+    duration = Gst.util_uint64_scale(frames, Gst.SECOND, synth.sample_rate)
+
+    # One element for the whole synth, however many notes are playing.
+    def need_data(src, length):
+        pts = Gst.util_uint64_scale(synth.position, Gst.SECOND, synth.sample_rate)
+        buffer = Gst.Buffer.new_wrapped(synth.render(frames).tobytes())
+        buffer.pts = pts
+        buffer.duration = duration
+        src.emit("push-buffer", buffer)
+
+    src.connect("need-data", need_data)
+    pipeline.set_state(Gst.State.PLAYING)
+    try:
+        GLib.MainLoop().run()
+    except KeyboardInterrupt:
+        print("Stopping...")
+    finally:
+        pipeline.set_state(Gst.State.NULL)
+
+
+def play_native(synth, backend, device, period):
+    synth.start(backend, device, period)
+    try:
+        while True:
+            time.sleep(REPORT_SECONDS)
+            print(f"{synth.position} frames played, {synth.xruns} xruns")
+    except KeyboardInterrupt:
+        print("Stopping...")
+    finally:
+        synth.stop()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--input", default="CASIO",
+                        help="play the MIDI input ports whose names contain this")
+    parser.add_argument("--waveform", default="saw", choices=["sine", "saw", "square"])
+    parser.add_argument("--soundfont", default="", help="SoundFont 2 bank to play instead")
+    parser.add_argument("--volume", type=float, default=0.2)
+    parser.add_argument("--rate", type=int, default=48000)
+    parser.add_argument("--alsa", metavar="DEVICE",
+                        help="play on this ALSA device from a native render thread")
+    parser.add_argument("--null", action="store_true",
+                        help="render from a native thread at the pace of a device, play nothing")
+    parser.add_argument("--period", type=int, default=96,
+                        help="frames per period with --alsa and --null")
+    args = parser.parse_args()
+
+    synth = midisynth.Synth(sample_rate=args.rate, channels=2, waveform=args.waveform,
+                            volume=args.volume, soundfont=args.soundfont)
+    if synth.open_inputs([args.input]) == 0:
+        raise RuntimeError(f"No MIDI input port matching {args.input}")
+    print(f"Playing MIDI input ports matching {args.input}... Press Ctrl+C to stop.")
+
+    if args.alsa:
+        play_native(synth, "alsa", args.alsa, args.period)
+    elif args.null:
+        play_native(synth, "null", "", args.period)
+    else:
+        play_gstreamer(synth)
+
+
+if __name__ == "__main__":
+    main()
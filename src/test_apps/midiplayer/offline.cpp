@@ -0,0 +1,354 @@
+#include "offline.h"
+
+#include "audio_caps.h"
+#include "events/capture.h"
+#include "logger/logger.h"
+#include "midi/seek_index.h"
+#include "midi/smf.h"
+#include "output/wav.h"
+#include "synth/block_renderer.h"
+
+#include <gst/app/gstappsrc.h>
+#include <gst/gst.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <vector>
+
+using logger::log;
+
+namespace
+{
+constexpr int BLOCK_FRAMES = 480;
+constexpr double TAIL_SECONDS = 1.0;  // keep rendering after the last event
+
+// Controllers of the pitch bend range, restored on a seek
+constexpr std::uint8_t CC_DATA_ENTRY = 6;
+constexpr std::uint8_t CC_RPN_LSB = 100;
+constexpr std::uint8_t CC_RPN_MSB = 101;
+
+/// @brief Where the events come from: a capture file, or a Standard MIDI File entered at any
+/// point through its seek index.
+class Input
+{
+public:
+    bool open(OfflineOptions const& options) {
+        if (options.capture.ends_with(".mid") || options.capture.ends_with(".midi")) {
+            return open_smf(options.capture, options.start);
+        }
+        if (!capture.open(options.capture)) {
+            log("Could not read capture file {}", options.capture);
+            return false;
+        }
+        return true;
+    }
+
+    /// @brief The next event and its time in ns from the start of the render.
+    bool next(events::Event& event, std::int64_t& time) {
+        if (reader) {
+            return next_smf(event, time);
+        }
+        events::CapturedMessage message;
+        while (capture.next(message)) {
+            if (!origin) {
+                origin = message.timestamp;
+            }
+            time = message.timestamp - *origin;
+            auto const& bytes = message.bytes;
+            if (events::parse(bytes.data(), bytes.size(), message.timestamp, event)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    bool open_smf(std::string const& path, double start) {
+        if (!file.open(path)) {
+            return false;
+        }
+        auto begin = std::chrono::steady_clock::now();
+        index.load_or_build(file, path);
+        auto indexed = std::chrono::steady_clock::now();
+
+        reader.emplace(file);
+        startTick = index.tempo().tick(start);
+        midi::ChannelStates channels;
+        index.seek(startTick, *reader, channels);
+        auto sought = std::chrono::steady_clock::now();
+
+        std::size_t numHeld = 0;
+        for (std::uint8_t ch = 0; ch < midi::NUM_CHANNELS; ++ch) {
+            auto const& state = channels[ch];
+            auto const controller = [&](std::uint8_t number) {
+                restore.push_back(
+                    {.type = events::EventType::CONTROL_CHANGE,
+                     .channel = ch,
+                     .data1 = number,
+                     .data2 = state.controllers[number]}
+                );
+            };
+            restore.push_back(
+                {.type = events::EventType::PROGRAM_CHANGE, .channel = ch, .data1 = state.program}
+            );
+            controller(CC_RPN_MSB);
+            controller(CC_RPN_LSB);
+            // A data entry of 0 looks like none at all: leave the default bend range then.
+            if (state.controllers[CC_DATA_ENTRY] != 0) {
+                controller(CC_DATA_ENTRY);
+            }
+            restore.push_back(
+                {.type = events::EventType::PITCH_BEND,
+                 .channel = ch,
+                 .data1 = std::uint8_t(state.pitchBend & 0x7F),
+                 .data2 = std::uint8_t(state.pitchBend >> 7)}
+            );
+            for (std::uint8_t note = 0; note < 128; ++note) {
+                if (auto velocity = state.notes[note]) {
+                    restore.push_back(
+                        {.type = events::EventType::NOTE_ON,
+                         .channel = ch,
+                         .data1 = note,
+                         .data2 = velocity}
+                    );
+                    ++numHeld;
+                }
+            }
+        }
+        log(
+            "{}: {} tracks, index {:.1f} ms, seek to {:.2f} s {:.3f} ms, {} notes held",
+            path,
+            file.num_tracks(),
+            std::chrono::duration<double, std::milli>(indexed - begin).count(),
+            index.tempo().seconds(startTick),
+            std::chrono::duration<double, std::milli>(sought - indexed).count(),
+            numHeld
+        );
+        return true;
+    }
+
+    bool next_smf(events::Event& event, std::int64_t& time) {
+        // First the state of the channels at the start, then the file from there.
+        if (restored < restore.size()) {
+            event = restore[restored++];
+            time = 0;
+            return true;
+        }
+        double const startSeconds = index.tempo().seconds(startTick);
+        midi::Event e;
+        while (reader->next(e)) {
+            if (e.kind != midi::EventKind::CHANNEL) {
+                continue;
+            }
+            time = static_cast<std::int64_t>((index.tempo().seconds(e.tick) - startSeconds) * 1e9);
+            std::uint8_t const bytes[] = {e.status, e.data1, e.data2};
+            if (events::parse(bytes, sizeof(bytes), time, event)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    events::CaptureReader capture;
+    std::optional<std::int64_t> origin;
+
+    midi::File file;
+    midi::SeekIndex index;
+    std::optional<midi::EventReader> reader;
+    std::uint64_t startTick = 0;
+    std::vector<events::Event> restore;
+    std::size_t restored = 0;
+};
+
+/// @brief Where the rendered blocks go: a file, a GStreamer pipeline, or nowhere.
+class Output
+{
+public:
+    explicit Output(OfflineOptions const& options)
+    : options(options) {}
+
+    ~Output() { close(); }
+
+    bool open() {
+        if (!options.gstSink.empty()) {
+            return open_pipeline();
+        }
+        if (options.output.empty()) {
+            return true;
+        }
+        file.open(options.output, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            log("Could not open {}", options.output);
+            return false;
+        }
+        wav = options.output.ends_with(".wav");
+        if (wav) {
+            output::write_wav_header(file, options.sampleRate, options.channels, options.format, 0);
+        }
+        return true;
+    }
+
+    bool write(const std::byte* data, std::size_t size, std::uint64_t firstFrame) {
+        if (appsrc) {
+            auto* buffer = gst_buffer_new_memdup(data, size);
+            GST_BUFFER_PTS(buffer) =
+                gst_util_uint64_scale(firstFrame, GST_SECOND, options.sampleRate);
+            GST_BUFFER_DURATION(buffer) =
+                gst_util_uint64_scale(BLOCK_FRAMES, GST_SECOND, options.sampleRate);
+            return gst_app_src_push_buffer(GST_APP_SRC(appsrc), buffer) == GST_FLOW_OK;
+        }
+        if (file.is_open()) {
+            file.write(reinterpret_cast<const char*>(data), size);
+            dataBytes += size;
+            return file.good();
+        }
+        return true;
+    }
+
+    void close() {
+        if (pipeline) {
+            gst_app_src_end_of_stream(GST_APP_SRC(appsrc));
+            auto* bus = gst_element_get_bus(pipeline);
+            auto* msg = gst_bus_timed_pop_filtered(
+                bus,
+                GST_CLOCK_TIME_NONE,
+                static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR)
+            );
+            if (msg) {
+                gst_message_unref(msg);
+            }
+            gst_object_unref(bus);
+            gst_element_set_state(pipeline, GST_STATE_NULL);
+            gst_object_unref(appsrc);
+            gst_object_unref(pipeline);
+            pipeline = nullptr;
+            appsrc = nullptr;
+        }
+        if (file.is_open()) {
+            if (wav) {
+                file.seekp(0);
+                output::write_wav_header(
+                    file,
+                    options.sampleRate,
+                    options.channels,
+                    options.format,
+                    static_cast<std::uint32_t>(dataBytes)
+                );
+            }
+            file.close();
+        }
+    }
+
+private:
+    bool open_pipeline() {
+        if (options.gstSink == "filesink" && options.output.empty()) {
+            log("filesink needs a file: see --output");
+            return false;
+        }
+        auto description = "appsrc name=source ! " + options.gstSink;
+        if (options.gstSink == "filesink") {
+            description += " location=" + options.output;
+        } else if (options.gstSink == "fakesink") {
+            description += " sync=false";
+        }
+        GError* error = nullptr;
+        pipeline = gst_parse_launch(description.c_str(), &error);
+        if (!pipeline) {
+            log("Could not create pipeline '{}': {}", description, error ? error->message : "");
+            g_clear_error(&error);
+            return false;
+        }
+        appsrc = gst_bin_get_by_name(GST_BIN(pipeline), "source");
+
+        auto* caps = make_audio_caps(options.sampleRate, options.channels, options.format);
+        g_object_set(
+            G_OBJECT(appsrc),
+            "caps",
+            caps,
+            "format",
+            GST_FORMAT_TIME,
+            "block",
+            TRUE,
+            nullptr
+        );
+        gst_caps_unref(caps);
+
+        gst_element_set_state(pipeline, GST_STATE_PLAYING);
+        return true;
+    }
+
+    OfflineOptions const& options;
+    std::ofstream file;
+    bool wav = false;
+    std::size_t dataBytes = 0;
+    GstElement* pipeline = nullptr;
+    GstElement* appsrc = nullptr;
+};
+}  // namespace
+
+int run_offline(OfflineOptions const& options) {
+    Input input;
+    if (!input.open(options)) {
+        return EXIT_FAILURE;
+    }
+    auto render = synth::renderer(options.waveform, options.channels, options.format);
+    if (!render) {
+        log("Unsupported output layout: {} channels", options.channels);
+        return EXIT_FAILURE;
+    }
+    Output output(options);
+    if (!output.open()) {
+        return EXIT_FAILURE;
+    }
+
+    synth::VoiceEngine engine(options.sampleRate, options.waveform);
+    engine.set_soundfont(options.soundFont);
+    engine.set_resampling(options.resampling);
+    auto bytesPerFrame = synth::bytes_per_frame(options.channels, options.format);
+    synth::BlockRenderer blocks(render, bytesPerFrame);
+    std::vector<std::byte> buffer(BLOCK_FRAMES * bytesPerFrame);
+    auto const tailFrames = static_cast<std::uint64_t>(TAIL_SECONDS * options.sampleRate);
+
+    events::Event event;
+    std::int64_t time;
+    bool pending = input.next(event, time);
+    std::uint64_t eventFrame = 0;
+    std::uint64_t numEvents = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    while (pending || blocks.position() < eventFrame + tailFrames) {
+        // Schedule everything that happens before the end of this block, at its exact frame.
+        std::uint64_t const blockEnd = blocks.position() + BLOCK_FRAMES;
+        while (pending) {
+            eventFrame = static_cast<std::uint64_t>(std::max<std::int64_t>(time, 0)) *
+                         options.sampleRate / 1'000'000'000;
+            if (eventFrame >= blockEnd || !blocks.schedule(eventFrame, event)) {
+                break;
+            }
+            ++numEvents;
+            pending = input.next(event, time);
+        }
+
+        std::uint64_t const frame = blocks.position();
+        blocks.render(engine, buffer.data(), BLOCK_FRAMES);
+        if (!output.write(buffer.data(), buffer.size(), frame)) {
+            log("Error writing rendered audio");
+            return EXIT_FAILURE;
+        }
+    }
+    output.close();
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double audioSeconds = static_cast<double>(blocks.position()) / options.sampleRate;
+    log(
+        "Rendered {} events, {:.2f} s of audio in {:.3f} s: real-time factor {:.1f}x",
+        numEvents,
+        audioSeconds,
+        elapsed,
+        audioSeconds / elapsed
+    );
+    return EXIT_SUCCESS;
+}
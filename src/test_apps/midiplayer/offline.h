@@ -0,0 +1,25 @@
+#pragma once
+
+#include "resampler/resampler.h"
+#include "soundfont/bank.h"
+#include "synth/render.h"
+
+#include <string>
+
+struct OfflineOptions
+{
+    std::string capture;  ///< recorded event stream (events/capture.h), or a .mid file
+    std::string output;   ///< .wav file, raw samples otherwise, nothing if empty
+    std::string gstSink;  ///< if set, push the blocks through `appsrc ! <gstSink>` instead
+    double start = 0.0;   ///< seconds into a .mid file to start rendering from
+    soundfont::Bank const* soundFont = nullptr;  ///< instruments to play instead of the waveform
+    resampler::Quality resampling = resampler::Quality::GOOD;  ///< of the SoundFont samples
+    int sampleRate;
+    int channels;
+    synth::Waveform waveform;
+    synth::SampleFormat format;
+};
+
+/// @brief Render a recorded event stream or a MIDI file as fast as possible through the same
+/// synthesis code as the live player, and report the real-time factor.
+int run_offline(OfflineOptions const& options);
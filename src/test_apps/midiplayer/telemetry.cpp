@@ -0,0 +1,154 @@
+#include "telemetry.h"
+
+#include "logger/logger.h"
+#include "stats/prometheus.h"
+
+#include <algorithm>
+#include <array>
+
+namespace
+{
+// Render time buckets, in ns: around the 2 ms period of the sink backends and the 10 ms block.
+constexpr std::array<std::uint64_t, 11> RENDER_BOUNDS = {
+    250'000,
+    500'000,
+    1'000'000,
+    2'000'000,
+    3'000'000,
+    5'000'000,
+    7'500'000,
+    10'000'000,
+    15'000'000,
+    20'000'000,
+    50'000'000,
+};
+
+/// @brief The text of a warning or error message, freed after logging.
+void log_message(char const* kind, GstMessage* message) {
+    GError* error = nullptr;
+    gchar* debug = nullptr;
+    if (GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR) {
+        gst_message_parse_error(message, &error, &debug);
+    } else {
+        gst_message_parse_warning(message, &error, &debug);
+    }
+    logger::log(
+        "GStreamer {} from {}: {}",
+        kind,
+        GST_OBJECT_NAME(GST_MESSAGE_SRC(message)),
+        error ? error->message : "unknown"
+    );
+    g_clear_error(&error);
+    g_free(debug);
+}
+}  // namespace
+
+void Telemetry::block_pushed(std::int64_t ahead) {
+    if (ahead < 0) {
+        lateBlocks.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Telemetry::watch_bus(GstElement* pipeline) {
+    GstBus* bus = gst_element_get_bus(pipeline);
+    gst_bus_add_watch(bus, on_message, this);
+    gst_object_unref(bus);
+}
+
+gboolean Telemetry::on_message(GstBus*, GstMessage* message, gpointer data) {
+    auto* telemetry = static_cast<Telemetry*>(data);
+    switch (GST_MESSAGE_TYPE(message)) {
+        case GST_MESSAGE_QOS: {
+            GstFormat format;
+            guint64 processed;
+            guint64 dropped;
+            gst_message_parse_qos_stats(message, &format, &processed, &dropped);
+            ++telemetry->qosMessages;
+            if (format == GST_FORMAT_BUFFERS || format == GST_FORMAT_DEFAULT) {
+                telemetry->droppedBuffers = std::max<std::uint64_t>(
+                    telemetry->droppedBuffers, dropped
+                );
+            }
+            break;
+        }
+        case GST_MESSAGE_WARNING:
+            ++telemetry->warnings;
+            log_message("warning", message);
+            break;
+        case GST_MESSAGE_ERROR:
+            ++telemetry->errors;
+            log_message("error", message);
+            break;
+        default:
+            break;
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+void Telemetry::dump() const {
+    logger::log(
+        "Render: {} of {} callbacks over {:.2f} ms, {}",
+        render.misses(),
+        render.callbacks(),
+        double(render.last_budget()) * 1e-6,
+        stats::summary(render.render_time())
+    );
+    logger::log(
+        "Dropouts: {} late blocks, {} push errors, {} QoS messages ({} buffers dropped), "
+        "{} warnings, {} errors, {} xruns",
+        lateBlocks.load(),
+        pushErrors.load(),
+        qosMessages,
+        droppedBuffers,
+        warnings,
+        errors,
+        sink ? sink->xruns() : 0
+    );
+}
+
+bool Telemetry::publish(std::string const& path) const {
+    stats::PrometheusText text;
+    text.counter(
+        "midiplayer_render_callbacks_total", "Render callbacks timed.", render.callbacks()
+    );
+    text.counter(
+        "midiplayer_render_deadline_misses_total",
+        "Render callbacks that took longer than their audio takes to play.",
+        render.misses()
+    );
+    text.gauge(
+        "midiplayer_render_budget_seconds",
+        "Time a render callback has, the duration of the audio it renders.",
+        double(render.last_budget()) * 1e-9
+    );
+    text.histogram(
+        "midiplayer_render_seconds",
+        "Time taken per render callback.",
+        render.render_time(),
+        RENDER_BOUNDS
+    );
+    text.gauge("midiplayer_voices", "Voices playing.", voices.load(std::memory_order_relaxed));
+    text.counter(
+        "midiplayer_late_blocks_total",
+        "Blocks pushed to the pipeline after their play time.",
+        lateBlocks.load(std::memory_order_relaxed)
+    );
+    text.counter(
+        "midiplayer_push_errors_total",
+        "Blocks appsrc refused.",
+        pushErrors.load(std::memory_order_relaxed)
+    );
+    text.counter("midiplayer_qos_messages_total", "QoS messages on the bus.", qosMessages);
+    // Each element reports its own running total, so the maximum over them is not a counter.
+    text.gauge(
+        "midiplayer_dropped_buffers",
+        "Most buffers dropped by one element, as reported by QoS.",
+        static_cast<double>(droppedBuffers)
+    );
+    text.counter("midiplayer_bus_warnings_total", "Warnings on the bus.", warnings);
+    text.counter("midiplayer_bus_errors_total", "Errors on the bus.", errors);
+    text.counter(
+        "midiplayer_xruns_total", "Underruns of the output sink.", sink ? sink->xruns() : 0
+    );
+    return text.write(path);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "output/sink.h"
+#include "stats/deadline.h"
+
+#include <gst/gst.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/// @brief What goes wrong on the way to the speaker, counted so dropouts can be told from load:
+/// - render callbacks overrunning the time their audio takes to play,
+/// - blocks reaching the sink after their play time,
+/// - what the pipeline reports itself on its bus: QoS messages about late buffers, warnings
+///   and errors,
+/// - the xruns of an output::Sink, on the sink backends.
+///
+/// Dumped with the latency, and published as a Prometheus text file with --metrics.
+class Telemetry
+{
+public:
+    /// @brief Audio thread: times the render callbacks.
+    stats::DeadlineWatchdog render;
+
+    /// @brief Audio thread: a block was pushed ahead ns before its play time.
+    void block_pushed(std::int64_t ahead);
+
+    /// @brief Audio thread: appsrc refused a block.
+    void push_failed() { pushErrors.fetch_add(1, std::memory_order_relaxed); }
+
+    /// @brief Audio thread: voices playing at the end of the last block.
+    void set_voices(int count) { voices.store(count, std::memory_order_relaxed); }
+
+    /// @brief Main thread: count the messages of the pipeline's bus from the main loop.
+    void watch_bus(GstElement* pipeline);
+
+    /// @brief Main thread: report the xruns of sink, which must stay open while watched.
+    void watch_sink(output::Sink const* sink) { this->sink = sink; }
+
+    /// @brief Main thread.
+    void dump() const;
+
+    /// @brief Main thread: write everything to path in the Prometheus text format. Returns false
+    /// and logs on error.
+    bool publish(std::string const& path) const;
+
+private:
+    static gboolean on_message(GstBus* bus, GstMessage* message, gpointer data);
+
+    std::atomic<std::uint64_t> lateBlocks{0};
+    std::atomic<std::uint64_t> pushErrors{0};
+    std::atomic<int> voices{0};
+
+    // Main thread only.
+    std::uint64_t qosMessages = 0;
+    std::uint64_t droppedBuffers = 0;  ///< the most any element reported in a QoS message
+    std::uint64_t warnings = 0;
+    std::uint64_t errors = 0;
+    output::Sink const* sink = nullptr;
+};
@@ -0,0 +1,142 @@
+#include "events/capture.h"
+#include "midi/smf_writer.h"
+#include "offline.h"
+#include "soundfont/bank.h"
+#include "soundfont/sf2_builder.h"
+#include "test_support/files.h"
+
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+using test_support::read_at;
+using test_support::read_file;
+using test_support::temp_path;
+
+constexpr int SAMPLE_RATE = 48'000;
+
+/// @brief A capture of A4 held for 100 ms, starting a second into the capture.
+std::string write_capture() {
+    auto const path = temp_path("midiplayer_offline.capture");
+    events::CaptureWriter writer;
+    REQUIRE(writer.open(path));
+    std::uint8_t const noteOn[] = {0x90, 69, 100};
+    std::uint8_t const noteOff[] = {0x80, 69, 0};
+    writer.write(1'000'000'000, 0, noteOn);
+    writer.write(1'100'000'000, 0, noteOff);
+    writer.close();
+    return path;
+}
+
+/// @brief A MIDI file switching channel 1 to program 5, then holding middle C from 0.2 s to
+/// 0.9 s.
+std::string write_smf() {
+    auto const path = temp_path("midiplayer_offline.mid");
+    midi::SmfWriter writer;
+    REQUIRE(writer.open(path));
+    std::uint8_t const programChange[] = {0xC0, 5};
+    std::uint8_t const noteOn[] = {0x90, 60, 100};
+    std::uint8_t const noteOff[] = {0x80, 60, 0};
+    writer.write(0, 0, programChange);
+    writer.write(200'000'000, 0, noteOn);
+    writer.write(900'000'000, 0, noteOff);
+    writer.close();
+    return path;
+}
+
+/// @brief A bank with a flat quarter scale loop on program 5, and nothing on program 0.
+Bytes program_5_bank() {
+    return sf2(
+        std::vector<std::int16_t>(1000, 8192),
+        {{.start = 0, .end = 900, .loopStart = 100, .loopEnd = 800}},
+        {{{{GEN_SAMPLE_MODES, 1}, {GEN_SAMPLE_ID, 0}}}},
+        {{.program = 5, .bank = 0, .zones = {{{GEN_INSTRUMENT, 0}}}}}
+    );
+}
+
+OfflineOptions options(std::string capture) {
+    return {
+        .capture = std::move(capture),
+        .sampleRate = SAMPLE_RATE,
+        .channels = 1,
+        .waveform = synth::Waveform::SINE,
+        .format = synth::SampleFormat::F32,
+    };
+}
+
+}  // namespace
+
+TEST_CASE("an offline render writes the events and a second of tail to a WAV file") {
+    auto const capture = write_capture();
+    auto const wav = temp_path("midiplayer_offline.wav");
+    auto render = options(capture);
+    render.output = wav;
+    REQUIRE(run_offline(render) == EXIT_SUCCESS);
+
+    // The note off lands at frame 4800; the tail runs a second past it, in whole blocks.
+    constexpr std::size_t FRAMES = 4800 + SAMPLE_RATE;
+    auto const bytes = read_file(wav);
+    REQUIRE(bytes.size() == 44 + FRAMES * sizeof(float));
+    CHECK(read_at<std::uint32_t>(bytes, 40) == FRAMES * sizeof(float));
+    CHECK(read_at<std::uint16_t>(bytes, 20) == 3);  // IEEE float
+    CHECK(read_at<std::uint32_t>(bytes, 24) == SAMPLE_RATE);
+
+    auto sample = [&](std::size_t frame) { return read_at<float>(bytes, 44 + 4 * frame); };
+    float peak = 0.f;
+    for (std::size_t frame = 0; frame < 4800; ++frame) {
+        peak = std::max(peak, std::abs(sample(frame)));
+    }
+    CHECK(peak > 0.f);
+    CHECK(peak <= 1.f);
+    // Released at 100 ms: silent well before the end.
+    for (std::size_t frame = 10'000; frame < FRAMES; ++frame) {
+        REQUIRE(sample(frame) == 0.f);
+    }
+
+    std::filesystem::remove(wav);
+    std::filesystem::remove(capture);
+}
+
+TEST_CASE("a seek into a MIDI file restores the programs before restriking the held notes") {
+    auto const smf = write_smf();
+    auto const wav = temp_path("midiplayer_offline_seek.wav");
+    Bytes const bytes = program_5_bank();
+    soundfont::Bank bank;
+    REQUIRE(bank.parse(bytes));
+
+    auto render = options(smf);
+    render.output = wav;
+    render.start = 0.5;  // past the program change, with the note held
+    render.soundFont = &bank;
+    REQUIRE(run_offline(render) == EXIT_SUCCESS);
+
+    // Program 0 has no instrument: the note only sounds on program 5.
+    auto const out = read_file(wav);
+    REQUIRE(out.size() > 44 + 480 * sizeof(float));
+    float peak = 0.f;
+    for (std::size_t frame = 0; frame < 480; ++frame) {
+        peak = std::max(peak, std::abs(read_at<float>(out, 44 + 4 * frame)));
+    }
+    CHECK(peak > 0.f);
+
+    std::filesystem::remove(wav);
+    std::filesystem::remove(smf);
+    std::filesystem::remove(smf + ".idx");
+}
+
+TEST_CASE("filesink without an output file is refused") {
+    auto const capture = write_capture();
+    auto render = options(capture);
+    render.gstSink = "filesink";
+    CHECK(run_offline(render) == EXIT_FAILURE);
+    std::filesystem::remove(capture);
+}
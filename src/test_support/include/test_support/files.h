@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace test_support
+{
+/// @brief A path for name in the system's temporary directory.
+inline std::string temp_path(std::string_view name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+/// @brief The whole file, empty if it cannot be read.
+inline std::vector<char> read_file(std::string const& path) {
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+/// @brief The T at offset in bytes, in host byte order.
+template <typename T>
+T read_at(std::vector<char> const& bytes, std::size_t offset) {
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(T));
+    return value;
+}
+
+}  // namespace test_support